@@ -0,0 +1,82 @@
+//
+// Copyright (c) 2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Container/StableIndexVector.h>
+
+namespace
+{
+
+struct TestElement
+{
+    unsigned index_{M_MAX_UNSIGNED};
+};
+
+struct TestElementIndex
+{
+    unsigned GetIndex(const TestElement* element) const { return element->index_; }
+    void SetIndex(TestElement* element, unsigned index) const { element->index_ = index; }
+};
+
+}
+
+TEST_CASE("StableIndexVector keeps indices until compacted")
+{
+    TestElement elements[4];
+    StableIndexVector<TestElement, TestElementIndex> vector;
+    for (TestElement& element : elements)
+        vector.Add(&element);
+
+    REQUIRE(vector.Size() == 4);
+    REQUIRE(vector.GetNumElements() == 4);
+    REQUIRE(elements[2].index_ == 2);
+
+    // Removed elements are replaced with null
+    REQUIRE(vector.Remove(&elements[1]));
+    REQUIRE_FALSE(vector.Remove(&elements[1]));
+    REQUIRE(vector.Size() == 4);
+    REQUIRE(vector.GetNumElements() == 3);
+    REQUIRE(vector[1] == nullptr);
+    REQUIRE(vector[2] == &elements[2]);
+    REQUIRE(elements[1].index_ == M_MAX_UNSIGNED);
+    REQUIRE(elements[2].index_ == 2);
+
+    // Compaction removes nulls and updates indices
+    vector.Compact();
+    REQUIRE(vector.Size() == 3);
+    REQUIRE(vector.GetNumElements() == 3);
+    REQUIRE(vector[1] == &elements[2]);
+    REQUIRE(elements[0].index_ == 0);
+    REQUIRE(elements[2].index_ == 1);
+    REQUIRE(elements[3].index_ == 2);
+
+    // Removed element may be added again
+    vector.Add(&elements[1]);
+    REQUIRE(elements[1].index_ == 3);
+    REQUIRE(vector[3] == &elements[1]);
+
+    vector.Clear();
+    REQUIRE(vector.Empty());
+    for (const TestElement& element : elements)
+        REQUIRE(element.index_ == M_MAX_UNSIGNED);
+}
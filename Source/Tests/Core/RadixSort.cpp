@@ -0,0 +1,186 @@
+//
+// Copyright (c) 2021-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Core/RadixSort.h>
+#include <Urho3D/RenderPipeline/PipelineBatchSortKey.h>
+
+#include <random>
+
+namespace
+{
+
+struct KeyValue
+{
+    unsigned long long key_{};
+    unsigned index_{};
+};
+
+ea::vector<KeyValue> CreateKeyValues(unsigned size, unsigned long long keyMask)
+{
+    std::mt19937_64 rng(size);
+    ea::vector<KeyValue> result(size);
+    for (unsigned i = 0; i < size; ++i)
+        result[i] = {rng() & keyMask, i};
+    return result;
+}
+
+ea::vector<PipelineBatchByState> CreateBatchesByState(unsigned size)
+{
+    std::mt19937_64 rng(size);
+    ea::vector<PipelineBatchByState> result(size);
+    for (PipelineBatchByState& batch : result)
+    {
+        // Keep the key distribution close to the real one: few render orders and shaders, many geometries
+        batch.primaryKey_ = rng() & 0x00ff00ff0fff0f0full;
+        batch.secondaryKey_ = rng() & 0x0000ffffffff0000ull;
+    }
+    return result;
+}
+
+bool IsStableSorted(const ea::vector<KeyValue>& elements)
+{
+    for (unsigned i = 1; i < elements.size(); ++i)
+    {
+        const KeyValue& lhs = elements[i - 1];
+        const KeyValue& rhs = elements[i];
+        if (lhs.key_ > rhs.key_ || (lhs.key_ == rhs.key_ && lhs.index_ > rhs.index_))
+            return false;
+    }
+    return true;
+}
+
+}
+
+TEST_CASE("Radix sort is stable and orders elements by key")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto workQueue = context->GetSubsystem<WorkQueue>();
+    const auto getKey = [](const KeyValue& element) { return element.key_; };
+
+    for (unsigned size : {0u, 1u, 17u, 1000u, 50000u})
+    {
+        for (unsigned long long keyMask : {0x0ull, 0xffull, 0xff00ff00ull, 0xffffffffffffffffull})
+        {
+            RadixSortBuffers<KeyValue> buffers;
+
+            auto elements = CreateKeyValues(size, keyMask);
+            RadixSort<KeyValue>(elements, buffers, getKey);
+            CHECK(elements.size() == size);
+            CHECK(IsStableSorted(elements));
+
+            auto elementsParallel = CreateKeyValues(size, keyMask);
+            ParallelRadixSort<KeyValue>(workQueue, elementsParallel, buffers, getKey);
+            CHECK(elementsParallel.size() == size);
+            CHECK(IsStableSorted(elementsParallel));
+        }
+    }
+}
+
+TEST_CASE("Pipeline batches are sorted the same way as with comparison sort")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto workQueue = context->GetSubsystem<WorkQueue>();
+
+    SECTION("Batches sorted by state")
+    {
+        RadixSortBuffers<PipelineBatchByState> buffers;
+        auto batches = CreateBatchesByState(20000);
+        auto expectedBatches = batches;
+
+        SortPipelineBatches(workQueue, batches, buffers);
+        ea::sort(expectedBatches.begin(), expectedBatches.end());
+
+        for (unsigned i = 0; i < batches.size(); ++i)
+        {
+            REQUIRE(batches[i].primaryKey_ == expectedBatches[i].primaryKey_);
+            REQUIRE(batches[i].secondaryKey_ == expectedBatches[i].secondaryKey_);
+        }
+    }
+
+    SECTION("Batches sorted back to front")
+    {
+        RadixSortBuffers<PipelineBatchBackToFront> buffers;
+        ea::vector<PipelineBatchBackToFront> batches;
+        std::mt19937 rng(0);
+        std::uniform_real_distribution<float> distanceDistribution(-100.0f, 100.0f);
+        for (unsigned i = 0; i < 1000; ++i)
+        {
+            PipelineBatchBackToFront batch;
+            batch.renderOrder_ = static_cast<unsigned char>(rng() % 3 + 127);
+            batch.distance_ = i % 10 == 0 ? 0.0f : distanceDistribution(rng);
+            batches.push_back(batch);
+        }
+        auto expectedBatches = batches;
+
+        SortPipelineBatches(workQueue, batches, buffers);
+        ea::stable_sort(expectedBatches.begin(), expectedBatches.end());
+
+        for (unsigned i = 0; i < batches.size(); ++i)
+        {
+            REQUIRE(batches[i].renderOrder_ == expectedBatches[i].renderOrder_);
+            REQUIRE(batches[i].distance_ == expectedBatches[i].distance_);
+        }
+    }
+}
+
+TEST_CASE("Pipeline batch sorting benchmark", "[.benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto workQueue = context->GetSubsystem<WorkQueue>();
+
+    const unsigned numBatches = 200000;
+    const auto sourceBatches = CreateBatchesByState(numBatches);
+    ea::vector<PipelineBatchByState> batches;
+    RadixSortBuffers<PipelineBatchByState> buffers;
+
+    BENCHMARK_ADVANCED("Comparison sort")(Catch::Benchmark::Chronometer meter)
+    {
+        meter.measure([&]
+        {
+            batches = sourceBatches;
+            ea::sort(batches.begin(), batches.end());
+            return batches.size();
+        });
+    };
+
+    BENCHMARK_ADVANCED("Radix sort")(Catch::Benchmark::Chronometer meter)
+    {
+        meter.measure([&]
+        {
+            batches = sourceBatches;
+            SortPipelineBatches(nullptr, batches, buffers);
+            return batches.size();
+        });
+    };
+
+    BENCHMARK_ADVANCED("Parallel radix sort")(Catch::Benchmark::Chronometer meter)
+    {
+        meter.measure([&]
+        {
+            batches = sourceBatches;
+            SortPipelineBatches(workQueue, batches, buffers);
+            return batches.size();
+        });
+    };
+}
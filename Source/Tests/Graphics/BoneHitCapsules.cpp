@@ -0,0 +1,229 @@
+//
+// Copyright (c) 2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../CommonUtils.h"
+#include "../ModelUtils.h"
+#include "../SceneUtils.h"
+
+#include <Urho3D/Graphics/AnimatedModel.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/Math/CapsuleBatch.h>
+#include <Urho3D/Math/RandomEngine.h>
+#include <Urho3D/Scene/Scene.h>
+
+namespace
+{
+
+SharedPtr<Model> CreateTestSkinnedModel(Context* context)
+{
+    return Tests::CreateSkinnedQuad_Model(context)->ExportModel();
+}
+
+SharedPtr<Scene> CreateTestScene(Context* context, Model* model, unsigned numModels)
+{
+    auto scene = MakeShared<Scene>(context);
+    scene->CreateComponent<Octree>();
+
+    for (unsigned i = 0; i < numModels; ++i)
+    {
+        auto node = scene->CreateChild(Format("Node {}", i));
+        node->SetPosition({static_cast<float>(i) * 3.0f, 0.0f, 0.0f});
+        auto animatedModel = node->CreateComponent<AnimatedModel>();
+        animatedModel->SetModel(model);
+        animatedModel->SetUseHitCapsules(true);
+    }
+    return scene;
+}
+
+}
+
+TEST_CASE("Capsule batch hit distances match scalar ray test")
+{
+    RandomEngine random{0};
+    CapsuleBatch batch;
+    for (unsigned i = 0; i < 103; ++i)
+    {
+        const Vector3 start = random.GetVector3({-2.0f, -2.0f, -2.0f}, {2.0f, 2.0f, 2.0f});
+        const Vector3 end = i % 10 == 0 ? start : random.GetVector3({-2.0f, -2.0f, -2.0f}, {2.0f, 2.0f, 2.0f});
+        batch.Add(start, end, random.GetFloat(0.1f, 1.0f));
+    }
+    REQUIRE(batch.GetSize() == 103);
+
+    for (unsigned i = 0; i < 50; ++i)
+    {
+        const Vector3 origin = random.GetVector3({-5.0f, -5.0f, -5.0f}, {5.0f, 5.0f, 5.0f});
+        const Vector3 target = random.GetVector3({-1.0f, -1.0f, -1.0f}, {1.0f, 1.0f, 1.0f});
+        const Ray ray{origin, target - origin};
+        const float sweepRadius = i % 2 == 0 ? 0.0f : 0.25f;
+
+        const auto distances = batch.HitDistances(ray, sweepRadius);
+        REQUIRE(distances.size() == batch.GetSize());
+        for (unsigned j = 0; j < distances.size(); ++j)
+        {
+            const float expected = ray.HitDistanceCapsule(batch.GetStart(j), batch.GetEnd(j), batch.GetRadius(j) + sweepRadius);
+            if (expected == M_INFINITY)
+                REQUIRE(distances[j] == M_INFINITY);
+            else
+                REQUIRE(Equals(distances[j], expected, 0.001f));
+        }
+    }
+}
+
+TEST_CASE("Ray is tested against capsule")
+{
+    const Vector3 start{-1.0f, 0.0f, 0.0f};
+    const Vector3 end{1.0f, 0.0f, 0.0f};
+
+    // Body, end sphere, inside and miss
+    CHECK(Equals(Ray({0.0f, 0.0f, 5.0f}, Vector3::BACK).HitDistanceCapsule(start, end, 0.5f), 4.5f));
+    CHECK(Equals(Ray({1.3f, 0.0f, 5.0f}, Vector3::BACK).HitDistanceCapsule(start, end, 0.5f), 4.6f));
+    CHECK(Equals(Ray({5.0f, 0.0f, 0.0f}, Vector3::LEFT).HitDistanceCapsule(start, end, 0.5f), 3.5f));
+    CHECK(Ray({0.5f, 0.1f, 0.0f}, Vector3::UP).HitDistanceCapsule(start, end, 0.5f) == 0.0f);
+    CHECK(Ray({1.6f, 0.0f, 5.0f}, Vector3::BACK).HitDistanceCapsule(start, end, 0.5f) == M_INFINITY);
+    CHECK(Ray({0.0f, 0.0f, 5.0f}, Vector3::FORWARD).HitDistanceCapsule(start, end, 0.5f) == M_INFINITY);
+}
+
+TEST_CASE("AnimatedModel is raycasted against bone hit capsules")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto model = Tests::GetOrCreateResource<Model>(context, "@Tests/BoneHitCapsules/SkinnedModel.mdl", CreateTestSkinnedModel);
+
+    // Root bone has no vertices, quads are enclosed by capsules along X axis
+    const auto& bones = model->GetSkeleton().GetBones();
+    REQUIRE(bones.size() == 3);
+    CHECK(bones[0].hitCapsuleRadius_ == 0.0f);
+    CHECK(Equals(bones[1].hitCapsuleRadius_, 0.5f));
+    CHECK(Equals(bones[2].hitCapsuleRadius_, 0.5f));
+    CHECK(bones[1].hitCapsuleStart_.Equals({-0.5f, 0.5f, 0.0f}));
+    CHECK(bones[1].hitCapsuleEnd_.Equals({0.5f, 0.5f, 0.0f}));
+
+    // Hit capsules are opt-in
+    CHECK_FALSE(MakeShared<AnimatedModel>(context)->GetUseHitCapsules());
+
+    auto scene = CreateTestScene(context, model, 2);
+    Tests::RunFrame(context, 0.1f, 0.1f);
+
+    auto octree = scene->GetComponent<Octree>();
+    auto animatedModel = scene->GetChild("Node 0")->GetComponent<AnimatedModel>();
+
+    // Octree raycast reports bone and capsule normal
+    {
+        ea::vector<RayQueryResult> results;
+        RayOctreeQuery query(results, Ray({0.0f, 1.5f, 5.0f}, Vector3::BACK), RAY_TRIANGLE, 10.0f);
+        octree->RaycastSingle(query);
+        REQUIRE(results.size() == 1);
+        CHECK(results[0].drawable_ == animatedModel);
+        CHECK(results[0].subObject_ == 2);
+        CHECK(Equals(results[0].distance_, 4.5f));
+        CHECK(results[0].normal_.Equals(Vector3::FORWARD));
+    }
+
+    // Capsules replace flat bone boxes unless disabled
+    {
+        ea::vector<RayQueryResult> results;
+        RayOctreeQuery query(results, Ray({0.45f, 0.05f, 5.0f}, Vector3::BACK), RAY_TRIANGLE, 10.0f);
+        octree->RaycastSingle(query);
+        REQUIRE(results.size() == 1);
+        CHECK(results[0].subObject_ == 1);
+        CHECK(Equals(results[0].distance_, 5.0f - sqrtf(0.5f * 0.5f - 0.45f * 0.45f), 0.001f));
+
+        animatedModel->SetUseHitCapsules(false);
+        octree->RaycastSingle(query);
+        REQUIRE(results.size() == 1);
+        CHECK(results[0].subObject_ == 1);
+        CHECK(Equals(results[0].distance_, 5.0f, 0.001f));
+        animatedModel->SetUseHitCapsules(true);
+    }
+
+    // Bones without collision shape are not hit by capsules either
+    {
+        Bone& quad2 = animatedModel->GetSkeleton().GetModifiableBones()[2];
+        quad2.collisionMask_ = BONECOLLISION_NONE;
+
+        ea::vector<RayQueryResult> results;
+        RayOctreeQuery query(results, Ray({0.0f, 1.5f, 5.0f}, Vector3::BACK), RAY_TRIANGLE, 10.0f);
+        octree->RaycastSingle(query);
+        CHECK(results.empty());
+        CHECK(animatedModel->SweepHitCapsules(query.ray_, 0.0f, 10.0f) == M_INFINITY);
+
+        quad2.collisionMask_ = BONECOLLISION_BOX;
+    }
+
+    // Sweep of a single model
+    {
+        const Ray ray{{0.0f, -0.2f, 5.0f}, Vector3::BACK};
+        CHECK(animatedModel->SweepHitCapsules(ray, 0.0f, 10.0f) == M_INFINITY);
+
+        unsigned hitBone = M_MAX_UNSIGNED;
+        const float distance = animatedModel->SweepHitCapsules(ray, 0.25f, 10.0f, {}, &hitBone);
+        CHECK(Equals(distance, 5.0f - sqrtf(0.75f * 0.75f - 0.7f * 0.7f), 0.001f));
+        CHECK(hitBone == 1);
+    }
+
+    // Sweep of many models at once
+    {
+        auto secondModel = scene->GetChild("Node 1")->GetComponent<AnimatedModel>();
+        const AnimatedModel* models[] = {animatedModel, secondModel};
+
+        float distance{};
+        unsigned hitBone = M_MAX_UNSIGNED;
+        const Ray ray{{3.0f, 1.5f, -5.0f}, Vector3::FORWARD};
+        CHECK(AnimatedModel::SweepHitCapsules(models, ray, 0.0f, 10.0f, &distance, &hitBone) == 1);
+        CHECK(Equals(distance, 4.5f));
+        CHECK(hitBone == 2);
+
+        const Ray missRay{{1.5f, 1.5f, -5.0f}, Vector3::FORWARD};
+        CHECK(AnimatedModel::SweepHitCapsules(models, missRay, 0.0f, 10.0f, &distance) == M_MAX_UNSIGNED);
+    }
+}
+
+TEST_CASE("Bone hit capsules benchmark", "[.benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto model = Tests::GetOrCreateResource<Model>(context, "@Tests/BoneHitCapsules/SkinnedModel.mdl", CreateTestSkinnedModel);
+
+    const unsigned numModels = 2000;
+    auto scene = CreateTestScene(context, model, numModels);
+    Tests::RunFrame(context, 0.1f, 0.1f);
+
+    ea::vector<const AnimatedModel*> models;
+    for (unsigned i = 0; i < numModels; ++i)
+        models.push_back(scene->GetChild(Format("Node {}", i))->GetComponent<AnimatedModel>());
+
+    const Ray ray{{numModels * 3.0f, 0.75f, 0.0f}, Vector3::LEFT};
+    BENCHMARK("Raycast 2000 models one by one")
+    {
+        unsigned numHits = 0;
+        for (const AnimatedModel* animatedModel : models)
+        {
+            if (animatedModel->SweepHitCapsules(ray, 0.0f, M_LARGE_VALUE) != M_INFINITY)
+                ++numHits;
+        }
+        return numHits;
+    };
+
+    BENCHMARK("Raycast 2000 models in batch")
+    {
+        return AnimatedModel::SweepHitCapsules(models, ray, 0.0f, M_LARGE_VALUE);
+    };
+}
@@ -0,0 +1,282 @@
+//
+// Copyright (c) 2021-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../CommonUtils.h"
+#include "../ModelUtils.h"
+
+#include <Urho3D/Graphics/AnimatedModel.h>
+#include <Urho3D/Graphics/Animation.h>
+#include <Urho3D/Graphics/AnimationController.h>
+#include <Urho3D/Graphics/CompressedAnimation.h>
+#include <Urho3D/Graphics/Octree.h>
+#include <Urho3D/IO/VectorBuffer.h>
+#include <Urho3D/Scene/Scene.h>
+
+namespace
+{
+
+SharedPtr<Animation> CreateTestAnimation(Context* context, unsigned numKeys)
+{
+    const float length = 2.0f;
+    const float step = length / (numKeys - 1);
+
+    auto animation = MakeShared<Animation>(context);
+    animation->SetLength(length);
+
+    AnimationTrack* constantTrack = animation->CreateTrack("Constant");
+    constantTrack->channelMask_ = CHANNEL_POSITION | CHANNEL_ROTATION | CHANNEL_SCALE;
+
+    AnimationTrack* rotationTrack = animation->CreateTrack("Rotation");
+    rotationTrack->channelMask_ = CHANNEL_POSITION | CHANNEL_ROTATION;
+
+    AnimationTrack* linearTrack = animation->CreateTrack("Linear");
+    linearTrack->channelMask_ = CHANNEL_POSITION;
+
+    AnimationTrack* noisyTrack = animation->CreateTrack("Noisy");
+    noisyTrack->channelMask_ = CHANNEL_SCALE;
+
+    for (unsigned i = 0; i < numKeys; ++i)
+    {
+        const float time = i * step;
+        const float noise = Sin(i * 1234.5f) * 0.5f;
+
+        constantTrack->AddKeyFrame({time, Vector3{1.0f, 2.0f, 3.0f}, Quaternion{30.0f, Vector3::UP}, Vector3::ONE * 2.0f});
+        rotationTrack->AddKeyFrame({time, Vector3::ZERO, Quaternion{time * 180.0f, Vector3{1.0f, 1.0f, 0.0f}.Normalized()}});
+        linearTrack->AddKeyFrame({time, Vector3{-10.0f, 0.0f, 5.0f}.Lerp(Vector3{10.0f, 1.0f, -5.0f}, time / length)});
+        noisyTrack->AddKeyFrame({time, Vector3::ZERO, Quaternion::IDENTITY, Vector3::ONE + Vector3::ONE * noise});
+    }
+
+    return animation;
+}
+
+void SampleUncompressed(const Animation& animation, float time, bool isLooped, ea::unordered_map<StringHash, Transform>& output)
+{
+    for (const auto& [nameHash, track] : animation.GetTracks())
+    {
+        unsigned frame = 0;
+        track.Sample(time, animation.GetLength(), isLooped, frame, output[nameHash]);
+    }
+}
+
+}
+
+TEST_CASE("Animation tracks are compressed within tolerance")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    const unsigned numKeys = 61;
+    const auto referenceAnimation = CreateTestAnimation(context, numKeys);
+    const auto animation = CreateTestAnimation(context, numKeys);
+
+    AnimationCompressionSettings settings;
+    settings.positionTolerance_ = 0.001f;
+    settings.rotationTolerance_ = 0.001f;
+    settings.scaleTolerance_ = 0.001f;
+
+    AnimationCompressionStats stats;
+    REQUIRE(animation->Compress(settings, &stats));
+    REQUIRE(animation->IsCompressed());
+    REQUIRE(animation->GetNumTracks() == 4);
+    REQUIRE(animation->GetTrack(ea::string{"Linear"})->keyFrames_.empty());
+
+    // Constant track and position of rotation track are constant
+    REQUIRE(stats.numTracks_ == 4);
+    REQUIRE(stats.numConstantChannels_ == 4);
+    REQUIRE(stats.numAnimatedChannels_ == 3);
+    REQUIRE(stats.numSourceKeys_ == 3 * numKeys);
+    // Linear track is reduced to 2 keys, noisy track is kept as is
+    REQUIRE(stats.numCompressedKeys_ <= 2 * numKeys + 2);
+    REQUIRE(stats.compressedSize_ < stats.sourceSize_ / 4);
+    REQUIRE(stats.maxPositionError_ <= 0.002f);
+    REQUIRE(stats.maxRotationError_ <= 0.002f);
+    REQUIRE(stats.maxScaleError_ <= 0.002f);
+
+    // Sample compressed animation at arbitrary times
+    const CompressedAnimation* compressed = animation->GetCompressedData();
+    for (const bool isLooped : {false, true})
+    {
+        ea::vector<unsigned> keyHints(compressed->GetNumKeyHints());
+        ea::vector<Transform> pose(compressed->GetNumTracks());
+        ea::unordered_map<StringHash, Transform> referencePose;
+
+        for (float time = 0.0f; time <= referenceAnimation->GetLength(); time += 0.0123f)
+        {
+            compressed->Sample(time, isLooped, keyHints, pose);
+            SampleUncompressed(*referenceAnimation, time, isLooped, referencePose);
+
+            for (const auto& [nameHash, expected] : referencePose)
+            {
+                const unsigned trackIndex = compressed->GetTrackIndex(nameHash);
+                REQUIRE(trackIndex < compressed->GetNumTracks());
+
+                const Transform& actual = pose[trackIndex];
+                const AnimationChannelFlags channelMask = referenceAnimation->GetTrack(nameHash)->channelMask_;
+                if (channelMask & CHANNEL_POSITION)
+                    REQUIRE(actual.position_.Equals(expected.position_, 0.005f));
+                if (channelMask & CHANNEL_ROTATION)
+                    REQUIRE(actual.rotation_.Equivalent(expected.rotation_, 0.0001f));
+                if (channelMask & CHANNEL_SCALE)
+                    REQUIRE(actual.scale_.Equals(expected.scale_, 0.005f));
+            }
+        }
+    }
+
+    // Decompression restores keyframes
+    animation->Decompress();
+    REQUIRE_FALSE(animation->IsCompressed());
+    REQUIRE(animation->GetTrack(ea::string{"Linear"})->keyFrames_.size() == 2);
+    REQUIRE(animation->GetTrack(ea::string{"Noisy"})->keyFrames_.size() == numKeys);
+    REQUIRE(animation->GetTrack(ea::string{"Constant"})->keyFrames_.size() == 1);
+    REQUIRE(animation->GetTrack(ea::string{"Constant"})->keyFrames_[0].position_.Equals(Vector3{1.0f, 2.0f, 3.0f}));
+}
+
+TEST_CASE("Compressed animation is saved and loaded")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    const auto animation = CreateTestAnimation(context, 31);
+    REQUIRE(animation->Compress(AnimationCompressionSettings{}));
+
+    VectorBuffer buffer;
+    REQUIRE(animation->Save(buffer));
+    buffer.Seek(0);
+
+    auto loadedAnimation = MakeShared<Animation>(context);
+    REQUIRE(loadedAnimation->Load(buffer));
+    REQUIRE(loadedAnimation->IsCompressed());
+    REQUIRE(loadedAnimation->GetNumTracks() == animation->GetNumTracks());
+
+    const CompressedAnimation* expected = animation->GetCompressedData();
+    const CompressedAnimation* actual = loadedAnimation->GetCompressedData();
+    REQUIRE(actual->GetNumTracks() == expected->GetNumTracks());
+    REQUIRE(actual->GetNumKeyHints() == expected->GetNumKeyHints());
+    REQUIRE(actual->GetMemoryUse() == expected->GetMemoryUse());
+
+    ea::vector<unsigned> expectedKeyHints(expected->GetNumKeyHints());
+    ea::vector<unsigned> actualKeyHints(actual->GetNumKeyHints());
+    ea::vector<Transform> expectedPose(expected->GetNumTracks());
+    ea::vector<Transform> actualPose(actual->GetNumTracks());
+    for (float time = 0.0f; time <= animation->GetLength(); time += 0.1f)
+    {
+        expected->Sample(time, true, expectedKeyHints, expectedPose);
+        actual->Sample(time, true, actualKeyHints, actualPose);
+        for (unsigned i = 0; i < expectedPose.size(); ++i)
+        {
+            REQUIRE(actualPose[i].position_ == expectedPose[i].position_);
+            REQUIRE(actualPose[i].rotation_ == expectedPose[i].rotation_);
+            REQUIRE(actualPose[i].scale_ == expectedPose[i].scale_);
+        }
+    }
+}
+
+TEST_CASE("Compressed animation is played by AnimationController")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    const auto model = Tests::CreateSkinnedQuad_Model(context)->ExportModel();
+    const auto referenceAnimation = Tests::CreateLoopedRotationAnimation(context, "", "Quad 1", Vector3::UP, 2.0f);
+    const auto compressedAnimation = referenceAnimation->Clone();
+    REQUIRE(compressedAnimation->Compress(AnimationCompressionSettings{}));
+
+    auto scene = MakeShared<Scene>(context);
+    scene->CreateComponent<Octree>();
+
+    const auto createModel = [&](Animation* animation)
+    {
+        Node* node = scene->CreateChild();
+        auto animatedModel = node->CreateComponent<AnimatedModel>();
+        animatedModel->SetModel(model);
+        auto animationController = node->CreateComponent<AnimationController>();
+        animationController->PlayNew(AnimationParameters{animation}.Looped());
+        return node;
+    };
+
+    Node* referenceNode = createModel(referenceAnimation);
+    Node* compressedNode = createModel(compressedAnimation);
+
+    for (unsigned i = 0; i < 10; ++i)
+    {
+        Tests::RunFrame(context, 0.17f, 0.17f);
+
+        Node* referenceBone = referenceNode->GetChild("Quad 1", true);
+        Node* compressedBone = compressedNode->GetChild("Quad 1", true);
+        REQUIRE(referenceBone);
+        REQUIRE(compressedBone);
+        REQUIRE(compressedBone->GetRotation().Equivalent(referenceBone->GetRotation(), 0.0001f));
+        REQUIRE(compressedBone->GetPosition().Equals(referenceBone->GetPosition(), 0.001f));
+    }
+}
+
+TEST_CASE("Compressed animation sampling benchmark", "[.benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    const unsigned numTracks = 60;
+    const unsigned numKeys = 1000;
+    const float length = 30.0f;
+
+    auto animation = MakeShared<Animation>(context);
+    animation->SetLength(length);
+    for (unsigned trackIndex = 0; trackIndex < numTracks; ++trackIndex)
+    {
+        AnimationTrack* track = animation->CreateTrack(Format("Bone {}", trackIndex));
+        track->channelMask_ = CHANNEL_POSITION | CHANNEL_ROTATION | CHANNEL_SCALE;
+        for (unsigned i = 0; i < numKeys; ++i)
+        {
+            const float time = i * length / (numKeys - 1);
+            const float phase = trackIndex * 0.37f + time;
+            track->AddKeyFrame({time, Vector3{Sin(phase * 40.0f), Cos(phase * 70.0f), 0.0f},
+                Quaternion{Sin(phase * 50.0f) * 90.0f, Cos(phase * 30.0f) * 90.0f, 0.0f}, Vector3::ONE});
+        }
+    }
+
+    const auto compressedAnimation = animation->Clone();
+    AnimationCompressionStats stats;
+    REQUIRE(compressedAnimation->Compress(AnimationCompressionSettings{}, &stats));
+    WARN(stats.ToString().c_str());
+
+    const CompressedAnimation* compressed = compressedAnimation->GetCompressedData();
+    ea::vector<unsigned> keyHints(compressed->GetNumKeyHints());
+    ea::vector<Transform> pose(compressed->GetNumTracks());
+    ea::vector<unsigned> frames(numTracks);
+
+    float time = 0.0f;
+    BENCHMARK("Sample uncompressed pose")
+    {
+        time = Mod(time + 1.0f / 60.0f, length);
+        unsigned trackIndex = 0;
+        for (const auto& [nameHash, track] : animation->GetTracks())
+        {
+            track.Sample(time, length, true, frames[trackIndex], pose[trackIndex]);
+            ++trackIndex;
+        }
+        return pose[0].position_;
+    };
+
+    BENCHMARK("Sample compressed pose")
+    {
+        time = Mod(time + 1.0f / 60.0f, length);
+        compressed->Sample(time, true, keyHints, pose);
+        return pose[0].position_;
+    };
+}
@@ -0,0 +1,250 @@
+//
+// Copyright (c) 2021-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Graphics/DrawCommandQueue.h>
+#include <Urho3D/Graphics/ShaderProgramLayout.h>
+
+namespace
+{
+
+/// Constant buffer layout with one float parameter in frame and object groups.
+class TestShaderProgramLayout : public ShaderProgramLayout
+{
+public:
+    TestShaderProgramLayout()
+    {
+        AddConstantBuffer(SP_FRAME, 16);
+        AddConstantBufferParameter("Frame", SP_FRAME, 0, sizeof(float));
+        AddConstantBuffer(SP_OBJECT, 16);
+        AddConstantBufferParameter("Index", SP_OBJECT, 0, sizeof(float));
+        RecalculateLayoutHash();
+    }
+};
+
+/// Draw command with all references resolved.
+struct ResolvedDrawCommand
+{
+    ea::vector<ea::pair<StringHash, Vector4>> parameters_;
+    ea::vector<ea::pair<unsigned, ByteVector>> constantBuffers_;
+    ea::vector<ea::pair<TextureUnit, Texture*>> resources_;
+    IntRect scissorRect_;
+    unsigned indexStart_{};
+    unsigned indexCount_{};
+
+    bool operator==(const ResolvedDrawCommand& rhs) const
+    {
+        return parameters_ == rhs.parameters_
+            && constantBuffers_ == rhs.constantBuffers_
+            && resources_ == rhs.resources_
+            && scissorRect_ == rhs.scissorRect_
+            && indexStart_ == rhs.indexStart_
+            && indexCount_ == rhs.indexCount_;
+    }
+};
+
+struct ParameterCollector
+{
+    ea::vector<ea::pair<StringHash, Vector4>>& parameters_;
+
+    void operator()(const StringHash& name, const int* data, unsigned arraySize) const {}
+    void operator()(const StringHash& name, const Vector4* data, unsigned arraySize) const
+    {
+        parameters_.emplace_back(name, *data);
+    }
+    void operator()(const StringHash& name, const Matrix3x4* data, unsigned arraySize) const {}
+    void operator()(const StringHash& name, const Matrix4* data, unsigned arraySize) const {}
+};
+
+ea::vector<ResolvedDrawCommand> ResolveDrawCommands(const DrawCommandQueue& drawQueue)
+{
+    ea::vector<ResolvedDrawCommand> result;
+    for (const DrawCommandDescription& cmd : drawQueue.GetDrawCommands())
+    {
+        ResolvedDrawCommand& resolvedCmd = result.emplace_back();
+        if (drawQueue.IsUsingConstantBuffers())
+        {
+            const ConstantBufferCollection& collection = drawQueue.GetConstantBuffers();
+            for (unsigned group = 0; group < MAX_SHADER_PARAMETER_GROUPS; ++group)
+            {
+                const ConstantBufferCollectionRef& ref = cmd.constantBuffers_[group];
+                if (ref.size_ == 0)
+                    continue;
+
+                REQUIRE(ref.index_ < collection.GetNumBuffers());
+                REQUIRE(ref.offset_ + ref.size_ <= collection.GetBufferSize(ref.index_));
+                const auto data = static_cast<const unsigned char*>(collection.GetBufferData(ref.index_)) + ref.offset_;
+                resolvedCmd.constantBuffers_.emplace_back(group, ByteVector(data, data + ref.size_));
+            }
+        }
+        else
+        {
+            const ParameterCollector collector{resolvedCmd.parameters_};
+            for (const ShaderParameterRange& range : cmd.shaderParameters_)
+                drawQueue.GetShaderParameters().ForEach(range.first, range.second, collector);
+        }
+        for (unsigned i = cmd.shaderResources_.first; i < cmd.shaderResources_.second; ++i)
+        {
+            const ShaderResourceDesc& desc = drawQueue.GetShaderResources()[i];
+            resolvedCmd.resources_.emplace_back(desc.unit_, desc.texture_);
+        }
+        resolvedCmd.scissorRect_ = drawQueue.GetScissorRects()[cmd.scissorRect_];
+        resolvedCmd.indexStart_ = cmd.indexStart_;
+        resolvedCmd.indexCount_ = cmd.indexCount_;
+    }
+    return result;
+}
+
+void RecordDrawCommand(DrawCommandQueue& drawQueue, unsigned index)
+{
+    if (drawQueue.BeginShaderParameterGroup(SP_FRAME, false))
+    {
+        drawQueue.AddShaderParameter("Frame", 1.0f);
+        drawQueue.CommitShaderParameterGroup(SP_FRAME);
+    }
+
+    if (drawQueue.BeginShaderParameterGroup(SP_OBJECT, true))
+    {
+        drawQueue.AddShaderParameter("Index", static_cast<float>(index));
+        drawQueue.CommitShaderParameterGroup(SP_OBJECT);
+    }
+
+    // Segment is recorded from scratch, so resources should be committed for each command
+    drawQueue.AddShaderResource(TU_DIFFUSE, reinterpret_cast<Texture*>(static_cast<uintptr_t>(index + 1)));
+    if (index % 2 == 0)
+        drawQueue.AddShaderResource(TU_NORMAL, reinterpret_cast<Texture*>(static_cast<uintptr_t>(index + 2)));
+    drawQueue.CommitShaderResources();
+
+    drawQueue.SetScissorRect(IntRect(0, 0, 10 + index / 3, 10));
+    drawQueue.Draw(index, 3);
+}
+
+}
+
+TEST_CASE("Draw command queue segments are concatenated without changes")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    // Record all commands into one queue
+    DrawCommandQueue referenceQueue(nullptr);
+    referenceQueue.Reset();
+    REQUIRE_FALSE(referenceQueue.IsUsingConstantBuffers());
+
+    const unsigned numCommands = 20;
+    for (unsigned i = 0; i < numCommands; ++i)
+        RecordDrawCommand(referenceQueue, i);
+
+    // Record commands into independent segments and append them
+    DrawCommandQueue mergedQueue(nullptr);
+    mergedQueue.Reset();
+
+    const ea::vector<unsigned> segmentBoundaries{0, 5, 6, 13, numCommands};
+    for (unsigned segmentIndex = 0; segmentIndex + 1 < segmentBoundaries.size(); ++segmentIndex)
+    {
+        DrawCommandQueue segmentQueue(nullptr);
+        segmentQueue.Reset(mergedQueue.GetPreferConstantBuffers());
+        for (unsigned i = segmentBoundaries[segmentIndex]; i < segmentBoundaries[segmentIndex + 1]; ++i)
+            RecordDrawCommand(segmentQueue, i);
+        mergedQueue.Append(segmentQueue);
+    }
+
+    // Continue recording into merged queue after segments
+    RecordDrawCommand(referenceQueue, numCommands);
+    RecordDrawCommand(mergedQueue, numCommands);
+
+    const auto referenceCommands = ResolveDrawCommands(referenceQueue);
+    const auto mergedCommands = ResolveDrawCommands(mergedQueue);
+    REQUIRE(referenceCommands.size() == numCommands + 1);
+    REQUIRE(mergedCommands.size() == numCommands + 1);
+    for (unsigned i = 0; i <= numCommands; ++i)
+        REQUIRE(referenceCommands[i] == mergedCommands[i]);
+}
+
+TEST_CASE("Draw command queue segments with constant buffers are concatenated without changes")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto layout = MakeShared<TestShaderProgramLayout>();
+
+    // Record all commands into one queue. Constant buffers are used if global uniforms are not supported.
+    DrawCommandQueue referenceQueue(nullptr);
+    referenceQueue.Reset(false);
+    REQUIRE(referenceQueue.IsUsingConstantBuffers());
+    referenceQueue.SetShaderProgramLayout(layout);
+
+    const unsigned numCommands = 20;
+    for (unsigned i = 0; i < numCommands; ++i)
+        RecordDrawCommand(referenceQueue, i);
+    REQUIRE(referenceQueue.GetConstantBuffers().GetNumBuffers() == 1);
+
+    // Record commands into independent segments and append them
+    DrawCommandQueue mergedQueue(nullptr);
+    mergedQueue.Reset(false);
+    mergedQueue.SetShaderProgramLayout(layout);
+
+    const ea::vector<unsigned> segmentBoundaries{0, 5, 6, 13, numCommands};
+    for (unsigned segmentIndex = 0; segmentIndex + 1 < segmentBoundaries.size(); ++segmentIndex)
+    {
+        DrawCommandQueue segmentQueue(nullptr);
+        segmentQueue.Reset(mergedQueue.GetPreferConstantBuffers());
+        segmentQueue.SetShaderProgramLayout(layout);
+        for (unsigned i = segmentBoundaries[segmentIndex]; i < segmentBoundaries[segmentIndex + 1]; ++i)
+            RecordDrawCommand(segmentQueue, i);
+        mergedQueue.Append(segmentQueue);
+
+        // Each segment is copied into its own buffer as is
+        const ConstantBufferCollection& segmentBuffers = segmentQueue.GetConstantBuffers();
+        const ConstantBufferCollection& mergedBuffers = mergedQueue.GetConstantBuffers();
+        REQUIRE(segmentBuffers.GetNumBuffers() == 1);
+        REQUIRE(mergedBuffers.GetNumBuffers() == segmentIndex + 1);
+
+        const unsigned bufferSize = segmentBuffers.GetBufferSize(0);
+        REQUIRE(bufferSize != 0);
+        REQUIRE(mergedBuffers.GetBufferSize(segmentIndex) == bufferSize);
+        REQUIRE(memcmp(mergedBuffers.GetBufferData(segmentIndex), segmentBuffers.GetBufferData(0), bufferSize) == 0);
+    }
+
+    // Continue recording into merged queue after segments
+    RecordDrawCommand(referenceQueue, numCommands);
+    RecordDrawCommand(mergedQueue, numCommands);
+
+    const auto referenceCommands = ResolveDrawCommands(referenceQueue);
+    const auto mergedCommands = ResolveDrawCommands(mergedQueue);
+    REQUIRE(referenceCommands.size() == numCommands + 1);
+    REQUIRE(mergedCommands.size() == numCommands + 1);
+    for (unsigned i = 0; i <= numCommands; ++i)
+    {
+        REQUIRE(referenceCommands[i].constantBuffers_.size() == 2);
+        REQUIRE(referenceCommands[i] == mergedCommands[i]);
+    }
+
+    // Commands of each segment reference the buffer the segment was copied into
+    const auto drawCommands = mergedQueue.GetDrawCommands();
+    for (unsigned segmentIndex = 0; segmentIndex + 1 < segmentBoundaries.size(); ++segmentIndex)
+    {
+        for (unsigned i = segmentBoundaries[segmentIndex]; i < segmentBoundaries[segmentIndex + 1]; ++i)
+        {
+            REQUIRE(drawCommands[i].constantBuffers_[SP_FRAME].index_ == segmentIndex);
+            REQUIRE(drawCommands[i].constantBuffers_[SP_OBJECT].index_ == segmentIndex);
+        }
+    }
+}
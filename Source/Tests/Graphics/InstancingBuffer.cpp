@@ -0,0 +1,85 @@
+//
+// Copyright (c) 2021-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/RenderPipeline/InstancingBuffer.h>
+
+TEST_CASE("Instancing buffer is filled in parallel the same way as sequentially")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto workQueue = context->GetSubsystem<WorkQueue>();
+
+    InstancingBufferSettings settings;
+    settings.enableInstancing_ = true;
+    settings.firstInstancingTexCoord_ = 4;
+    settings.numInstancingTexCoords_ = 4;
+
+    const auto getInstanceElements = [](unsigned instanceIndex)
+    {
+        ea::array<Vector4, 4> elements;
+        for (unsigned i = 0; i < elements.size(); ++i)
+            elements[i] = Vector4(instanceIndex, i, 0.0f, 1.0f);
+        return elements;
+    };
+
+    // Fill reference buffer one instance at a time
+    auto referenceBuffer = MakeShared<InstancingBuffer>(context);
+    referenceBuffer->SetSettings(settings);
+    referenceBuffer->Begin();
+
+    const unsigned numInstances = 5000;
+    for (unsigned i = 0; i < numInstances; ++i)
+    {
+        const auto elements = getInstanceElements(i);
+        REQUIRE(referenceBuffer->AddInstance() == i);
+        referenceBuffer->SetElements(elements.data(), 0, 4);
+    }
+
+    // Allocate all instances at once, much more than initial capacity, and fill them in worker threads
+    auto parallelBuffer = MakeShared<InstancingBuffer>(context);
+    parallelBuffer->SetSettings(settings);
+    parallelBuffer->Begin();
+
+    const unsigned startInstance = parallelBuffer->AddInstances(numInstances);
+    REQUIRE(startInstance == 0);
+    REQUIRE(parallelBuffer->GetNextInstanceIndex() == numInstances);
+
+    ForEachParallel(workQueue, 64, numInstances, [&](unsigned beginIndex, unsigned endIndex)
+    {
+        for (unsigned i = beginIndex; i < endIndex; ++i)
+        {
+            const auto elements = getInstanceElements(i);
+            parallelBuffer->SetInstanceElements(startInstance + i, &elements[0], 0, 1);
+            parallelBuffer->SetInstanceElements(startInstance + i, &elements[1], 1, 3);
+        }
+    });
+
+    for (unsigned i = 0; i < numInstances; ++i)
+    {
+        const auto elements = getInstanceElements(i);
+        REQUIRE(memcmp(parallelBuffer->GetInstanceData(i), elements.data(), sizeof(elements)) == 0);
+        REQUIRE(memcmp(referenceBuffer->GetInstanceData(i), elements.data(), sizeof(elements)) == 0);
+    }
+}
@@ -0,0 +1,193 @@
+//
+// Copyright (c) 2021-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/Graphics/Camera.h>
+#include <Urho3D/Graphics/OcclusionBuffer.h>
+#include <Urho3D/Scene/Scene.h>
+
+namespace
+{
+
+/// Unit box mesh centered at origin.
+struct BoxMesh
+{
+    ea::vector<Vector3> vertices_;
+    ea::vector<unsigned short> indices_;
+
+    BoxMesh()
+    {
+        for (unsigned i = 0; i < 8; ++i)
+            vertices_.emplace_back(i & 1 ? 0.5f : -0.5f, i & 2 ? 0.5f : -0.5f, i & 4 ? 0.5f : -0.5f);
+
+        const unsigned short faces[6][4] = {
+            {0, 2, 3, 1}, {4, 5, 7, 6}, {0, 1, 5, 4}, {2, 6, 7, 3}, {0, 4, 6, 2}, {1, 3, 7, 5}};
+        for (const auto& face : faces)
+        {
+            for (unsigned short index : {face[0], face[1], face[2], face[0], face[2], face[3]})
+                indices_.push_back(index);
+        }
+    }
+};
+
+/// Procedural city: grid of buildings of varying height in front of the camera.
+ea::vector<Matrix3x4> CreateCityBuildings(unsigned gridSize)
+{
+    ea::vector<Matrix3x4> result;
+    for (unsigned x = 0; x < gridSize; ++x)
+    {
+        for (unsigned z = 0; z < gridSize; ++z)
+        {
+            const float height = 5.0f + static_cast<float>((x * 7 + z * 13) % 11) * 2.0f;
+            const Vector3 position{(x - gridSize * 0.5f) * 12.0f, height * 0.5f, 20.0f + z * 12.0f};
+            result.emplace_back(position, Quaternion::IDENTITY, Vector3{8.0f, height, 8.0f});
+        }
+    }
+    return result;
+}
+
+void DrawCity(OcclusionBuffer* buffer, Camera* camera, const BoxMesh& mesh, const ea::vector<Matrix3x4>& buildings)
+{
+    buffer->SetView(camera);
+    buffer->SetMaxTriangles(M_MAX_UNSIGNED);
+    buffer->Clear();
+    for (const Matrix3x4& model : buildings)
+    {
+        buffer->AddTriangles(model, mesh.vertices_.data(), sizeof(Vector3), mesh.indices_.data(),
+            sizeof(unsigned short), 0, mesh.indices_.size());
+    }
+    buffer->DrawTriangles();
+    buffer->BuildDepthHierarchy();
+}
+
+}
+
+TEST_CASE("Threaded occlusion buffer is identical to non-threaded one")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    context->GetSubsystem<WorkQueue>()->CreateThreads(3);
+
+    auto scene = MakeShared<Scene>(context);
+    Node* cameraNode = scene->CreateChild("Camera");
+    cameraNode->SetPosition({0.0f, 8.0f, 0.0f});
+    cameraNode->LookAt({0.0f, 4.0f, 50.0f});
+    auto camera = cameraNode->CreateComponent<Camera>();
+    camera->SetAspectRatio(2.0f);
+    camera->SetFarClip(500.0f);
+
+    const BoxMesh mesh;
+    const auto buildings = CreateCityBuildings(10);
+
+    const int width = 256;
+    const int height = 128;
+    auto referenceBuffer = MakeShared<OcclusionBuffer>(context);
+    auto threadedBuffer = MakeShared<OcclusionBuffer>(context);
+    REQUIRE(referenceBuffer->SetSize(width, height, false));
+    REQUIRE(threadedBuffer->SetSize(width, height, true));
+    REQUIRE_FALSE(referenceBuffer->IsThreaded());
+    REQUIRE(threadedBuffer->IsThreaded());
+
+    DrawCity(referenceBuffer, camera, mesh, buildings);
+    DrawCity(threadedBuffer, camera, mesh, buildings);
+
+    REQUIRE(referenceBuffer->GetNumTriangles() == threadedBuffer->GetNumTriangles());
+    const ea::span<const int> referenceData{referenceBuffer->GetBuffer(), width * height};
+    const ea::span<const int> threadedData{threadedBuffer->GetBuffer(), width * height};
+    CHECK(ea::equal(referenceData.begin(), referenceData.end(), threadedData.begin()));
+
+    // Some pixels should be covered, some not
+    const auto numCovered = ea::count_if(referenceData.begin(), referenceData.end(),
+        [](int depth) { return depth < static_cast<int>(OCCLUSION_Z_SCALE); });
+    CHECK(numCovered > 0);
+    CHECK(numCovered < width * height);
+
+    // Box hidden behind the first row of buildings is not visible, box in front of it is
+    const BoundingBox hiddenBox{Vector3{-1.0f, 0.0f, 25.0f}, Vector3{1.0f, 2.0f, 27.0f}};
+    const BoundingBox visibleBox{Vector3{-1.0f, 0.0f, 10.0f}, Vector3{1.0f, 2.0f, 12.0f}};
+    for (OcclusionBuffer* buffer : {referenceBuffer.Get(), threadedBuffer.Get()})
+    {
+        CHECK_FALSE(buffer->IsVisible(hiddenBox));
+        CHECK(buffer->IsVisible(visibleBox));
+    }
+}
+
+TEST_CASE("Occlusion buffer benchmark", "[.benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    context->GetSubsystem<WorkQueue>()->CreateThreads(3);
+
+    auto scene = MakeShared<Scene>(context);
+    Node* cameraNode = scene->CreateChild("Camera");
+    cameraNode->SetPosition({0.0f, 8.0f, 0.0f});
+    cameraNode->LookAt({0.0f, 4.0f, 50.0f});
+    auto camera = cameraNode->CreateComponent<Camera>();
+    camera->SetAspectRatio(2.0f);
+    camera->SetFarClip(1000.0f);
+
+    const BoxMesh mesh;
+    const auto buildings = CreateCityBuildings(64);
+
+    auto buffer = MakeShared<OcclusionBuffer>(context);
+    auto threadedBuffer = MakeShared<OcclusionBuffer>(context);
+    buffer->SetSize(512, 256, false);
+    threadedBuffer->SetSize(512, 256, true);
+    REQUIRE(threadedBuffer->IsThreaded());
+
+    BENCHMARK_ADVANCED("Occlusion buffer")(Catch::Benchmark::Chronometer meter)
+    {
+        meter.measure([&]
+        {
+            DrawCity(buffer, camera, mesh, buildings);
+            return buffer->GetNumTriangles();
+        });
+    };
+
+    BENCHMARK_ADVANCED("Threaded occlusion buffer")(Catch::Benchmark::Chronometer meter)
+    {
+        meter.measure([&]
+        {
+            DrawCity(threadedBuffer, camera, mesh, buildings);
+            return threadedBuffer->GetNumTriangles();
+        });
+    };
+
+    // Report throughput in addition to frame time
+    const auto measureThroughput = [&](OcclusionBuffer* occlusionBuffer, const char* name)
+    {
+        const unsigned numIterations = 50;
+        unsigned long long numTriangles = 0;
+        HiresTimer timer;
+        for (unsigned i = 0; i < numIterations; ++i)
+        {
+            DrawCity(occlusionBuffer, camera, mesh, buildings);
+            numTriangles += occlusionBuffer->GetNumTriangles();
+        }
+        const double elapsedMs = ea::max(timer.GetUSec(false), 1ll) / 1000.0;
+        WARN(Format("{}: {:.0f} triangles/ms", name, numTriangles / elapsedMs).c_str());
+    };
+    measureThroughput(buffer, "Occlusion buffer");
+    measureThroughput(threadedBuffer, "Threaded occlusion buffer");
+}
@@ -0,0 +1,187 @@
+//
+// Copyright (c) 2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Graphics/PipelineStatePrecache.h>
+#include <Urho3D/Graphics/Shader.h>
+#include <Urho3D/Graphics/ShaderVariation.h>
+#include <Urho3D/IO/BinaryArchive.h>
+#include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/IO/VectorBuffer.h>
+#include <Urho3D/Resource/ResourceCache.h>
+
+namespace
+{
+
+SharedPtr<Shader> CreateTestShader(Context* context, const ea::string& name)
+{
+    auto shader = MakeShared<Shader>(context);
+    shader->SetName(name);
+    context->GetSubsystem<ResourceCache>()->AddManualResource(shader);
+    return shader;
+}
+
+PipelineStateDesc CreateTestPipelineStateDesc(ShaderVariation* vertexShader, ShaderVariation* pixelShader, CullMode cullMode)
+{
+    PipelineStateDesc desc;
+    desc.numVertexElements_ = 2;
+    desc.vertexElements_[0] = VertexElement{TYPE_VECTOR3, SEM_POSITION};
+    desc.vertexElements_[1] = VertexElement{TYPE_VECTOR3, SEM_NORMAL};
+    desc.vertexElements_[1].offset_ = 12;
+    desc.vertexShader_ = vertexShader;
+    desc.pixelShader_ = pixelShader;
+    desc.primitiveType_ = TRIANGLE_LIST;
+    desc.depthWriteEnabled_ = true;
+    desc.depthCompareFunction_ = CMP_LESSEQUAL;
+    desc.stencilReferenceValue_ = 3;
+    desc.cullMode_ = cullMode;
+    desc.constantDepthBias_ = 0.5f;
+    desc.colorWriteEnabled_ = true;
+    desc.blendMode_ = BLEND_ALPHA;
+    desc.RecalculateHash();
+    return desc;
+}
+
+}
+
+TEST_CASE("PipelineStatePrecacheEntry is serialized")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    PipelineStatePrecacheEntry entry;
+    entry.vertexShaderName_ = "Shaders/HLSL/LitSolid.hlsl";
+    entry.vertexShaderDefines_ = "NORMALMAP";
+    entry.vertexShaderSourceHash_ = 0x12345678;
+    entry.pixelShaderName_ = "Shaders/HLSL/LitSolid.hlsl";
+    entry.pixelShaderDefines_ = "DIFFMAP NORMALMAP";
+    entry.pixelShaderSourceHash_ = 0x9abcdef0;
+    entry.desc_ = CreateTestPipelineStateDesc(nullptr, nullptr, CULL_CW);
+
+    VectorBuffer buffer;
+    {
+        BinaryOutputArchive archive{context, buffer};
+        REQUIRE(ConsumeArchiveException([&]
+        {
+            ArchiveBlock block = archive.OpenUnorderedBlock("entry");
+            entry.SerializeInBlock(archive);
+        }));
+    }
+
+    buffer.Seek(0);
+    PipelineStatePrecacheEntry loadedEntry;
+    {
+        BinaryInputArchive archive{context, buffer};
+        REQUIRE(ConsumeArchiveException([&]
+        {
+            ArchiveBlock block = archive.OpenUnorderedBlock("entry");
+            loadedEntry.SerializeInBlock(archive);
+        }));
+    }
+
+    REQUIRE(loadedEntry == entry);
+    REQUIRE(loadedEntry.ToHash() == entry.ToHash());
+    REQUIRE(loadedEntry.vertexShaderSourceHash_ == entry.vertexShaderSourceHash_);
+    REQUIRE(loadedEntry.pixelShaderSourceHash_ == entry.pixelShaderSourceHash_);
+}
+
+TEST_CASE("PipelineStatePrecacheEntry is outdated when shader source is changed")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    auto shader = MakeShared<Shader>(context);
+
+    PipelineStatePrecacheEntry entry;
+    entry.vertexShaderSourceHash_ = PipelineStatePrecache::GetShaderSourceHash(shader, VS);
+    entry.pixelShaderSourceHash_ = PipelineStatePrecache::GetShaderSourceHash(shader, PS);
+    REQUIRE(entry.IsUpToDate(shader, shader));
+
+    entry.vertexShaderSourceHash_ = StringHash("void VS() {}").Value();
+    REQUIRE_FALSE(entry.IsUpToDate(shader, shader));
+
+    entry.vertexShaderSourceHash_ = PipelineStatePrecache::GetShaderSourceHash(shader, VS);
+    entry.pixelShaderSourceHash_ = StringHash("void PS() {}").Value();
+    REQUIRE_FALSE(entry.IsUpToDate(shader, shader));
+}
+
+TEST_CASE("PipelineStatePrecache stores pipeline states and discards outdated ones")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto cache = context->GetSubsystem<ResourceCache>();
+    auto fileSystem = context->GetSubsystem<FileSystem>();
+
+    const ea::string fileName = fileSystem->GetTemporaryDir() + "PipelineStatePrecacheTest.bin";
+    fileSystem->Delete(fileName);
+
+    auto vertexShader = CreateTestShader(context, "Shaders/HLSL/PipelineStatePrecacheTestVS.hlsl");
+    auto pixelShader = CreateTestShader(context, "Shaders/HLSL/PipelineStatePrecacheTestPS.hlsl");
+    auto vertexShaderVariation = MakeShared<ShaderVariation>(vertexShader, VS);
+    auto pixelShaderVariation = MakeShared<ShaderVariation>(pixelShader, PS);
+    pixelShaderVariation->SetDefines("DIFFMAP");
+
+    auto pipelineStateCache = MakeShared<PipelineStateCache>(context);
+
+    // Record pipeline states, duplicates are ignored
+    ea::unordered_set<PipelineStatePrecacheEntry> recordedEntries;
+    {
+        auto precache = MakeShared<PipelineStatePrecache>(pipelineStateCache, fileName);
+        REQUIRE(precache->GetNumPendingStates() == 0);
+
+        for (CullMode cullMode : {CULL_NONE, CULL_CCW, CULL_NONE})
+            precache->StorePipelineState(CreateTestPipelineStateDesc(vertexShaderVariation, pixelShaderVariation, cullMode));
+        REQUIRE(precache->GetEntries().size() == 2);
+
+        recordedEntries = precache->GetEntries();
+        for (const PipelineStatePrecacheEntry& entry : recordedEntries)
+        {
+            REQUIRE(entry.pixelShaderDefines_ == "DIFFMAP");
+            REQUIRE(entry.IsUpToDate(vertexShader, pixelShader));
+        }
+    }
+    REQUIRE(fileSystem->FileExists(fileName));
+
+    // Remove one of the shaders so all the entries become outdated
+    cache->ReleaseResource<Shader>(pixelShader->GetName(), true);
+    {
+        auto precache = MakeShared<PipelineStatePrecache>(pipelineStateCache, fileName);
+        REQUIRE(precache->GetEntries() == recordedEntries);
+        REQUIRE(precache->GetNumPendingStates() == 2);
+
+        for (unsigned i = 0; i < 100 && precache->GetNumPendingStates() > 0; ++i)
+            Tests::RunFrame(context, 0.01f);
+
+        REQUIRE(precache->GetNumPendingStates() == 0);
+        REQUIRE(precache->GetNumPrecachedStates() == 0);
+        REQUIRE(precache->GetEntries().empty());
+    }
+
+    // Outdated entries are removed from the file
+    {
+        auto precache = MakeShared<PipelineStatePrecache>(pipelineStateCache, fileName);
+        REQUIRE(precache->GetNumPendingStates() == 0);
+        REQUIRE(precache->GetEntries().empty());
+    }
+
+    cache->ReleaseResource<Shader>(vertexShader->GetName(), true);
+    fileSystem->Delete(fileName);
+}
@@ -0,0 +1,190 @@
+//
+// Copyright (c) 2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../CommonUtils.h"
+#include "../ModelUtils.h"
+
+#include <Urho3D/Graphics/SoftwareModelAnimator.h>
+#include <Urho3D/Graphics/VertexBuffer.h>
+
+namespace
+{
+
+const unsigned NumTestBones = 8;
+
+/// Create grid of vertices skinned to 4 bones each, with a morph affecting every other vertex.
+SharedPtr<ModelView> CreateSkinnedGridModel(Context* context, unsigned gridSize)
+{
+    auto modelView = MakeShared<ModelView>(context);
+
+    auto& bones = modelView->GetBones();
+    bones.resize(NumTestBones);
+    for (unsigned i = 0; i < NumTestBones; ++i)
+    {
+        bones[i].name_ = Format("Bone {}", i);
+        bones[i].parentIndex_ = i > 0 ? 0 : M_MAX_UNSIGNED;
+        bones[i].SetInitialTransform({static_cast<float>(i), 0.0f, 0.0f});
+        bones[i].RecalculateOffsetMatrix();
+    }
+
+    auto& geometries = modelView->GetGeometries();
+    geometries.resize(1);
+    geometries[0].lods_.resize(1);
+    GeometryLODView& geometry = geometries[0].lods_[0];
+    geometry.vertexFormat_.position_ = TYPE_VECTOR3;
+    geometry.vertexFormat_.normal_ = TYPE_VECTOR3;
+    geometry.vertexFormat_.blendIndices_ = TYPE_UBYTE4;
+    geometry.vertexFormat_.blendWeights_ = TYPE_VECTOR4;
+
+    for (unsigned y = 0; y < gridSize; ++y)
+    {
+        for (unsigned x = 0; x < gridSize; ++x)
+        {
+            const unsigned index = y * gridSize + x;
+
+            ModelVertex vertex;
+            vertex.SetPosition({static_cast<float>(x), static_cast<float>(y), static_cast<float>(index % 7)});
+            vertex.SetNormal(Vector3{1.0f, static_cast<float>(x % 3), static_cast<float>(y % 5)}.Normalized());
+            vertex.blendIndices_ = Vector4(index % NumTestBones, (index + 1) % NumTestBones,
+                (index + 3) % NumTestBones, (index + 5) % NumTestBones);
+            const Vector4 weights{1.0f + index % 2, 1.0f + index % 3, 1.0f + index % 5, 1.0f};
+            vertex.blendWeights_ = weights / weights.DotProduct(Vector4::ONE);
+            geometry.vertices_.push_back(vertex);
+
+            if (index % 2 == 0)
+                geometry.morphs_[0].push_back(ModelVertexMorph{index, {0.5f, -1.0f, static_cast<float>(x % 4)}});
+        }
+    }
+
+    for (unsigned i = 0; i + 2 < geometry.vertices_.size(); ++i)
+    {
+        geometry.indices_.push_back(i);
+        geometry.indices_.push_back(i + 1);
+        geometry.indices_.push_back(i + 2);
+    }
+
+    return modelView;
+}
+
+ea::vector<Matrix3x4> CreateTestSkinMatrices(float time)
+{
+    ea::vector<Matrix3x4> result;
+    for (unsigned i = 0; i < NumTestBones; ++i)
+    {
+        const Vector3 position{time, static_cast<float>(i), -static_cast<float>(i) * time};
+        const Quaternion rotation{time * 30.0f * i, Vector3{1.0f, 2.0f, static_cast<float>(i)}.Normalized()};
+        const Vector3 scale{1.0f + i * 0.1f, 1.0f, 1.0f - i * 0.05f};
+        result.emplace_back(position, rotation, scale);
+    }
+    return result;
+}
+
+}
+
+TEST_CASE("Software skinning and morphing match reference implementation")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    // Large enough to be processed in parallel
+    const unsigned gridSize = 128;
+    const float morphWeight = 0.5f;
+    const auto modelView = CreateSkinnedGridModel(context, gridSize);
+    const auto model = modelView->ExportModel();
+    const auto skinMatrices = CreateTestSkinMatrices(0.3f);
+
+    const auto& sourceVertices = modelView->GetGeometries()[0].lods_[0].vertices_;
+    REQUIRE(sourceVertices.size() >= SoftwareModelAnimator::MinVerticesForParallelUpdate);
+
+    auto animator = MakeShared<SoftwareModelAnimator>(context);
+    animator->Initialize(model, true, SoftwareModelAnimator::MaxBones);
+
+    ea::vector<ModelMorph> morphs = model->GetMorphs();
+    REQUIRE(morphs.size() == 1);
+    morphs[0].weight_ = morphWeight;
+
+    animator->ResetAnimation();
+    animator->ApplyMorphs(morphs);
+    animator->ApplySkinning(skinMatrices);
+
+    VertexBuffer* vertexBuffer = animator->GetVertexBuffers()[0];
+    REQUIRE(vertexBuffer);
+    REQUIRE(vertexBuffer->GetVertexCount() == sourceVertices.size());
+
+    const unsigned vertexSize = vertexBuffer->GetVertexSize();
+    const unsigned normalOffset = vertexBuffer->GetElementOffset(SEM_NORMAL);
+    const unsigned char* vertexData = vertexBuffer->GetShadowData();
+
+    const auto& morphVertices = modelView->GetGeometries()[0].lods_[0].morphs_.find(0)->second;
+    for (unsigned i = 0; i < sourceVertices.size(); ++i)
+    {
+        const ModelVertex& sourceVertex = sourceVertices[i];
+
+        Vector3 sourcePosition = sourceVertex.GetPosition();
+        if (i % 2 == 0)
+            sourcePosition += morphVertices[i / 2].positionDelta_ * morphWeight;
+
+        Matrix3x4 skinMatrix = skinMatrices[static_cast<unsigned>(sourceVertex.blendIndices_.x_)] * sourceVertex.blendWeights_.x_;
+        skinMatrix = skinMatrix + skinMatrices[static_cast<unsigned>(sourceVertex.blendIndices_.y_)] * sourceVertex.blendWeights_.y_;
+        skinMatrix = skinMatrix + skinMatrices[static_cast<unsigned>(sourceVertex.blendIndices_.z_)] * sourceVertex.blendWeights_.z_;
+        skinMatrix = skinMatrix + skinMatrices[static_cast<unsigned>(sourceVertex.blendIndices_.w_)] * sourceVertex.blendWeights_.w_;
+
+        const Vector3 expectedPosition = skinMatrix * sourcePosition;
+        const Vector3 expectedNormal = skinMatrix * Vector4(static_cast<Vector3>(sourceVertex.normal_), 0.0f);
+
+        Vector3 position;
+        Vector3 normal;
+        memcpy(&position, vertexData + i * vertexSize, sizeof(Vector3));
+        memcpy(&normal, vertexData + i * vertexSize + normalOffset, sizeof(Vector3));
+
+        REQUIRE(position.Equals(expectedPosition, 0.0001f));
+        REQUIRE(normal.Equals(expectedNormal, 0.0001f));
+    }
+}
+
+TEST_CASE("Software skinning benchmark", "[.benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    const auto model = CreateSkinnedGridModel(context, 256)->ExportModel();
+    const auto skinMatrices = CreateTestSkinMatrices(0.3f);
+
+    ea::vector<ModelMorph> morphs = model->GetMorphs();
+    morphs[0].weight_ = 0.5f;
+
+    auto animator = MakeShared<SoftwareModelAnimator>(context);
+    animator->Initialize(model, true, SoftwareModelAnimator::MaxBones);
+
+    BENCHMARK("Skin 65536 vertices with 4 bones")
+    {
+        animator->ResetAnimation();
+        animator->ApplySkinning(skinMatrices);
+        return animator->GetVertexBuffers()[0]->GetShadowData()[0];
+    };
+
+    BENCHMARK("Morph and skin 65536 vertices with 4 bones")
+    {
+        animator->ResetAnimation();
+        animator->ApplyMorphs(morphs);
+        animator->ApplySkinning(skinMatrices);
+        return animator->GetVertexBuffers()[0]->GetShadowData()[0];
+    };
+}
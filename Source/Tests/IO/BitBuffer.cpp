@@ -0,0 +1,160 @@
+//
+// Copyright (c) 2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/IO/BitBuffer.h>
+#include <Urho3D/IO/MemoryBuffer.h>
+
+TEST_CASE("BitBuffer round-trips unaligned values")
+{
+    BitBuffer buffer;
+    buffer.WriteBits(5, 3);
+    buffer.WriteBool(true);
+    buffer.WriteBits(0xabcdef, 24);
+    buffer.WriteBits(0xdeadbeef, 32);
+    buffer.WriteVLE(300);
+    buffer.WriteFloat(-1.5f);
+    buffer.WriteString("Hello");
+    buffer.WriteVector3({1.0f, -2.0f, 3.0f});
+    buffer.WriteQuaternion(Quaternion{30.0f, Vector3::UP});
+
+    const unsigned expectedBits = 3 + 1 + 24 + 32 + 16 + 32 + 8 + 5 * 8 + 3 * 32 + 4 * 32;
+    REQUIRE(buffer.GetNumBits() == expectedBits);
+    REQUIRE(buffer.GetSize() == (expectedBits + 7) / 8);
+
+    BitBuffer src{buffer.GetData(), buffer.GetSize()};
+    REQUIRE(src.ReadBits(3) == 5);
+    REQUIRE(src.ReadBool() == true);
+    REQUIRE(src.ReadBits(24) == 0xabcdef);
+    REQUIRE(src.ReadBits(32) == 0xdeadbeef);
+    REQUIRE(src.ReadVLE() == 300);
+    REQUIRE(src.ReadFloat() == -1.5f);
+    REQUIRE(src.ReadString() == "Hello");
+    REQUIRE(src.ReadVector3() == Vector3{1.0f, -2.0f, 3.0f});
+    REQUIRE(src.ReadQuaternion() == Quaternion{30.0f, Vector3::UP});
+    REQUIRE(src.TellBit() == expectedBits);
+
+    // Reading past the end yields zeros
+    src.SeekBit(src.GetNumBits());
+    REQUIRE(src.IsEof());
+    REQUIRE(src.ReadBits(16) == 0);
+}
+
+TEST_CASE("BitBuffer reads truncated strings safely")
+{
+    BitBuffer buffer;
+    buffer.WriteString("Hello, world!");
+
+    // String is cut at the end of data
+    BitBuffer truncatedSrc{buffer.GetData(), 6};
+    REQUIRE(truncatedSrc.ReadString() == "Hello");
+    REQUIRE(truncatedSrc.IsEof());
+
+    // Size is not trusted blindly
+    BitBuffer corruptedBuffer;
+    corruptedBuffer.WriteVLE(0x7fffffff);
+    corruptedBuffer.WriteBits('A', 8);
+    corruptedBuffer.WriteBits('B', 8);
+
+    BitBuffer corruptedSrc{corruptedBuffer.GetData(), corruptedBuffer.GetSize()};
+    const ea::string result = corruptedSrc.ReadString();
+    REQUIRE(result == "AB");
+    REQUIRE(result.capacity() < 0x100);
+
+    // Nothing is read past the end
+    BitBuffer emptySrc{buffer.GetData(), 1};
+    REQUIRE(emptySrc.ReadString().empty());
+}
+
+TEST_CASE("BitBuffer is loaded from stream")
+{
+    BitBuffer buffer;
+    buffer.WriteBits(0x1f, 5);
+    buffer.WriteHalfFloat(0.25f);
+
+    MemoryBuffer stream{buffer.GetData(), buffer.GetSize()};
+    BitBuffer src;
+    src.SetData(stream, buffer.GetSize());
+    REQUIRE(stream.IsEof());
+    REQUIRE(src.ReadBits(5) == 0x1f);
+    REQUIRE(src.ReadHalfFloat() == 0.25f);
+}
+
+TEST_CASE("BitBuffer quantized values are within error bounds")
+{
+    const unsigned numBits = 12;
+    const float minValue = -10.0f;
+    const float maxValue = 20.0f;
+    const float maxError = (maxValue - minValue) / ((1 << numBits) - 1) * 0.5f + M_EPSILON;
+
+    BitBuffer buffer;
+    for (float value = minValue; value <= maxValue; value += 0.37f)
+        buffer.WriteQuantizedFloat(value, minValue, maxValue, numBits);
+
+    // Values out of range are clamped
+    buffer.WriteQuantizedFloat(100.0f, minValue, maxValue, numBits);
+    buffer.WriteQuantizedFloat(-100.0f, minValue, maxValue, numBits);
+
+    for (float value = minValue; value <= maxValue; value += 0.37f)
+        REQUIRE(std::abs(buffer.ReadQuantizedFloat(minValue, maxValue, numBits) - value) <= maxError);
+
+    REQUIRE(buffer.ReadQuantizedFloat(minValue, maxValue, numBits) == maxValue);
+    REQUIRE(buffer.ReadQuantizedFloat(minValue, maxValue, numBits) == minValue);
+}
+
+TEST_CASE("BitBuffer smallest-three quaternions are within error bounds")
+{
+    const unsigned numBits = 10;
+
+    ea::vector<Quaternion> rotations;
+    for (float angle = -180.0f; angle <= 180.0f; angle += 15.0f)
+    {
+        rotations.emplace_back(angle, Vector3::UP);
+        rotations.emplace_back(angle, Vector3{1.0f, 2.0f, -3.0f}.Normalized());
+        rotations.emplace_back(angle, angle * 0.5f, -angle);
+    }
+
+    BitBuffer buffer;
+    for (const Quaternion& rotation : rotations)
+        buffer.WriteSmallestThreeQuaternion(rotation, numBits);
+    REQUIRE(buffer.GetNumBits() == rotations.size() * BitBuffer::GetSmallestThreeQuaternionBits(numBits));
+
+    for (const Quaternion& rotation : rotations)
+    {
+        const Quaternion decoded = buffer.ReadSmallestThreeQuaternion(numBits);
+        // Rotations of q and -q are the same
+        const float dot = Abs(decoded.DotProduct(rotation));
+        REQUIRE(dot > 0.9999f);
+    }
+}
+
+TEST_CASE("BitBuffer half floats preserve precision")
+{
+    const Vector3 value{0.5f, -123.25f, 3.0f};
+
+    BitBuffer buffer;
+    buffer.WriteHalfVector3(value);
+    REQUIRE(buffer.GetSize() == 6);
+    REQUIRE(buffer.ReadHalfVector3() == value);
+}
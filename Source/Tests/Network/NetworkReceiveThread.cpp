@@ -0,0 +1,235 @@
+//
+// Copyright (c) 2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/IO/VectorBuffer.h>
+#include <Urho3D/Network/Connection.h>
+#include <Urho3D/Network/NetworkEvents.h>
+#include <Urho3D/Network/NetworkReceiveThread.h>
+#include <Urho3D/Network/Protocol.h>
+
+#include <slikenet/MessageIdentifiers.h>
+
+#include <thread>
+
+namespace
+{
+
+/// Create packet with Urho3D message header.
+VectorBuffer CreateMessagePacket(NetworkMessageId messageId)
+{
+    VectorBuffer buffer;
+    buffer.WriteUByte(ID_USER_PACKET_ENUM);
+    buffer.WriteUInt(messageId);
+    return buffer;
+}
+
+IncomingPacket CreateIncomingPacket(const VectorBuffer& buffer)
+{
+    IncomingPacket packet;
+    packet.data_.assign(buffer.GetData(), buffer.GetData() + buffer.GetSize());
+    return packet;
+}
+
+}
+
+TEST_CASE("IncomingPacketQueue is bounded and preserves order")
+{
+    IncomingPacketQueue queue(3);
+
+    // Capacity is rounded up to 4
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        IncomingPacket* packet = queue.BeginPush();
+        REQUIRE(packet);
+        packet->messageId_ = static_cast<int>(i);
+        queue.EndPush();
+    }
+    REQUIRE_FALSE(queue.BeginPush());
+
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        IncomingPacket* packet = queue.Front();
+        REQUIRE(packet);
+        REQUIRE(packet->messageId_ == static_cast<int>(i));
+        queue.Pop();
+    }
+    REQUIRE_FALSE(queue.Front());
+
+    queue.BeginPush();
+    queue.EndPush();
+    queue.Clear();
+    REQUIRE_FALSE(queue.Front());
+}
+
+TEST_CASE("IncomingPacketQueue transfers packets between threads")
+{
+    const unsigned numPackets = 100000;
+    IncomingPacketQueue queue(16);
+
+    std::thread producer([&]
+    {
+        for (unsigned i = 0; i < numPackets; ++i)
+        {
+            IncomingPacket* packet = nullptr;
+            while (!(packet = queue.BeginPush()))
+                std::this_thread::yield();
+
+            packet->messageId_ = static_cast<int>(i);
+            packet->data_.assign(i % 7 + 1, static_cast<unsigned char>(i));
+            queue.EndPush();
+        }
+    });
+
+    unsigned numReceived = 0;
+    bool isConsistent = true;
+    while (numReceived < numPackets)
+    {
+        const IncomingPacket* packet = queue.Front();
+        if (!packet)
+        {
+            std::this_thread::yield();
+            continue;
+        }
+
+        isConsistent &= packet->messageId_ == static_cast<int>(numReceived);
+        isConsistent &= packet->data_.size() == numReceived % 7 + 1;
+        isConsistent &= packet->data_.back() == static_cast<unsigned char>(numReceived);
+        queue.Pop();
+        ++numReceived;
+    }
+
+    producer.join();
+    REQUIRE(isConsistent);
+    REQUIRE_FALSE(queue.Front());
+}
+
+TEST_CASE("Packed messages are unpacked and validated")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    const auto messageId1 = static_cast<NetworkMessageId>(MSG_USER + 1);
+    const auto messageId2 = static_cast<NetworkMessageId>(MSG_USER + 2);
+
+    // Valid packed message
+    {
+        VectorBuffer buffer = CreateMessagePacket(MSG_PACKED_MESSAGE);
+        buffer.WriteUInt(messageId1);
+        buffer.WriteUInt(3);
+        buffer.WriteUByte(1);
+        buffer.WriteUByte(2);
+        buffer.WriteUByte(3);
+        buffer.WriteUInt(messageId2);
+        buffer.WriteUInt(0);
+
+        IncomingPacket packet = CreateIncomingPacket(buffer);
+        REQUIRE(NetworkReceiveThread::UnpackPacket(packet));
+        REQUIRE(packet.packetId_ == ID_USER_PACKET_ENUM);
+        REQUIRE(packet.messageId_ == MSG_PACKED_MESSAGE);
+        REQUIRE(packet.messages_.size() == 2);
+        REQUIRE(packet.messages_[0].messageId_ == messageId1);
+        REQUIRE(packet.messages_[0].size_ == 3);
+        REQUIRE(packet.data_[packet.messages_[0].offset_] == 1);
+        REQUIRE(packet.messages_[1].messageId_ == messageId2);
+        REQUIRE(packet.messages_[1].size_ == 0);
+        REQUIRE(packet.messages_[1].offset_ == packet.data_.size());
+
+        // Connection receives each message as event
+        auto connection = MakeShared<Connection>(context);
+        ea::vector<ea::pair<int, ByteVector>> receivedMessages;
+        connection->SubscribeToEvent(connection, E_NETWORKMESSAGE, [&](StringHash, VariantMap& eventData)
+        {
+            const ByteVector& data = eventData[NetworkMessage::P_DATA].GetBuffer();
+            receivedMessages.emplace_back(eventData[NetworkMessage::P_MESSAGEID].GetInt(), data);
+        });
+
+        REQUIRE(connection->ProcessPacket(packet));
+        REQUIRE(receivedMessages.size() == 2);
+        REQUIRE(receivedMessages[0].first == messageId1);
+        REQUIRE(receivedMessages[0].second == ByteVector{1, 2, 3});
+        REQUIRE(receivedMessages[1].first == messageId2);
+        REQUIRE(receivedMessages[1].second.empty());
+    }
+
+    // Truncated header of packed message
+    {
+        VectorBuffer buffer = CreateMessagePacket(MSG_PACKED_MESSAGE);
+        buffer.WriteUInt(messageId1);
+        buffer.WriteUShort(0);
+
+        IncomingPacket packet = CreateIncomingPacket(buffer);
+        REQUIRE_FALSE(NetworkReceiveThread::UnpackPacket(packet));
+    }
+
+    // Truncated data of packed message
+    {
+        VectorBuffer buffer = CreateMessagePacket(MSG_PACKED_MESSAGE);
+        buffer.WriteUInt(messageId1);
+        buffer.WriteUInt(4);
+        buffer.WriteUByte(1);
+
+        IncomingPacket packet = CreateIncomingPacket(buffer);
+        REQUIRE_FALSE(NetworkReceiveThread::UnpackPacket(packet));
+    }
+
+    // Oversized length that would overflow the offset
+    {
+        VectorBuffer buffer = CreateMessagePacket(MSG_PACKED_MESSAGE);
+        buffer.WriteUInt(messageId1);
+        buffer.WriteUInt(M_MAX_UNSIGNED);
+        buffer.WriteUByte(1);
+
+        IncomingPacket packet = CreateIncomingPacket(buffer);
+        REQUIRE_FALSE(NetworkReceiveThread::UnpackPacket(packet));
+    }
+
+    // Truncated message ID and timestamp
+    {
+        VectorBuffer buffer;
+        buffer.WriteUByte(ID_USER_PACKET_ENUM);
+        buffer.WriteUShort(MSG_PACKED_MESSAGE);
+
+        IncomingPacket packet = CreateIncomingPacket(buffer);
+        REQUIRE_FALSE(NetworkReceiveThread::UnpackPacket(packet));
+
+        IncomingPacket timestampPacket = CreateIncomingPacket(VectorBuffer{});
+        timestampPacket.data_.assign(3, static_cast<unsigned char>(ID_TIMESTAMP));
+        REQUIRE_FALSE(NetworkReceiveThread::UnpackPacket(timestampPacket));
+
+        IncomingPacket emptyPacket;
+        REQUIRE_FALSE(NetworkReceiveThread::UnpackPacket(emptyPacket));
+    }
+
+    // Empty payload is unpacked, but ignored by connection
+    {
+        auto connection = MakeShared<Connection>(context);
+        for (NetworkMessageId messageId : {MSG_PACKED_MESSAGE, messageId1})
+        {
+            IncomingPacket packet = CreateIncomingPacket(CreateMessagePacket(messageId));
+            REQUIRE(NetworkReceiveThread::UnpackPacket(packet));
+            REQUIRE(packet.messages_.empty());
+            REQUIRE_FALSE(connection->ProcessPacket(packet));
+        }
+    }
+}
@@ -56,12 +56,21 @@ void ManualConnection::IncrementTime(unsigned delta)
     SendUnorderedMessages(messages_[true][false]);
 }
 
+unsigned ManualConnection::GetNumBytesSent(NetworkMessageId messageId) const
+{
+    const auto iter = sentMessageStats_.find(messageId);
+    return iter != sentMessageStats_.end() ? static_cast<unsigned>(iter->second.numBytes_) : 0;
+}
+
 void ManualConnection::SendMessageInternal(NetworkMessageId messageId, bool reliable, bool inOrder, const unsigned char* data, unsigned numBytes)
 {
     const double currentDropRatio = droppedMessages_ / ea::max(1.0, static_cast<double>(totalUnreliableMessages_));
     const double currentShuffleRatio = shuffledMessages_ / ea::max(1.0, static_cast<double>(totalUnorderedMessages_));
 
     ++totalMessages_;
+    SentMessageStats& stats = sentMessageStats_[messageId];
+    ++stats.numMessages_;
+    stats.numBytes_ += numBytes;
     if (!reliable)
         ++totalUnreliableMessages_;
     if (!inOrder)
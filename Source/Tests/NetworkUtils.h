@@ -52,6 +52,13 @@ struct ConnectionQuality
     float shuffleRate_{};
 };
 
+/// Statistics of messages of one type sent via ManualConnection.
+struct SentMessageStats
+{
+    unsigned long long numMessages_{};
+    unsigned long long numBytes_{};
+};
+
 /// Test implementation of AbstractConnection with manual control over message transmission.
 class ManualConnection : public AbstractConnection
 {
@@ -74,6 +81,11 @@ public:
 
     void IncrementTime(unsigned delta);
 
+    /// Return total size of sent messages of given type in bytes, including dropped ones.
+    unsigned GetNumBytesSent(NetworkMessageId messageId) const;
+    /// Return statistics of sent messages per message type, including dropped ones.
+    const ea::unordered_map<NetworkMessageId, SentMessageStats>& GetSentMessageStats() const { return sentMessageStats_; }
+
 private:
     struct InternalMessage
     {
@@ -101,6 +113,7 @@ private:
     unsigned totalUnreliableMessages_{};
     unsigned droppedMessages_{};
     unsigned shuffledMessages_{};
+    ea::unordered_map<NetworkMessageId, SentMessageStats> sentMessageStats_;
 };
 
 /// Network simulator for tests.
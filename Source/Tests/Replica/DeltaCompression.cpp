@@ -0,0 +1,155 @@
+//
+// Copyright (c) 2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../CommonUtils.h"
+#include "../NetworkUtils.h"
+#include "../SceneUtils.h"
+
+#include <Urho3D/IO/MemoryBuffer.h>
+#include <Urho3D/IO/VectorBuffer.h>
+#include <Urho3D/Network/Network.h>
+#include <Urho3D/Replica/BehaviorNetworkObject.h>
+#include <Urho3D/Replica/DeltaEncoding.h>
+#include <Urho3D/Replica/ReplicatedTransform.h>
+#include <Urho3D/Replica/ReplicationManager.h>
+#include <Urho3D/Replica/ServerReplicator.h>
+#include <Urho3D/Resource/XMLFile.h>
+#include <Urho3D/Scene/Scene.h>
+
+namespace
+{
+
+SharedPtr<XMLFile> CreateAlwaysUploadedTestPrefab(Context* context)
+{
+    auto node = MakeShared<Node>(context);
+    auto replicatedTransform = node->CreateComponent<ReplicatedTransform>();
+    replicatedTransform->SetNumUploadAttempts(0);
+
+    return Tests::ConvertNodeToPrefab(node);
+}
+
+ByteVector DeltaRoundTrip(const ByteVector& baseline, const ByteVector& value, unsigned& encodedSize)
+{
+    VectorBuffer dest;
+    WriteDeltaEncodedBuffer(dest, baseline, value);
+    encodedSize = dest.GetSize();
+
+    ByteVector result;
+    MemoryBuffer src{dest.GetBuffer()};
+    REQUIRE(ReadDeltaEncodedBuffer(src, baseline, result));
+    REQUIRE(src.IsEof());
+    return result;
+}
+
+}
+
+TEST_CASE("Delta encoding writes only changed bytes")
+{
+    const ByteVector baseline{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16};
+    unsigned encodedSize = 0;
+
+    // Unchanged value
+    REQUIRE(DeltaRoundTrip(baseline, baseline, encodedSize) == baseline);
+    REQUIRE(encodedSize == 1);
+
+    // Single changed byte
+    ByteVector value = baseline;
+    value[5] = 100;
+    REQUIRE(DeltaRoundTrip(baseline, value, encodedSize) == value);
+    REQUIRE(encodedSize == 4);
+
+    // Close runs are merged, distant runs are not
+    value[7] = 101;
+    value[15] = 102;
+    REQUIRE(DeltaRoundTrip(baseline, value, encodedSize) == value);
+    REQUIRE(encodedSize == 1 + (2 + 3) + (2 + 1));
+
+    // Completely different value
+    ByteVector differentValue(baseline.size(), 0);
+    REQUIRE(DeltaRoundTrip(baseline, differentValue, encodedSize) == differentValue);
+    REQUIRE(encodedSize == 1 + 2 + baseline.size());
+
+    // Malformed data is rejected
+    VectorBuffer malformed;
+    malformed.WriteVLE(1);
+    malformed.WriteVLE(10);
+    malformed.WriteVLE(10);
+    MemoryBuffer src{malformed.GetBuffer()};
+    ByteVector result;
+    REQUIRE_FALSE(ReadDeltaEncodedBuffer(src, baseline, result));
+}
+
+TEST_CASE("Unreliable updates of idle objects are delta-compressed")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    context->GetSubsystem<Network>()->SetUpdateFps(Tests::NetworkSimulator::FramesInSecond);
+
+    auto prefab = Tests::GetOrCreateResource<XMLFile>(context, "@/DeltaCompression/AlwaysUploadedPrefab.xml", CreateAlwaysUploadedTestPrefab);
+
+    const auto quality = Tests::ConnectionQuality{0.08f, 0.12f, 0.20f, 0.1f, 0.1f};
+    const unsigned numObjects = 64;
+    // NetworkId, baseline age, component type, size and ReplicatedTransform with position and rotation
+    const unsigned fullUpdateSize = 4 + 1 + 4 + 1 + 52;
+
+    // Setup scenes
+    auto serverScene = MakeShared<Scene>(context);
+    auto clientScene = MakeShared<Scene>(context);
+
+    ea::vector<Node*> serverNodes;
+    for (unsigned i = 0; i < numObjects; ++i)
+    {
+        const Vector3 position{static_cast<float>(i % 8), 0.0f, static_cast<float>(i / 8)};
+        serverNodes.push_back(Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, prefab, Format("Object {}", i), position));
+    }
+
+    Tests::NetworkSimulator sim(serverScene);
+    sim.AddClient(clientScene, quality);
+    sim.SimulateTime(5.0f);
+
+    // Measure traffic while objects are idle
+    auto connection = static_cast<Tests::ManualConnection*>(sim.GetServerToClientConnection(clientScene));
+    const ServerReplicator* serverReplicator = serverScene->GetComponent<ReplicationManager>()->GetServerReplicator();
+
+    const unsigned numBytesBefore = connection->GetNumBytesSent(MSG_UPDATE_OBJECTS_UNRELIABLE);
+    sim.SimulateTime(1.0f);
+    const unsigned numBytesAfter = connection->GetNumBytesSent(MSG_UPDATE_OBJECTS_UNRELIABLE);
+
+    const float bytesPerObjectPerFrame = static_cast<float>(numBytesAfter - numBytesBefore)
+        / Tests::NetworkSimulator::FramesInSecond / numObjects;
+    UNSCOPED_INFO("Bytes per idle object per frame: " << bytesPerObjectPerFrame << " (full update is " << fullUpdateSize << ")");
+
+    REQUIRE(serverReplicator->GetNumDeltaCompressedUnreliableUpdates(connection) > 0);
+    REQUIRE(bytesPerObjectPerFrame * 5 < fullUpdateSize);
+
+    // Move objects, expect them replicated correctly despite packet loss
+    for (unsigned i = 0; i < numObjects; ++i)
+        serverNodes[i]->Translate({0.0f, static_cast<float>(i) * 0.5f, 1.0f});
+    sim.SimulateTime(2.0f);
+
+    for (unsigned i = 0; i < numObjects; ++i)
+    {
+        Node* clientNode = clientScene->GetChild(Format("Object {}", i), true);
+        REQUIRE(clientNode);
+        REQUIRE(clientNode->GetWorldPosition().Equals(serverNodes[i]->GetWorldPosition(), M_LARGE_EPSILON));
+    }
+}
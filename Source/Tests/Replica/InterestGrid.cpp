@@ -0,0 +1,181 @@
+//
+// Copyright (c) 2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../CommonUtils.h"
+#include "../NetworkUtils.h"
+#include "../SceneUtils.h"
+
+#include <Urho3D/Math/RandomEngine.h>
+#include <Urho3D/Network/Network.h>
+#include <Urho3D/Scene/Scene.h>
+#include <Urho3D/Replica/BehaviorNetworkObject.h>
+#include <Urho3D/Replica/FilteredByInterest.h>
+#include <Urho3D/Replica/InterestGrid.h>
+#include <Urho3D/Replica/NetworkSettingsConsts.h>
+#include <Urho3D/Replica/ReplicationManager.h>
+#include <Urho3D/Replica/ReplicatedTransform.h>
+#include <Urho3D/Resource/XMLFile.h>
+
+namespace
+{
+
+SharedPtr<XMLFile> CreateInterestManagedTestPrefab(Context* context)
+{
+    auto node = MakeShared<Node>(context);
+    node->CreateComponent<ReplicatedTransform>();
+    node->CreateComponent<FilteredByInterest>();
+
+    return Tests::ConvertNodeToPrefab(node);
+}
+
+}
+
+TEST_CASE("InterestGrid returns objects within radius")
+{
+    RandomEngine random(0);
+
+    InterestGrid grid;
+    grid.SetCellSize(16.0f);
+    grid.Clear();
+
+    ea::vector<Vector3> positions;
+    for (unsigned i = 0; i < 1000; ++i)
+    {
+        const Vector3 position{random.GetFloat(-200.0f, 200.0f), random.GetFloat(-20.0f, 20.0f), random.GetFloat(-200.0f, 200.0f)};
+        positions.push_back(position);
+        grid.AddObject(i, position);
+    }
+    grid.Commit();
+
+    REQUIRE(grid.GetNumObjects() == positions.size());
+
+    for (const float radius : {0.0f, 10.0f, 40.0f, 1000.0f})
+    {
+        const Vector3 center{random.GetFloat(-100.0f, 100.0f), 0.0f, random.GetFloat(-100.0f, 100.0f)};
+
+        ea::vector<unsigned> expected;
+        for (unsigned i = 0; i < positions.size(); ++i)
+        {
+            if ((positions[i] - center).Length() <= radius)
+                expected.push_back(i);
+        }
+
+        ea::vector<unsigned> actual;
+        grid.QueryObjects(center, radius, [&](unsigned index, float distance)
+        {
+            CHECK(distance == Catch::Approx((positions[index] - center).Length()).margin(0.001f));
+            actual.push_back(index);
+        });
+        ea::sort(actual.begin(), actual.end());
+
+        REQUIRE(actual == expected);
+    }
+}
+
+TEST_CASE("InterestArea applies hysteresis and priority bands")
+{
+    InterestArea area;
+    area.radius_ = 90.0f;
+    area.hysteresis_ = 10.0f;
+    area.numBands_ = 3;
+
+    REQUIRE(area.GetRelevance(0.0f, false) == NetworkObjectRelevance::NormalUpdates);
+    REQUIRE(area.GetRelevance(29.0f, false) == NetworkObjectRelevance::NormalUpdates);
+    REQUIRE(area.GetRelevance(31.0f, false) == static_cast<NetworkObjectRelevance>(2));
+    REQUIRE(area.GetRelevance(61.0f, false) == static_cast<NetworkObjectRelevance>(4));
+    REQUIRE(area.GetRelevance(89.0f, false) == static_cast<NetworkObjectRelevance>(4));
+
+    REQUIRE(area.GetRelevance(95.0f, false) == NetworkObjectRelevance::Irrelevant);
+    REQUIRE(area.GetRelevance(95.0f, true) == static_cast<NetworkObjectRelevance>(4));
+    REQUIRE(area.GetRelevance(101.0f, true) == NetworkObjectRelevance::Irrelevant);
+}
+
+TEST_CASE("FilteredByInterest replicates objects within area of interest")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    context->GetSubsystem<Network>()->SetUpdateFps(Tests::NetworkSimulator::FramesInSecond);
+
+    auto prefab = Tests::GetOrCreateResource<XMLFile>(context, "@/InterestGrid/InterestManagedTestPrefab.xml", CreateInterestManagedTestPrefab);
+
+    // Create scenes
+    auto serverScene = MakeShared<Scene>(context);
+    auto clientScene = MakeShared<Scene>(context);
+
+    const auto quality = Tests::ConnectionQuality{ 0.08f, 0.12f, 0.20f, 0.02f, 0.02f };
+    Tests::NetworkSimulator sim(serverScene);
+    sim.AddClient(clientScene, quality);
+    sim.SimulateTime(5.0f);
+
+    const float radius = NetworkSettings::InterestRadius.defaultValue_.GetFloat();
+    const float hysteresis = NetworkSettings::InterestHysteresis.defaultValue_.GetFloat();
+    REQUIRE(hysteresis > 2.0f);
+
+    // Spawn objects
+    {
+        auto clientNode = Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, prefab, "Client Node");
+        clientNode->GetComponent<BehaviorNetworkObject>()->SetOwner(sim.GetServerToClientConnection(clientScene));
+        clientNode->SetWorldPosition(Vector3::ZERO);
+
+        auto nearNode = Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, prefab, "Near Node");
+        nearNode->SetWorldPosition(Vector3{0.0f, 0.0f, radius * 0.5f});
+
+        auto farNode = Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, prefab, "Far Node");
+        farNode->SetWorldPosition(Vector3{0.0f, 0.0f, radius * 3.0f});
+    }
+
+    sim.SimulateTime(2.0f);
+
+    REQUIRE(clientScene->GetChild("Client Node", true));
+    REQUIRE(clientScene->GetChild("Near Node", true));
+    REQUIRE_FALSE(clientScene->GetChild("Far Node", true));
+
+    // Move near object just outside of the radius, expect it to stay due to hysteresis
+    serverScene->GetChild("Near Node", true)->SetWorldPosition(Vector3{0.0f, 0.0f, radius + hysteresis * 0.5f});
+    sim.SimulateTime(2.0f);
+    REQUIRE(clientScene->GetChild("Near Node", true));
+
+    // Move near object outside of hysteresis range
+    serverScene->GetChild("Near Node", true)->SetWorldPosition(Vector3{0.0f, 0.0f, radius + hysteresis * 2.0f});
+    sim.SimulateTime(2.0f);
+    REQUIRE_FALSE(clientScene->GetChild("Near Node", true));
+
+    // Move objects into hysteresis range, expect them to stay irrelevant
+    serverScene->GetChild("Near Node", true)->SetWorldPosition(Vector3{0.0f, 0.0f, radius + hysteresis * 0.5f});
+    serverScene->GetChild("Far Node", true)->SetWorldPosition(Vector3{0.0f, 0.0f, -radius - hysteresis * 0.5f});
+    sim.SimulateTime(2.0f);
+    REQUIRE_FALSE(clientScene->GetChild("Near Node", true));
+    REQUIRE_FALSE(clientScene->GetChild("Far Node", true));
+
+    // Move client object closer, expect both objects to become relevant
+    serverScene->GetChild("Client Node", true)->SetWorldPosition(Vector3{radius * 0.1f, 0.0f, 0.0f});
+    serverScene->GetChild("Near Node", true)->SetWorldPosition(Vector3{0.0f, 0.0f, radius * 0.8f});
+    serverScene->GetChild("Far Node", true)->SetWorldPosition(Vector3{0.0f, 0.0f, -radius * 0.8f});
+    sim.SimulateTime(2.0f);
+
+    auto nearNode = clientScene->GetChild("Near Node", true);
+    auto farNode = clientScene->GetChild("Far Node", true);
+    REQUIRE(nearNode);
+    REQUIRE(farNode);
+    REQUIRE(nearNode->GetWorldPosition().Equals(Vector3{0.0f, 0.0f, radius * 0.8f}));
+    REQUIRE(farNode->GetWorldPosition().Equals(Vector3{0.0f, 0.0f, -radius * 0.8f}));
+}
@@ -0,0 +1,194 @@
+//
+// Copyright (c) 2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#include "../CommonUtils.h"
+#include "../NetworkUtils.h"
+
+#include <Urho3D/Network/Network.h>
+#include <Urho3D/Scene/Scene.h>
+#include <Urho3D/Scene/SceneEvents.h>
+#include <Urho3D/Replica/BehaviorNetworkObject.h>
+#include <Urho3D/Replica/LagCompensatedHitbox.h>
+#include <Urho3D/Replica/LagCompensationHistory.h>
+#include <Urho3D/Replica/ReplicationManager.h>
+#include <Urho3D/Replica/ServerReplicator.h>
+
+namespace
+{
+
+LagCompensatedHitboxState CreateHitbox(unsigned id, const Vector3& position)
+{
+    return LagCompensatedHitboxState{static_cast<NetworkId>(id), position, Quaternion::IDENTITY, Vector3::ONE * 0.5f};
+}
+
+LagCompensatedQuery CreateDownwardQuery(float x, float radius = 0.0f)
+{
+    LagCompensatedQuery query;
+    query.ray_ = Ray{Vector3{x, 10.0f, 0.0f}, Vector3::DOWN};
+    query.radius_ = radius;
+    return query;
+}
+
+}
+
+TEST_CASE("LagCompensationHistory interpolates hitboxes between frames")
+{
+    LagCompensationHistory history;
+    history.SetCapacity(4);
+
+    // Object 1 moves along X, object 2 is static, object 3 appears later
+    for (unsigned i = 0; i < 10; ++i)
+    {
+        history.BeginFrame(static_cast<NetworkFrame>(i));
+        history.AddHitbox(CreateHitbox(2, Vector3{10.0f, 0.0f, 0.0f}));
+        history.AddHitbox(CreateHitbox(1, Vector3{i * 2.0f, 0.0f, 0.0f}));
+        if (i >= 9)
+            history.AddHitbox(CreateHitbox(3, Vector3{-10.0f, 0.0f, 0.0f}));
+        history.EndFrame();
+    }
+
+    REQUIRE(history.GetLatestFrame() == static_cast<NetworkFrame>(9));
+    REQUIRE(history.GetOldestFrame() == static_cast<NetworkFrame>(6));
+
+    // Sample between frames
+    ea::vector<LagCompensatedHitboxState> hitboxes;
+    history.SampleHitboxes(NetworkTime{static_cast<NetworkFrame>(8), 0.5f}, hitboxes);
+    REQUIRE(hitboxes.size() == 2);
+    REQUIRE(hitboxes[0].objectId_ == static_cast<NetworkId>(1));
+    REQUIRE(hitboxes[0].position_.Equals(Vector3{17.0f, 0.0f, 0.0f}));
+    REQUIRE(hitboxes[1].position_.Equals(Vector3{10.0f, 0.0f, 0.0f}));
+
+    // Sample outside of history
+    history.SampleHitboxes(NetworkTime{static_cast<NetworkFrame>(2)}, hitboxes);
+    REQUIRE(hitboxes.size() == 2);
+    REQUIRE(hitboxes[0].position_.Equals(Vector3{12.0f, 0.0f, 0.0f}));
+
+    history.SampleHitboxes(NetworkTime{static_cast<NetworkFrame>(20)}, hitboxes);
+    REQUIRE(hitboxes.size() == 3);
+    REQUIRE(hitboxes[0].position_.Equals(Vector3{18.0f, 0.0f, 0.0f}));
+}
+
+TEST_CASE("LagCompensationHistory processes batched ray and sweep queries")
+{
+    LagCompensationHistory history;
+    history.SetCapacity(8);
+
+    for (unsigned i = 0; i < 2; ++i)
+    {
+        history.BeginFrame(static_cast<NetworkFrame>(i));
+        history.AddHitbox(CreateHitbox(1, Vector3{i * 4.0f, 0.0f, 0.0f}));
+        history.AddHitbox(CreateHitbox(2, Vector3{2.0f, -3.0f, 0.0f}));
+        history.EndFrame();
+    }
+
+    ea::vector<LagCompensatedQuery> queries;
+    queries.push_back(CreateDownwardQuery(2.0f));
+    queries.push_back(CreateDownwardQuery(0.0f));
+    queries.push_back(CreateDownwardQuery(3.0f, 0.8f));
+    queries.push_back(CreateDownwardQuery(2.0f));
+    queries.back().ignoredObjectId_ = static_cast<NetworkId>(1);
+    queries.push_back(CreateDownwardQuery(2.0f));
+    queries.back().maxDistance_ = 5.0f;
+
+    ea::vector<LagCompensatedHit> results;
+    history.ProcessQueries(NetworkTime{static_cast<NetworkFrame>(0), 0.5f}, queries, results);
+
+    const auto getHits = [&](unsigned queryIndex)
+    {
+        ea::vector<LagCompensatedHit> hits;
+        for (const LagCompensatedHit& hit : results)
+        {
+            if (hit.queryIndex_ == queryIndex)
+                hits.push_back(hit);
+        }
+        return hits;
+    };
+
+    // Ray hits interpolated object first and static object second
+    const auto hits0 = getHits(0);
+    REQUIRE(hits0.size() == 2);
+    REQUIRE(hits0[0].objectId_ == static_cast<NetworkId>(1));
+    REQUIRE(hits0[0].distance_ == Catch::Approx(9.5f));
+    REQUIRE(hits0[0].position_.Equals(Vector3{2.0f, 0.5f, 0.0f}));
+    REQUIRE(hits0[1].objectId_ == static_cast<NetworkId>(2));
+    REQUIRE(hits0[1].distance_ == Catch::Approx(12.5f));
+
+    // Ray misses object at its recorded position
+    REQUIRE(getHits(1).empty());
+
+    // Sweep hits object that ray would miss
+    const auto hits2 = getHits(2);
+    REQUIRE(hits2.size() == 2);
+    REQUIRE(hits2[0].objectId_ == static_cast<NetworkId>(1));
+    REQUIRE(hits2[0].distance_ == Catch::Approx(8.7f));
+
+    // Ignored object and max distance are respected
+    const auto hits3 = getHits(3);
+    REQUIRE(hits3.size() == 1);
+    REQUIRE(hits3[0].objectId_ == static_cast<NetworkId>(2));
+    REQUIRE(getHits(4).empty());
+}
+
+TEST_CASE("LagCompensatedHitbox records hitboxes on server")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    context->GetSubsystem<Network>()->SetUpdateFps(Tests::NetworkSimulator::FramesInSecond);
+
+    // Setup scene
+    auto serverScene = MakeShared<Scene>(context);
+
+    Node* node = serverScene->CreateChild("Node", LOCAL);
+    auto networkObject = node->CreateComponent<BehaviorNetworkObject>();
+    auto hitbox = node->CreateComponent<LagCompensatedHitbox>();
+    hitbox->SetSize(Vector3{1.0f, 2.0f, 1.0f});
+    hitbox->SetOffset(Vector3{0.0f, 1.0f, 0.0f});
+
+    // Move object forever
+    serverScene->SubscribeToEvent(serverScene, E_SCENEUPDATE,
+        [&](StringHash, VariantMap& eventData)
+    {
+        const float timeStep = eventData[SceneUpdate::P_TIMESTEP].GetFloat();
+        node->Translate(timeStep * Vector3::RIGHT * 4.0f, TS_PARENT);
+    });
+
+    // Simulate some time and remember current state
+    Tests::NetworkSimulator sim(serverScene);
+    ServerReplicator* serverReplicator = serverScene->GetComponent<ReplicationManager>()->GetServerReplicator();
+
+    sim.SimulateTime(4.0f);
+    const NetworkTime serverTime = serverReplicator->GetServerTime();
+    const Vector3 position = node->GetWorldPosition();
+
+    // Spend some more time and check that past hitbox is hit and current is not
+    sim.SimulateTime(1.0f);
+
+    ea::vector<LagCompensatedQuery> queries(2);
+    queries[0].ray_ = Ray{position + Vector3{0.0f, 10.0f, 0.0f}, Vector3::DOWN};
+    queries[1].ray_ = Ray{node->GetWorldPosition() + Vector3{0.0f, 10.0f, 0.0f}, Vector3::DOWN};
+
+    ea::vector<LagCompensatedHit> results;
+    serverReplicator->GetLagCompensationHistory().ProcessQueries(serverTime, queries, results);
+
+    REQUIRE(results.size() == 1);
+    REQUIRE(results[0].queryIndex_ == 0);
+    REQUIRE(results[0].objectId_ == networkObject->GetNetworkId());
+    REQUIRE(results[0].distance_ == Catch::Approx(8.0f));
+}
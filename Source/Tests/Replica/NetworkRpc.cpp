@@ -0,0 +1,275 @@
+//
+// Copyright (c) 2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#include "../CommonUtils.h"
+#include "../NetworkUtils.h"
+#include "../SceneUtils.h"
+
+#include <Urho3D/Network/Network.h>
+#include <Urho3D/Scene/Scene.h>
+#include <Urho3D/Replica/BehaviorNetworkObject.h>
+#include <Urho3D/Replica/ClientReplica.h>
+#include <Urho3D/Replica/FilteredByDistance.h>
+#include <Urho3D/Replica/NetworkRpc.h>
+#include <Urho3D/Replica/ReplicationManager.h>
+#include <Urho3D/Replica/ReplicatedTransform.h>
+#include <Urho3D/Resource/XMLFile.h>
+
+namespace
+{
+
+enum class TestRpcMode
+{
+    First,
+    Second
+};
+
+const NetworkRpc<unsigned, Vector3, ea::string, TestRpcMode> RpcTest{"Test"};
+const NetworkRpc<int> RpcCounter{"Counter"};
+
+SharedPtr<XMLFile> CreateTestPrefab(Context* context)
+{
+    auto node = MakeShared<Node>(context);
+    node->CreateComponent<ReplicatedTransform>();
+
+    return Tests::ConvertNodeToPrefab(node);
+}
+
+SharedPtr<XMLFile> CreateFilteredTestPrefab(Context* context)
+{
+    auto node = MakeShared<Node>(context);
+    node->CreateComponent<ReplicatedTransform>();
+
+    auto filter = node->CreateComponent<FilteredByDistance>();
+    filter->SetRelevant(false);
+    filter->SetDistance(10.0f);
+
+    return Tests::ConvertNodeToPrefab(node);
+}
+
+}
+
+TEST_CASE("NetworkRpcBatch serializes and filters calls")
+{
+    NetworkRpcBatch batch;
+    batch.AddCall(static_cast<NetworkId>(1), RpcTest, 10u, Vector3{1.0f, 2.0f, 3.0f}, "Hello", TestRpcMode::Second);
+    batch.AddCall(static_cast<NetworkId>(2), RpcCounter, -5);
+    batch.AddCall(static_cast<NetworkId>(1), RpcCounter, 7);
+    REQUIRE(batch.GetNumCalls() == 3);
+
+    VectorBuffer message;
+    REQUIRE(batch.WriteCalls(message, [](NetworkId networkId) { return networkId == static_cast<NetworkId>(1); }) == 2);
+
+    ea::vector<ea::pair<NetworkId, StringHash>> calls;
+    unsigned testArgument{};
+    Vector3 vectorArgument;
+    ea::string stringArgument;
+    TestRpcMode enumArgument{};
+    int counterArgument{};
+
+    MemoryBuffer src(message.GetBuffer());
+    NetworkRpcBatch::ReadCalls(src, [&](NetworkId networkId, StringHash rpcId, MemoryBuffer& arguments)
+    {
+        calls.emplace_back(networkId, rpcId);
+        if (rpcId == RpcTest.GetId())
+        {
+            NetworkRpc<unsigned, Vector3, ea::string, TestRpcMode>::InvokeHandler(
+                [&](AbstractConnection*, unsigned a, const Vector3& b, const ea::string& c, TestRpcMode d)
+            {
+                testArgument = a;
+                vectorArgument = b;
+                stringArgument = c;
+                enumArgument = d;
+            }, nullptr, arguments);
+        }
+        else if (rpcId == RpcCounter.GetId())
+        {
+            NetworkRpc<int>::InvokeHandler([&](AbstractConnection*, int value) { counterArgument = value; }, nullptr, arguments);
+        }
+    });
+
+    REQUIRE(calls.size() == 2);
+    REQUIRE(calls[0] == ea::make_pair(static_cast<NetworkId>(1), RpcTest.GetId()));
+    REQUIRE(calls[1] == ea::make_pair(static_cast<NetworkId>(1), RpcCounter.GetId()));
+    REQUIRE(testArgument == 10u);
+    REQUIRE(vectorArgument == Vector3{1.0f, 2.0f, 3.0f});
+    REQUIRE(stringArgument == "Hello");
+    REQUIRE(enumArgument == TestRpcMode::Second);
+    REQUIRE(counterArgument == 7);
+
+    batch.Clear();
+    REQUIRE(batch.IsEmpty());
+    REQUIRE(batch.GetSize() == 0);
+}
+
+TEST_CASE("NetworkObject RPCs are batched and delivered between client and server")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    context->GetSubsystem<Network>()->SetUpdateFps(Tests::NetworkSimulator::FramesInSecond);
+
+    auto prefab = Tests::GetOrCreateResource<XMLFile>(context, "@/NetworkRpc/TestPrefab.xml", CreateTestPrefab);
+
+    auto serverScene = MakeShared<Scene>(context);
+    auto clientSceneA = MakeShared<Scene>(context);
+    auto clientSceneB = MakeShared<Scene>(context);
+
+    const auto quality = Tests::ConnectionQuality{ 0.08f, 0.12f, 0.20f, 0.02f, 0.02f };
+    Tests::NetworkSimulator sim(serverScene);
+    sim.AddClient(clientSceneA, quality);
+    sim.AddClient(clientSceneB, quality);
+    sim.SimulateTime(5.0f);
+
+    // Spawn object owned by client A
+    AbstractConnection* connectionA = sim.GetServerToClientConnection(clientSceneA);
+    auto serverNode = Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, prefab, "Node");
+    auto serverObject = serverNode->GetComponent<BehaviorNetworkObject>();
+    serverObject->SetOwner(connectionA);
+    sim.SimulateTime(1.0f);
+
+    auto clientObjectA = clientSceneA->GetChild("Node", true)->GetComponent<BehaviorNetworkObject>();
+    auto clientObjectB = clientSceneB->GetChild("Node", true)->GetComponent<BehaviorNetworkObject>();
+    REQUIRE(clientObjectA->IsOwnedByThisClient());
+    REQUIRE(clientObjectB->IsReplicatedClient());
+
+    // Subscribe to RPCs
+    ea::vector<int> serverCounters;
+    AbstractConnection* serverSender = nullptr;
+    serverObject->SubscribeToRpc(RpcCounter, [&](AbstractConnection* sender, int value)
+    {
+        serverSender = sender;
+        serverCounters.push_back(value);
+    });
+
+    ea::vector<int> clientCountersA;
+    ea::vector<int> clientCountersB;
+    clientObjectA->SubscribeToRpc(RpcCounter, [&](AbstractConnection*, int value) { clientCountersA.push_back(value); });
+    clientObjectB->SubscribeToRpc(RpcCounter, [&](AbstractConnection*, int value) { clientCountersB.push_back(value); });
+
+    ea::string clientString;
+    clientObjectB->SubscribeToRpc(RpcTest, [&](AbstractConnection*, unsigned, const Vector3&, const ea::string& value, TestRpcMode)
+    {
+        clientString = value;
+    });
+
+    // Send many calls from client to server
+    const int numCalls = 100;
+    for (int i = 0; i < numCalls; ++i)
+        clientObjectA->SendRpcToServer(RpcCounter, i);
+    sim.SimulateTime(1.0f);
+
+    REQUIRE(serverSender == connectionA);
+    REQUIRE(serverCounters.size() == numCalls);
+    for (int i = 0; i < numCalls; ++i)
+        REQUIRE(serverCounters[i] == i);
+
+    // Send many calls from server to individual client and to all clients, expect them in one message per client
+    const auto getNumRpcMessages = [&](Scene* clientScene)
+    {
+        auto connection = static_cast<Tests::ManualConnection*>(sim.GetServerToClientConnection(clientScene));
+        const auto& stats = connection->GetSentMessageStats();
+        const auto iter = stats.find(MSG_OBJECTS_RPC);
+        return iter != stats.end() ? iter->second.numMessages_ : 0;
+    };
+    const auto numRpcMessagesA = getNumRpcMessages(clientSceneA);
+    const auto numRpcMessagesB = getNumRpcMessages(clientSceneB);
+
+    for (int i = 0; i < numCalls; ++i)
+        serverObject->SendRpcToClient(connectionA, RpcCounter, i);
+    serverObject->SendRpcToClients(RpcCounter, -1);
+    serverObject->SendRpcToClients(RpcTest, 1u, Vector3::ONE, "Broadcast", TestRpcMode::First);
+    sim.SimulateTime(1.0f / Tests::NetworkSimulator::FramesInSecond);
+
+    REQUIRE(getNumRpcMessages(clientSceneA) == numRpcMessagesA + 1);
+    REQUIRE(getNumRpcMessages(clientSceneB) == numRpcMessagesB + 1);
+
+    sim.SimulateTime(1.0f);
+
+    REQUIRE(clientCountersA.size() == numCalls + 1);
+    for (int i = 0; i < numCalls; ++i)
+        REQUIRE(clientCountersA[i] == i);
+    REQUIRE(clientCountersA.back() == -1);
+
+    REQUIRE(clientCountersB == ea::vector<int>{-1});
+    REQUIRE(clientString == "Broadcast");
+}
+
+TEST_CASE("NetworkObject RPCs are accepted only from clients the object is replicated to")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    context->GetSubsystem<Network>()->SetUpdateFps(Tests::NetworkSimulator::FramesInSecond);
+
+    auto prefab = Tests::GetOrCreateResource<XMLFile>(context, "@/NetworkRpc/TestPrefab.xml", CreateTestPrefab);
+    auto filteredPrefab = Tests::GetOrCreateResource<XMLFile>(context, "@/NetworkRpc/FilteredTestPrefab.xml", CreateFilteredTestPrefab);
+
+    auto serverScene = MakeShared<Scene>(context);
+    auto clientSceneA = MakeShared<Scene>(context);
+    auto clientSceneB = MakeShared<Scene>(context);
+
+    const auto quality = Tests::ConnectionQuality{ 0.08f, 0.12f, 0.20f, 0.0f, 0.0f };
+    Tests::NetworkSimulator sim(serverScene);
+    sim.AddClient(clientSceneA, quality);
+    sim.AddClient(clientSceneB, quality);
+    sim.SimulateTime(5.0f);
+
+    // Spawn object close to client A and far from client B
+    AbstractConnection* connectionA = sim.GetServerToClientConnection(clientSceneA);
+    AbstractConnection* connectionB = sim.GetServerToClientConnection(clientSceneB);
+    auto ownedNodeA = Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, prefab, "Owned Node A");
+    ownedNodeA->GetComponent<BehaviorNetworkObject>()->SetOwner(connectionA);
+    auto ownedNodeB = Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, prefab, "Owned Node B", {1000.0f, 0.0f, 0.0f});
+    ownedNodeB->GetComponent<BehaviorNetworkObject>()->SetOwner(connectionB);
+
+    auto serverNode = Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, filteredPrefab, "Node");
+    auto serverObject = serverNode->GetComponent<BehaviorNetworkObject>();
+    sim.SimulateTime(1.0f);
+
+    REQUIRE(clientSceneA->GetChild("Node", true));
+    REQUIRE_FALSE(clientSceneB->GetChild("Node", true));
+    auto clientObjectA = clientSceneA->GetChild("Node", true)->GetComponent<BehaviorNetworkObject>();
+
+    ea::vector<ea::pair<AbstractConnection*, int>> serverCalls;
+    serverObject->SubscribeToRpc(RpcCounter, [&](AbstractConnection* sender, int value)
+    {
+        serverCalls.emplace_back(sender, value);
+    });
+
+    // Handler may unsubscribe itself
+    unsigned numTestCalls = 0;
+    serverObject->SubscribeToRpc(RpcTest, [&](AbstractConnection*, unsigned, const Vector3&, const ea::string&, TestRpcMode)
+    {
+        serverObject->UnsubscribeFromRpc(RpcTest.GetId());
+        ++numTestCalls;
+    });
+
+    clientObjectA->SendRpcToServer(RpcCounter, 1);
+    clientObjectA->SendRpcToServer(RpcTest, 1u, Vector3::ONE, "Test", TestRpcMode::Second);
+    clientObjectA->SendRpcToServer(RpcTest, 2u, Vector3::ONE, "Test", TestRpcMode::Second);
+
+    // Client B doesn't know about the object, but sends the call anyway
+    ClientReplica* clientReplicaB = clientSceneB->GetComponent<ReplicationManager>()->GetClientReplica();
+    clientReplicaB->GetRpcBatch().AddCall(serverObject->GetNetworkId(), RpcCounter, 2);
+    sim.SimulateTime(1.0f);
+
+    REQUIRE(serverCalls.size() == 1);
+    REQUIRE(serverCalls[0].first == connectionA);
+    REQUIRE(serverCalls[0].second == 1);
+    REQUIRE(numTestCalls == 1);
+}
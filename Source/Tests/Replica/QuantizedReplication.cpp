@@ -0,0 +1,187 @@
+//
+// Copyright (c) 2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../CommonUtils.h"
+#include "../ModelUtils.h"
+#include "../NetworkUtils.h"
+#include "../SceneUtils.h"
+
+#include <Urho3D/Graphics/Animation.h>
+#include <Urho3D/Graphics/AnimationController.h>
+#include <Urho3D/IO/VectorBuffer.h>
+#include <Urho3D/Network/Network.h>
+#include <Urho3D/Replica/BehaviorNetworkObject.h>
+#include <Urho3D/Replica/ReplicatedAnimation.h>
+#include <Urho3D/Replica/ReplicatedTransform.h>
+#include <Urho3D/Replica/ReplicationManager.h>
+#include <Urho3D/Scene/Scene.h>
+#include <Urho3D/Resource/XMLFile.h>
+
+namespace
+{
+
+const unsigned PositionBits = 16;
+const float PositionRange = 256.0f;
+const unsigned RotationBits = 12;
+const unsigned AnimationBits = 12;
+
+SharedPtr<XMLFile> CreateDefaultPrefab(Context* context)
+{
+    auto node = MakeShared<Node>(context);
+    node->CreateComponent<ReplicatedTransform>();
+    node->CreateComponent<AnimationController>();
+    node->CreateComponent<ReplicatedAnimation>();
+
+    return Tests::ConvertNodeToPrefab(node);
+}
+
+SharedPtr<XMLFile> CreateQuantizedPrefab(Context* context)
+{
+    auto node = MakeShared<Node>(context);
+
+    auto replicatedTransform = node->CreateComponent<ReplicatedTransform>();
+    replicatedTransform->SetPositionQuantizationBits(PositionBits);
+    replicatedTransform->SetPositionRange(PositionRange);
+    replicatedTransform->SetRotationQuantizationBits(RotationBits);
+    replicatedTransform->SetHalfPrecisionVelocity(true);
+
+    node->CreateComponent<AnimationController>();
+    auto replicatedAnimation = node->CreateComponent<ReplicatedAnimation>();
+    replicatedAnimation->SetQuantizationBits(AnimationBits);
+
+    return Tests::ConvertNodeToPrefab(node);
+}
+
+SharedPtr<Animation> CreateTestAnimation(Context* context)
+{
+    return Tests::CreateLoopedTranslationAnimation(context, "", "", {0.0f, 1.0f, 0.0f}, {1.0f, 0.0f, 0.0f}, 2.0f);
+}
+
+Vector3 GetTestPosition(unsigned index, float time)
+{
+    return {static_cast<float>(index % 16) * 10.0f - 80.0f + time, 1.0f, static_cast<float>(index / 16) * 10.0f - 80.0f};
+}
+
+Quaternion GetTestRotation(unsigned index, float time)
+{
+    return Quaternion{index * 17.0f + time * 90.0f, index * 5.0f, -time * 30.0f};
+}
+
+/// Return average size of unreliable delta per object in bytes.
+template <class T> float GetAverageDeltaSize(const ea::vector<Node*>& nodes, NetworkFrame frame)
+{
+    VectorBuffer buffer;
+    unsigned totalSize = 0;
+    for (Node* node : nodes)
+    {
+        auto behavior = node->GetComponent<T>();
+        buffer.Clear();
+        behavior->WriteUnreliableDelta(frame, buffer);
+        totalSize += buffer.GetSize();
+    }
+    return static_cast<float>(totalSize) / nodes.size();
+}
+
+}
+
+TEST_CASE("Quantized replication reduces bytes per object per tick")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    context->GetSubsystem<Network>()->SetUpdateFps(Tests::NetworkSimulator::FramesInSecond);
+
+    auto defaultPrefab = Tests::GetOrCreateResource<XMLFile>(context, "@/QuantizedReplication/DefaultPrefab.xml", CreateDefaultPrefab);
+    auto quantizedPrefab = Tests::GetOrCreateResource<XMLFile>(context, "@/QuantizedReplication/QuantizedPrefab.xml", CreateQuantizedPrefab);
+    auto animation = Tests::GetOrCreateResource<Animation>(context, "@/QuantizedReplication/Animation.ani", CreateTestAnimation);
+
+    const auto quality = Tests::ConnectionQuality{0.08f, 0.12f, 0.20f, 0, 0};
+    const unsigned numObjects = 64;
+
+    // Setup scenes
+    auto serverScene = MakeShared<Scene>(context);
+    auto clientScene = MakeShared<Scene>(context);
+
+    ea::vector<Node*> defaultNodes;
+    ea::vector<Node*> quantizedNodes;
+    for (unsigned i = 0; i < numObjects; ++i)
+    {
+        defaultNodes.push_back(Tests::SpawnOnServer<BehaviorNetworkObject>(
+            serverScene, defaultPrefab, Format("Default {}", i), GetTestPosition(i, 0.0f), GetTestRotation(i, 0.0f)));
+        quantizedNodes.push_back(Tests::SpawnOnServer<BehaviorNetworkObject>(
+            serverScene, quantizedPrefab, Format("Quantized {}", i), GetTestPosition(i, 0.0f), GetTestRotation(i, 0.0f)));
+    }
+
+    for (Node* node : defaultNodes)
+        node->GetComponent<AnimationController>()->PlayNewExclusive(AnimationParameters{animation}.Looped().Weight(0.6f));
+    for (Node* node : quantizedNodes)
+        node->GetComponent<AnimationController>()->PlayNewExclusive(AnimationParameters{animation}.Looped().Weight(0.6f));
+
+    Tests::NetworkSimulator sim(serverScene);
+    sim.AddClient(clientScene, quality);
+    sim.SimulateTime(5.0f);
+
+    // Move objects and let the client catch up
+    const float time = 1.25f;
+    for (unsigned i = 0; i < numObjects; ++i)
+    {
+        defaultNodes[i]->SetWorldTransform(GetTestPosition(i, time), GetTestRotation(i, time));
+        quantizedNodes[i]->SetWorldTransform(GetTestPosition(i, time), GetTestRotation(i, time));
+    }
+    sim.SimulateTime(2.0f);
+
+    // Measure size of deltas
+    const NetworkFrame currentFrame = serverScene->GetComponent<ReplicationManager>()->GetServerReplicator()->GetCurrentFrame();
+    const float defaultTransformSize = GetAverageDeltaSize<ReplicatedTransform>(defaultNodes, currentFrame);
+    const float quantizedTransformSize = GetAverageDeltaSize<ReplicatedTransform>(quantizedNodes, currentFrame);
+    const float defaultAnimationSize = GetAverageDeltaSize<ReplicatedAnimation>(defaultNodes, currentFrame);
+    const float quantizedAnimationSize = GetAverageDeltaSize<ReplicatedAnimation>(quantizedNodes, currentFrame);
+
+    UNSCOPED_INFO("ReplicatedTransform bytes per object per tick: " << defaultTransformSize << " -> " << quantizedTransformSize);
+    UNSCOPED_INFO("ReplicatedAnimation bytes per object per tick: " << defaultAnimationSize << " -> " << quantizedAnimationSize);
+
+    REQUIRE(defaultTransformSize == 52.0f);
+    REQUIRE(quantizedTransformSize == 23.0f);
+    REQUIRE(quantizedAnimationSize < defaultAnimationSize);
+
+    // Expect quantized objects replicated with bounded error
+    const float positionError = 2 * PositionRange / ((1 << PositionBits) - 1);
+    for (unsigned i = 0; i < numObjects; ++i)
+    {
+        Node* defaultClientNode = clientScene->GetChild(Format("Default {}", i), true);
+        Node* quantizedClientNode = clientScene->GetChild(Format("Quantized {}", i), true);
+        REQUIRE(defaultClientNode);
+        REQUIRE(quantizedClientNode);
+
+        const Vector3 expectedPosition = GetTestPosition(i, time);
+        const Quaternion expectedRotation = GetTestRotation(i, time);
+
+        REQUIRE(defaultClientNode->GetWorldPosition().Equals(expectedPosition, M_LARGE_EPSILON));
+        REQUIRE(quantizedClientNode->GetWorldPosition().Equals(expectedPosition, positionError));
+        REQUIRE(Abs(quantizedClientNode->GetWorldRotation().DotProduct(expectedRotation)) > 0.999f);
+
+        const auto clientAnimationController = quantizedClientNode->GetComponent<AnimationController>();
+        REQUIRE(clientAnimationController->GetNumAnimations() == 1);
+        const AnimationParameters& clientParams = clientAnimationController->GetAnimationParameters(0);
+        REQUIRE(clientParams.animation_ == animation);
+        REQUIRE(clientParams.weight_ == Catch::Approx(0.6f).margin(1.0f / (1 << AnimationBits)));
+    }
+}
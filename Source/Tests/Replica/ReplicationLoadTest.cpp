@@ -0,0 +1,277 @@
+//
+// Copyright (c) 2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../CommonUtils.h"
+#include "../NetworkUtils.h"
+#include "../SceneUtils.h"
+
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Network/Network.h>
+#include <Urho3D/Network/NetworkEvents.h>
+#include <Urho3D/Replica/BehaviorNetworkObject.h>
+#include <Urho3D/Replica/ReplicatedTransform.h>
+#include <Urho3D/Replica/ReplicationManager.h>
+#include <Urho3D/Replica/ServerReplicator.h>
+#include <Urho3D/Resource/XMLFile.h>
+#include <Urho3D/Scene/Scene.h>
+#include <Urho3D/Scene/SceneEvents.h>
+
+#include <EASTL/map.h>
+
+#include <cstdlib>
+
+namespace
+{
+
+/// Parameters of replication load test, may be overridden by environment variables.
+struct LoadTestParameters
+{
+    unsigned numClients_{100};
+    unsigned numObjects_{1000};
+    float duration_{10.0f};
+    float minPing_{0.08f};
+    float maxPing_{0.12f};
+    float dropRate_{0.02f};
+};
+
+void ReadEnvironmentVariable(const char* name, unsigned& value)
+{
+    if (const char* text = std::getenv(name))
+        value = ToUInt(text);
+}
+
+void ReadEnvironmentVariable(const char* name, float& value)
+{
+    if (const char* text = std::getenv(name))
+        value = ToFloat(text);
+}
+
+LoadTestParameters GetLoadTestParameters()
+{
+    LoadTestParameters params;
+    ReadEnvironmentVariable("URHO3D_LOAD_TEST_CLIENTS", params.numClients_);
+    ReadEnvironmentVariable("URHO3D_LOAD_TEST_OBJECTS", params.numObjects_);
+    ReadEnvironmentVariable("URHO3D_LOAD_TEST_DURATION", params.duration_);
+    ReadEnvironmentVariable("URHO3D_LOAD_TEST_MIN_PING", params.minPing_);
+    ReadEnvironmentVariable("URHO3D_LOAD_TEST_MAX_PING", params.maxPing_);
+    ReadEnvironmentVariable("URHO3D_LOAD_TEST_DROP_RATE", params.dropRate_);
+    return params;
+}
+
+SharedPtr<XMLFile> CreateLoadTestPrefab(Context* context)
+{
+    auto node = MakeShared<Node>(context);
+    node->CreateComponent<ReplicatedTransform>();
+
+    return Tests::ConvertNodeToPrefab(node);
+}
+
+/// Each object moves along its own circle with its own speed.
+Vector3 GetObjectPosition(unsigned index, float time)
+{
+    const unsigned gridSize = 32;
+    const Vector3 center{(index % gridSize) * 8.0f, 0.0f, (index / gridSize) * 8.0f};
+    const float angle = 360.0f * time / (2.0f + (index % 7) * 0.5f) + index * 17.0f;
+    return center + 2.0f * Vector3{Cos(angle), 0.0f, Sin(angle)};
+}
+
+ea::string GetMessageName(NetworkMessageId messageId)
+{
+    switch (messageId)
+    {
+    case MSG_CONFIGURE: return "Configure";
+    case MSG_SCENE_CLOCK: return "SceneClock";
+    case MSG_SYNCHRONIZED: return "Synchronized";
+    case MSG_REMOVE_OBJECTS: return "RemoveObjects";
+    case MSG_ADD_OBJECTS: return "AddObjects";
+    case MSG_UPDATE_OBJECTS_RELIABLE: return "UpdateObjectsReliable";
+    case MSG_UPDATE_OBJECTS_UNRELIABLE: return "UpdateObjectsUnreliable";
+    case MSG_OBJECTS_FEEDBACK_UNRELIABLE: return "ObjectsFeedbackUnreliable";
+    case MSG_ACKNOWLEDGE_UPDATES_UNRELIABLE: return "AcknowledgeUpdatesUnreliable";
+    case MSG_OBJECTS_RPC: return "ObjectsRpc";
+    default: return Format("Message {}", static_cast<int>(messageId));
+    }
+}
+
+/// Sum statistics of messages sent by all connections.
+ea::map<NetworkMessageId, Tests::SentMessageStats> GetTotalMessageStats(
+    const ea::vector<Tests::ManualConnection*>& connections)
+{
+    ea::map<NetworkMessageId, Tests::SentMessageStats> result;
+    for (const Tests::ManualConnection* connection : connections)
+    {
+        for (const auto& [messageId, stats] : connection->GetSentMessageStats())
+        {
+            Tests::SentMessageStats& totalStats = result[messageId];
+            totalStats.numMessages_ += stats.numMessages_;
+            totalStats.numBytes_ += stats.numBytes_;
+        }
+    }
+    return result;
+}
+
+}
+
+TEST_CASE("Replication load test", "[.benchmark][.loadtest]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto network = context->GetSubsystem<Network>();
+    network->SetUpdateFps(Tests::NetworkSimulator::FramesInSecond);
+
+    const LoadTestParameters params = GetLoadTestParameters();
+    const float frameTime = 1.0f / Tests::NetworkSimulator::FramesInSecond;
+    const unsigned numFrames = ea::max(1, RoundToInt(params.duration_ * Tests::NetworkSimulator::FramesInSecond));
+
+    auto prefab = Tests::GetOrCreateResource<XMLFile>(context, "@/ReplicationLoadTest/TestPrefab.xml", CreateLoadTestPrefab);
+
+    // Setup scenes
+    auto serverScene = MakeShared<Scene>(context);
+    ea::vector<SharedPtr<Scene>> clientScenes;
+    for (unsigned i = 0; i < params.numClients_; ++i)
+        clientScenes.push_back(MakeShared<Scene>(context));
+
+    const auto quality = Tests::ConnectionQuality{params.minPing_, params.maxPing_, params.maxPing_ + 0.08f, params.dropRate_, 0.0f};
+    Tests::NetworkSimulator sim(serverScene);
+    ea::vector<Tests::ManualConnection*> serverToClientConnections;
+    for (Scene* clientScene : clientScenes)
+    {
+        sim.AddClient(clientScene, quality);
+        serverToClientConnections.push_back(static_cast<Tests::ManualConnection*>(sim.GetServerToClientConnection(clientScene)));
+    }
+    sim.SimulateTime(5.0f);
+
+    // Spawn and animate objects
+    ea::vector<ReplicatedTransform*> serverTransforms;
+    for (unsigned i = 0; i < params.numObjects_; ++i)
+    {
+        Node* node = Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, prefab, Format("Object Node {}", i), GetObjectPosition(i, 0.0f));
+        serverTransforms.push_back(node->GetComponent<ReplicatedTransform>());
+    }
+
+    float elapsedTime = 0.0f;
+    serverScene->SubscribeToEvent(serverScene, E_SCENEUPDATE,
+        [&](StringHash, VariantMap& eventData)
+    {
+        elapsedTime += eventData[SceneUpdate::P_TIMESTEP].GetFloat();
+        for (unsigned i = 0; i < params.numObjects_; ++i)
+            serverTransforms[i]->GetNode()->SetWorldPosition(GetObjectPosition(i, elapsedTime));
+    });
+
+    sim.SimulateTime(3.0f);
+
+    // Measure time spent in server replication, from the end of server network frame till sent messages
+    bool isMeasuring = false;
+    HiresTimer serverTickTimer;
+    long long totalServerTickTime = 0;
+    long long maxServerTickTime = 0;
+    unsigned numServerTicks = 0;
+
+    serverScene->SubscribeToEvent(network, E_ENDSERVERNETWORKFRAME,
+        [&](StringHash, VariantMap&)
+    {
+        serverTickTimer.Reset();
+    });
+    serverScene->SubscribeToEvent(network, E_NETWORKUPDATESENT,
+        [&](StringHash, VariantMap& eventData)
+    {
+        if (!isMeasuring || !eventData[NetworkUpdateSent::P_ISSERVER].GetBool())
+            return;
+
+        const long long tickTime = serverTickTimer.GetUSec(false);
+        totalServerTickTime += tickTime;
+        maxServerTickTime = ea::max(maxServerTickTime, tickTime);
+        ++numServerTicks;
+    });
+
+    const auto initialMessageStats = GetTotalMessageStats(serverToClientConnections);
+
+    double totalInterpolationError = 0.0;
+    float maxInterpolationError = 0.0f;
+    unsigned long long numErrorSamples = 0;
+    unsigned long long numMissingObjects = 0;
+
+    HiresTimer simulationTimer;
+    isMeasuring = true;
+    for (unsigned frameIndex = 0; frameIndex < numFrames; ++frameIndex)
+    {
+        sim.SimulateTime(frameTime);
+
+        // Compare client positions with server positions at the time client is displaying
+        for (Scene* clientScene : clientScenes)
+        {
+            const auto replicationManager = clientScene->GetComponent<ReplicationManager>();
+            const NetworkTime replicaTime = replicationManager->GetClientReplica()->GetReplicaTime();
+            for (const ReplicatedTransform* serverTransform : serverTransforms)
+            {
+                NetworkObject* clientObject = replicationManager->GetNetworkObject(serverTransform->GetNetworkObject()->GetNetworkId());
+                if (!clientObject)
+                {
+                    ++numMissingObjects;
+                    continue;
+                }
+
+                const Vector3 expectedPosition = serverTransform->SampleTemporalPosition(replicaTime).value_;
+                const float error = (clientObject->GetNode()->GetWorldPosition() - expectedPosition).Length();
+                totalInterpolationError += error;
+                maxInterpolationError = ea::max(maxInterpolationError, error);
+                ++numErrorSamples;
+            }
+        }
+    }
+    isMeasuring = false;
+    const long long totalSimulationTime = simulationTimer.GetUSec(false);
+
+    // Report results
+    const auto finalMessageStats = GetTotalMessageStats(serverToClientConnections);
+    const double measuredDuration = numFrames * frameTime;
+    const double clientSeconds = ea::max(1u, params.numClients_) * measuredDuration;
+
+    PrintLine(Format("Replication load test: {} clients, {} objects, {:.1f} s, ping {:.0f}-{:.0f} ms, drop rate {:.1f}%",
+        params.numClients_, params.numObjects_, measuredDuration, params.minPing_ * 1000, params.maxPing_ * 1000,
+        params.dropRate_ * 100));
+    PrintLine(Format("Server tick time: {:.3f} ms average, {:.3f} ms max over {} ticks",
+        totalServerTickTime / 1000.0 / ea::max(1u, numServerTicks), maxServerTickTime / 1000.0, numServerTicks));
+    PrintLine(Format("Simulation time: {:.3f} ms per frame including clients", totalSimulationTime / 1000.0 / numFrames));
+
+    unsigned long long totalBytes = 0;
+    for (const auto& [messageId, stats] : finalMessageStats)
+    {
+        const auto iter = initialMessageStats.find(messageId);
+        const Tests::SentMessageStats initialStats = iter != initialMessageStats.end() ? iter->second : Tests::SentMessageStats{};
+        const unsigned long long numMessages = stats.numMessages_ - initialStats.numMessages_;
+        const unsigned long long numBytes = stats.numBytes_ - initialStats.numBytes_;
+        if (numMessages == 0)
+            continue;
+
+        totalBytes += numBytes;
+        PrintLine(Format("{}: {:.1f} messages and {:.0f} bytes per client per second",
+            GetMessageName(messageId), numMessages / clientSeconds, numBytes / clientSeconds));
+    }
+    PrintLine(Format("Total: {:.0f} bytes per client per second", totalBytes / clientSeconds));
+    PrintLine(Format("Interpolation error: {:.4f} average, {:.4f} max, {} missing objects",
+        numErrorSamples ? totalInterpolationError / numErrorSamples : 0.0, maxInterpolationError, numMissingObjects));
+
+    // Expect every client to receive every object
+    REQUIRE(numMissingObjects == 0);
+}
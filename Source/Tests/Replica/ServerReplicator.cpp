@@ -0,0 +1,372 @@
+//
+// Copyright (c) 2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../CommonUtils.h"
+#include "../NetworkUtils.h"
+#include "../SceneUtils.h"
+
+#include <Urho3D/Network/Network.h>
+#include <Urho3D/Scene/Scene.h>
+#include <Urho3D/Replica/BehaviorNetworkObject.h>
+#include <Urho3D/Replica/ClientReplica.h>
+#include <Urho3D/Replica/FilteredByDistance.h>
+#include <Urho3D/Replica/NetworkSettingsConsts.h>
+#include <Urho3D/Replica/ReplicationManager.h>
+#include <Urho3D/Replica/ReplicatedTransform.h>
+#include <Urho3D/Replica/ServerReplicator.h>
+#include <Urho3D/Resource/XMLFile.h>
+
+namespace
+{
+
+SharedPtr<XMLFile> CreateFilteredTestPrefab(Context* context)
+{
+    auto node = MakeShared<Node>(context);
+    node->CreateComponent<ReplicatedTransform>();
+
+    auto filter = node->CreateComponent<FilteredByDistance>();
+    filter->SetRelevant(false);
+    filter->SetDistance(10.0f);
+
+    return Tests::ConvertNodeToPrefab(node);
+}
+
+SharedPtr<XMLFile> CreateUnfilteredTestPrefab(Context* context)
+{
+    auto node = MakeShared<Node>(context);
+    node->CreateComponent<ReplicatedTransform>();
+
+    return Tests::ConvertNodeToPrefab(node);
+}
+
+}
+
+TEST_CASE("ServerReplicator evaluates relevance independently for each client")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    context->GetSubsystem<Network>()->SetUpdateFps(Tests::NetworkSimulator::FramesInSecond);
+
+    auto filteredPrefab = Tests::GetOrCreateResource<XMLFile>(context, "@/ServerReplicator/FilteredTestPrefab.xml", CreateFilteredTestPrefab);
+    auto unfilteredPrefab = Tests::GetOrCreateResource<XMLFile>(context, "@/ServerReplicator/UnfilteredTestPrefab.xml", CreateUnfilteredTestPrefab);
+
+    // Create scenes, more than one client to exercise parallel update
+    const unsigned numClients = 4;
+    auto serverScene = MakeShared<Scene>(context);
+    ea::vector<SharedPtr<Scene>> clientScenes;
+    for (unsigned i = 0; i < numClients; ++i)
+        clientScenes.push_back(MakeShared<Scene>(context));
+
+    const auto quality = Tests::ConnectionQuality{ 0.08f, 0.12f, 0.20f, 0.02f, 0.02f };
+    Tests::NetworkSimulator sim(serverScene);
+    for (Scene* clientScene : clientScenes)
+        sim.AddClient(clientScene, quality);
+    sim.SimulateTime(5.0f);
+
+    // Spawn owned object and nearby filtered object for each client, and one shared unfiltered object
+    for (unsigned i = 0; i < numClients; ++i)
+    {
+        const Vector3 position{i * 100.0f, 0.0f, 0.0f};
+
+        auto clientNode = Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, filteredPrefab, Format("Client Node {}", i));
+        clientNode->GetComponent<BehaviorNetworkObject>()->SetOwner(sim.GetServerToClientConnection(clientScenes[i]));
+        clientNode->SetWorldPosition(position);
+
+        auto nearbyNode = Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, filteredPrefab, Format("Nearby Node {}", i));
+        nearbyNode->SetWorldPosition(position + Vector3{0.0f, 0.0f, 5.0f});
+    }
+    auto sharedNode = Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, unfilteredPrefab, "Shared Node");
+    sharedNode->SetWorldPosition(Vector3{0.0f, 1.0f, 0.0f});
+
+    sim.SimulateTime(8.0f);
+
+    // Expect each client to receive own objects and shared object only
+    for (unsigned i = 0; i < numClients; ++i)
+    {
+        Scene* clientScene = clientScenes[i];
+        const Vector3 position{i * 100.0f, 0.0f, 0.0f};
+
+        auto clientNode = clientScene->GetChild(Format("Client Node {}", i), true);
+        auto nearbyNode = clientScene->GetChild(Format("Nearby Node {}", i), true);
+        auto sharedNode = clientScene->GetChild("Shared Node", true);
+
+        REQUIRE(clientNode);
+        REQUIRE(nearbyNode);
+        REQUIRE(sharedNode);
+
+        REQUIRE(clientNode->GetWorldPosition() == position);
+        REQUIRE(nearbyNode->GetWorldPosition() == position + Vector3{0.0f, 0.0f, 5.0f});
+        REQUIRE(sharedNode->GetWorldPosition() == Vector3{0.0f, 1.0f, 0.0f});
+
+        for (unsigned j = 0; j < numClients; ++j)
+        {
+            if (i == j)
+                continue;
+
+            REQUIRE_FALSE(clientScene->GetChild(Format("Client Node {}", j), true));
+            REQUIRE_FALSE(clientScene->GetChild(Format("Nearby Node {}", j), true));
+        }
+    }
+
+    // Move shared object and expect all clients to receive update
+    serverScene->GetChild("Shared Node", true)->SetWorldPosition(Vector3{0.0f, 2.0f, 0.0f});
+    sim.SimulateTime(2.0f);
+
+    for (Scene* clientScene : clientScenes)
+        REQUIRE(clientScene->GetChild("Shared Node", true)->GetWorldPosition() == Vector3{0.0f, 2.0f, 0.0f});
+}
+
+TEST_CASE("ServerReplicator delivers all unreliable updates when budget is exceeded")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    context->GetSubsystem<Network>()->SetUpdateFps(Tests::NetworkSimulator::FramesInSecond);
+
+    auto prefab = Tests::GetOrCreateResource<XMLFile>(context, "@/ServerReplicator/UnfilteredTestPrefab.xml", CreateUnfilteredTestPrefab);
+
+    auto serverScene = MakeShared<Scene>(context);
+    auto clientScene = MakeShared<Scene>(context);
+
+    const auto quality = Tests::ConnectionQuality{ 0.08f, 0.12f, 0.20f, 0.0f, 0.0f };
+    Tests::NetworkSimulator sim(serverScene);
+    sim.AddClient(clientScene, quality);
+    sim.SimulateTime(5.0f);
+
+    // Spawn more objects than fit into one unreliable message
+    const unsigned numObjects = 400;
+    const auto getPosition = [](unsigned index, float offset) { return Vector3{index * 2.0f, offset, 0.0f}; };
+
+    auto clientNode = Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, prefab, "Client Node");
+    clientNode->GetComponent<BehaviorNetworkObject>()->SetOwner(sim.GetServerToClientConnection(clientScene));
+
+    ea::vector<Node*> serverNodes;
+    for (unsigned i = 0; i < numObjects; ++i)
+    {
+        auto node = Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, prefab, Format("Object Node {}", i));
+        node->SetWorldPosition(getPosition(i, 0.0f));
+        serverNodes.push_back(node);
+    }
+    sim.SimulateTime(2.0f);
+
+    // Move all objects once and expect updates to be deferred for longer than objects keep uploading them
+    for (unsigned i = 0; i < numObjects; ++i)
+        serverNodes[i]->SetWorldPosition(getPosition(i, 1.0f));
+    sim.SimulateTime(1.0f / Tests::NetworkSimulator::FramesInSecond);
+
+    ServerReplicator* serverReplicator = serverScene->GetComponent<ReplicationManager>()->GetServerReplicator();
+    AbstractConnection* serverToClientConnection = sim.GetServerToClientConnection(clientScene);
+    REQUIRE(serverReplicator->GetNumDeferredUnreliableUpdates(serverToClientConnection) > 0);
+
+    const unsigned numUploadFrames = serverNodes[0]->GetComponent<ReplicatedTransform>()->GetNumUploadAttempts();
+    sim.SimulateTime(static_cast<float>(numUploadFrames) / Tests::NetworkSimulator::FramesInSecond);
+    REQUIRE(serverReplicator->GetNumDeferredUnreliableUpdates(serverToClientConnection) > 0);
+
+    // Expect all objects to eventually receive latest position after they stopped
+    sim.SimulateTime(3.0f);
+    REQUIRE(serverReplicator->GetNumDeferredUnreliableUpdates(serverToClientConnection) == 0);
+    for (unsigned i = 0; i < numObjects; ++i)
+    {
+        Node* node = clientScene->GetChild(Format("Object Node {}", i), true);
+        REQUIRE(node);
+        REQUIRE(node->GetWorldPosition().Equals(serverNodes[i]->GetWorldPosition()));
+        REQUIRE(node->GetWorldPosition().Equals(getPosition(i, 1.0f)));
+    }
+}
+
+TEST_CASE("ServerReplicator streams large scenes starting from closest objects")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    context->GetSubsystem<Network>()->SetUpdateFps(Tests::NetworkSimulator::FramesInSecond);
+
+    auto prefab = Tests::GetOrCreateResource<XMLFile>(context, "@/ServerReplicator/UnfilteredTestPrefab.xml", CreateUnfilteredTestPrefab);
+
+    auto serverScene = MakeShared<Scene>(context);
+    auto clientScene = MakeShared<Scene>(context);
+
+    const auto quality = Tests::ConnectionQuality{ 0.08f, 0.12f, 0.20f, 0.0f, 0.0f };
+    Tests::NetworkSimulator sim(serverScene);
+    sim.AddClient(clientScene, quality);
+    sim.SimulateTime(5.0f);
+
+    // Spawn many more objects than can be added in one frame, furthest objects first
+    const unsigned maxAddedObjects = NetworkSettings::MaxAddedObjectsPerFrame.defaultValue_.GetUInt();
+    const unsigned numObjects = 2000;
+    const auto getDistance = [&](unsigned index) { return (numObjects - index) * 2.0f; };
+
+    auto clientNode = Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, prefab, "Client Node");
+    clientNode->GetComponent<BehaviorNetworkObject>()->SetOwner(sim.GetServerToClientConnection(clientScene));
+
+    for (unsigned i = 0; i < numObjects; ++i)
+    {
+        auto node = Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, prefab, Format("Object Node {}", i));
+        node->SetWorldPosition(Vector3{getDistance(i), 0.0f, 0.0f});
+    }
+    sim.SimulateTime(1.0f / Tests::NetworkSimulator::FramesInSecond);
+
+    ServerReplicator* serverReplicator = serverScene->GetComponent<ReplicationManager>()->GetServerReplicator();
+    REQUIRE(serverReplicator->GetNumPendingAddedObjects(sim.GetServerToClientConnection(clientScene)) == numObjects + 1 - maxAddedObjects);
+
+    // Expect client to receive only part of the scene, and every received object to be closer than any missing one
+    sim.SimulateTime(0.2f);
+
+    const ClientReplica& clientReplica = *clientScene->GetComponent<ReplicationManager>()->GetClientReplica();
+    REQUIRE_FALSE(clientReplica.IsStreamingComplete());
+    REQUIRE(clientReplica.GetNumPendingObjects() > 0);
+
+    unsigned numReceived = 0;
+    float maxReceivedDistance = 0.0f;
+    float minMissingDistance = M_LARGE_VALUE;
+    for (unsigned i = 0; i < numObjects; ++i)
+    {
+        if (clientScene->GetChild(Format("Object Node {}", i), true))
+        {
+            ++numReceived;
+            maxReceivedDistance = ea::max(maxReceivedDistance, getDistance(i));
+        }
+        else
+            minMissingDistance = ea::min(minMissingDistance, getDistance(i));
+    }
+    REQUIRE(numReceived > 0);
+    REQUIRE(numReceived < numObjects);
+    REQUIRE(maxReceivedDistance < minMissingDistance);
+
+    // Expect whole scene to be received eventually
+    sim.SimulateTime(2.0f);
+
+    REQUIRE(clientReplica.IsStreamingComplete());
+    REQUIRE(clientReplica.GetNumPendingObjects() == 0);
+    REQUIRE(serverReplicator->GetNumPendingAddedObjects(sim.GetServerToClientConnection(clientScene)) == 0);
+    for (unsigned i = 0; i < numObjects; ++i)
+        REQUIRE(clientScene->GetChild(Format("Object Node {}", i), true));
+}
+
+TEST_CASE("ServerReplicator streams distant parent before its closer children")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    context->GetSubsystem<Network>()->SetUpdateFps(Tests::NetworkSimulator::FramesInSecond);
+
+    auto prefab = Tests::GetOrCreateResource<XMLFile>(context, "@/ServerReplicator/UnfilteredTestPrefab.xml", CreateUnfilteredTestPrefab);
+
+    auto serverScene = MakeShared<Scene>(context);
+    auto clientScene = MakeShared<Scene>(context);
+
+    const auto quality = Tests::ConnectionQuality{ 0.08f, 0.12f, 0.20f, 0.0f, 0.0f };
+    Tests::NetworkSimulator sim(serverScene);
+    sim.AddClient(clientScene, quality);
+    sim.SimulateTime(5.0f);
+
+    // Spawn distant root with more close children than can be added in one frame, and some independent objects
+    const unsigned maxAddedObjects = NetworkSettings::MaxAddedObjectsPerFrame.defaultValue_.GetUInt();
+    const unsigned numChildren = maxAddedObjects * 2;
+    const unsigned numObjects = maxAddedObjects;
+
+    auto clientNode = Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, prefab, "Client Node");
+    clientNode->GetComponent<BehaviorNetworkObject>()->SetOwner(sim.GetServerToClientConnection(clientScene));
+
+    for (unsigned i = 0; i < numObjects; ++i)
+    {
+        auto node = Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, prefab, Format("Object Node {}", i));
+        node->SetWorldPosition(Vector3{10.0f + i, 0.0f, 0.0f});
+    }
+
+    auto rootNode = Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, prefab, "Root Node");
+    rootNode->SetWorldPosition(Vector3{1000.0f, 0.0f, 0.0f});
+    Node* parentNode = rootNode;
+    for (unsigned i = 0; i < numChildren; ++i)
+    {
+        // Make first half of the hierarchy deep and the rest wide
+        auto node = Tests::SpawnOnServer<BehaviorNetworkObject>(parentNode, prefab, Format("Child Node {}", i));
+        node->SetWorldPosition(Vector3{1.0f, 0.0f, static_cast<float>(i)});
+        if (i < numChildren / 2)
+            parentNode = node;
+    }
+    sim.SimulateTime(1.0f / Tests::NetworkSimulator::FramesInSecond);
+
+    // Expect root to be added in the first batch together with its children
+    ServerReplicator* serverReplicator = serverScene->GetComponent<ReplicationManager>()->GetServerReplicator();
+    REQUIRE(serverReplicator->GetNumPendingAddedObjects(sim.GetServerToClientConnection(clientScene))
+        == numObjects + numChildren + 2 - maxAddedObjects);
+
+    sim.SimulateTime(0.2f);
+    REQUIRE(clientScene->GetChild("Root Node", true));
+
+    // Expect whole scene to be received eventually
+    sim.SimulateTime(2.0f);
+
+    const ClientReplica& clientReplica = *clientScene->GetComponent<ReplicationManager>()->GetClientReplica();
+    REQUIRE(clientReplica.IsStreamingComplete());
+    REQUIRE(serverReplicator->GetNumPendingAddedObjects(sim.GetServerToClientConnection(clientScene)) == 0);
+    for (unsigned i = 0; i < numChildren; ++i)
+        REQUIRE(clientScene->GetChild(Format("Child Node {}", i), true));
+    for (unsigned i = 0; i < numObjects; ++i)
+        REQUIRE(clientScene->GetChild(Format("Object Node {}", i), true));
+}
+
+TEST_CASE("ServerReplicator benchmark", "[.benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    context->GetSubsystem<Network>()->SetUpdateFps(Tests::NetworkSimulator::FramesInSecond);
+
+    auto filteredPrefab = Tests::GetOrCreateResource<XMLFile>(context, "@/ServerReplicator/FilteredTestPrefab.xml", CreateFilteredTestPrefab);
+    auto unfilteredPrefab = Tests::GetOrCreateResource<XMLFile>(context, "@/ServerReplicator/UnfilteredTestPrefab.xml", CreateUnfilteredTestPrefab);
+
+    const unsigned numClients = 64;
+    const unsigned numObjects = 2048;
+
+    auto serverScene = MakeShared<Scene>(context);
+    ea::vector<SharedPtr<Scene>> clientScenes;
+    for (unsigned i = 0; i < numClients; ++i)
+        clientScenes.push_back(MakeShared<Scene>(context));
+
+    const auto quality = Tests::ConnectionQuality{ 0.08f, 0.12f, 0.20f, 0.0f, 0.0f };
+    Tests::NetworkSimulator sim(serverScene);
+    for (Scene* clientScene : clientScenes)
+        sim.AddClient(clientScene, quality);
+    sim.SimulateTime(5.0f);
+
+    for (unsigned i = 0; i < numClients; ++i)
+    {
+        auto clientNode = Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, unfilteredPrefab, Format("Client Node {}", i));
+        clientNode->GetComponent<BehaviorNetworkObject>()->SetOwner(sim.GetServerToClientConnection(clientScenes[i]));
+        clientNode->SetWorldPosition(Vector3{i * 4.0f, 0.0f, 0.0f});
+    }
+
+    ea::vector<Node*> objectNodes;
+    for (unsigned i = 0; i < numObjects; ++i)
+    {
+        auto node = Tests::SpawnOnServer<BehaviorNetworkObject>(serverScene, filteredPrefab, Format("Object Node {}", i));
+        node->SetWorldPosition(Vector3{(i % numClients) * 4.0f, 0.0f, (i / numClients) * 1.0f});
+        objectNodes.push_back(node);
+    }
+
+    sim.SimulateTime(2.0f);
+
+    const float frameTime = 1.0f / Tests::NetworkSimulator::FramesInSecond;
+    unsigned frameIndex = 0;
+    BENCHMARK(Format("Replicate {} objects to {} clients", numObjects, numClients).c_str())
+    {
+        ++frameIndex;
+        for (unsigned i = 0; i < numObjects; i += 4)
+            objectNodes[i]->Translate(Vector3{0.0f, 0.01f * (frameIndex % 2 ? 1.0f : -1.0f), 0.0f});
+        sim.SimulateTime(frameTime);
+        return frameIndex;
+    };
+}
@@ -24,6 +24,7 @@
 #include "../ModelUtils.h"
 #include "../SceneUtils.h"
 
+#include <Urho3D/Core/WorkQueue.h>
 #include <Urho3D/Graphics/AnimatedModel.h>
 #include <Urho3D/Graphics/AnimationController.h>
 #include <Urho3D/Graphics/Camera.h>
@@ -34,6 +35,23 @@
 namespace
 {
 
+/// AnimationController that counts its updates.
+class TestAnimationController : public AnimationController
+{
+    URHO3D_OBJECT(TestAnimationController, AnimationController);
+
+public:
+    using AnimationController::AnimationController;
+
+    void Update(float timeStep) override
+    {
+        AnimationController::Update(timeStep);
+        ++numUpdates_;
+    }
+
+    unsigned numUpdates_{};
+};
+
 SharedPtr<Model> CreateTestSkinnedModel(Context* context)
 {
     return Tests::CreateSkinnedQuad_Model(context)->ExportModel();
@@ -517,6 +535,407 @@ TEST_CASE("Animation is filtered when start bone is specified")
     }
 }
 
+TEST_CASE("AnimatedModel is animated without bone nodes")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    auto model = Tests::GetOrCreateResource<Model>(context, "@Tests/AnimationController/SkinnedModel.mdl", CreateTestSkinnedModel);
+    auto animationRotate = Tests::GetOrCreateResource<Animation>(context, "@Tests/AnimationController/Rotation.ani", CreateTestRotationAnimation);
+    auto animationTranslateXZ = Tests::GetOrCreateResource<Animation>(context, "@Tests/AnimationController/TranslateXZ.ani", CreateTestTranslateXZAnimation);
+
+    const auto createScene = [&](bool createBoneNodes, bool switchAfterModel)
+    {
+        auto scene = MakeShared<Scene>(context);
+        scene->CreateComponent<Octree>();
+
+        auto node = scene->CreateChild("Node");
+        auto animatedModel = node->CreateComponent<AnimatedModel>();
+        if (!switchAfterModel)
+            animatedModel->SetCreateBoneNodes(createBoneNodes);
+        animatedModel->SetModel(model);
+        if (switchAfterModel)
+            animatedModel->SetCreateBoneNodes(createBoneNodes);
+
+        auto animationController = node->CreateComponent<AnimationController>();
+        animationController->PlayNew(AnimationParameters{animationRotate}.Looped());
+        animationController->PlayNew(AnimationParameters{animationTranslateXZ}.Looped().Layer(1).StartBone("Quad 2"));
+        return scene;
+    };
+
+    // Setup
+    auto referenceScene = createScene(true, false);
+    auto nodeFreeScene = createScene(false, false);
+    auto switchedScene = createScene(false, true);
+
+    Tests::ComponentRef<AnimatedModel> referenceModel{referenceScene, "Node"};
+    Tests::ComponentRef<AnimatedModel> nodeFreeModel{nodeFreeScene, "Node"};
+    Tests::ComponentRef<AnimatedModel> switchedModel{switchedScene, "Node"};
+    Tests::NodeRef referenceQuad2{referenceScene, "Quad 2"};
+
+    REQUIRE_FALSE(nodeFreeModel->GetCreateBoneNodes());
+    REQUIRE(nodeFreeModel->GetNode()->GetNumChildren() == 0);
+    REQUIRE(switchedModel->GetNode()->GetNumChildren() == 0);
+
+    const auto compareBones = [&](AnimatedModel* animatedModel)
+    {
+        const unsigned numBones = referenceModel->GetSkeleton().GetNumBones();
+        REQUIRE(animatedModel->GetSkeleton().GetNumBones() == numBones);
+        for (unsigned i = 0; i < numBones; ++i)
+        {
+            const Matrix3x4 expected = referenceModel->GetBoneWorldTransform(i);
+            REQUIRE(animatedModel->GetBoneWorldTransform(i).Equals(expected, M_LARGE_EPSILON));
+        }
+    };
+
+    // Assert
+    for (unsigned frame = 0; frame < 5; ++frame)
+    {
+        Tests::RunFrame(context, 0.3f, 0.1f);
+        compareBones(*nodeFreeModel);
+        compareBones(*switchedModel);
+    }
+    REQUIRE(nodeFreeModel->GetNode()->GetNumChildren() == 0);
+
+    // Exposed bone node follows the pose
+    Node* exposedQuad2 = nodeFreeModel->ExposeBoneNode("Quad 2");
+    REQUIRE(exposedQuad2);
+    REQUIRE(exposedQuad2->GetParent() == nodeFreeModel->GetNode());
+    REQUIRE(exposedQuad2->GetWorldPosition().Equals(referenceQuad2->GetWorldPosition(), M_LARGE_EPSILON));
+    REQUIRE(nodeFreeModel->ExposeBoneNode("Quad 2") == exposedQuad2);
+
+    Tests::RunFrame(context, 0.3f, 0.1f);
+    compareBones(*nodeFreeModel);
+    REQUIRE(exposedQuad2->GetWorldPosition().Equals(referenceQuad2->GetWorldPosition(), M_LARGE_EPSILON));
+
+    // Mode and exposed nodes survive serialization
+    Tests::SerializeAndDeserializeScene(referenceScene);
+    Tests::SerializeAndDeserializeScene(nodeFreeScene);
+    REQUIRE_FALSE(nodeFreeModel->GetCreateBoneNodes());
+    REQUIRE(nodeFreeModel->GetNode()->GetNumChildren() == 1);
+
+    Tests::NodeRef nodeFreeQuad2{nodeFreeScene, "Quad 2"};
+    for (unsigned frame = 0; frame < 3; ++frame)
+    {
+        Tests::RunFrame(context, 0.3f, 0.1f);
+        compareBones(*nodeFreeModel);
+        REQUIRE(nodeFreeQuad2->GetWorldPosition().Equals(referenceQuad2->GetWorldPosition(), M_LARGE_EPSILON));
+    }
+
+    // Unrelated child node named like a bone is neither driven nor removed by the model
+    Node* userNode = nodeFreeModel->GetNode()->CreateChild("Quad 1");
+    userNode->SetPosition(Vector3::ONE);
+    Tests::RunFrame(context, 0.3f, 0.1f);
+    REQUIRE(userNode->GetPosition().Equals(Vector3::ONE));
+
+    WeakPtr<Node> userNodeWeak{userNode};
+    WeakPtr<Node> exposedNodeWeak{nodeFreeQuad2.GetNode()};
+    nodeFreeModel->SetCreateBoneNodes(true);
+    REQUIRE(userNodeWeak);
+    REQUIRE(userNodeWeak->GetPosition().Equals(Vector3::ONE));
+    REQUIRE(exposedNodeWeak.Expired());
+
+    // Switching back recreates all bone nodes
+    switchedModel->SetCreateBoneNodes(true);
+    REQUIRE(switchedModel->GetSkeleton().GetBone("Quad 2")->node_);
+    Tests::RunFrame(context, 0.3f, 0.1f);
+    compareBones(*switchedModel);
+}
+
+TEST_CASE("AnimatedModel update benchmark", "[.benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    auto model = Tests::GetOrCreateResource<Model>(context, "@Tests/AnimationController/SkinnedModel.mdl", CreateTestSkinnedModel);
+    auto animation = Tests::GetOrCreateResource<Animation>(context, "@Tests/AnimationController/Rotation.ani", CreateTestRotationAnimation);
+
+    const auto createScene = [&](bool createBoneNodes)
+    {
+        auto scene = MakeShared<Scene>(context);
+        scene->CreateComponent<Octree>();
+        for (unsigned i = 0; i < 2000; ++i)
+        {
+            auto node = scene->CreateChild();
+            node->SetPosition(Vector3{static_cast<float>(i % 50), 0.0f, static_cast<float>(i / 50)});
+            auto animatedModel = node->CreateComponent<AnimatedModel>();
+            animatedModel->SetCreateBoneNodes(createBoneNodes);
+            animatedModel->SetModel(model);
+            auto animationController = node->CreateComponent<AnimationController>();
+            animationController->PlayNew(AnimationParameters{animation}.Looped());
+        }
+        return scene;
+    };
+
+    const auto updateScene = [](Scene* scene)
+    {
+        // Update the Octree directly to skip frame rate limiting of the Engine
+        FrameInfo frameInfo;
+        frameInfo.timeStep_ = 1.0f / 60.0f;
+        scene->Update(frameInfo.timeStep_);
+        scene->GetComponent<Octree>()->Update(frameInfo);
+        return scene->GetElapsedTime();
+    };
+
+    auto sceneWithBoneNodes = createScene(true);
+    BENCHMARK("Update 2000 AnimatedModels with bone nodes")
+    {
+        return updateScene(sceneWithBoneNodes);
+    };
+    sceneWithBoneNodes = nullptr;
+
+    auto sceneWithoutBoneNodes = createScene(false);
+    BENCHMARK("Update 2000 AnimatedModels without bone nodes")
+    {
+        return updateScene(sceneWithoutBoneNodes);
+    };
+}
+
+TEST_CASE("AnimationController-s are updated by Octree in batch")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    auto model = Tests::GetOrCreateResource<Model>(context, "@Tests/AnimationController/SkinnedModel.mdl", CreateTestSkinnedModel);
+    auto animationTranslateX = Tests::GetOrCreateResource<Animation>(context, "@Tests/AnimationController/TranslateX.ani", CreateTestTranslateXAnimation);
+
+    // Create enough controllers to update them in parallel, some of them before the Octree
+    const unsigned numNodes = Octree::MinAnimationControllersForParallelUpdate * 2;
+    auto scene = MakeShared<Scene>(context);
+
+    ea::vector<Node*> nodes;
+    ea::vector<AnimationController*> controllers;
+    const auto createNode = [&]()
+    {
+        Node* node = scene->CreateChild("Node");
+        nodes.push_back(node);
+
+        auto animatedModel = node->CreateComponent<AnimatedModel>();
+        animatedModel->SetModel(model);
+
+        auto controller = node->CreateComponent<AnimationController>();
+        controller->PlayNew(AnimationParameters{animationTranslateX}.Looped());
+        controllers.push_back(controller);
+    };
+
+    for (unsigned i = 0; i < numNodes / 2; ++i)
+        createNode();
+    auto octree = scene->CreateComponent<Octree>();
+    for (unsigned i = numNodes / 2; i < numNodes; ++i)
+        createNode();
+
+    REQUIRE(octree->GetNumAnimationControllers() == numNodes);
+
+    // Disabled and removed controllers are not updated
+    controllers[0]->SetEnabled(false);
+    nodes[1]->Remove();
+    REQUIRE(octree->GetNumAnimationControllers() == numNodes - 2);
+
+    Tests::RunFrame(context, 0.25f, 0.25f);
+    REQUIRE(controllers[0]->GetAnimationParameters(0).time_.Value() == 0.0f);
+    for (unsigned i = 2; i < numNodes; ++i)
+        REQUIRE(controllers[i]->GetAnimationParameters(0).time_.Value() == 0.25f);
+
+    // Controllers are updated individually without the Octree
+    octree->Remove();
+    Tests::RunFrame(context, 0.25f, 0.25f);
+    REQUIRE(controllers[0]->GetAnimationParameters(0).time_.Value() == 0.0f);
+    for (unsigned i = 2; i < numNodes; ++i)
+        REQUIRE(controllers[i]->GetAnimationParameters(0).time_.Value() == 0.5f);
+}
+
+TEST_CASE("AnimationController with overridden Update is not updated by Octree in batch")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    if (!context->IsReflected<TestAnimationController>())
+    {
+        context->RegisterFactory<TestAnimationController>();
+        context->Reflect<TestAnimationController>()->CopyAttributesFrom(context->GetReflection<AnimationController>());
+    }
+
+    auto model = Tests::GetOrCreateResource<Model>(context, "@Tests/AnimationController/SkinnedModel.mdl", CreateTestSkinnedModel);
+    auto animationTranslateX = Tests::GetOrCreateResource<Animation>(context, "@Tests/AnimationController/TranslateX.ani", CreateTestTranslateXAnimation);
+
+    auto scene = MakeShared<Scene>(context);
+    auto octree = scene->CreateComponent<Octree>();
+
+    Node* node = scene->CreateChild("Node");
+    node->CreateComponent<AnimatedModel>()->SetModel(model);
+    auto controller = node->CreateComponent<TestAnimationController>();
+    controller->PlayNew(AnimationParameters{animationTranslateX}.Looped());
+
+    REQUIRE_FALSE(controller->IsBatchUpdateSupported());
+    REQUIRE(octree->GetNumAnimationControllers() == 0);
+
+    Tests::RunFrame(context, 0.25f, 0.25f);
+    REQUIRE(controller->numUpdates_ == 1);
+    REQUIRE(controller->GetAnimationParameters(0).time_.Value() == 0.25f);
+}
+
+TEST_CASE("AnimatedModel removed after parallel AnimationController update is not updated by Octree")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    context->GetSubsystem<WorkQueue>()->CreateThreads(3);
+
+    auto model = Tests::GetOrCreateResource<Model>(context, "@Tests/AnimationController/SkinnedModel.mdl", CreateTestSkinnedModel);
+    auto animationTranslateX = Tests::GetOrCreateResource<Animation>(context, "@Tests/AnimationController/TranslateX.ani", CreateTestTranslateXAnimation);
+
+    const unsigned numNodes = Octree::MinAnimationControllersForParallelUpdate * 2;
+    auto scene = MakeShared<Scene>(context);
+    auto octree = scene->CreateComponent<Octree>();
+
+    ea::vector<WeakPtr<Node>> nodes;
+    for (unsigned i = 0; i < numNodes; ++i)
+    {
+        Node* node = scene->CreateChild("Node");
+        nodes.emplace_back(node);
+
+        auto animatedModel = node->CreateComponent<AnimatedModel>();
+        animatedModel->SetModel(model);
+
+        auto controller = node->CreateComponent<AnimationController>();
+        controller->PlayNew(AnimationParameters{animationTranslateX}.Looped());
+    }
+    REQUIRE(octree->GetNumAnimationControllers() == numNodes);
+
+    FrameInfo frameInfo;
+    frameInfo.timeStep_ = 0.1f;
+    for (unsigned frame = 0; frame < 3; ++frame)
+    {
+        // Scene update marks AnimatedModel-s dirty from worker threads
+        scene->Update(frameInfo.timeStep_);
+
+        // Remove some models between scene post-update and Octree update
+        nodes[frame * 2]->Remove();
+        nodes[frame * 2 + 1]->RemoveComponent<AnimatedModel>();
+        REQUIRE(nodes[frame * 2] == nullptr);
+
+        octree->Update(frameInfo);
+    }
+
+    REQUIRE(octree->GetNumAnimationControllers() == numNodes - 3);
+}
+
+TEST_CASE("Animation LOD reduces animated bones of distant AnimatedModel")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    auto model = Tests::GetOrCreateResource<Model>(context, "@Tests/AnimationController/SkinnedModel.mdl", CreateTestSkinnedModel);
+    auto animationTranslateX = Tests::GetOrCreateResource<Animation>(context, "@Tests/AnimationController/TranslateX.ani", CreateTestTranslateXAnimation);
+
+    auto scene = MakeShared<Scene>(context);
+    scene->CreateComponent<Octree>();
+
+    auto cameraNode = scene->CreateChild("Camera");
+    cameraNode->SetPosition({0.0f, 0.0f, -100.0f});
+    auto camera = cameraNode->CreateComponent<Camera>();
+
+    auto node = scene->CreateChild("Node");
+    auto animatedModel = node->CreateComponent<AnimatedModel>();
+    animatedModel->SetModel(model);
+    auto animationController = node->CreateComponent<AnimationController>();
+    animationController->PlayNew(AnimationParameters{animationTranslateX}.Looped());
+
+    REQUIRE(animatedModel->GetSkeleton().GetBone("Root")->depth_ == 0);
+    REQUIRE(animatedModel->GetSkeleton().GetBone("Quad 1")->depth_ == 1);
+    REQUIRE(animatedModel->GetSkeleton().GetBone("Quad 2")->depth_ == 2);
+
+    // Simulate model being rendered from the distance
+    FrameInfo frameInfo;
+    frameInfo.camera_ = camera;
+    frameInfo.frameNumber_ = 1;
+    animatedModel->UpdateBatches(frameInfo);
+    REQUIRE(animatedModel->GetEffectiveAnimationLodDistance() > 0.0f);
+    REQUIRE(animatedModel->GetAnimationLodMaxBoneDepth() == M_MAX_UNSIGNED);
+
+    // Importance reduces LOD distance
+    const float lodDistance = animatedModel->GetEffectiveAnimationLodDistance();
+    animatedModel->SetAnimationImportance(2.0f);
+    REQUIRE(Equals(animatedModel->GetEffectiveAnimationLodDistance(), lodDistance * 0.5f));
+    animatedModel->SetAnimationImportance(1.0f);
+
+    animatedModel->SetReducedBonesLodDistance(lodDistance * 0.5f);
+    animatedModel->SetReducedBonesMaxDepth(1);
+    REQUIRE(animatedModel->GetAnimationLodMaxBoneDepth() == 1);
+
+    // Bone deeper than allowed is not animated
+    Tests::RunFrame(context, 0.5f, 0.5f);
+    REQUIRE(node->GetChild("Quad 2", true)->GetPosition().Equals({0.0f, 1.0f, 0.0f}));
+}
+
+TEST_CASE("Animation LOD is scaled to fit animation bone budget")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    auto model = Tests::GetOrCreateResource<Model>(context, "@Tests/AnimationController/SkinnedModel.mdl", CreateTestSkinnedModel);
+    auto animationTranslateX = Tests::GetOrCreateResource<Animation>(context, "@Tests/AnimationController/TranslateX.ani", CreateTestTranslateXAnimation);
+
+    auto scene = MakeShared<Scene>(context);
+    auto octree = scene->CreateComponent<Octree>();
+    for (unsigned i = 0; i < 10; ++i)
+    {
+        auto node = scene->CreateChild("Node");
+        auto animatedModel = node->CreateComponent<AnimatedModel>();
+        animatedModel->SetModel(model);
+        auto animationController = node->CreateComponent<AnimationController>();
+        animationController->PlayNew(AnimationParameters{animationTranslateX}.Looped());
+    }
+
+    // Without budget the scale is not changed
+    Tests::RunFrame(context, 0.1f, 0.01f);
+    REQUIRE(octree->GetAverageEvaluatedAnimationBones() > 0.0f);
+    REQUIRE(octree->GetAnimationLodScale() == 1.0f);
+
+    // Scale grows while over budget
+    octree->SetAnimationBoneBudget(1);
+    Tests::RunFrame(context, 0.1f, 0.01f);
+    REQUIRE(octree->GetAnimationLodScale() > 1.0f);
+
+    octree->SetAnimationBoneBudget(0);
+    REQUIRE(octree->GetAnimationLodScale() == 1.0f);
+}
+
+TEST_CASE("AnimationController batch update benchmark", "[.benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    auto model = Tests::GetOrCreateResource<Model>(context, "@Tests/AnimationController/SkinnedModel.mdl", CreateTestSkinnedModel);
+    auto animation = Tests::GetOrCreateResource<Animation>(context, "@Tests/AnimationController/Rotation.ani", CreateTestRotationAnimation);
+
+    const auto createScene = [&](unsigned numModels)
+    {
+        auto scene = MakeShared<Scene>(context);
+        scene->CreateComponent<Octree>();
+        for (unsigned i = 0; i < numModels; ++i)
+        {
+            auto node = scene->CreateChild();
+            node->SetPosition(Vector3{static_cast<float>(i % 100), 0.0f, static_cast<float>(i / 100)});
+            auto animatedModel = node->CreateComponent<AnimatedModel>();
+            animatedModel->SetCreateBoneNodes(false);
+            animatedModel->SetModel(model);
+            auto animationController = node->CreateComponent<AnimationController>();
+            animationController->PlayNew(AnimationParameters{animation}.Looped());
+        }
+        return scene;
+    };
+
+    const auto updateScene = [](Scene* scene)
+    {
+        // Update the Octree directly to skip frame rate limiting of the Engine
+        FrameInfo frameInfo;
+        frameInfo.timeStep_ = 1.0f / 60.0f;
+        scene->Update(frameInfo.timeStep_);
+        scene->GetComponent<Octree>()->Update(frameInfo);
+        return scene->GetElapsedTime();
+    };
+
+    for (unsigned numModels : {500u, 2000u, 10000u})
+    {
+        auto scene = createScene(numModels);
+        BENCHMARK(Format("Update {} animated characters", numModels).c_str())
+        {
+            return updateScene(scene);
+        };
+    }
+}
+
 TEST_CASE("VariantCurve is sample with looping and without it")
 {
     VariantCurve curve;
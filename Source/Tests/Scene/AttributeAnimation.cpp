@@ -0,0 +1,189 @@
+//
+// Copyright (c) 2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Graphics/Light.h>
+#include <Urho3D/Scene/Scene.h>
+#include <Urho3D/Scene/ValueAnimation.h>
+
+namespace
+{
+
+SharedPtr<ValueAnimation> CreateTestAnimation(Context* context, InterpMethod method, const ea::vector<Variant>& keyFrames)
+{
+    auto animation = MakeShared<ValueAnimation>(context);
+    animation->SetInterpolationMethod(method);
+    for (unsigned i = 0; i < keyFrames.size(); ++i)
+        animation->SetKeyFrame(i * 0.5f + (i % 2) * 0.25f, keyFrames[i]);
+    return animation;
+}
+
+template <class T> void CheckSampledValues(ValueAnimation* animation)
+{
+    for (float time = -0.5f; time < animation->GetEndTime() + 0.5f; time += 0.0625f)
+    {
+        const Variant expected = animation->GetAnimationValue(time);
+        const Variant actual = animation->SampleValue<T>(time);
+        if constexpr (ea::is_same_v<T, IntRect> || ea::is_same_v<T, IntVector2> || ea::is_same_v<T, IntVector3>)
+            REQUIRE(actual == expected);
+        else if constexpr (ea::is_same_v<T, float> || ea::is_same_v<T, double>)
+            REQUIRE(actual.Get<T>() == Catch::Approx(expected.Get<T>()).margin(M_LARGE_EPSILON));
+        else
+            REQUIRE(actual.Get<T>().Equals(expected.Get<T>(), M_LARGE_EPSILON));
+    }
+}
+
+/// Light that tracks attribute writes.
+class TestAttributeLight : public Light
+{
+    URHO3D_OBJECT(TestAttributeLight, Light);
+
+public:
+    using Light::Light;
+
+    static void RegisterObject(Context* context)
+    {
+        context->RegisterFactory<TestAttributeLight>();
+        URHO3D_COPY_BASE_ATTRIBUTES(Light);
+    }
+
+    void OnSetAttribute(const AttributeInfo& attr, const Variant& src) override
+    {
+        Light::OnSetAttribute(attr, src);
+        ++numSetAttributes_;
+    }
+
+    unsigned numSetAttributes_{};
+};
+
+}
+
+TEST_CASE("Value animation is sampled without Variant")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    for (InterpMethod method : {IM_NONE, IM_LINEAR, IM_SPLINE})
+    {
+        CheckSampledValues<float>(CreateTestAnimation(context, method, {1.0f, 3.0f, -2.0f, 0.5f, 1.0f}));
+        CheckSampledValues<double>(CreateTestAnimation(context, method, {1.0, 3.0, -2.0, 0.5}));
+        CheckSampledValues<Vector2>(CreateTestAnimation(context, method, {Vector2::ONE, Vector2::UP, Vector2{3.0f, -1.0f}, Vector2::ONE}));
+        CheckSampledValues<Vector3>(CreateTestAnimation(context, method, {Vector3::ZERO, Vector3::UP, Vector3::LEFT, Vector3{1.0f, 2.0f, 3.0f}}));
+        CheckSampledValues<Vector4>(CreateTestAnimation(context, method, {Vector4::ZERO, Vector4::ONE, Vector4{1.0f, -2.0f, 3.0f, 0.0f}}));
+        CheckSampledValues<Quaternion>(CreateTestAnimation(context, method,
+            {Quaternion::IDENTITY, Quaternion{90.0f, Vector3::UP}, Quaternion{30.0f, 60.0f, 0.0f}, Quaternion::IDENTITY}));
+        CheckSampledValues<Color>(CreateTestAnimation(context, method, {Color::RED, Color::GREEN, Color::BLUE, Color::WHITE}));
+        CheckSampledValues<IntRect>(CreateTestAnimation(context, method, {IntRect{0, 0, 10, 10}, IntRect{5, -5, 20, 7}, IntRect::ZERO}));
+        CheckSampledValues<IntVector2>(CreateTestAnimation(context, method, {IntVector2{0, 10}, IntVector2{7, -3}, IntVector2::ONE}));
+        CheckSampledValues<IntVector3>(CreateTestAnimation(context, method, {IntVector3{0, 10, 3}, IntVector3{7, -3, 1}}));
+    }
+}
+
+TEST_CASE("Attribute animations are updated by the scene in batch")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    auto positionAnimation = CreateTestAnimation(context, IM_SPLINE,
+        {Vector3::ZERO, Vector3{1.0f, 2.0f, 0.0f}, Vector3{-1.0f, 0.0f, 3.0f}, Vector3::ZERO});
+    auto colorAnimation = CreateTestAnimation(context, IM_LINEAR, {Color::RED, Color::BLUE});
+    auto brightnessAnimation = CreateTestAnimation(context, IM_LINEAR, {1.0f, 2.0f});
+
+    auto scene = MakeShared<Scene>(context);
+    Node* node = scene->CreateChild("Node");
+    node->SetAttributeAnimation("Position", positionAnimation, WM_LOOP);
+    auto light = node->CreateComponent<Light>();
+    light->SetAttributeAnimation("Color", colorAnimation, WM_CLAMP);
+    light->SetAttributeAnimation("Brightness Multiplier", brightnessAnimation, WM_ONCE);
+
+    Node* removedNode = scene->CreateChild("Removed Node");
+    removedNode->SetAttributeAnimation("Position", positionAnimation);
+    REQUIRE(scene->GetNumAttributeAnimationTargets() == 3);
+
+    removedNode->Remove();
+    REQUIRE(scene->GetNumAttributeAnimationTargets() == 2);
+
+    float time = 0.0f;
+    for (unsigned i = 0; i < 10; ++i)
+    {
+        scene->Update(0.1f);
+        time += 0.1f;
+
+        REQUIRE(node->GetPosition().Equals(positionAnimation->GetAnimationValue(time).GetVector3(), M_LARGE_EPSILON));
+        REQUIRE(light->GetColor().Equals(colorAnimation->GetAnimationValue(Min(time, colorAnimation->GetEndTime())).GetColor(), M_LARGE_EPSILON));
+    }
+
+    // Animation played once is removed when finished
+    CHECK(light->GetBrightness() == 2.0f);
+    CHECK(light->GetAttributeAnimation("Brightness Multiplier") == nullptr);
+    CHECK(light->GetAttributeAnimation("Color") == colorAnimation);
+
+    node->SetAttributeAnimation("Position", nullptr);
+    light->Remove();
+    scene->Update(0.1f);
+    CHECK(scene->GetNumAttributeAnimationTargets() == 0);
+}
+
+TEST_CASE("Attribute animations call OnSetAttribute of derived types")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    if (!context->IsReflected<TestAttributeLight>())
+        TestAttributeLight::RegisterObject(context);
+
+    auto brightnessAnimation = CreateTestAnimation(context, IM_LINEAR, {1.0f, 2.0f});
+
+    auto scene = MakeShared<Scene>(context);
+    auto light = scene->CreateChild("Node")->CreateComponent<TestAttributeLight>();
+    REQUIRE_FALSE(light->SupportsNativeAttributeAnimation());
+    REQUIRE(MakeShared<Light>(context)->SupportsNativeAttributeAnimation());
+
+    light->SetAttributeAnimation("Brightness Multiplier", brightnessAnimation, WM_CLAMP);
+    for (unsigned i = 0; i < 5; ++i)
+        scene->Update(0.1f);
+
+    CHECK(light->numSetAttributes_ == 5);
+    CHECK(light->GetBrightness() == Catch::Approx(brightnessAnimation->GetAnimationValue(0.5f).GetFloat()));
+}
+
+TEST_CASE("Attribute animation benchmark", "[.benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+
+    auto positionAnimation = CreateTestAnimation(context, IM_SPLINE,
+        {Vector3::ZERO, Vector3{1.0f, 2.0f, 0.0f}, Vector3{-1.0f, 0.0f, 3.0f}, Vector3{2.0f, 0.0f, 1.0f}, Vector3::ZERO});
+    auto rotationAnimation = CreateTestAnimation(context, IM_LINEAR,
+        {Quaternion::IDENTITY, Quaternion{90.0f, Vector3::UP}, Quaternion{180.0f, Vector3::UP}});
+
+    auto scene = MakeShared<Scene>(context);
+    for (unsigned i = 0; i < 10000; ++i)
+    {
+        Node* node = scene->CreateChild();
+        node->SetAttributeAnimation("Position", positionAnimation);
+        node->SetAttributeAnimation("Rotation", rotationAnimation);
+    }
+
+    BENCHMARK("Update 20000 attribute animations")
+    {
+        scene->Update(0.01f);
+        return scene->GetNumAttributeAnimationTargets();
+    };
+}
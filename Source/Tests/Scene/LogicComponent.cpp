@@ -0,0 +1,276 @@
+//
+// Copyright (c) 2021-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../CommonUtils.h"
+
+#include <Urho3D/Scene/LogicComponent.h>
+#ifdef URHO3D_PHYSICS
+#include <Urho3D/Physics/PhysicsWorld.h>
+#endif
+
+#include <atomic>
+
+namespace
+{
+
+/// Logic component that records its updates.
+class TestLogicComponent : public LogicComponent
+{
+    URHO3D_OBJECT(TestLogicComponent, LogicComponent);
+
+public:
+    using LogicComponent::LogicComponent;
+
+    void DelayedStart() override { ++numDelayedStarts_; }
+    void Update(float timeStep) override
+    {
+        ++numUpdates_;
+        if (updateLog_)
+            updateLog_->push_back(this);
+        if (componentToRemove_)
+        {
+            // Component may remove itself, don't touch members after that
+            WeakPtr<Component> componentToRemove = componentToRemove_;
+            componentToRemove_ = nullptr;
+            componentToRemove->Remove();
+        }
+    }
+    void PostUpdate(float timeStep) override { ++numPostUpdates_; }
+    void FixedUpdate(float timeStep) override { ++numFixedUpdates_; }
+    void FixedPostUpdate(float timeStep) override { ++numFixedPostUpdates_; }
+
+    unsigned numDelayedStarts_{};
+    unsigned numUpdates_{};
+    unsigned numPostUpdates_{};
+    unsigned numFixedUpdates_{};
+    unsigned numFixedPostUpdates_{};
+
+    ea::vector<LogicComponent*>* updateLog_{};
+    WeakPtr<Component> componentToRemove_;
+};
+
+/// Logic component that is safe to update in parallel.
+class TestThreadSafeLogicComponent : public LogicComponent
+{
+    URHO3D_OBJECT(TestThreadSafeLogicComponent, LogicComponent);
+
+public:
+    using LogicComponent::LogicComponent;
+
+    bool IsThreadSafeUpdate() const override { return true; }
+
+    void DelayedStart() override { ++numDelayedStarts_; }
+    void Update(float timeStep) override
+    {
+        node_->Translate(Vector3::UP * timeStep);
+        ++numUpdates_;
+        ++totalUpdates_;
+    }
+
+    unsigned numDelayedStarts_{};
+    unsigned numUpdates_{};
+
+    static std::atomic<unsigned> totalUpdates_;
+};
+
+std::atomic<unsigned> TestThreadSafeLogicComponent::totalUpdates_{};
+
+void RegisterTestComponents(Context* context)
+{
+    if (!context->IsReflected<TestLogicComponent>())
+        context->RegisterFactory<TestLogicComponent>();
+    if (!context->IsReflected<TestThreadSafeLogicComponent>())
+        context->RegisterFactory<TestThreadSafeLogicComponent>();
+}
+
+}
+
+TEST_CASE("Logic components are updated by the scene")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    RegisterTestComponents(context);
+
+    auto scene = MakeShared<Scene>(context);
+#ifdef URHO3D_PHYSICS
+    scene->CreateComponent<PhysicsWorld>();
+#endif
+    LogicComponentScheduler& scheduler = scene->GetLogicComponentScheduler();
+
+    SharedPtr<TestLogicComponent> component1{scene->CreateChild("Node 1")->CreateComponent<TestLogicComponent>()};
+    SharedPtr<TestLogicComponent> component2{scene->CreateChild("Node 2")->CreateComponent<TestLogicComponent>()};
+    SharedPtr<TestLogicComponent> component3{scene->CreateChild("Node 3")->CreateComponent<TestLogicComponent>()};
+    component3->SetUpdateEventMask(USE_NO_EVENT);
+
+    REQUIRE(scheduler.GetNumComponents(LogicUpdateStage::Update) == 3);
+    REQUIRE(scheduler.GetNumComponents(LogicUpdateStage::PostUpdate) == 2);
+
+    // Delayed start is called once, components without update events are removed after it
+    scene->Update(1.0f / 60.0f);
+    scene->Update(1.0f / 60.0f);
+
+    REQUIRE(component1->numDelayedStarts_ == 1);
+    REQUIRE(component1->numUpdates_ == 2);
+    REQUIRE(component1->numPostUpdates_ == 2);
+    REQUIRE(component3->numDelayedStarts_ == 1);
+    REQUIRE(component3->numUpdates_ == 0);
+    REQUIRE(component3->numPostUpdates_ == 0);
+    REQUIRE(scheduler.GetNumComponents(LogicUpdateStage::Update) == 2);
+
+#ifdef URHO3D_PHYSICS
+    REQUIRE(component1->numFixedUpdates_ > 0);
+    REQUIRE(component1->numFixedUpdates_ == component1->numFixedPostUpdates_);
+    REQUIRE(component3->numFixedUpdates_ == 0);
+#endif
+
+    // Disabled components are not updated
+    component2->SetEnabled(false);
+    scene->Update(1.0f / 60.0f);
+
+    REQUIRE(component1->numUpdates_ == 3);
+    REQUIRE(component2->numUpdates_ == 2);
+    REQUIRE(scheduler.GetNumComponents(LogicUpdateStage::Update) == 1);
+
+    component2->SetEnabled(true);
+    scene->Update(1.0f / 60.0f);
+
+    REQUIRE(component1->numUpdates_ == 4);
+    REQUIRE(component2->numUpdates_ == 3);
+
+    // Removed components are not updated
+    component2->Remove();
+    scene->Update(1.0f / 60.0f);
+
+    REQUIRE(component1->numUpdates_ == 5);
+    REQUIRE(component2->numUpdates_ == 3);
+    REQUIRE(scheduler.GetNumComponents(LogicUpdateStage::Update) == 1);
+    REQUIRE(scheduler.GetNumComponents(LogicUpdateStage::PostUpdate) == 1);
+}
+
+#ifdef URHO3D_PHYSICS
+TEST_CASE("Logic components are fixed-updated by physics world of their scene")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    RegisterTestComponents(context);
+
+    auto sceneA = MakeShared<Scene>(context);
+    auto sceneB = MakeShared<Scene>(context);
+    SharedPtr<TestLogicComponent> componentA{sceneA->CreateChild("Node")->CreateComponent<TestLogicComponent>()};
+    SharedPtr<TestLogicComponent> componentB{sceneB->CreateChild("Node")->CreateComponent<TestLogicComponent>()};
+
+    // Physics world may be added after logic components
+    auto physicsWorldA = sceneA->CreateComponent<PhysicsWorld>();
+    auto physicsWorldB = sceneB->CreateComponent<PhysicsWorld>();
+    REQUIRE(sceneA->GetFixedUpdateSource() == physicsWorldA);
+
+    sceneA->Update(1.0f / 60.0f);
+    REQUIRE(componentA->numFixedUpdates_ > 0);
+    REQUIRE(componentA->numFixedUpdates_ == componentA->numFixedPostUpdates_);
+    REQUIRE(componentB->numFixedUpdates_ == 0);
+
+    // Scene is not fixed-updated after physics world is removed
+    const unsigned numFixedUpdates = componentA->numFixedUpdates_;
+    physicsWorldA->Remove();
+    REQUIRE(sceneA->GetFixedUpdateSource() == nullptr);
+
+    physicsWorldB->Update(1.0f / 60.0f);
+    sceneA->Update(1.0f / 60.0f);
+    REQUIRE(componentA->numFixedUpdates_ == numFixedUpdates);
+    REQUIRE(componentB->numFixedUpdates_ > 0);
+}
+#endif
+
+TEST_CASE("Logic components may be removed during update")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    RegisterTestComponents(context);
+
+    auto scene = MakeShared<Scene>(context);
+    ea::vector<LogicComponent*> updateLog;
+
+    ea::vector<WeakPtr<TestLogicComponent>> components;
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        auto component = scene->CreateChild()->CreateComponent<TestLogicComponent>();
+        component->updateLog_ = &updateLog;
+        components.emplace_back(component);
+    }
+
+    // First component removes the third one, second component removes itself
+    components[0]->componentToRemove_ = components[2];
+    components[1]->componentToRemove_ = components[1];
+
+    scene->Update(1.0f / 60.0f);
+
+    REQUIRE(components[1].Expired());
+    REQUIRE(components[2].Expired());
+    REQUIRE(updateLog.size() == 3);
+    REQUIRE(updateLog[0] == components[0].Get());
+    REQUIRE(updateLog[2] == components[3].Get());
+
+    updateLog.clear();
+    scene->Update(1.0f / 60.0f);
+
+    REQUIRE(updateLog == ea::vector<LogicComponent*>{components[0].Get(), components[3].Get()});
+    REQUIRE(scene->GetLogicComponentScheduler().GetNumComponents(LogicUpdateStage::Update) == 2);
+}
+
+TEST_CASE("Thread-safe logic components are updated in parallel")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    RegisterTestComponents(context);
+
+    auto scene = MakeShared<Scene>(context);
+
+    const unsigned numComponents = LogicComponentScheduler::MinComponentsForParallelUpdate * 4;
+    ea::vector<TestThreadSafeLogicComponent*> components;
+    for (unsigned i = 0; i < numComponents; ++i)
+        components.push_back(scene->CreateChild()->CreateComponent<TestThreadSafeLogicComponent>());
+
+    TestThreadSafeLogicComponent::totalUpdates_ = 0;
+    scene->Update(0.5f);
+    scene->Update(0.5f);
+
+    REQUIRE(TestThreadSafeLogicComponent::totalUpdates_ == numComponents * 2);
+    for (TestThreadSafeLogicComponent* component : components)
+    {
+        REQUIRE(component->numDelayedStarts_ == 1);
+        REQUIRE(component->numUpdates_ == 2);
+        REQUIRE(component->GetNode()->GetWorldPosition().Equals(Vector3::UP));
+    }
+}
+
+TEST_CASE("Logic component update benchmark", "[.benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    RegisterTestComponents(context);
+
+    auto scene = MakeShared<Scene>(context);
+    for (unsigned i = 0; i < 20000; ++i)
+        scene->CreateChild()->CreateComponent<TestLogicComponent>();
+
+    BENCHMARK("Update 20000 logic components")
+    {
+        scene->Update(1.0f / 60.0f);
+        return scene->GetElapsedTime();
+    };
+}
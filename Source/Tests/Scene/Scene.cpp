@@ -55,3 +55,192 @@ TEST_CASE("Scene lookup")
     CHECK(Tests::GetAttributeValue(child20->FindComponentAttribute("@/Name")) == Variant(child20->GetName()));
     CHECK(Tests::GetAttributeValue(child20->FindComponentAttribute("@StaticModel/LOD Bias")) == Variant(1.0f));
 }
+
+TEST_CASE("Scene component index stores components contiguously")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto scene = MakeShared<Scene>(context);
+    scene->CreateComponentIndex<StaticModel>();
+
+    ea::vector<StaticModel*> models;
+    for (unsigned i = 0; i < 10; ++i)
+        models.push_back(scene->CreateChild()->CreateComponent<StaticModel>());
+
+    const SceneComponentIndex& index = scene->GetComponentIndex<StaticModel>();
+    REQUIRE(index.size() == 10);
+
+    ea::vector<unsigned> handles;
+    for (StaticModel* model : models)
+        handles.push_back(index.GetHandle(model));
+
+    // Remove some components, last component is moved into the hole
+    models[2]->Remove();
+    models[9]->GetNode()->Remove();
+    models[0]->Remove();
+    REQUIRE(index.size() == 7);
+
+    for (unsigned i : {1, 3, 4, 5, 6, 7, 8})
+    {
+        REQUIRE(index.GetHandle(models[i]) == handles[i]);
+        REQUIRE(index.GetComponentByHandle(handles[i]) == models[i]);
+        REQUIRE(index[index.GetPosition(handles[i])] == models[i]);
+    }
+    REQUIRE(index.GetComponentByHandle(handles[0]) == nullptr);
+    REQUIRE(index.GetComponentByHandle(handles[2]) == nullptr);
+
+    const auto indexedModels = scene->GetIndexedComponents<StaticModel>();
+    REQUIRE(indexedModels.size() == 7);
+    for (StaticModel* model : indexedModels)
+        REQUIRE(models.contains(model));
+
+    // Handles are reused
+    StaticModel* newModel = scene->CreateChild()->CreateComponent<StaticModel>();
+    REQUIRE(index.size() == 8);
+    REQUIRE(index.GetComponentByHandle(index.GetHandle(newModel)) == newModel);
+    REQUIRE(index.GetHandle(newModel) < 10);
+}
+
+namespace
+{
+
+/// Create chains of nodes similar to character skeletons.
+ea::vector<ea::vector<Node*>> CreateNodeChains(Scene* scene, unsigned numChains, unsigned chainLength)
+{
+    ea::vector<ea::vector<Node*>> result(numChains);
+    for (unsigned chainIndex = 0; chainIndex < numChains; ++chainIndex)
+    {
+        Node* parent = scene;
+        for (unsigned i = 0; i < chainLength; ++i)
+        {
+            Node* node = parent->CreateChild();
+            node->SetPosition({0.0f, 1.0f, static_cast<float>(i % 3)});
+            node->SetRotation(Quaternion(static_cast<float>(chainIndex + i) * 10.0f, Vector3::UP));
+            node->SetScale(1.0f + static_cast<float>(i % 2) * 0.5f);
+            result[chainIndex].push_back(node);
+            parent = node;
+        }
+    }
+    return result;
+}
+
+Matrix3x4 CalculateWorldTransform(const Node* node)
+{
+    const Node* parent = node->GetParent();
+    return parent ? CalculateWorldTransform(parent) * node->GetTransform() : node->GetTransform();
+}
+
+}
+
+TEST_CASE("Dirty world transforms are recalculated in batch on scene update")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto scene = MakeShared<Scene>(context);
+
+    const auto chains = CreateNodeChains(scene, 20, 8);
+    scene->Update(0.0f);
+
+    for (const auto& chain : chains)
+    {
+        for (Node* node : chain)
+            REQUIRE_FALSE(node->IsDirty());
+    }
+
+    // Move the roots of some chains, and the middle nodes of the others
+    for (unsigned chainIndex = 0; chainIndex < chains.size(); ++chainIndex)
+    {
+        const auto& chain = chains[chainIndex];
+        Node* node = chain[chainIndex % 2 == 0 ? 0 : chain.size() / 2];
+        node->Translate({1.0f, 0.0f, 0.0f});
+    }
+
+    // Mark child dirty before its parent so they are both queued
+    chains[1].back()->Rotate(Quaternion(45.0f, Vector3::RIGHT));
+    chains[1][1]->Rotate(Quaternion(45.0f, Vector3::RIGHT));
+
+    // Update some nodes lazily, leaving dirty children behind
+    chains[2][chains[2].size() / 2]->GetWorldTransform();
+    chains[4][0]->GetWorldTransform();
+
+    // Move a node with dirty children to another parent
+    chains[6][0]->SetParent(chains[7][2]);
+
+    REQUIRE(chains[0].back()->IsDirty());
+
+    scene->Update(0.0f);
+
+    for (const auto& chain : chains)
+    {
+        for (Node* node : chain)
+        {
+            REQUIRE_FALSE(node->IsDirty());
+            REQUIRE(node->GetWorldTransform().Equals(CalculateWorldTransform(node)));
+        }
+    }
+}
+
+TEST_CASE("Only topmost dirty node of branching hierarchy is queued for transform update")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto scene = MakeShared<Scene>(context);
+
+    // Create binary tree of depth 6
+    Node* root = scene->CreateChild("Root");
+    ea::vector<Node*> nodes{root};
+    for (unsigned i = 0; nodes.size() < 63; ++i)
+    {
+        nodes.push_back(nodes[i]->CreateChild());
+        nodes.push_back(nodes[i]->CreateChild());
+    }
+    scene->Update(0.0f);
+    REQUIRE(scene->GetNumQueuedTransformUpdates() == 0);
+
+    root->Translate({1.0f, 0.0f, 0.0f});
+    REQUIRE(scene->GetNumQueuedTransformUpdates() == 1);
+    for (Node* node : nodes)
+        REQUIRE(node->IsDirty());
+
+    // Nodes that are already dirty are not queued again
+    nodes[1]->Translate({1.0f, 0.0f, 0.0f});
+    nodes.back()->Translate({1.0f, 0.0f, 0.0f});
+    REQUIRE(scene->GetNumQueuedTransformUpdates() == 1);
+
+    scene->Update(0.0f);
+    REQUIRE(scene->GetNumQueuedTransformUpdates() == 0);
+    for (Node* node : nodes)
+    {
+        REQUIRE_FALSE(node->IsDirty());
+        REQUIRE(node->GetWorldTransform().Equals(CalculateWorldTransform(node)));
+    }
+}
+
+TEST_CASE("World transform update benchmark", "[.benchmark]")
+{
+    auto context = Tests::GetOrCreateContext(Tests::CreateCompleteContext);
+    auto scene = MakeShared<Scene>(context);
+    const auto chains = CreateNodeChains(scene, 2000, 30);
+
+    const auto moveRoots = [&]
+    {
+        for (const auto& chain : chains)
+            chain[0]->Translate(Vector3::RIGHT * 0.001f);
+    };
+
+    BENCHMARK("Lazy update")
+    {
+        moveRoots();
+        for (const auto& chain : chains)
+        {
+            for (Node* node : chain)
+                node->GetWorldTransform();
+        }
+        scene->UpdateDirtyTransforms();
+        return chains.size();
+    };
+
+    BENCHMARK("Batch update")
+    {
+        moveRoots();
+        scene->UpdateDirtyTransforms();
+        return chains.size();
+    };
+}
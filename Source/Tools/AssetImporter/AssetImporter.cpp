@@ -176,6 +176,8 @@ float defaultTicksPerSecond_ = 4800.0f;
 float importStartTime_ = 0.0f;
 float importEndTime_ = 0.0f;
 bool suppressFbxPivotNodes_ = true;
+bool compressAnimations_ = false;
+AnimationCompressionSettings animationCompressionSettings_;
 
 int main(int argc, char** argv);
 void Run(const ea::vector<ea::string>& arguments);
@@ -308,6 +310,8 @@ void Run(const ea::vector<ea::string>& arguments)
             "-split <start> <end> (animation model only)\n"
             "            Split animation, will only import from start frame to end frame\n"
             "-np         Do not suppress $fbx pivot nodes (FBX files only)\n"
+            "-ac [tol]   Compress animations. Optional tolerance of position, rotation (radians)\n"
+            "            and scale error. Default 0.0005\n"
         );
     }
 
@@ -463,6 +467,18 @@ void Run(const ea::vector<ea::string>& arguments)
                 checkUniqueModel_ = false;
             else if (argument == "bp")
                 moveToBindPose_ = true;
+            else if (argument == "ac")
+            {
+                compressAnimations_ = true;
+                if (value.length() && value[0] != '-')
+                {
+                    const float tolerance = ToFloat(value);
+                    animationCompressionSettings_.positionTolerance_ = tolerance;
+                    animationCompressionSettings_.rotationTolerance_ = tolerance;
+                    animationCompressionSettings_.scaleTolerance_ = tolerance;
+                    ++i;
+                }
+            }
             else if (argument == "split")
             {
                 ea::string value2 = i + 2 < arguments.size() ? arguments[i + 2] : EMPTY_STRING;
@@ -1496,6 +1512,15 @@ void BuildAndSaveAnimations(OutModel* model)
             }
         }
 
+        if (compressAnimations_)
+        {
+            AnimationCompressionStats stats;
+            if (outAnim->Compress(animationCompressionSettings_, &stats))
+                PrintLine("Compressed animation " + animName + ": " + stats.ToString());
+            else
+                PrintLine("Warning: could not compress animation " + animName);
+        }
+
         File outFile(context_);
         if (!outFile.Open(animOutName, FILE_WRITE))
             ErrorExit("Could not open output file " + animOutName);
@@ -713,6 +713,7 @@ static const char* predefinedNames[] = {
     EP_APPLICATION_NAME.c_str(),
     EP_ORIENTATIONS.c_str(),
     EP_PACKAGE_CACHE_DIR.c_str(),
+    EP_PIPELINE_STATE_CACHE.c_str(),
     EP_RENDER_PATH.c_str(),
     EP_REFRESH_RATE.c_str(),
     EP_RESOURCE_PACKAGES.c_str(),
@@ -767,6 +768,7 @@ static VariantType predefinedTypes[] = {
     VAR_STRING, // EP_APPLICATION_NAME
     VAR_STRING, // EP_ORIENTATIONS
     VAR_STRING, // EP_PACKAGE_CACHE_DIR
+    VAR_STRING, // EP_PIPELINE_STATE_CACHE
     VAR_STRING, // EP_RENDER_PATH
     VAR_INT,    // EP_REFRESH_RATE
     VAR_STRING, // EP_RESOURCE_PACKAGES
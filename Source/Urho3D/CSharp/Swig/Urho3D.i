@@ -500,6 +500,15 @@ public:
 %ignore Urho3D::Node::SetEntity;
 %ignore Urho3D::Scene::GetRegistry;
 %ignore Urho3D::Scene::GetComponentIndex;
+%ignore Urho3D::Scene::GetIndexedComponents;
+%ignore Urho3D::AnimationParameters::SerializeQuantized;
+%ignore Urho3D::AnimationParameters::DeserializeQuantized;
+%ignore Urho3D::SceneComponentIndex;
+%ignore Urho3D::Scene::GetLogicComponentScheduler;
+%ignore Urho3D::LogicComponent::SetUpdateListIndex;
+%ignore Urho3D::LogicComponent::GetUpdateListIndex;
+%ignore Urho3D::LogicComponent::ApplyDelayedStart;
+%ignore Urho3D::LogicComponent::ProcessUpdate;
 %ignore Urho3D::Animatable::animationEnabled_;
 %ignore Urho3D::Animatable::objectAnimation_;
 %ignore Urho3D::Component::node_;
@@ -558,7 +567,6 @@ public:
 %ignore Urho3D::PointOctreeQuery::TestDrawables;
 %ignore Urho3D::BoxOctreeQuery::TestDrawables;
 %ignore Urho3D::OctreeQuery::TestDrawables;
-%ignore Urho3D::UpdateDrawablesWork;
 %ignore Urho3D::ProcessLightWork;
 %ignore Urho3D::CheckVisibilityWork;
 %ignore Urho3D::CheckDrawableVisibilityWork;
@@ -655,6 +663,9 @@ public:
 %include "Urho3D/Graphics/Model.h"
 %include "Urho3D/Graphics/StaticModel.h"
 %include "Urho3D/Graphics/StaticModelGroup.h"
+%ignore Urho3D::CompressedAnimation::Compress;
+%ignore Urho3D::CompressedAnimation::Sample;
+%include "Urho3D/Graphics/CompressedAnimation.h"
 %include "Urho3D/Graphics/Animation.h"
 %include "Urho3D/Graphics/AnimationState.h"
 %include "Urho3D/Graphics/AnimationStateSource.h"
@@ -738,6 +749,12 @@ public:
 %ignore Urho3D::Connection::Initialize;
 %ignore Urho3D::Connection::GetAddressOrGUID;
 %ignore Urho3D::Connection::SetAddressOrGUID;
+%ignore Urho3D::Connection::ProcessPacket;
+%ignore Urho3D::LagCompensationHistory::ProcessQueries;
+%ignore Urho3D::NetworkObject::ProcessRpc;
+%ignore Urho3D::ClientReplica::GetRpcBatch;
+%ignore Urho3D::ServerReplicator::GetRpcBatch;
+%ignore Urho3D::ServerReplicator::GetBroadcastRpcBatch;
 %ignore Urho3D::Network::HandleMessage;
 %ignore Urho3D::Network::NewConnectionEstablished;
 %ignore Urho3D::Network::ClientDisconnected;
@@ -771,6 +788,8 @@ public:
 %include "Urho3D/Replica/ClientInputStatistics.h"
 %include "Urho3D/Replica/ClientReplica.h"
 %include "Urho3D/Replica/FilteredByDistance.h"
+%include "Urho3D/Replica/LagCompensationHistory.h"
+%include "Urho3D/Replica/LagCompensatedHitbox.h"
 %include "Urho3D/Replica/NetworkTime.h"
 %include "Urho3D/Replica/NetworkId.h"
 %include "Urho3D/Replica/PredictedKinematicController.h"
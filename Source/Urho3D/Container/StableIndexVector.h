@@ -0,0 +1,114 @@
+//
+// Copyright (c) 2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Math/MathDefs.h"
+
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+/// Vector of pointers to objects that store their own index in the vector.
+/// Removed elements are replaced with null until Compact is called,
+/// so the vector may be iterated by index while elements are added or removed.
+/// IndexAccessor shall provide GetIndex(const T*) and SetIndex(T*, unsigned) to access the index stored in element.
+template <class T, class IndexAccessor>
+class StableIndexVector
+{
+public:
+    StableIndexVector() = default;
+    explicit StableIndexVector(const IndexAccessor& accessor) : accessor_(accessor) {}
+
+    /// Add element to the end.
+    void Add(T* element)
+    {
+        accessor_.SetIndex(element, elements_.size());
+        elements_.push_back(element);
+    }
+
+    /// Remove element if present. Other elements are not moved. Return whether the element was removed.
+    bool Remove(T* element)
+    {
+        const unsigned index = accessor_.GetIndex(element);
+        if (index >= elements_.size() || elements_[index] != element)
+            return false;
+
+        elements_[index] = nullptr;
+        ++numRemoved_;
+        accessor_.SetIndex(element, M_MAX_UNSIGNED);
+        return true;
+    }
+
+    /// Remove null elements and update indices of remaining elements. Shall not be called while iterating.
+    void Compact()
+    {
+        if (numRemoved_ == 0)
+            return;
+
+        unsigned newSize = 0;
+        for (T* element : elements_)
+        {
+            if (element)
+            {
+                accessor_.SetIndex(element, newSize);
+                elements_[newSize++] = element;
+            }
+        }
+        elements_.resize(newSize);
+        numRemoved_ = 0;
+    }
+
+    /// Remove all elements and reset their indices.
+    void Clear()
+    {
+        for (T* element : elements_)
+        {
+            if (element)
+                accessor_.SetIndex(element, M_MAX_UNSIGNED);
+        }
+        elements_.clear();
+        numRemoved_ = 0;
+    }
+
+    /// Return element by index. Null if removed.
+    T* operator[](unsigned index) const { return elements_[index]; }
+    /// Return number of elements including removed ones.
+    unsigned Size() const { return elements_.size(); }
+    /// Return whether there are no elements, including removed ones.
+    bool Empty() const { return elements_.empty(); }
+    /// Return number of elements excluding removed ones.
+    unsigned GetNumElements() const { return elements_.size() - numRemoved_; }
+    /// Return all elements including removed ones.
+    const ea::vector<T*>& GetElements() const { return elements_; }
+
+private:
+    /// Accessor of index stored in element.
+    IndexAccessor accessor_;
+    /// Elements. Removed elements are replaced with null.
+    ea::vector<T*> elements_;
+    /// Number of null elements.
+    unsigned numRemoved_{};
+};
+
+}
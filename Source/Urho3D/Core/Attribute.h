@@ -67,8 +67,22 @@ public:
     virtual void Get(const Serializable* ptr, Variant& dest) const = 0;
     /// Set the attribute.
     virtual void Set(Serializable* ptr, const Variant& src) = 0;
+#ifndef SWIG
+    /// Return type of the value accepted by SetValue, or VAR_NONE if the attribute can be set only from Variant.
+    virtual VariantType GetValueType() const { return VAR_NONE; }
+    /// Set the attribute from the value of the type returned by GetValueType, bypassing Variant.
+    virtual void SetValue(Serializable* ptr, const void* src) { }
+#endif
 };
 
+/// Return whether the attribute value of given type may be passed to AttributeAccessor::SetValue as is.
+template <class T> constexpr bool IsTypedAttributeValue()
+{
+    return ea::is_same_v<T, float> || ea::is_same_v<T, double> || ea::is_same_v<T, Vector2> || ea::is_same_v<T, Vector3>
+        || ea::is_same_v<T, Vector4> || ea::is_same_v<T, Quaternion> || ea::is_same_v<T, Color> || ea::is_same_v<T, IntRect>
+        || ea::is_same_v<T, IntVector2> || ea::is_same_v<T, IntVector3>;
+}
+
 /// Description of an automatically serializable variable.
 struct AttributeInfo
 {
@@ -0,0 +1,237 @@
+//
+// Copyright (c) 2021-2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Core/WorkQueue.h"
+
+#include <EASTL/array.h>
+#include <EASTL/sort.h>
+#include <EASTL/span.h>
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+/// Radix sort digit layout. Keys are 64-bit and sorted 8 bits per pass.
+/// @{
+static constexpr unsigned RadixSortDigitBits = 8;
+static constexpr unsigned RadixSortNumBuckets = 1u << RadixSortDigitBits;
+static constexpr unsigned RadixSortNumDigits = 64 / RadixSortDigitBits;
+/// @}
+
+/// Collections smaller than this are sorted with insertion sort.
+static constexpr unsigned RadixSortMinElements = 64;
+/// Minimal number of elements processed by one thread in parallel radix sort.
+static constexpr unsigned RadixSortMinElementsPerThread = 8 * 1024;
+
+/// Histogram of all digits of the keys in the range.
+using RadixSortHistogram = ea::array<ea::array<unsigned, RadixSortNumBuckets>, RadixSortNumDigits>;
+
+/// Temporary buffers used by radix sort. Should be reused between calls to avoid allocations.
+template <class T>
+struct RadixSortBuffers
+{
+    /// Storage of the same size as sorted collection.
+    ea::vector<T> scratch_;
+    /// Histograms for each chunk of sorted collection.
+    ea::vector<RadixSortHistogram> histograms_;
+    /// Scatter offsets for each chunk of sorted collection.
+    ea::vector<ea::array<unsigned, RadixSortNumBuckets>> offsets_;
+};
+
+namespace Detail
+{
+
+/// Return digit of the key.
+inline unsigned GetRadixSortDigit(unsigned long long key, unsigned digit)
+{
+    return static_cast<unsigned>(key >> (digit * RadixSortDigitBits)) & (RadixSortNumBuckets - 1);
+}
+
+/// Accumulate histogram of all digits of the keys in the range.
+template <class T, class GetKey>
+void AccumulateRadixSortHistogram(RadixSortHistogram& histogram, const T* begin, const T* end, const GetKey& getKey)
+{
+    for (auto& digitHistogram : histogram)
+        digitHistogram.fill(0);
+
+    for (const T* element = begin; element != end; ++element)
+    {
+        const unsigned long long key = getKey(*element);
+        for (unsigned digit = 0; digit < RadixSortNumDigits; ++digit)
+            ++histogram[digit][GetRadixSortDigit(key, digit)];
+    }
+}
+
+/// Accumulate histogram of single digit of the keys in the range.
+template <class T, class GetKey>
+void AccumulateRadixSortDigitHistogram(ea::array<unsigned, RadixSortNumBuckets>& histogram,
+    const T* begin, const T* end, unsigned digit, const GetKey& getKey)
+{
+    histogram.fill(0);
+    for (const T* element = begin; element != end; ++element)
+        ++histogram[GetRadixSortDigit(getKey(*element), digit)];
+}
+
+/// Return whether the pass over digit would change the order of elements.
+inline bool IsRadixSortPassNeeded(const ea::array<unsigned, RadixSortNumBuckets>& totalHistogram, unsigned size)
+{
+    return ea::find(totalHistogram.begin(), totalHistogram.end(), size) == totalHistogram.end();
+}
+
+/// Scatter elements to buckets according to digit.
+template <class T, class GetKey>
+void ScatterRadixSortElements(ea::array<unsigned, RadixSortNumBuckets>& offsets,
+    const T* begin, const T* end, T* dest, unsigned digit, const GetKey& getKey)
+{
+    for (const T* element = begin; element != end; ++element)
+        dest[offsets[GetRadixSortDigit(getKey(*element), digit)]++] = *element;
+}
+
+}
+
+/// Sort elements by 64-bit unsigned key in ascending order. Sort is stable.
+/// Least significant digit radix sort is used, passes over digits shared by all keys are skipped.
+/// Signature of getKey: unsigned long long(const T& element)
+template <class T, class GetKey>
+void RadixSort(ea::span<T> elements, RadixSortBuffers<T>& buffers, const GetKey& getKey)
+{
+    const unsigned size = elements.size();
+    if (size < RadixSortMinElements)
+    {
+        ea::insertion_sort(elements.begin(), elements.end(),
+            [&](const T& lhs, const T& rhs) { return getKey(lhs) < getKey(rhs); });
+        return;
+    }
+
+    buffers.scratch_.resize(size);
+    buffers.histograms_.resize(1);
+    RadixSortHistogram& histogram = buffers.histograms_[0];
+    Detail::AccumulateRadixSortHistogram(histogram, elements.data(), elements.data() + size, getKey);
+
+    T* source = elements.data();
+    T* dest = buffers.scratch_.data();
+    for (unsigned digit = 0; digit < RadixSortNumDigits; ++digit)
+    {
+        const auto& digitHistogram = histogram[digit];
+        if (!Detail::IsRadixSortPassNeeded(digitHistogram, size))
+            continue;
+
+        ea::array<unsigned, RadixSortNumBuckets> offsets;
+        unsigned offset = 0;
+        for (unsigned bucket = 0; bucket < RadixSortNumBuckets; ++bucket)
+        {
+            offsets[bucket] = offset;
+            offset += digitHistogram[bucket];
+        }
+
+        Detail::ScatterRadixSortElements(offsets, source, source + size, dest, digit, getKey);
+        ea::swap(source, dest);
+    }
+
+    if (source != elements.data())
+        ea::copy(source, source + size, elements.data());
+}
+
+/// Sort elements by 64-bit unsigned key in ascending order using worker threads. Sort is stable.
+/// Falls back to single-threaded sort for small collections.
+/// Should be called from main thread.
+template <class T, class GetKey>
+void ParallelRadixSort(WorkQueue* workQueue, ea::span<T> elements, RadixSortBuffers<T>& buffers, const GetKey& getKey)
+{
+    const unsigned size = elements.size();
+    const unsigned maxChunks = workQueue ? workQueue->GetNumThreads() + 1 : 1;
+    const unsigned numChunks = ea::min(maxChunks, size / RadixSortMinElementsPerThread);
+    if (numChunks <= 1)
+    {
+        RadixSort(elements, buffers, getKey);
+        return;
+    }
+
+    const unsigned chunkSize = (size + numChunks - 1) / numChunks;
+    buffers.scratch_.resize(size);
+    buffers.histograms_.resize(numChunks);
+    buffers.offsets_.resize(numChunks);
+
+    // Evaluate histograms of all digits to skip redundant passes
+    T* source = elements.data();
+    T* dest = buffers.scratch_.data();
+    ForEachParallel(workQueue, chunkSize, size, [&](unsigned beginIndex, unsigned endIndex)
+    {
+        Detail::AccumulateRadixSortHistogram(buffers.histograms_[beginIndex / chunkSize],
+            source + beginIndex, source + endIndex, getKey);
+    });
+
+    bool isFirstPass = true;
+    for (unsigned digit = 0; digit < RadixSortNumDigits; ++digit)
+    {
+        ea::array<unsigned, RadixSortNumBuckets> totalHistogram{};
+        for (unsigned chunk = 0; chunk < numChunks; ++chunk)
+        {
+            for (unsigned bucket = 0; bucket < RadixSortNumBuckets; ++bucket)
+                totalHistogram[bucket] += buffers.histograms_[chunk][digit][bucket];
+        }
+
+        if (!Detail::IsRadixSortPassNeeded(totalHistogram, size))
+            continue;
+
+        // Histograms of all digits are valid only for the original order of elements
+        if (!isFirstPass)
+        {
+            ForEachParallel(workQueue, chunkSize, size, [&](unsigned beginIndex, unsigned endIndex)
+            {
+                Detail::AccumulateRadixSortDigitHistogram(buffers.histograms_[beginIndex / chunkSize][digit],
+                    source + beginIndex, source + endIndex, digit, getKey);
+            });
+        }
+        isFirstPass = false;
+
+        // Elements of each chunk are placed after elements with smaller digit and elements of previous chunks
+        unsigned offset = 0;
+        for (unsigned bucket = 0; bucket < RadixSortNumBuckets; ++bucket)
+        {
+            for (unsigned chunk = 0; chunk < numChunks; ++chunk)
+            {
+                buffers.offsets_[chunk][bucket] = offset;
+                offset += buffers.histograms_[chunk][digit][bucket];
+            }
+        }
+
+        ForEachParallel(workQueue, chunkSize, size, [&](unsigned beginIndex, unsigned endIndex)
+        {
+            Detail::ScatterRadixSortElements(buffers.offsets_[beginIndex / chunkSize],
+                source + beginIndex, source + endIndex, dest, digit, getKey);
+        });
+        ea::swap(source, dest);
+    }
+
+    if (source != elements.data())
+    {
+        ForEachParallel(workQueue, chunkSize, size, [&](unsigned beginIndex, unsigned endIndex)
+        {
+            ea::copy(source + beginIndex, source + endIndex, elements.data() + beginIndex);
+        });
+    }
+}
+
+}
@@ -322,6 +322,8 @@ bool Engine::Initialize(const VariantMap& parameters)
 
         if (HasParameter(parameters, EP_DUMP_SHADERS))
             graphics->BeginDumpShaders(GetParameter(parameters, EP_DUMP_SHADERS, EMPTY_STRING).GetString());
+        if (HasParameter(parameters, EP_PIPELINE_STATE_CACHE))
+            renderer->GetPipelineStateCache()->BeginPrecache(GetParameter(parameters, EP_PIPELINE_STATE_CACHE).GetString());
         if (HasParameter(parameters, EP_RENDER_PATH))
             renderer->SetDefaultRenderPath(cache->GetResource<XMLFile>(GetParameter(parameters, EP_RENDER_PATH).GetString()));
 
@@ -992,6 +994,7 @@ void Engine::DefineParameters(CLI::App& commandLine, VariantMap& engineParameter
     addOptionString("--pf,--resource-packages", EP_RESOURCE_PACKAGES, "Resource packages")->set_custom_option("path1;path2;...");
     addOptionString("--ap,--autoload-paths", EP_AUTOLOAD_PATHS, "Resource autoload paths")->set_custom_option("path1;path2;...");
     addOptionString("--ds,--dump-shaders", EP_DUMP_SHADERS, "Dump shaders")->set_custom_option("filename");
+    addOptionString("--pipeline-state-cache", EP_PIPELINE_STATE_CACHE, "Record and precache pipeline states")->set_custom_option("filename");
     addFlagInternal("--mq,--material-quality", "Material quality", [&](CLI::results_t res) {
         unsigned value = 0;
         if (CLI::detail::lexical_cast(res[0], value) && value >= QUALITY_LOW && value <= QUALITY_MAX)
@@ -1067,6 +1070,10 @@ void Engine::HandleEndFrame(StringHash eventType, VariantMap& eventData)
 
 void Engine::DoExit()
 {
+    // Save recorded pipeline states while shaders are still alive
+    if (auto* renderer = GetSubsystem<Renderer>())
+        renderer->GetPipelineStateCache()->EndPrecache();
+
     auto* graphics = GetSubsystem<Graphics>();
     if (graphics)
         graphics->Close();
@@ -53,6 +53,7 @@ static const ea::string EP_ORGANIZATION_NAME = "OrganizationName";
 static const ea::string EP_APPLICATION_NAME = "ApplicationName";
 static const ea::string EP_ORIENTATIONS = "Orientations";
 static const ea::string EP_PACKAGE_CACHE_DIR = "PackageCacheDir";
+static const ea::string EP_PIPELINE_STATE_CACHE = "PipelineStateCache";
 static const ea::string EP_RENDER_PATH = "RenderPath";
 static const ea::string EP_REFRESH_RATE = "RefreshRate";
 static const ea::string EP_RESOURCE_PACKAGES = "ResourcePackages";
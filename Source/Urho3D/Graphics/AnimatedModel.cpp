@@ -42,6 +42,7 @@
 #include "../Graphics/SoftwareModelAnimator.h"
 #include "../Graphics/VertexBuffer.h"
 #include "../IO/Log.h"
+#include "../Math/CapsuleBatch.h"
 #include "../Resource/ResourceCache.h"
 #include "../Resource/ResourceEvents.h"
 #include "../Scene/Scene.h"
@@ -98,11 +99,19 @@ void AnimatedModel::RegisterObject(Context* context)
     URHO3D_ACCESSOR_ATTRIBUTE("Shadow Distance", GetShadowDistance, SetShadowDistance, float, 0.0f, AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("LOD Bias", GetLodBias, SetLodBias, float, 1.0f, AM_DEFAULT);
     URHO3D_ACCESSOR_ATTRIBUTE("Animation LOD Bias", GetAnimationLodBias, SetAnimationLodBias, float, 1.0f, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Animation Importance", GetAnimationImportance, SetAnimationImportance, float, 1.0f, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Animation LOD Interpolation", GetAnimationLodInterpolation, SetAnimationLodInterpolation, bool, false, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Reduced Bones LOD Distance", GetReducedBonesLodDistance, SetReducedBonesLodDistance, float, 0.0f, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Reduced Bones Max Depth", GetReducedBonesMaxDepth, SetReducedBonesMaxDepth, unsigned, 2, AM_DEFAULT);
     URHO3D_COPY_BASE_ATTRIBUTES(Drawable);
     URHO3D_MIXED_ACCESSOR_ATTRIBUTE("Bone Animation Enabled", GetBonesEnabledAttr, SetBonesEnabledAttr, VariantVector,
         Variant::emptyVariantVector, AM_FILE | AM_NOEDIT);
     URHO3D_ACCESSOR_ATTRIBUTE("Morphs", GetMorphsAttr, SetMorphsAttr, ea::vector<unsigned char>, Variant::emptyBuffer,
         AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Create Bone Nodes", GetCreateBoneNodes, SetCreateBoneNodes, bool, true, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Exposed Bone Nodes", GetExposedBoneNodesAttr, SetExposedBoneNodesAttr, VariantVector,
+        Variant::emptyVariantVector, AM_FILE | AM_NOEDIT | AM_NODEIDVECTOR);
+    URHO3D_ACCESSOR_ATTRIBUTE("Use Hit Capsules", GetUseHitCapsules, SetUseHitCapsules, bool, false, AM_DEFAULT);
 }
 
 void AnimatedModel::SerializeInBlock(Archive& archive)
@@ -162,18 +171,36 @@ void AnimatedModel::ProcessCustomRayQuery(const RayOctreeQuery& query, const Bou
         return;
 
     const ea::vector<Bone>& bones = skeleton_.GetBones();
+    const AnimatedModel* poseMaster = GetBoneNodeFreeMaster();
+
+    // Bones with hit capsules are tested together after the loop
+    static thread_local CapsuleBatch hitCapsules;
+    static thread_local ea::vector<unsigned> hitCapsuleBones;
+    hitCapsules.Clear();
+    hitCapsuleBones.clear();
 
     for (unsigned i = 0; i < bones.size(); ++i)
     {
         const Bone& bone = bones[i];
-        if (!bone.node_)
+        if (!bone.node_ && !poseMaster)
             continue;
 
         float distance;
 
         // Keep this check to reuse this function for normal raycast without dedicated array of matrices.
-        const Matrix3x4& transform =
-            i < boneWorldTransforms.size() ? boneWorldTransforms[i] : bone.node_->GetWorldTransform();
+        Matrix3x4 transform;
+        if (!GetQueryBoneTransform(i, worldTransform, boneWorldTransforms, poseMaster, transform))
+            continue;
+
+        // Bones excluded from collision are skipped by hit capsules too
+        if (useHitCapsules_ && bone.hitCapsuleRadius_ > 0.0f && bone.collisionMask_ != BONECOLLISION_NONE)
+        {
+            const Vector3 scale = transform.Scale();
+            hitCapsules.Add(transform * bone.hitCapsuleStart_, transform * bone.hitCapsuleEnd_,
+                bone.hitCapsuleRadius_ * Max(scale.x_, Max(scale.y_, scale.z_)));
+            hitCapsuleBones.push_back(i);
+            continue;
+        }
 
         // Use hitbox if available
         if (bone.collisionMask_ & BONECOLLISION_BOX)
@@ -215,6 +242,27 @@ void AnimatedModel::ProcessCustomRayQuery(const RayOctreeQuery& query, const Bou
         result.subObject_ = i;
         results.push_back(result);
     }
+
+    if (!hitCapsules.GetSize())
+        return;
+
+    const ea::span<const float> distances = hitCapsules.HitDistances(query.ray_);
+    for (unsigned i = 0; i < distances.size(); ++i)
+    {
+        const float distance = distances[i];
+        if (distance >= query.maxDistance_)
+            continue;
+
+        RayQueryResult result;
+        result.position_ = query.ray_.origin_ + distance * query.ray_.direction_;
+        const Vector3 normal = result.position_ - hitCapsules.GetClosestSegmentPoint(i, result.position_);
+        result.normal_ = normal.LengthSquared() > M_EPSILON ? normal.Normalized() : -query.ray_.direction_;
+        result.distance_ = distance;
+        result.drawable_ = this;
+        result.node_ = node_;
+        result.subObject_ = hitCapsuleBones[i];
+        results.push_back(result);
+    }
 }
 
 void AnimatedModel::ProcessRayQuery(const RayOctreeQuery& query, ea::vector<RayQueryResult>& results)
@@ -222,6 +270,79 @@ void AnimatedModel::ProcessRayQuery(const RayOctreeQuery& query, ea::vector<RayQ
     ProcessCustomRayQuery(query, GetWorldBoundingBox(), node_->GetWorldTransform(), {}, results);
 }
 
+float AnimatedModel::SweepHitCapsules(const Ray& ray, float radius, float maxDistance,
+    ea::span<const Matrix3x4> boneWorldTransforms, unsigned* hitBoneIndex) const
+{
+    if (!node_)
+        return M_INFINITY;
+
+    // Check swept AABB first unless the pose is provided externally
+    if (boneWorldTransforms.empty() && !worldBoundingBoxDirty_)
+    {
+        const BoundingBox& box = worldBoundingBox_;
+        if (ray.HitDistance(BoundingBox{box.min_ - Vector3::ONE * radius, box.max_ + Vector3::ONE * radius}) >= maxDistance)
+            return M_INFINITY;
+    }
+
+    static thread_local CapsuleBatch hitCapsules;
+    static thread_local ea::vector<unsigned> hitCapsuleBones;
+    hitCapsules.Clear();
+    hitCapsuleBones.clear();
+    CollectHitCapsules(hitCapsules, hitCapsuleBones, node_->GetWorldTransform(), boneWorldTransforms);
+
+    float closestDistance = M_INFINITY;
+    const ea::span<const float> distances = hitCapsules.HitDistances(ray, radius);
+    for (unsigned i = 0; i < distances.size(); ++i)
+    {
+        if (distances[i] < closestDistance && distances[i] < maxDistance)
+        {
+            closestDistance = distances[i];
+            if (hitBoneIndex)
+                *hitBoneIndex = hitCapsuleBones[i];
+        }
+    }
+    return closestDistance;
+}
+
+unsigned AnimatedModel::SweepHitCapsules(ea::span<const AnimatedModel* const> models, const Ray& ray, float radius,
+    float maxDistance, float* hitDistance, unsigned* hitBoneIndex)
+{
+    static thread_local CapsuleBatch hitCapsules;
+    static thread_local ea::vector<unsigned> hitCapsuleBones;
+    static thread_local ea::vector<unsigned> hitCapsuleModels;
+    hitCapsules.Clear();
+    hitCapsuleBones.clear();
+    hitCapsuleModels.clear();
+
+    for (unsigned modelIndex = 0; modelIndex < models.size(); ++modelIndex)
+    {
+        const AnimatedModel* model = models[modelIndex];
+        if (!model || !model->GetNode())
+            continue;
+
+        model->CollectHitCapsules(hitCapsules, hitCapsuleBones, model->GetNode()->GetWorldTransform(), {});
+        hitCapsuleModels.resize(hitCapsuleBones.size(), modelIndex);
+    }
+
+    unsigned closestModel = M_MAX_UNSIGNED;
+    float closestDistance = maxDistance;
+    const ea::span<const float> distances = hitCapsules.HitDistances(ray, radius);
+    for (unsigned i = 0; i < distances.size(); ++i)
+    {
+        if (distances[i] < closestDistance)
+        {
+            closestDistance = distances[i];
+            closestModel = hitCapsuleModels[i];
+            if (hitBoneIndex)
+                *hitBoneIndex = hitCapsuleBones[i];
+        }
+    }
+
+    if (hitDistance)
+        *hitDistance = closestModel != M_MAX_UNSIGNED ? closestDistance : M_INFINITY;
+    return closestModel;
+}
+
 bool AnimatedModel::PrepareForThreadedUpdate(Camera* camera, unsigned frameNumber)
 {
     // If node was invisible last frame, need to decide animation LOD distance here
@@ -272,7 +393,12 @@ void AnimatedModel::Update(const FrameInfo& frame)
             {
                 if (UpdateAndCheckAnimationTimers(frame.timeStep_))
                 {
-                    CalculateAnimations();
+                    CalculateAnimationsWithLod(frame.timeStep_);
+                    transformsDirty = true;
+                }
+                else if (!animationLodTargetPose_.empty())
+                {
+                    InterpolateAnimationLod(frame.timeStep_);
                     transformsDirty = true;
                 }
             }
@@ -284,12 +410,31 @@ void AnimatedModel::Update(const FrameInfo& frame)
         if (transformsDirty)
         {
             Octree* octree = octant_->GetOctree();
-            for (unsigned boneIndex = 0; boneIndex < skeleton_.GetNumBones(); ++boneIndex)
+            if (createBoneNodes_)
             {
-                Node* node = skeleton_.GetBone(boneIndex)->node_;
-                const Transform& transform = skeletonData_[boneIndex].localToParent_;
-                if (node)
-                    octree->QueueNodeTransformUpdate(node, transform);
+                for (unsigned boneIndex = 0; boneIndex < skeleton_.GetNumBones(); ++boneIndex)
+                {
+                    Node* node = skeleton_.GetBone(boneIndex)->node_;
+                    const Transform& transform = skeletonData_[boneIndex].localToParent_;
+                    if (node)
+                        octree->QueueNodeTransformUpdate(node, transform);
+                }
+            }
+            else
+            {
+                // Skin directly from the pose, only exposed bone nodes need to follow it
+                skinningDirty_ = true;
+                ++poseVersion_;
+                for (unsigned boneIndex = 0; boneIndex < skeleton_.GetNumBones(); ++boneIndex)
+                {
+                    if (Node* node = skeleton_.GetBone(boneIndex)->node_)
+                    {
+                        Transform transform;
+                        skeletonData_[boneIndex].localToComponent_.Decompose(
+                            transform.position_, transform.rotation_, transform.scale_);
+                        octree->QueueNodeTransformUpdate(node, transform);
+                    }
+                }
             }
         }
     }
@@ -315,6 +460,10 @@ void AnimatedModel::InitializeLocalBoneTransforms(bool reset)
         ModelAnimationOutput& output = skeletonData_[i];
 
         output.dirty_ = CHANNEL_NONE;
+        // Without bone nodes the pose is retained between updates
+        if (!reset && !createBoneNodes_)
+            continue;
+
         if (!reset && bone->node_)
         {
             output.localToParent_.position_ = bone->node_->GetPosition();
@@ -402,6 +551,14 @@ void AnimatedModel::UpdateGeometry(const FrameInfo& frame)
 
 UpdateGeometryType AnimatedModel::GetUpdateGeometryType()
 {
+    // Non-master models are not notified about the master pose changes if there are no bone nodes
+    if (!isMaster_)
+    {
+        const AnimatedModel* poseMaster = GetBoneNodeFreeMaster();
+        if (poseMaster && poseMaster->poseVersion_ != masterPoseVersion_)
+            skinningDirty_ = true;
+    }
+
     if (morphsDirty_ || forceAnimationUpdate_ || (skinningDirty_ && softwareSkinning_))
         return UPDATE_MAIN_THREAD;
     else if (skinningDirty_)
@@ -415,7 +572,29 @@ void AnimatedModel::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
     if (debug && IsEnabledEffective())
     {
         debug->AddBoundingBox(GetWorldBoundingBox(), Color::GREEN, depthTest);
-        debug->AddSkeleton(skeleton_, Color(0.75f, 0.75f, 0.75f), depthTest);
+        if (!GetBoneNodeFreeMaster())
+        {
+            debug->AddSkeleton(skeleton_, Color(0.75f, 0.75f, 0.75f), depthTest);
+            return;
+        }
+
+        // Draw the skeleton from the pose, same as DebugRenderer::AddSkeleton does from bone nodes
+        const auto hasGeometry = [](const Bone& bone)
+        { return bone.radius_ >= M_EPSILON || bone.boundingBox_.Size().LengthSquared() >= M_EPSILON; };
+
+        const ea::vector<Bone>& bones = skeleton_.GetBones();
+        for (unsigned i = 0; i < bones.size(); ++i)
+        {
+            if (!hasGeometry(bones[i]))
+                continue;
+
+            const unsigned parentIndex = bones[i].parentIndex_;
+            const Vector3 start = GetBoneWorldTransform(i).Translation();
+            const Vector3 end = parentIndex != i && parentIndex < bones.size() && hasGeometry(bones[parentIndex])
+                ? GetBoneWorldTransform(parentIndex).Translation()
+                : start;
+            debug->AddLine(start, end, Color(0.75f, 0.75f, 0.75f), depthTest);
+        }
     }
 }
 
@@ -472,6 +651,8 @@ void AnimatedModel::SetModel(Model* model, bool createBones)
         // Reserve space for skinning matrices
         skinMatrices_.resize(skeleton_.GetNumBones());
         skeletonData_.resize(skeleton_.GetNumBones());
+        InitializeLocalBoneTransforms(true);
+        CalculateFinalBoneTransforms();
         SetGeometryBoneMappings();
 
         // Reconsider software skinning
@@ -531,11 +712,146 @@ void AnimatedModel::SetAnimationLodBias(float bias)
     animationLodBias_ = Max(bias, 0.0f);
 }
 
+void AnimatedModel::SetAnimationImportance(float importance)
+{
+    animationImportance_ = Max(importance, M_EPSILON);
+}
+
+void AnimatedModel::SetAnimationLodInterpolation(bool enable)
+{
+    animationLodInterpolation_ = enable;
+    if (!animationLodInterpolation_)
+    {
+        animationLodSourcePose_.clear();
+        animationLodTargetPose_.clear();
+    }
+}
+
+void AnimatedModel::SetReducedBonesLodDistance(float distance)
+{
+    reducedBonesLodDistance_ = Max(distance, 0.0f);
+}
+
+void AnimatedModel::SetReducedBonesMaxDepth(unsigned depth)
+{
+    reducedBonesMaxDepth_ = depth;
+}
+
 void AnimatedModel::SetUpdateInvisible(bool enable)
 {
     updateInvisible_ = enable;
 }
 
+void AnimatedModel::SetCreateBoneNodes(bool enable)
+{
+    if (enable == createBoneNodes_)
+        return;
+
+    // When loading, bone nodes are assigned later in ApplyAttributes
+    if (loading_ || !isMaster_ || !model_)
+    {
+        createBoneNodes_ = enable;
+        return;
+    }
+
+    // Remove bone nodes of the previous mode and recreate the skeleton
+    RemoveRootBone();
+    createBoneNodes_ = enable;
+
+    const VariantVector bonesEnabled = GetBonesEnabledAttr();
+    skeleton_.ClearBones();
+    SetSkeleton(model_->GetSkeleton(), true);
+    SetBonesEnabledAttr(bonesEnabled);
+
+    InitializeLocalBoneTransforms(true);
+    skinningDirty_ = true;
+    boneBoundingBoxDirty_ = true;
+    MarkAnimationDirty();
+}
+
+Node* AnimatedModel::ExposeBoneNode(const ea::string& boneName)
+{
+    Bone* bone = skeleton_.GetBone(boneName);
+    if (!bone || !node_)
+        return nullptr;
+
+    if (bone->node_ || createBoneNodes_ || !isMaster_)
+        return bone->node_;
+
+    // Create bone as local, as it is never to be directly synchronized over the network
+    Node* boneNode = node_->CreateChild(boneName, LOCAL);
+    boneNode->SetTemporary(IsTemporary());
+
+    const unsigned boneIndex = skeleton_.GetBoneIndex(bone);
+    exposedBoneNodes_.resize(skeleton_.GetNumBones());
+    exposedBoneNodes_[boneIndex] = boneNode;
+    CalculateFinalBoneTransforms();
+    Vector3 position;
+    Quaternion rotation;
+    Vector3 scale;
+    skeletonData_[boneIndex].localToComponent_.Decompose(position, rotation, scale);
+    boneNode->SetTransform(position, rotation, scale);
+
+    bone->node_ = boneNode;
+    return boneNode;
+}
+
+Matrix3x4 AnimatedModel::GetBoneWorldTransform(unsigned index) const
+{
+    const Bone* bone = index < skeleton_.GetNumBones() ? &skeleton_.GetBones()[index] : nullptr;
+    if (!bone || !node_)
+        return Matrix3x4::IDENTITY;
+
+    if (const AnimatedModel* poseMaster = GetBoneNodeFreeMaster())
+    {
+        const Matrix3x4* boneTransform = GetMasterBoneTransform(*poseMaster, index);
+        return boneTransform ? node_->GetWorldTransform() * *boneTransform : node_->GetWorldTransform();
+    }
+
+    return bone->node_ ? bone->node_->GetWorldTransform() : node_->GetWorldTransform();
+}
+
+bool AnimatedModel::GetQueryBoneTransform(unsigned index, const Matrix3x4& worldTransform,
+    ea::span<const Matrix3x4> boneWorldTransforms, const AnimatedModel* poseMaster, Matrix3x4& transform) const
+{
+    const Bone& bone = skeleton_.GetBones()[index];
+    if (index < boneWorldTransforms.size())
+        transform = boneWorldTransforms[index];
+    else if (!poseMaster)
+    {
+        if (!bone.node_)
+            return false;
+        transform = bone.node_->GetWorldTransform();
+    }
+    else if (const Matrix3x4* boneTransform = GetMasterBoneTransform(*poseMaster, index))
+        transform = worldTransform * *boneTransform;
+    else
+        return false;
+    return true;
+}
+
+void AnimatedModel::CollectHitCapsules(CapsuleBatch& batch, ea::vector<unsigned>& boneIndices,
+    const Matrix3x4& worldTransform, ea::span<const Matrix3x4> boneWorldTransforms) const
+{
+    const ea::vector<Bone>& bones = skeleton_.GetBones();
+    const AnimatedModel* poseMaster = GetBoneNodeFreeMaster();
+
+    for (unsigned i = 0; i < bones.size(); ++i)
+    {
+        const Bone& bone = bones[i];
+        if (bone.hitCapsuleRadius_ <= 0.0f || bone.collisionMask_ == BONECOLLISION_NONE)
+            continue;
+
+        Matrix3x4 transform;
+        if (!GetQueryBoneTransform(i, worldTransform, boneWorldTransforms, poseMaster, transform))
+            continue;
+
+        const Vector3 scale = transform.Scale();
+        batch.Add(transform * bone.hitCapsuleStart_, transform * bone.hitCapsuleEnd_,
+            bone.hitCapsuleRadius_ * Max(scale.x_, Max(scale.y_, scale.z_)));
+        boneIndices.push_back(i);
+    }
+}
 
 void AnimatedModel::SetMorphWeight(unsigned index, float weight)
 {
@@ -665,8 +981,8 @@ void AnimatedModel::SetSkeleton(const Skeleton& skeleton, bool createBones)
 
             for (unsigned i = 0; i < destBones.size(); ++i)
             {
-                if (destBones[i].node_ && destBones[i].name_ == srcBones[i].name_ && destBones[i].parentIndex_ ==
-                                                                                     srcBones[i].parentIndex_)
+                if ((destBones[i].node_ || !createBoneNodes_) && destBones[i].name_ == srcBones[i].name_
+                    && destBones[i].parentIndex_ == srcBones[i].parentIndex_)
                 {
                     // If compatible, just copy the values and retain the old node and animated status
                     Node* boneNode = destBones[i].node_;
@@ -692,6 +1008,9 @@ void AnimatedModel::SetSkeleton(const Skeleton& skeleton, bool createBones)
         // Detach the rootbone of the previous model if any
         if (createBones)
             RemoveRootBone();
+        // Without bone nodes, bones are never created automatically
+        if (!createBoneNodes_)
+            createBones = false;
 
         skeleton_.Define(skeleton);
 
@@ -788,6 +1107,29 @@ VariantVector AnimatedModel::GetBonesEnabledAttr() const
     return ret;
 }
 
+void AnimatedModel::SetExposedBoneNodesAttr(const VariantVector& value)
+{
+    // Just remember the node IDs. They need to go through the SceneResolver, the nodes are found in AssignBoneNodes
+    exposedBoneNodeIDs_.clear();
+    const unsigned numNodes = !value.empty() ? value[0].GetUInt() : 0;
+    for (unsigned i = 1; i <= numNodes && i < value.size(); ++i)
+        exposedBoneNodeIDs_.push_back(value[i].GetUInt());
+    assignBonesPending_ = true;
+}
+
+VariantVector AnimatedModel::GetExposedBoneNodesAttr() const
+{
+    VariantVector ret;
+    ret.push_back(0u);
+    for (const WeakPtr<Node>& boneNode : exposedBoneNodes_)
+    {
+        if (boneNode)
+            ret.push_back(boneNode->GetID());
+    }
+    ret[0] = ret.size() - 1;
+    return ret;
+}
+
 const ea::vector<unsigned char>& AnimatedModel::GetMorphsAttr() const
 {
     attrBuffer_.Clear();
@@ -839,8 +1181,12 @@ void AnimatedModel::OnNodeSet(Node* node)
     if (node)
     {
         // If this AnimatedModel is the first in the node, it is the master which controls animation & morphs
-        isMaster_ = GetComponent<AnimatedModel>() == this;
+        auto* master = GetComponent<AnimatedModel>();
+        isMaster_ = master == this;
+        masterModel_ = isMaster_ ? nullptr : master;
     }
+    else
+        masterModel_ = nullptr;
 }
 
 void AnimatedModel::OnMarkedDirty(Node* node)
@@ -882,8 +1228,36 @@ void AnimatedModel::AssignBoneNodes()
     if (!node_)
         return;
 
-    // Find the bone nodes from the node hierarchy and add listeners
     ea::vector<Bone>& bones = skeleton_.GetModifiableBones();
+
+    // Without bone nodes, only reconnect the exposed ones. They follow the pose and are not listened to
+    if (isMaster_ && !createBoneNodes_)
+    {
+        if (Scene* scene = GetScene())
+        {
+            for (unsigned nodeID : exposedBoneNodeIDs_)
+            {
+                Node* boneNode = scene->GetNode(nodeID);
+                const unsigned boneIndex = boneNode && boneNode->GetParent() == node_
+                    ? skeleton_.GetBoneIndex(boneNode->GetName()) : M_MAX_UNSIGNED;
+                if (boneIndex == M_MAX_UNSIGNED)
+                    continue;
+
+                exposedBoneNodes_.resize(bones.size());
+                exposedBoneNodes_[boneIndex] = boneNode;
+            }
+        }
+        exposedBoneNodeIDs_.clear();
+
+        for (unsigned i = 0; i < bones.size(); ++i)
+            bones[i].node_ = i < exposedBoneNodes_.size() ? exposedBoneNodes_[i].Get() : nullptr;
+
+        if (animationStateSource_)
+            animationStateSource_->MarkAnimationStateTracksDirty();
+        return;
+    }
+
+    // Find the bone nodes from the node hierarchy and add listeners
     bool boneFound = false;
     for (auto i = bones.begin(); i != bones.end(); ++i)
     {
@@ -973,6 +1347,62 @@ void AnimatedModel::RemoveRootBone()
     Bone* rootBone = skeleton_.GetRootBone();
     if (rootBone && rootBone->node_)
         rootBone->node_->Remove();
+
+    // Exposed bone nodes are not parented to each other
+    if (isMaster_ && !createBoneNodes_)
+    {
+        for (Bone& bone : skeleton_.GetModifiableBones())
+            bone.node_ = nullptr;
+    }
+
+    for (const WeakPtr<Node>& boneNode : exposedBoneNodes_)
+    {
+        if (boneNode)
+            boneNode->Remove();
+    }
+    exposedBoneNodes_.clear();
+}
+
+const AnimatedModel* AnimatedModel::GetBoneNodeFreeMaster() const
+{
+    if (isMaster_)
+        return createBoneNodes_ ? nullptr : this;
+
+    // Look up the master again only if the cached one was removed
+    const AnimatedModel* master = masterModel_;
+    if (!master || master->GetNode() != node_)
+        master = node_ ? node_->GetComponent<AnimatedModel>() : nullptr;
+    return master && master != this && !master->createBoneNodes_ ? master : nullptr;
+}
+
+void AnimatedModel::UpdateMasterBoneIndices(const AnimatedModel& master)
+{
+    const ea::vector<Bone>& bones = skeleton_.GetBones();
+    const ea::vector<Bone>& masterBones = master.skeleton_.GetBones();
+
+    // Validate cached indices instead of tracking changes of the master skeleton
+    masterBoneIndices_.resize(bones.size(), M_MAX_UNSIGNED);
+    for (unsigned i = 0; i < bones.size(); ++i)
+    {
+        const unsigned masterIndex = masterBoneIndices_[i];
+        if (masterIndex >= masterBones.size() || masterBones[masterIndex].nameHash_ != bones[i].nameHash_)
+            masterBoneIndices_[i] = master.skeleton_.GetBoneIndex(bones[i].nameHash_);
+    }
+}
+
+const Matrix3x4* AnimatedModel::GetMasterBoneTransform(const AnimatedModel& master, unsigned index) const
+{
+    if (&master == this)
+        return &skeletonData_[index].localToComponent_;
+
+    const ea::vector<Bone>& masterBones = master.skeleton_.GetBones();
+    const StringHash nameHash = skeleton_.GetBones()[index].nameHash_;
+
+    unsigned masterIndex = index < masterBoneIndices_.size() ? masterBoneIndices_[index] : M_MAX_UNSIGNED;
+    if (masterIndex >= masterBones.size() || masterBones[masterIndex].nameHash_ != nameHash)
+        masterIndex = master.skeleton_.GetBoneIndex(nameHash);
+
+    return masterIndex < master.skeletonData_.size() ? &master.skeletonData_[masterIndex].localToComponent_ : nullptr;
 }
 
 void AnimatedModel::MarkAnimationDirty()
@@ -1038,26 +1468,95 @@ void AnimatedModel::SetGeometryBoneMappings()
     }
 }
 
+float AnimatedModel::GetEffectiveAnimationLodDistance() const
+{
+    const Octree* octree = octant_ ? octant_->GetOctree() : nullptr;
+    const float budgetScale = octree ? octree->GetAnimationLodScale() : 1.0f;
+    return animationLodDistance_ * budgetScale / animationImportance_;
+}
+
+unsigned AnimatedModel::GetAnimationLodMaxBoneDepth() const
+{
+    if (reducedBonesLodDistance_ > 0.0f && GetEffectiveAnimationLodDistance() >= reducedBonesLodDistance_)
+        return reducedBonesMaxDepth_;
+    return M_MAX_UNSIGNED;
+}
+
 bool AnimatedModel::UpdateAndCheckAnimationTimers(float timeStep)
 {
     // If using animation LOD, accumulate time and see if it is time to update
-    if (animationLodBias_ > 0.0f && animationLodDistance_ > 0.0f)
+    const float lodDistance = GetEffectiveAnimationLodDistance();
+    if (animationLodBias_ > 0.0f && lodDistance > 0.0f)
     {
+        const float lodTimeScale = animationLodBias_ * ANIMATION_LOD_BASESCALE;
+        animationLodInterval_ = lodDistance / lodTimeScale;
+
         // Perform the first update always regardless of LOD timer
         if (animationLodTimer_ >= 0.0f)
         {
-            animationLodTimer_ += animationLodBias_ * timeStep * ANIMATION_LOD_BASESCALE;
-            if (animationLodTimer_ >= animationLodDistance_)
-                animationLodTimer_ = fmodf(animationLodTimer_, animationLodDistance_);
+            animationLodTimer_ += timeStep * lodTimeScale;
+            if (animationLodTimer_ >= lodDistance)
+                animationLodTimer_ = fmodf(animationLodTimer_, lodDistance);
             else
                 return false;
         }
         else
             animationLodTimer_ = 0.0f;
     }
+    else
+        animationLodInterval_ = 0.0f;
     return true;
 }
 
+void AnimatedModel::CalculateAnimationsWithLod(float timeStep)
+{
+    // Interpolate only if animation is updated less often than every frame
+    const bool interpolate = animationLodInterpolation_ && animationLodInterval_ > timeStep;
+    if (!interpolate)
+    {
+        animationLodSourcePose_.clear();
+        animationLodTargetPose_.clear();
+        CalculateAnimations();
+        return;
+    }
+
+    // Start from the current pose and move towards the new one during the next interval
+    StoreAnimationLodPose(animationLodSourcePose_);
+    CalculateAnimations();
+    StoreAnimationLodPose(animationLodTargetPose_);
+
+    animationLodInterpolationTime_ = 0.0f;
+    InterpolateAnimationLod(timeStep);
+}
+
+void AnimatedModel::InterpolateAnimationLod(float timeStep)
+{
+    URHO3D_ASSERT(animationLodSourcePose_.size() == skeletonData_.size());
+    URHO3D_ASSERT(animationLodTargetPose_.size() == skeletonData_.size());
+
+    animationLodInterpolationTime_ += timeStep;
+    const float factor = animationLodInterval_ > 0.0f ? Min(animationLodInterpolationTime_ / animationLodInterval_, 1.0f) : 1.0f;
+
+    // Bones that are not animated may be driven by something else
+    for (unsigned boneIndex = 0; boneIndex < skeleton_.GetNumBones(); ++boneIndex)
+    {
+        if (skeleton_.GetBone(boneIndex)->animated_)
+        {
+            skeletonData_[boneIndex].localToParent_ =
+                animationLodSourcePose_[boneIndex].Lerp(animationLodTargetPose_[boneIndex], factor);
+        }
+    }
+
+    boneBoundingBoxDirty_ = true;
+}
+
+void AnimatedModel::StoreAnimationLodPose(ea::vector<Transform>& pose) const
+{
+    pose.resize(skeletonData_.size());
+    for (unsigned boneIndex = 0; boneIndex < skeletonData_.size(); ++boneIndex)
+        pose[boneIndex] = skeletonData_[boneIndex].localToParent_;
+}
+
 void AnimatedModel::CalculateAnimations()
 {
     URHO3D_ASSERT(isMaster_);
@@ -1065,8 +1564,18 @@ void AnimatedModel::CalculateAnimations()
     // AnimationStateSource is a weak pointer which may or may not be an issue
     if (AnimationStateSource* animationStateSource = animationStateSource_)
     {
+        const unsigned maxBoneDepth = GetAnimationLodMaxBoneDepth();
         for (AnimationState* state : animationStateSource->GetAnimationStates())
-            state->CalculateModelTracks(skeletonData_);
+            state->CalculateModelTracks(skeletonData_, maxBoneDepth);
+
+        // Report evaluated bones for animation budget
+        if (Octree* octree = octant_ ? octant_->GetOctree() : nullptr)
+        {
+            const auto& bones = skeleton_.GetBones();
+            const auto numEvaluatedBones = ea::count_if(bones.begin(), bones.end(),
+                [&](const Bone& bone) { return bone.animated_ && bone.depth_ <= maxBoneDepth; });
+            octree->AddEvaluatedAnimationBones(numEvaluatedBones);
+        }
     }
 
     animationDirty_ = false;
@@ -1079,6 +1588,10 @@ void AnimatedModel::ApplyAnimation()
     // (first AnimatedModel in a node)
     if (isMaster_)
     {
+        // Pose is applied immediately, stop any interpolation
+        animationLodSourcePose_.clear();
+        animationLodTargetPose_.clear();
+
         InitializeLocalBoneTransforms(false);
         CalculateAnimations();
         CalculateLocalBoundingBox();
@@ -1088,6 +1601,28 @@ void AnimatedModel::ApplyAnimation()
 
 void AnimatedModel::ApplyBoneTransformsToNodes()
 {
+    if (!createBoneNodes_)
+    {
+        // Skin directly from the pose, only exposed bone nodes need to follow it
+        skinningDirty_ = true;
+        ++poseVersion_;
+        for (unsigned boneIndex = 0; boneIndex < skeleton_.GetNumBones(); ++boneIndex)
+        {
+            if (Node* node = skeleton_.GetBone(boneIndex)->node_)
+            {
+                Vector3 position;
+                Quaternion rotation;
+                Vector3 scale;
+                skeletonData_[boneIndex].localToComponent_.Decompose(position, rotation, scale);
+                node->SetTransform(position, rotation, scale);
+            }
+        }
+
+        // Bounding box has changed, reinsert to octree
+        MarkForUpdate();
+        return;
+    }
+
     for (unsigned boneIndex = 0; boneIndex < skeleton_.GetNumBones(); ++boneIndex)
     {
         Bone* bone = skeleton_.GetBone(boneIndex);
@@ -1112,29 +1647,33 @@ void AnimatedModel::UpdateSkinning()
     // Use model's world transform in case a bone is missing
     const Matrix3x4& worldTransform = node_->GetWorldTransform();
 
-    // Skinning with global matrices only
-    if (!geometrySkinMatrices_.size())
+    // Without bone nodes, skin matrices are calculated directly from the pose
+    const AnimatedModel* poseMaster = GetBoneNodeFreeMaster();
+    if (poseMaster && poseMaster != this)
     {
-        for (unsigned i = 0; i < bones.size(); ++i)
+        UpdateMasterBoneIndices(*poseMaster);
+        masterPoseVersion_ = poseMaster->poseVersion_;
+    }
+
+    for (unsigned i = 0; i < bones.size(); ++i)
+    {
+        const Bone& bone = bones[i];
+        if (poseMaster)
         {
-            const Bone& bone = bones[i];
-            if (bone.node_)
-                skinMatrices_[i] = bone.node_->GetWorldTransform() * bone.offsetMatrix_;
-            else
-                skinMatrices_[i] = worldTransform;
+            const Matrix3x4* boneTransform = GetMasterBoneTransform(*poseMaster, i);
+            skinMatrices_[i] = boneTransform ? worldTransform * *boneTransform * bone.offsetMatrix_ : worldTransform;
         }
+        else if (bone.node_)
+            skinMatrices_[i] = bone.node_->GetWorldTransform() * bone.offsetMatrix_;
+        else
+            skinMatrices_[i] = worldTransform;
     }
+
     // Skinning with per-geometry matrices
-    else
+    if (geometrySkinMatrices_.size())
     {
         for (unsigned i = 0; i < bones.size(); ++i)
         {
-            const Bone& bone = bones[i];
-            if (bone.node_)
-                skinMatrices_[i] = bone.node_->GetWorldTransform() * bone.offsetMatrix_;
-            else
-                skinMatrices_[i] = worldTransform;
-
             // Copy the skin matrix to per-geometry matrices as needed
             for (unsigned j = 0; j < geometrySkinMatrixPtrs_[i].size(); ++j)
                 *geometrySkinMatrixPtrs_[i][j] = skinMatrices_[i];
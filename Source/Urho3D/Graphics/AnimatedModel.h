@@ -32,6 +32,8 @@ namespace Urho3D
 
 class Animation;
 class AnimationState;
+class CapsuleBatch;
+class Ray;
 class SoftwareModelAnimator;
 
 /// Animated model component.
@@ -68,6 +70,14 @@ public:
         ea::vector<RayQueryResult>& results);
     /// Process octree raycast. May be called from a worker thread.
     void ProcessRayQuery(const RayOctreeQuery& query, ea::vector<RayQueryResult>& results) override;
+    /// Return hit distance of ray or swept sphere to bone hit capsules, or infinity if no hit. Zero radius performs raycast.
+    /// Bone world transforms are taken from the current pose if not provided. May be called from a worker thread.
+    float SweepHitCapsules(const Ray& ray, float radius, float maxDistance,
+        ea::span<const Matrix3x4> boneWorldTransforms = {}, unsigned* hitBoneIndex = nullptr) const;
+    /// Test ray or swept sphere against bone hit capsules of many models at once.
+    /// Return index of the closest hit model and output hit distance and bone, or M_MAX_UNSIGNED if no hit.
+    static unsigned SweepHitCapsules(ea::span<const AnimatedModel* const> models, const Ray& ray, float radius,
+        float maxDistance, float* hitDistance = nullptr, unsigned* hitBoneIndex = nullptr);
     /// Update before octree reinsertion. Is called from a worker thread.
     void Update(const FrameInfo& frame) override;
     /// Calculate distance and prepare batches for rendering. May be called from worker thread(s), possibly re-entrantly.
@@ -86,9 +96,32 @@ public:
     /// Set animation LOD bias.
     /// @property
     void SetAnimationLodBias(float bias);
+    /// Set animation importance. Animation LOD distance is divided by importance, so important models are updated more often.
+    /// @property
+    void SetAnimationImportance(float importance);
+    /// Set whether to interpolate the pose between sparse animation LOD updates.
+    /// Interpolated pose lags behind the animation by one update interval.
+    /// @property
+    void SetAnimationLodInterpolation(bool enable);
+    /// Set animation LOD distance starting from which only bones up to reduced bones depth are animated. Zero disables bone reduction.
+    /// @property
+    void SetReducedBonesLodDistance(float distance);
+    /// Set max depth of animated bones when bone reduction is active.
+    /// @property
+    void SetReducedBonesMaxDepth(unsigned depth);
+    /// Set whether to use bone hit capsules generated by Model for triangle-level raycasts instead of bone boxes and spheres.
+    /// @property
+    void SetUseHitCapsules(bool enable) { useHitCapsules_ = enable; }
     /// Set whether to update animation and the bounding box when not visible. Recommended to enable for physically controlled models like ragdolls.
     /// @property
     void SetUpdateInvisible(bool enable);
+    /// Set whether to create scene nodes for all bones. If disabled, the skeleton pose is kept in the component
+    /// and bone nodes are only created on demand via ExposeBoneNode. Recreates the bones of the current model.
+    /// @property
+    void SetCreateBoneNodes(bool enable);
+    /// Create (if needed) and return the scene node of the bone. In node-free mode the node is a direct child
+    /// of the model node which follows the bone pose; changes of its transform do not affect the skinning.
+    Node* ExposeBoneNode(const ea::string& boneName);
     /// Set vertex morph weight by index.
     void SetMorphWeight(unsigned index, float weight);
     /// Set vertex morph weight by name.
@@ -111,10 +144,42 @@ public:
     /// @property
     float GetAnimationLodBias() const { return animationLodBias_; }
 
+    /// Return animation importance.
+    /// @property
+    float GetAnimationImportance() const { return animationImportance_; }
+
+    /// Return whether to interpolate the pose between sparse animation LOD updates.
+    /// @property
+    bool GetAnimationLodInterpolation() const { return animationLodInterpolation_; }
+
+    /// Return animation LOD distance starting from which bone reduction is active.
+    /// @property
+    float GetReducedBonesLodDistance() const { return reducedBonesLodDistance_; }
+
+    /// Return max depth of animated bones when bone reduction is active.
+    /// @property
+    unsigned GetReducedBonesMaxDepth() const { return reducedBonesMaxDepth_; }
+
+    /// Return animation LOD distance adjusted by importance and animation bone budget of the Octree.
+    float GetEffectiveAnimationLodDistance() const;
+    /// Return max depth of bones animated with current animation LOD.
+    unsigned GetAnimationLodMaxBoneDepth() const;
+
+    /// Return whether to use bone hit capsules for triangle-level raycasts.
+    /// @property
+    bool GetUseHitCapsules() const { return useHitCapsules_; }
+
     /// Return whether to update animation when not visible.
     /// @property
     bool GetUpdateInvisible() const { return updateInvisible_; }
 
+    /// Return whether to create scene nodes for all bones.
+    /// @property
+    bool GetCreateBoneNodes() const { return createBoneNodes_; }
+
+    /// Return world transform of the bone by index. Works both with and without bone nodes.
+    Matrix3x4 GetBoneWorldTransform(unsigned index) const;
+
     /// Return all vertex morphs.
     const ea::vector<ModelMorph>& GetMorphs() const { return morphs_; }
 
@@ -142,12 +207,16 @@ public:
     void SetBonesEnabledAttr(const VariantVector& value);
     /// Set morphs attribute.
     void SetMorphsAttr(const ea::vector<unsigned char>& value);
+    /// Set exposed bone node IDs attribute.
+    void SetExposedBoneNodesAttr(const VariantVector& value);
     /// Return model attribute.
     ResourceRef GetModelAttr() const;
     /// Return bones' animation enabled attribute.
     VariantVector GetBonesEnabledAttr() const;
     /// Return morphs attribute.
     const ea::vector<unsigned char>& GetMorphsAttr() const;
+    /// Return exposed bone node IDs attribute.
+    VariantVector GetExposedBoneNodesAttr() const;
 
     /// Return per-geometry bone mappings.
     const ea::vector<ea::vector<unsigned> >& GetGeometryBoneMappings() const { return geometryBoneMappings_; }
@@ -171,8 +240,20 @@ private:
     void AssignBoneNodes();
     /// Finalize master model bone bounding boxes by merging from matching non-master bones.. Performed whenever any of the AnimatedModels in the same node changes its model.
     void FinalizeBoneBoundingBoxes();
-    /// Remove (old) skeleton root bone.
+    /// Remove (old) skeleton root bone. In node-free mode also remove exposed bone nodes.
     void RemoveRootBone();
+    /// Return the master model if it keeps the skeleton pose without bone nodes, null otherwise.
+    const AnimatedModel* GetBoneNodeFreeMaster() const;
+    /// Update mapping from own bones to the bones of the master model.
+    void UpdateMasterBoneIndices(const AnimatedModel& master);
+    /// Return model-space transform of the bone in the pose of the master model.
+    const Matrix3x4* GetMasterBoneTransform(const AnimatedModel& master, unsigned index) const;
+    /// Return world transform of the bone for spatial queries. Return false if the bone has no transform.
+    bool GetQueryBoneTransform(unsigned index, const Matrix3x4& worldTransform, ea::span<const Matrix3x4> boneWorldTransforms,
+        const AnimatedModel* poseMaster, Matrix3x4& transform) const;
+    /// Add bone hit capsules in world space to the batch. Output index of each added bone.
+    void CollectHitCapsules(CapsuleBatch& batch, ea::vector<unsigned>& boneIndices, const Matrix3x4& worldTransform,
+        ea::span<const Matrix3x4> boneWorldTransforms) const;
     /// Mark animation and skinning to require an update.
     void MarkAnimationDirty();
     /// Mark morphs to require an update.
@@ -192,6 +273,9 @@ private:
     /// @{
     bool PrepareForThreadedUpdate(Camera* camera, unsigned frameNumber);
     bool UpdateAndCheckAnimationTimers(float timeStep);
+    void CalculateAnimationsWithLod(float timeStep);
+    void InterpolateAnimationLod(float timeStep);
+    void StoreAnimationLodPose(ea::vector<Transform>& pose) const;
 
     void InitializeLocalBoneTransforms(bool reset);
     void CalculateFinalBoneTransforms();
@@ -213,8 +297,14 @@ private:
 
     /// Skeleton.
     Skeleton skeleton_;
-    /// Animation data of Skeleton, used only during Update.
+    /// Animation data of Skeleton. Used only during Update, unless bone nodes are disabled and it stores the pose.
     ea::vector<ModelAnimationOutput> skeletonData_;
+    /// Bone indices in the master model skeleton, used by non-master models if master has no bone nodes.
+    ea::vector<unsigned> masterBoneIndices_;
+    /// Version of the skeleton pose, incremented whenever the pose changes in node-free mode.
+    unsigned poseVersion_{};
+    /// Last seen version of the master model pose.
+    unsigned masterPoseVersion_{};
     /// Component that provides animation states for the model.
     WeakPtr<AnimationStateSource> animationStateSource_;
     /// Software model animator.
@@ -241,8 +331,35 @@ private:
     float animationLodTimer_;
     /// Animation LOD distance, the minimum of all LOD view distances last frame.
     float animationLodDistance_;
+    /// Interval between animation LOD updates in seconds. Zero if animation LOD is not active.
+    float animationLodInterval_{};
+    /// Animation importance.
+    float animationImportance_{1.0f};
+    /// Animation LOD distance starting from which bone reduction is active.
+    float reducedBonesLodDistance_{};
+    /// Max depth of animated bones when bone reduction is active.
+    unsigned reducedBonesMaxDepth_{2};
+    /// Whether to interpolate the pose between sparse animation LOD updates.
+    bool animationLodInterpolation_{};
+    /// Time elapsed since the last animation LOD update.
+    float animationLodInterpolationTime_{};
+    /// Poses interpolated between animation LOD updates. Empty if interpolation is not active.
+    /// @{
+    ea::vector<Transform> animationLodSourcePose_;
+    ea::vector<Transform> animationLodTargetPose_;
+    /// @}
+    /// Whether to use bone hit capsules for triangle-level raycasts.
+    bool useHitCapsules_{false};
     /// Update animation when invisible flag.
     bool updateInvisible_;
+    /// Whether to create scene nodes for all bones.
+    bool createBoneNodes_{true};
+    /// Bone nodes created by ExposeBoneNode in node-free mode, indexed by bone.
+    ea::vector<WeakPtr<Node>> exposedBoneNodes_;
+    /// IDs of exposed bone nodes to be resolved in AssignBoneNodes.
+    ea::vector<unsigned> exposedBoneNodeIDs_;
+    /// Cached master model if this model is not the master.
+    WeakPtr<AnimatedModel> masterModel_;
     /// Software skinning flag.
     bool softwareSkinning_{};
     /// Number of bones used for software skinning.
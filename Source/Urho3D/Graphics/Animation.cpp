@@ -186,6 +186,7 @@ bool Animation::LoadXML(const XMLElement& source)
 
     LoadTriggersFromXML(source);
     LoadMetadataFromXML(source);
+    LoadCompressionFromXML(source);
 
     return true;
 }
@@ -286,6 +287,18 @@ bool Animation::BeginLoad(Deserializer& source)
         }
     }
 
+    // Read compressed tracks
+    if (version >= compressedVersion && source.ReadBool())
+    {
+        compressed_ = MakeShared<CompressedAnimation>();
+        if (!compressed_->Load(source))
+        {
+            URHO3D_LOGERROR(source.GetName() + " has invalid compressed animation data");
+            compressed_ = nullptr;
+            return false;
+        }
+    }
+
     // Optionally read triggers from an XML file
     ea::string xmlName = ReplaceExtension(GetName(), ".xml");
 
@@ -295,12 +308,14 @@ bool Animation::BeginLoad(Deserializer& source)
         XMLElement rootElem = file->GetRoot();
         LoadTriggersFromXML(rootElem);
         LoadMetadataFromXML(rootElem);
+        LoadCompressionFromXML(rootElem);
 
         memoryUse += triggers_.size() * sizeof(AnimationTriggerPoint);
-        SetMemoryUse(memoryUse);
-        return true;
     }
 
+    if (compressed_)
+        memoryUse += compressed_->GetMemoryUse();
+
     SetMemoryUse(memoryUse);
     return true;
 }
@@ -316,6 +331,25 @@ void Animation::LoadTriggersFromXML(const XMLElement& source)
     }
 }
 
+void Animation::LoadCompressionFromXML(const XMLElement& source)
+{
+    const XMLElement compressionElem = source.GetChild("compression");
+    if (!compressionElem || compressed_)
+        return;
+
+    AnimationCompressionSettings settings;
+    if (compressionElem.HasAttribute("position"))
+        settings.positionTolerance_ = compressionElem.GetFloat("position");
+    if (compressionElem.HasAttribute("rotation"))
+        settings.rotationTolerance_ = compressionElem.GetFloat("rotation");
+    if (compressionElem.HasAttribute("scale"))
+        settings.scaleTolerance_ = compressionElem.GetFloat("scale");
+
+    AnimationCompressionStats stats;
+    if (Compress(settings, &stats))
+        URHO3D_LOGDEBUG("Animation {} is compressed: {}", GetName(), stats.ToString());
+}
+
 bool Animation::Save(Serializer& dest) const
 {
     // Write ID, name and length
@@ -375,6 +409,11 @@ bool Animation::Save(Serializer& dest) const
         }
     }
 
+    // Write compressed tracks
+    dest.WriteBool(compressed_ != nullptr);
+    if (compressed_)
+        compressed_->Save(dest);
+
     // If triggers have been defined, write an XML file for them
     if (!triggers_.empty() || HasMetadata())
     {
@@ -459,6 +498,7 @@ void Animation::RemoveAllTracks()
 {
     tracks_.clear();
     variantTracks_.clear();
+    compressed_ = nullptr;
 }
 
 void Animation::SetTrigger(unsigned index, const AnimationTriggerPoint& trigger)
@@ -513,6 +553,7 @@ SharedPtr<Animation> Animation::Clone(const ea::string& cloneName) const
     ret->length_ = length_;
     ret->tracks_ = tracks_;
     ret->triggers_ = triggers_;
+    ret->compressed_ = compressed_;
     ret->CopyMetadata(*this);
     ret->SetMemoryUse(GetMemoryUse());
 
@@ -569,6 +610,7 @@ AnimationTriggerPoint* Animation::GetTrigger(unsigned index)
 void Animation::SetTracks(const ea::vector<AnimationTrack>& tracks)
 {
     tracks_.clear();
+    compressed_ = nullptr;
 
     for (auto itr = tracks.begin(); itr != tracks.end(); itr++)
     {
@@ -576,4 +618,39 @@ void Animation::SetTracks(const ea::vector<AnimationTrack>& tracks)
     }
 }
 
+bool Animation::Compress(const AnimationCompressionSettings& settings, AnimationCompressionStats* stats)
+{
+    if (compressed_)
+        Decompress();
+
+    ea::vector<const AnimationTrack*> tracks;
+    for (const auto& [nameHash, track] : tracks_)
+        tracks.push_back(&track);
+
+    compressed_ = CompressedAnimation::Compress(tracks, length_, settings, stats);
+    if (!compressed_)
+        return false;
+
+    for (auto& [nameHash, track] : tracks_)
+    {
+        track.keyFrames_.clear();
+        track.keyFrames_.shrink_to_fit();
+    }
+    return true;
+}
+
+void Animation::Decompress()
+{
+    if (!compressed_)
+        return;
+
+    for (auto& [nameHash, track] : tracks_)
+    {
+        const unsigned trackIndex = compressed_->GetTrackIndex(nameHash);
+        if (trackIndex != M_MAX_UNSIGNED)
+            compressed_->Decompress(trackIndex, track);
+    }
+    compressed_ = nullptr;
+}
+
 }
@@ -25,6 +25,7 @@
 #pragma once
 
 #include "../Graphics/AnimationTrack.h"
+#include "../Graphics/CompressedAnimation.h"
 #include "../Container/Ptr.h"
 #include "../Resource/Resource.h"
 
@@ -144,15 +145,28 @@ public:
     /// Set all animation tracks.
     void SetTracks(const ea::vector<AnimationTrack>& tracks);
 
+    /// Compress transform tracks. Keyframes of the tracks are released, track names and channel masks are kept.
+    /// This is unsafe if the animation is currently used in playback. Return true if successful.
+    bool Compress(const AnimationCompressionSettings& settings, AnimationCompressionStats* stats = nullptr);
+    /// Restore keyframes of compressed transform tracks. This is unsafe if the animation is currently used in playback.
+    void Decompress();
+    /// Return whether the transform tracks are compressed.
+    bool IsCompressed() const { return compressed_ != nullptr; }
+    /// Return compressed transform tracks, if any.
+    const CompressedAnimation* GetCompressedData() const { return compressed_; }
+
 private:
     void LoadTriggersFromXML(const XMLElement& source);
+    /// Compress tracks if requested by XML element.
+    void LoadCompressionFromXML(const XMLElement& source);
 
     /// Class versions (used for serialization)
     /// @{
     static const unsigned legacyVersion = 1; // Fake version for legacy unversioned UANI file
     static const unsigned variantTrackVersion = 2; // VariantAnimationTrack support added here
+    static const unsigned compressedVersion = 3; // CompressedAnimation support added here
 
-    static const unsigned currentVersion = variantTrackVersion;
+    static const unsigned currentVersion = compressedVersion;
     /// @}
 
     /// Animation name.
@@ -167,6 +181,8 @@ private:
     ea::unordered_map<StringHash, VariantAnimationTrack> variantTracks_;
     /// Animation trigger points.
     ea::vector<AnimationTriggerPoint> triggers_;
+    /// Compressed transform tracks.
+    SharedPtr<CompressedAnimation> compressed_;
 };
 
 }
@@ -29,7 +29,9 @@
 #include "../Graphics/AnimationController.h"
 #include "../Graphics/AnimationState.h"
 #include "../Graphics/DrawableEvents.h"
+#include "../Graphics/Octree.h"
 #include "../Graphics/Renderer.h"
+#include "../IO/BitBuffer.h"
 #include "../IO/FileSystem.h"
 #include "../IO/Log.h"
 #include "../IO/MemoryBuffer.h"
@@ -87,6 +89,53 @@ enum class AnimationParameterMask
 };
 URHO3D_FLAGSET(AnimationParameterMask, AnimationParameterFlags);
 
+/// Number of bits used to store AnimationParameterFlags.
+const unsigned NumAnimationParameterBits = 15;
+
+/// Return flags of non-default parameters that should be serialized.
+AnimationParameterFlags GetSerializationFlags(const AnimationParameters& params)
+{
+    AnimationParameterFlags flags;
+    flags.Set(AnimationParameterMask::InstanceIndex, params.instanceIndex_ != 0);
+    flags.Set(AnimationParameterMask::Looped, params.looped_);
+    flags.Set(AnimationParameterMask::RemoveOnCompletion, params.removeOnCompletion_);
+    flags.Set(AnimationParameterMask::Layer, params.layer_ != 0);
+    flags.Set(AnimationParameterMask::Additive, params.blendMode_ == ABM_ADDITIVE);
+    flags.Set(AnimationParameterMask::StartBone, params.startBone_.empty());
+    flags.Set(AnimationParameterMask::AutoFadeOutTime, params.autoFadeOutTime_ != 0.0f);
+    flags.Set(AnimationParameterMask::Time, params.time_.Value() != 0.0f);
+    flags.Set(AnimationParameterMask::MinTime, params.time_.Min() != 0.0f);
+    flags.Set(AnimationParameterMask::MaxTime, params.animation_ && params.time_.Max() != params.animation_->GetLength());
+    flags.Set(AnimationParameterMask::Speed, params.speed_ != 1.0f);
+    flags.Set(AnimationParameterMask::RemoveOnZeroWeight, params.removeOnZeroWeight_);
+    flags.Set(AnimationParameterMask::Weight, params.weight_ != 1.0f);
+    flags.Set(AnimationParameterMask::TargetWeight, params.targetWeight_ != 1.0f);
+    flags.Set(AnimationParameterMask::TargetWeightDelay, params.targetWeightDelay_ != 0.0f);
+
+    return flags;
+}
+
+/// Return whether the bone is the start bone or its descendant. Any bone matches if there is no start bone.
+bool IsBoneInSubtree(const Skeleton& skeleton, unsigned boneIndex, unsigned startBoneIndex)
+{
+    const ea::vector<Bone>& bones = skeleton.GetBones();
+    if (startBoneIndex >= bones.size())
+        return true;
+
+    // Limit number of steps in case of malformed skeleton
+    for (unsigned i = 0; i < bones.size(); ++i)
+    {
+        if (boneIndex == startBoneIndex)
+            return true;
+
+        const unsigned parentIndex = bones[boneIndex].parentIndex_;
+        if (parentIndex == boneIndex || parentIndex >= bones.size())
+            return false;
+        boneIndex = parentIndex;
+    }
+    return false;
+}
+
 }
 
 extern const char* LOGIC_CATEGORY;
@@ -294,23 +343,7 @@ AnimationParameters AnimationParameters::Deserialize(Animation* animation, Deser
 
 void AnimationParameters::Serialize(Serializer& dest) const
 {
-    AnimationParameterFlags flags;
-    flags.Set(AnimationParameterMask::InstanceIndex, instanceIndex_ != 0);
-    flags.Set(AnimationParameterMask::Looped, looped_);
-    flags.Set(AnimationParameterMask::RemoveOnCompletion, removeOnCompletion_);
-    flags.Set(AnimationParameterMask::Layer, layer_ != 0);
-    flags.Set(AnimationParameterMask::Additive, blendMode_ == ABM_ADDITIVE);
-    flags.Set(AnimationParameterMask::StartBone, startBone_.empty());
-    flags.Set(AnimationParameterMask::AutoFadeOutTime, autoFadeOutTime_ != 0.0f);
-    flags.Set(AnimationParameterMask::Time, time_.Value() != 0.0f);
-    flags.Set(AnimationParameterMask::MinTime, time_.Min() != 0.0f);
-    flags.Set(AnimationParameterMask::MaxTime, animation_ && time_.Max() != animation_->GetLength());
-    flags.Set(AnimationParameterMask::Speed, speed_ != 1.0f);
-    flags.Set(AnimationParameterMask::RemoveOnZeroWeight, removeOnZeroWeight_);
-    flags.Set(AnimationParameterMask::Weight, weight_ != 1.0f);
-    flags.Set(AnimationParameterMask::TargetWeight, targetWeight_ != 1.0f);
-    flags.Set(AnimationParameterMask::TargetWeightDelay, targetWeightDelay_ != 0.0f);
-
+    const AnimationParameterFlags flags = GetSerializationFlags(*this);
     dest.WriteVLE(flags.AsInteger());
     if (flags.Test(AnimationParameterMask::InstanceIndex))
         dest.WriteVLE(instanceIndex_);
@@ -336,6 +369,101 @@ void AnimationParameters::Serialize(Serializer& dest) const
         dest.WriteFloat(targetWeightDelay_);
 }
 
+AnimationParameters AnimationParameters::DeserializeQuantized(Animation* animation, BitBuffer& src, unsigned numBits)
+{
+    AnimationParameters result{animation};
+
+    const auto flags = static_cast<AnimationParameterFlags>(src.ReadBits(NumAnimationParameterBits));
+
+    if (flags.Test(AnimationParameterMask::InstanceIndex))
+        result.instanceIndex_ = src.ReadVLE();
+
+    result.looped_ = flags.Test(AnimationParameterMask::Looped);
+
+    result.removeOnCompletion_ = flags.Test(AnimationParameterMask::RemoveOnCompletion);
+
+    if (flags.Test(AnimationParameterMask::Layer))
+        result.layer_ = src.ReadVLE();
+
+    result.blendMode_ = flags.Test(AnimationParameterMask::Additive) ? ABM_ADDITIVE : ABM_LERP;
+
+    if (flags.Test(AnimationParameterMask::StartBone))
+        result.startBone_ = src.ReadString();
+
+    if (flags.Test(AnimationParameterMask::AutoFadeOutTime))
+        result.autoFadeOutTime_ = src.ReadHalfFloat();
+
+    float minTime = 0.0f;
+    float maxTime = result.animation_ ? result.animation_->GetLength() : 0.0f;
+
+    if (flags.Test(AnimationParameterMask::MinTime))
+        minTime = src.ReadFloat();
+    if (flags.Test(AnimationParameterMask::MaxTime))
+        maxTime = src.ReadFloat();
+
+    float time = 0.0f;
+    if (flags.Test(AnimationParameterMask::Time))
+    {
+        const bool isQuantized = src.ReadBool();
+        time = isQuantized ? src.ReadQuantizedFloat(minTime, maxTime, numBits) : src.ReadFloat();
+    }
+
+    result.time_ = {time, minTime, maxTime};
+
+    if (flags.Test(AnimationParameterMask::Speed))
+        result.speed_ = src.ReadHalfFloat();
+
+    result.removeOnZeroWeight_ = flags.Test(AnimationParameterMask::RemoveOnZeroWeight);
+
+    if (flags.Test(AnimationParameterMask::Weight))
+        result.weight_ = src.ReadQuantizedFloat(0.0f, 1.0f, numBits);
+
+    if (flags.Test(AnimationParameterMask::TargetWeight))
+        result.targetWeight_ = src.ReadQuantizedFloat(0.0f, 1.0f, numBits);
+
+    if (flags.Test(AnimationParameterMask::TargetWeightDelay))
+        result.targetWeightDelay_ = src.ReadHalfFloat();
+
+    return result;
+}
+
+void AnimationParameters::SerializeQuantized(BitBuffer& dest, unsigned numBits) const
+{
+    const AnimationParameterFlags flags = GetSerializationFlags(*this);
+    dest.WriteBits(flags.AsInteger(), NumAnimationParameterBits);
+    if (flags.Test(AnimationParameterMask::InstanceIndex))
+        dest.WriteVLE(instanceIndex_);
+    if (flags.Test(AnimationParameterMask::Layer))
+        dest.WriteVLE(layer_);
+    if (flags.Test(AnimationParameterMask::StartBone))
+        dest.WriteString(startBone_);
+    if (flags.Test(AnimationParameterMask::AutoFadeOutTime))
+        dest.WriteHalfFloat(autoFadeOutTime_);
+    if (flags.Test(AnimationParameterMask::MinTime))
+        dest.WriteFloat(time_.Min());
+    if (flags.Test(AnimationParameterMask::MaxTime))
+        dest.WriteFloat(time_.Max());
+    if (flags.Test(AnimationParameterMask::Time))
+    {
+        // Time may be outside of the range for non-looped animations, keep full precision in this case
+        const float time = time_.Value();
+        const bool isQuantized = time_.Min() < time_.Max() && time >= time_.Min() && time <= time_.Max();
+        dest.WriteBool(isQuantized);
+        if (isQuantized)
+            dest.WriteQuantizedFloat(time, time_.Min(), time_.Max(), numBits);
+        else
+            dest.WriteFloat(time);
+    }
+    if (flags.Test(AnimationParameterMask::Speed))
+        dest.WriteHalfFloat(speed_);
+    if (flags.Test(AnimationParameterMask::Weight))
+        dest.WriteQuantizedFloat(weight_, 0.0f, 1.0f, numBits);
+    if (flags.Test(AnimationParameterMask::TargetWeight))
+        dest.WriteQuantizedFloat(targetWeight_, 0.0f, 1.0f, numBits);
+    if (flags.Test(AnimationParameterMask::TargetWeightDelay))
+        dest.WriteHalfFloat(targetWeightDelay_);
+}
+
 bool AnimationParameters::IsMergeableWith(const AnimationParameters& rhs) const
 {
     return animation_ == rhs.animation_ && instanceIndex_ == rhs.instanceIndex_;
@@ -365,7 +493,11 @@ AnimationController::AnimationController(Context* context) :
 {
 }
 
-AnimationController::~AnimationController() = default;
+AnimationController::~AnimationController()
+{
+    if (updateOctree_)
+        updateOctree_->RemoveAnimationController(this);
+}
 
 void AnimationController::RegisterObject(Context* context)
 {
@@ -383,17 +515,17 @@ void AnimationController::ApplyAttributes()
 
 void AnimationController::OnSetEnabled()
 {
-    Scene* scene = GetScene();
-    if (scene)
-    {
-        if (IsEnabledEffective())
-            SubscribeToEvent(scene, E_SCENEPOSTUPDATE, URHO3D_HANDLER(AnimationController, HandleScenePostUpdate));
-        else
-            UnsubscribeFromEvent(scene, E_SCENEPOSTUPDATE);
-    }
+    UpdateEventSubscription();
 }
 
 void AnimationController::Update(float timeStep)
+{
+    PrepareUpdate();
+    UpdateAnimationStates(timeStep);
+    CommitUpdate();
+}
+
+void AnimationController::PrepareUpdate()
 {
     // Update stats
     if (auto renderer = GetSubsystem<Renderer>())
@@ -411,6 +543,17 @@ void AnimationController::Update(float timeStep)
         revisionDirty_ = false;
     }
 
+    // Update animation tracks if necessary.
+    // Tracks are resolved before animations are advanced because it may access arbitrary nodes and components.
+    for (const AnimationInstance& instance : animations_)
+    {
+        if (instance.state_->AreTracksDirty())
+            UpdateAnimationStateTracks(instance.state_);
+    }
+}
+
+void AnimationController::UpdateAnimationStates(float timeStep)
+{
     // Update individual animations
     pendingTriggers_.clear();
     for (auto& [params, state] : animations_)
@@ -426,14 +569,10 @@ void AnimationController::Update(float timeStep)
     // Sort animation states if necessary
     if (animationStatesDirty_)
         SortAnimationStates();
+}
 
-    // Update animation tracks if necessary
-    for (AnimationState* state : animationStates_)
-    {
-        if (state->AreTracksDirty())
-            UpdateAnimationStateTracks(state);
-    }
-
+void AnimationController::CommitUpdate()
+{
     // Node and attribute animations need to be applied manually
     CommitNodeAndAttributeAnimations();
 }
@@ -926,12 +1065,48 @@ void AnimationController::OnNodeSet(Node* node)
 
 void AnimationController::OnSceneSet(Scene* scene)
 {
-    if (scene && IsEnabledEffective())
+    if (scene)
+        UpdateEventSubscription();
+    else
+    {
+        if (updateOctree_)
+            updateOctree_->RemoveAnimationController(this);
+        updateOctree_ = nullptr;
+        UnsubscribeFromEvent(E_SCENEPOSTUPDATE);
+    }
+}
+
+void AnimationController::UpdateEventSubscription()
+{
+    Scene* scene = GetScene();
+    Octree* octree = scene && IsEnabledEffective() && IsBatchUpdateSupported() ? scene->GetComponent<Octree>() : nullptr;
+
+    if (updateOctree_ != octree)
+    {
+        if (updateOctree_)
+            updateOctree_->RemoveAnimationController(this);
+        updateOctree_ = octree;
+        if (updateOctree_)
+            updateOctree_->AddAnimationController(this);
+    }
+
+    // Fallback to individual update if there's no Octree in the scene
+    if (scene && IsEnabledEffective() && !octree)
         SubscribeToEvent(scene, E_SCENEPOSTUPDATE, URHO3D_HANDLER(AnimationController, HandleScenePostUpdate));
-    else if (!scene)
+    else
         UnsubscribeFromEvent(E_SCENEPOSTUPDATE);
 }
 
+void AnimationController::DisconnectFromOctree()
+{
+    updateOctree_ = nullptr;
+    updateOctreeIndex_ = M_MAX_UNSIGNED;
+
+    Scene* scene = GetScene();
+    if (scene && IsEnabledEffective())
+        SubscribeToEvent(scene, E_SCENEPOSTUPDATE, URHO3D_HANDLER(AnimationController, HandleScenePostUpdate));
+}
+
 void AnimationController::HandleScenePostUpdate(StringHash eventType, VariantMap& eventData)
 {
     using namespace ScenePostUpdate;
@@ -1165,6 +1340,11 @@ void AnimationController::UpdateAnimationStateTracks(AnimationState* state)
     if (!startNode)
         startNode = node_;
 
+    // Without bone nodes, bone tracks are filtered by the skeleton hierarchy instead
+    const bool boneNodesEnabled = !model || model->GetCreateBoneNodes();
+    const unsigned startBoneIndex = model && !startBoneName.empty()
+        ? model->GetSkeleton().GetBoneIndex(startBoneName) : M_MAX_UNSIGNED;
+
     // Setup model and node tracks
     const auto& tracks = animation->GetTracks();
     for (const auto& item : tracks)
@@ -1174,7 +1354,10 @@ void AnimationController::UpdateAnimationStateTracks(AnimationState* state)
         // Try to find bone first, filter by start bone node
         const unsigned trackBoneIndex = model ? model->GetSkeleton().GetBoneIndex(track.nameHash_) : M_MAX_UNSIGNED;
         Bone* trackBone = trackBoneIndex != M_MAX_UNSIGNED ? model->GetSkeleton().GetBone(trackBoneIndex) : nullptr;
-        if (trackBone && trackBone->node_ && (startNode == node_ || trackBone->node_->IsChildOf(startNode)))
+        const bool isBoneTrackEnabled = trackBone && (boneNodesEnabled
+            ? trackBone->node_ && (startNode == node_ || trackBone->node_->IsChildOf(startNode))
+            : IsBoneInSubtree(model->GetSkeleton(), trackBoneIndex, startBoneIndex));
+        if (isBoneTrackEnabled)
         {
             ModelAnimationStateTrack stateTrack;
             stateTrack.track_ = &track;
@@ -1185,6 +1368,10 @@ void AnimationController::UpdateAnimationStateTracks(AnimationState* state)
             continue;
         }
 
+        // Exposed bone nodes are driven by the model and should not be animated as stray nodes
+        if (trackBone && !boneNodesEnabled)
+            continue;
+
         // Find stray node otherwise
         Node* trackNode = GetTrackNodeByNameHash(track.nameHash_, startNode);
         if (trackNode)
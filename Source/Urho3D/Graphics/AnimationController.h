@@ -37,7 +37,9 @@ namespace Urho3D
 class AnimatedModel;
 class Animation;
 struct AnimationTriggerPoint;
+class BitBuffer;
 struct Bone;
+class Octree;
 
 /// State and parameters of playing Animation.
 struct URHO3D_API AnimationParameters
@@ -103,6 +105,12 @@ struct URHO3D_API AnimationParameters
     static AnimationParameters Deserialize(Animation* animation, Deserializer& src);
     void Serialize(Serializer& dest) const;
 
+    /// Compact serialization used for network replication.
+    /// Time and weights are quantized to given number of bits, weights are clamped to [0, 1].
+    /// Other floats are stored with half precision.
+    static AnimationParameters DeserializeQuantized(Animation* animation, BitBuffer& src, unsigned numBits);
+    void SerializeQuantized(BitBuffer& dest, unsigned numBits) const;
+
     bool IsMergeableWith(const AnimationParameters& rhs) const;
 
     bool operator==(const AnimationParameters& rhs) const;
@@ -115,6 +123,8 @@ class URHO3D_API AnimationController : public AnimationStateSource
 {
     URHO3D_OBJECT(AnimationController, AnimationStateSource);
 
+    friend class Octree;
+
 public:
     /// Construct.
     explicit AnimationController(Context* context);
@@ -132,8 +142,11 @@ public:
     /// Should be called on every substantial change in animated structure.
     void MarkAnimationStateTracksDirty() override;
 
-    /// Update the animations. Is called from HandleScenePostUpdate().
+    /// Update the animations. Is called from HandleScenePostUpdate() unless updated by the Octree in batch.
     virtual void Update(float timeStep);
+    /// Return whether the Octree may update this controller in batch without calling Update.
+    /// Derived types are updated via Update by default, override to opt in if Update is not overridden.
+    virtual bool IsBatchUpdateSupported() const { return GetType() == AnimationController::GetTypeStatic(); }
     /// Smoothly replace existing animations with animations from external source.
     void ReplaceAnimations(ea::span<const AnimationParameters> newAnimations, float elapsedTime, float fadeTime);
 
@@ -201,6 +214,10 @@ protected:
 private:
     /// Handle scene post-update event.
     void HandleScenePostUpdate(StringHash eventType, VariantMap& eventData);
+    /// Subscribe to scene post-update or connect to the Octree for batched update.
+    void UpdateEventSubscription();
+    /// Called by the Octree when it stops updating the controller.
+    void DisconnectFromOctree();
     /// Sort animations states according to the layers.
     void SortAnimationStates();
     /// Update animation state tracks so they are connected to correct animatable objects.
@@ -226,6 +243,13 @@ private:
     void UpdateState(AnimationState* state, const AnimationParameters& params) const;
     /// @}
 
+    /// Update split into stages. Only UpdateAnimationStates may be called from worker threads.
+    /// @{
+    void PrepareUpdate();
+    void UpdateAnimationStates(float timeStep);
+    void CommitUpdate();
+    /// @}
+
     void CommitNodeAndAttributeAnimations();
     void SendTriggerEvents();
 
@@ -254,6 +278,11 @@ private:
     /// TODO: Revisit allocations?
     ea::unordered_map<Node*, NodeAnimationOutput> animatedNodes_;
     ea::unordered_map<AnimatedAttributeReference, Variant> animatedAttributes_;
+
+    /// Octree that updates the controller in batch, if any.
+    WeakPtr<Octree> updateOctree_;
+    /// Index in the list of batched controllers of the Octree.
+    unsigned updateOctreeIndex_{M_MAX_UNSIGNED};
 };
 
 }
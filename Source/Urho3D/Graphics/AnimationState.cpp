@@ -158,12 +158,16 @@ void AnimationState::ClearAllTracks()
 
 void AnimationState::AddModelTrack(const ModelAnimationStateTrack& track)
 {
-    modelTracks_.push_back(track);
+    ModelAnimationStateTrack& stateTrack = modelTracks_.emplace_back(track);
+    if (const CompressedAnimation* compressed = animation_ ? animation_->GetCompressedData() : nullptr)
+        stateTrack.compressedTrackIndex_ = compressed->GetTrackIndex(track.track_->nameHash_);
 }
 
 void AnimationState::AddNodeTrack(const NodeAnimationStateTrack& track)
 {
-    nodeTracks_.push_back(track);
+    NodeAnimationStateTrack& stateTrack = nodeTracks_.emplace_back(track);
+    if (const CompressedAnimation* compressed = animation_ ? animation_->GetCompressedData() : nullptr)
+        stateTrack.compressedTrackIndex_ = compressed->GetTrackIndex(track.track_->nameHash_);
 }
 
 void AnimationState::AddAttributeTrack(const AttributeAnimationStateTrack& track)
@@ -174,6 +178,8 @@ void AnimationState::AddAttributeTrack(const AttributeAnimationStateTrack& track
 void AnimationState::OnTracksReady()
 {
     tracksDirty_ = false;
+    compressedPose_.clear();
+    compressedKeyHints_.clear();
     if (model_)
         model_->MarkAnimationDirty();
 }
@@ -231,23 +237,21 @@ float AnimationState::GetLength() const
     return animation_ ? animation_->GetLength() : 0.0f;
 }
 
-void AnimationState::CalculateModelTracks(ea::vector<ModelAnimationOutput>& output) const
+void AnimationState::CalculateModelTracks(ea::vector<ModelAnimationOutput>& output, unsigned maxBoneDepth) const
 {
     if (!animation_ || !IsEnabled())
         return;
 
+    const CompressedAnimation* compressed = SampleCompressedTracks();
     for (const ModelAnimationStateTrack& stateTrack : modelTracks_)
     {
-        // Do not apply if the bone has animation disabled
-        if (!stateTrack.bone_->animated_)
+        // Do not apply if the bone has animation disabled or is skipped due to animation LOD
+        if (!stateTrack.bone_->animated_ || stateTrack.bone_->depth_ > maxBoneDepth)
             continue;
 
         URHO3D_ASSERT(output.size() > stateTrack.boneIndex_);
         ModelAnimationOutput& trackOutput = output[stateTrack.boneIndex_];
-
-        unsigned keyFrame = stateTrack.keyFrame_;
-        CalulcateTransformTrack(trackOutput, *stateTrack.track_, keyFrame, weight_);
-        stateTrack.keyFrame_ = keyFrame;
+        CalulcateTransformTrack(trackOutput, stateTrack, compressed, weight_);
     }
 }
 
@@ -256,13 +260,11 @@ void AnimationState::CalculateNodeTracks(ea::unordered_map<Node*, NodeAnimationO
     if (!animation_ || !IsEnabled())
         return;
 
+    const CompressedAnimation* compressed = SampleCompressedTracks();
     for (const NodeAnimationStateTrack& stateTrack : nodeTracks_)
     {
         NodeAnimationOutput& trackOutput = output[stateTrack.node_.Get()];
-
-        unsigned keyFrame = stateTrack.keyFrame_;
-        CalulcateTransformTrack(trackOutput, *stateTrack.track_, keyFrame, weight_);
-        stateTrack.keyFrame_ = keyFrame;
+        CalulcateTransformTrack(trackOutput, stateTrack, compressed, weight_);
     }
 }
 
@@ -281,27 +283,57 @@ void AnimationState::CalculateAttributeTracks(ea::unordered_map<AnimatedAttribut
     }
 }
 
-void AnimationState::CalulcateTransformTrack(NodeAnimationOutput& output, const AnimationTrack& track, unsigned& frame, float weight) const
+const CompressedAnimation* AnimationState::SampleCompressedTracks() const
 {
-    if (track.keyFrames_.empty())
+    const CompressedAnimation* compressed = animation_->GetCompressedData();
+    if (!compressed)
+        return nullptr;
+
+    if (compressedPose_.size() != compressed->GetNumTracks() || compressedKeyHints_.size() != compressed->GetNumKeyHints())
+    {
+        compressedPose_.resize(compressed->GetNumTracks());
+        compressedKeyHints_.clear();
+        compressedKeyHints_.resize(compressed->GetNumKeyHints());
+    }
+
+    compressed->Sample(time_, looped_, compressedKeyHints_, compressedPose_);
+    return compressed;
+}
+
+void AnimationState::CalulcateTransformTrack(NodeAnimationOutput& output, const NodeAnimationStateTrack& stateTrack,
+    const CompressedAnimation* compressed, float weight) const
+{
+    const AnimationTrack& track = *stateTrack.track_;
+    const unsigned compressedTrackIndex = stateTrack.compressedTrackIndex_;
+    if (compressed && compressedTrackIndex < compressed->GetNumTracks())
+    {
+        ApplyTransformTrack(output, track.channelMask_, compressed->GetBaseValue(compressedTrackIndex),
+            compressedPose_[compressedTrackIndex], weight);
         return;
+    }
 
-    const bool isFullWeight = Equals(weight, 1.0f);
-    const AnimationKeyFrame& baseValue = track.keyFrames_.front();
+    if (track.keyFrames_.empty())
+        return;
 
     Transform sampledValue;
-    track.Sample(time_, animation_->GetLength(), looped_, frame, sampledValue);
+    track.Sample(time_, animation_->GetLength(), looped_, stateTrack.keyFrame_, sampledValue);
+    ApplyTransformTrack(output, track.channelMask_, track.keyFrames_.front(), sampledValue, weight);
+}
 
+void AnimationState::ApplyTransformTrack(NodeAnimationOutput& output, AnimationChannelFlags channelMask,
+    const Transform& baseValue, const Transform& sampledValue, float weight) const
+{
+    const bool isFullWeight = Equals(weight, 1.0f);
     if (blendingMode_ == ABM_ADDITIVE)
     {
         // In additive mode, check for output being already initialzed
-        if ((track.channelMask_ & output.dirty_).Test(CHANNEL_POSITION))
+        if ((channelMask & output.dirty_).Test(CHANNEL_POSITION))
         {
             const Vector3 delta = sampledValue.position_ - baseValue.position_;
             output.localToParent_.position_ += delta * weight;
         }
 
-        if ((track.channelMask_ & output.dirty_).Test(CHANNEL_ROTATION))
+        if ((channelMask & output.dirty_).Test(CHANNEL_ROTATION))
         {
             const Quaternion delta = sampledValue.rotation_ * baseValue.rotation_.Inverse();
             if (isFullWeight)
@@ -310,7 +342,7 @@ void AnimationState::CalulcateTransformTrack(NodeAnimationOutput& output, const
                 output.localToParent_.rotation_ = Quaternion::IDENTITY.Slerp(delta, weight) * output.localToParent_.rotation_;
         }
 
-        if ((track.channelMask_ & output.dirty_).Test(CHANNEL_SCALE))
+        if ((channelMask & output.dirty_).Test(CHANNEL_SCALE))
         {
             const Vector3 delta = sampledValue.scale_ - baseValue.scale_;
             output.localToParent_.scale_ += delta * weight;
@@ -319,7 +351,7 @@ void AnimationState::CalulcateTransformTrack(NodeAnimationOutput& output, const
     else
     {
         // In interpolation mode, disable interpolation if output is not initialzed yet
-        if (track.channelMask_.Test(CHANNEL_POSITION))
+        if (channelMask.Test(CHANNEL_POSITION))
         {
             if (!isFullWeight && output.dirty_.Test(CHANNEL_POSITION))
                 output.localToParent_.position_ = output.localToParent_.position_.Lerp(sampledValue.position_, weight);
@@ -330,7 +362,7 @@ void AnimationState::CalulcateTransformTrack(NodeAnimationOutput& output, const
             }
         }
 
-        if (track.channelMask_.Test(CHANNEL_ROTATION))
+        if (channelMask.Test(CHANNEL_ROTATION))
         {
             if (!isFullWeight && output.dirty_.Test(CHANNEL_ROTATION))
                 output.localToParent_.rotation_ = output.localToParent_.rotation_.Slerp(sampledValue.rotation_, weight);
@@ -341,7 +373,7 @@ void AnimationState::CalulcateTransformTrack(NodeAnimationOutput& output, const
             }
         }
 
-        if (track.channelMask_.Test(CHANNEL_SCALE))
+        if (channelMask.Test(CHANNEL_SCALE))
         {
             if (!isFullWeight && output.dirty_.Test(CHANNEL_SCALE))
                 output.localToParent_.scale_ = output.localToParent_.scale_.Lerp(sampledValue.scale_, weight);
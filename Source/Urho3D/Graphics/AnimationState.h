@@ -43,6 +43,7 @@ class Serializer;
 class Serializable;
 class Skeleton;
 struct AnimationTrack;
+class CompressedAnimation;
 struct VariantAnimationTrack;
 struct Bone;
 
@@ -62,6 +63,8 @@ struct NodeAnimationStateTrack
     WeakPtr<Node> node_;
     // It's temporary cache and it's never accessed from multiple threads, so it's okay to have it mutable here.
     mutable unsigned keyFrame_{};
+    /// Index of the track in compressed animation data, if compressed.
+    unsigned compressedTrackIndex_{M_MAX_UNSIGNED};
 };
 
 /// Output that aggregates all NodeAnimationStateTrack-s targeted at the same node.
@@ -208,16 +211,22 @@ public:
     /// @property
     float GetLength() const;
 
-    /// Calculate animation for the model skeleton.
-    void CalculateModelTracks(ea::vector<ModelAnimationOutput>& output) const;
+    /// Calculate animation for the model skeleton. Bones deeper than maxBoneDepth are not animated.
+    void CalculateModelTracks(ea::vector<ModelAnimationOutput>& output, unsigned maxBoneDepth = M_MAX_UNSIGNED) const;
     /// Apply animation to a scene node hierarchy.
     void CalculateNodeTracks(ea::unordered_map<Node*, NodeAnimationOutput>& output) const;
     /// Apply animation to attributes.
     void CalculateAttributeTracks(ea::unordered_map<AnimatedAttributeReference, Variant>& output) const;
 
 private:
+    /// Sample compressed transform tracks, if any. Return compressed data.
+    const CompressedAnimation* SampleCompressedTracks() const;
     /// Apply value of transformation track to the output.
-    void CalulcateTransformTrack(NodeAnimationOutput& output, const AnimationTrack& track, unsigned& frame, float weight) const;
+    void CalulcateTransformTrack(NodeAnimationOutput& output, const NodeAnimationStateTrack& stateTrack,
+        const CompressedAnimation* compressed, float weight) const;
+    /// Blend sampled transform into the output.
+    void ApplyTransformTrack(NodeAnimationOutput& output, AnimationChannelFlags channelMask,
+        const Transform& baseValue, const Transform& sampledValue, float weight) const;
     /// Apply single attribute track to target object. Key frame hint is updated on call.
     void CalulcateAttributeTrack(Variant& output, const VariantAnimationTrack& track, unsigned& frame, float weight) const;
 
@@ -248,6 +257,12 @@ private:
     ea::vector<NodeAnimationStateTrack> nodeTracks_;
     ea::vector<AttributeAnimationStateTrack> attributeTracks_;
     /// @}
+
+    /// Temporary buffers for sampling compressed animation. Never accessed from multiple threads.
+    /// @{
+    mutable ea::vector<Transform> compressedPose_;
+    mutable ea::vector<unsigned> compressedKeyHints_;
+    /// @}
 };
 
 using AnimationStateVector = ea::vector<SharedPtr<AnimationState>>;
@@ -0,0 +1,844 @@
+//
+// Copyright (c) 2008-2022 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Graphics/CompressedAnimation.h"
+#include "../IO/Deserializer.h"
+#include "../IO/Log.h"
+#include "../IO/Serializer.h"
+
+#include <EASTL/sort.h>
+
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#endif
+
+#include <cmath>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+/// Maximum number of keys scanned when trying to extend a segment during key reduction.
+const unsigned MaxReducedSegmentLength = 256;
+/// Number of channels interpolated at once.
+const unsigned LaneCount = 4;
+/// Scale of quantized smallest-three rotation component.
+const float RotationQuantizationScale = 32767.0f;
+/// Bit mask of quantized smallest-three rotation component.
+const unsigned short RotationComponentMask = 0x7fff;
+/// Index of stored component for each quaternion component depending on index of the largest one.
+const unsigned char RotationComponentOrder[4][4] = {{3, 0, 1, 2}, {0, 3, 1, 2}, {0, 1, 3, 2}, {0, 1, 2, 3}};
+/// Scale of quantized vector component.
+const float VectorQuantizationScale = 65535.0f;
+
+float GetRotationError(const Quaternion& lhs, const Quaternion& rhs)
+{
+    // Don't use acos of dot product, it is too imprecise for small angles
+    const Quaternion delta = lhs.Conjugate() * rhs;
+    const float sinHalfAngle = Vector3{delta.x_, delta.y_, delta.z_}.Length();
+    return 2.0f * std::atan2(sinHalfAngle, Abs(delta.w_));
+}
+
+Quaternion NlerpShortestPath(const Quaternion& lhs, const Quaternion& rhs, float factor)
+{
+    const Quaternion target = lhs.DotProduct(rhs) < 0.0f ? -rhs : rhs;
+    return (lhs + (target - lhs) * factor).Normalized();
+}
+
+/// Return indices of keys to keep so that linear interpolation between them stays within tolerance.
+template <class T, class Interpolate, class GetError>
+ea::vector<unsigned> ReduceKeys(const AnimationTrack& track, T Transform::*member, float tolerance,
+    const Interpolate& interpolate, const GetError& getError)
+{
+    const auto& keyFrames = track.keyFrames_;
+    const unsigned numKeys = keyFrames.size();
+
+    const auto isSegmentWithinTolerance = [&](unsigned first, unsigned last)
+    {
+        const float firstTime = keyFrames[first].time_;
+        const float interval = keyFrames[last].time_ - firstTime;
+        for (unsigned i = first + 1; i < last; ++i)
+        {
+            const float factor = interval > 0.0f ? (keyFrames[i].time_ - firstTime) / interval : 0.0f;
+            const T value = interpolate(keyFrames[first].*member, keyFrames[last].*member, factor);
+            if (getError(value, keyFrames[i].*member) > tolerance)
+                return false;
+        }
+        return true;
+    };
+
+    ea::vector<unsigned> result{0};
+    unsigned first = 0;
+    while (first + 1 < numKeys)
+    {
+        unsigned last = first + 1;
+        while (last + 1 < numKeys && last - first < MaxReducedSegmentLength
+            && isSegmentWithinTolerance(first, last + 1))
+            ++last;
+
+        result.push_back(last);
+        first = last;
+    }
+    return result;
+}
+
+/// Return approximate maximum deviation of normalized linear interpolation from spherical interpolation.
+float GetNlerpError(float angle)
+{
+    // Maximum deviation is close to quarter of the interval
+    const float factor = 0.25f;
+    const float nlerpAngle = std::atan2(factor * std::sin(angle), 1.0f - factor + factor * std::cos(angle));
+    return Abs(nlerpAngle - factor * angle);
+}
+
+/// Insert keyframes where normalized linear interpolation of rotations is too different from spherical.
+AnimationTrack SubdivideRotations(const AnimationTrack& track, float tolerance)
+{
+    if (!(track.channelMask_ & CHANNEL_ROTATION))
+        return track;
+
+    const unsigned maxSegments = 64;
+    AnimationTrack result = track;
+    result.keyFrames_.clear();
+
+    const auto& keyFrames = track.keyFrames_;
+    for (unsigned i = 0; i < keyFrames.size(); ++i)
+    {
+        const AnimationKeyFrame& keyFrame = keyFrames[i];
+        result.keyFrames_.push_back(keyFrame);
+        if (i + 1 == keyFrames.size())
+            break;
+
+        const AnimationKeyFrame& nextKeyFrame = keyFrames[i + 1];
+        const float angle = GetRotationError(keyFrame.rotation_, nextKeyFrame.rotation_);
+        unsigned numSegments = 1;
+        while (numSegments < maxSegments && GetNlerpError(angle / numSegments) > tolerance * 0.5f)
+            ++numSegments;
+
+        for (unsigned j = 1; j < numSegments; ++j)
+        {
+            const float factor = static_cast<float>(j) / numSegments;
+            AnimationKeyFrame& newKeyFrame = result.keyFrames_.emplace_back();
+            newKeyFrame.time_ = Lerp(keyFrame.time_, nextKeyFrame.time_, factor);
+            newKeyFrame.position_ = keyFrame.position_.Lerp(nextKeyFrame.position_, factor);
+            newKeyFrame.rotation_ = keyFrame.rotation_.Slerp(nextKeyFrame.rotation_, factor);
+            newKeyFrame.scale_ = keyFrame.scale_.Lerp(nextKeyFrame.scale_, factor);
+        }
+    }
+    return result;
+}
+
+void EncodeRotation(const Quaternion& value, unsigned short* output)
+{
+    const Quaternion rotation = value.Normalized();
+    const float components[4] = {rotation.w_, rotation.x_, rotation.y_, rotation.z_};
+
+    unsigned largestIndex = 0;
+    for (unsigned i = 1; i < 4; ++i)
+    {
+        if (Abs(components[i]) > Abs(components[largestIndex]))
+            largestIndex = i;
+    }
+
+    // Largest component is always positive so it can be restored from the others
+    const float sign = components[largestIndex] < 0.0f ? -1.0f : 1.0f;
+    unsigned outputIndex = 0;
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        if (i == largestIndex)
+            continue;
+
+        const float normalized = Clamp(sign * components[i] * static_cast<float>(M_SQRT2), -1.0f, 1.0f);
+        output[outputIndex++] = static_cast<unsigned short>(RoundToInt((normalized * 0.5f + 0.5f) * RotationQuantizationScale));
+    }
+
+    output[0] |= (largestIndex & 1) << 15;
+    output[1] |= (largestIndex >> 1) << 15;
+}
+
+void EncodeVector(const Vector3& value, const Vector3& rangeMin, const Vector3& rangeStep, unsigned short* output)
+{
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        const float step = rangeStep.Data()[i];
+        const float normalized = step > 0.0f ? (value.Data()[i] - rangeMin.Data()[i]) / step : 0.0f;
+        output[i] = static_cast<unsigned short>(Clamp(RoundToInt(normalized), 0, 65535));
+    }
+}
+
+/// Dequantize smallest-three components of 4 lanes and restore the largest component.
+void DecodeRotationLanes(float (&components)[3][LaneCount], float (&largest)[LaneCount])
+{
+#ifdef URHO3D_SSE
+    const __m128 scale = _mm_set1_ps(2.0f / RotationQuantizationScale);
+    const __m128 offset = _mm_set1_ps(-1.0f);
+    const __m128 normalization = _mm_set1_ps(static_cast<float>(M_SQRT1_2));
+
+    __m128 sumSquares = _mm_setzero_ps();
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        __m128 value = _mm_load_ps(components[i]);
+        value = _mm_mul_ps(_mm_add_ps(_mm_mul_ps(value, scale), offset), normalization);
+        sumSquares = _mm_add_ps(sumSquares, _mm_mul_ps(value, value));
+        _mm_store_ps(components[i], value);
+    }
+
+    const __m128 remainder = _mm_max_ps(_mm_sub_ps(_mm_set1_ps(1.0f), sumSquares), _mm_setzero_ps());
+    _mm_store_ps(largest, _mm_sqrt_ps(remainder));
+#else
+    for (unsigned lane = 0; lane < LaneCount; ++lane)
+    {
+        float sumSquares = 0.0f;
+        for (unsigned i = 0; i < 3; ++i)
+        {
+            float& value = components[i][lane];
+            value = (value * (2.0f / RotationQuantizationScale) - 1.0f) * static_cast<float>(M_SQRT1_2);
+            sumSquares += value * value;
+        }
+        largest[lane] = std::sqrt(ea::max(1.0f - sumSquares, 0.0f));
+    }
+#endif
+}
+
+/// Interpolate 4 lanes of quaternions along the shortest path and normalize. Result is written to lhs.
+void NlerpLanes(float (&lhs)[4][LaneCount], const float (&rhs)[4][LaneCount], const float (&factor)[LaneCount])
+{
+#ifdef URHO3D_SSE
+    __m128 a[4];
+    __m128 b[4];
+    __m128 dot = _mm_setzero_ps();
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        a[i] = _mm_load_ps(lhs[i]);
+        b[i] = _mm_load_ps(rhs[i]);
+        dot = _mm_add_ps(dot, _mm_mul_ps(a[i], b[i]));
+    }
+
+    const __m128 flipSign = _mm_and_ps(_mm_cmplt_ps(dot, _mm_setzero_ps()), _mm_set1_ps(-0.0f));
+    const __m128 t = _mm_load_ps(factor);
+    __m128 lengthSquared = _mm_setzero_ps();
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        const __m128 target = _mm_xor_ps(b[i], flipSign);
+        a[i] = _mm_add_ps(a[i], _mm_mul_ps(_mm_sub_ps(target, a[i]), t));
+        lengthSquared = _mm_add_ps(lengthSquared, _mm_mul_ps(a[i], a[i]));
+    }
+
+    const __m128 invLength = _mm_div_ps(_mm_set1_ps(1.0f), _mm_sqrt_ps(lengthSquared));
+    for (unsigned i = 0; i < 4; ++i)
+        _mm_store_ps(lhs[i], _mm_mul_ps(a[i], invLength));
+#else
+    for (unsigned lane = 0; lane < LaneCount; ++lane)
+    {
+        float dot = 0.0f;
+        for (unsigned i = 0; i < 4; ++i)
+            dot += lhs[i][lane] * rhs[i][lane];
+
+        const float sign = dot < 0.0f ? -1.0f : 1.0f;
+        float lengthSquared = 0.0f;
+        for (unsigned i = 0; i < 4; ++i)
+        {
+            float& value = lhs[i][lane];
+            value += (sign * rhs[i][lane] - value) * factor[lane];
+            lengthSquared += value * value;
+        }
+
+        const float invLength = 1.0f / std::sqrt(lengthSquared);
+        for (unsigned i = 0; i < 4; ++i)
+            lhs[i][lane] *= invLength;
+    }
+#endif
+}
+
+/// Interpolate 4 lanes of quantized vectors and dequantize. Result is written to lhs.
+void LerpVectorLanes(float (&lhs)[3][LaneCount], const float (&rhs)[3][LaneCount], const float (&factor)[LaneCount],
+    const float (&rangeMin)[3][LaneCount], const float (&rangeStep)[3][LaneCount])
+{
+#ifdef URHO3D_SSE
+    const __m128 t = _mm_load_ps(factor);
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        const __m128 a = _mm_load_ps(lhs[i]);
+        const __m128 b = _mm_load_ps(rhs[i]);
+        const __m128 value = _mm_add_ps(a, _mm_mul_ps(_mm_sub_ps(b, a), t));
+        _mm_store_ps(lhs[i], _mm_add_ps(_mm_load_ps(rangeMin[i]), _mm_mul_ps(value, _mm_load_ps(rangeStep[i]))));
+    }
+#else
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        for (unsigned lane = 0; lane < LaneCount; ++lane)
+        {
+            const float value = lhs[i][lane] + (rhs[i][lane] - lhs[i][lane]) * factor[lane];
+            lhs[i][lane] = rangeMin[i][lane] + value * rangeStep[i][lane];
+        }
+    }
+#endif
+}
+
+template <class T>
+void WriteArray(Serializer& dest, const ea::vector<T>& values)
+{
+    dest.WriteVLE(values.size());
+    if (!values.empty())
+        dest.Write(values.data(), values.size() * sizeof(T));
+}
+
+template <class T>
+bool ReadArray(Deserializer& source, ea::vector<T>& values)
+{
+    values.resize(source.ReadVLE());
+    const unsigned size = values.size() * sizeof(T);
+    return !size || source.Read(values.data(), size) == size;
+}
+
+}
+
+ea::string AnimationCompressionStats::ToString() const
+{
+    const float ratio = compressedSize_ > 0 ? static_cast<float>(sourceSize_) / compressedSize_ : 0.0f;
+    return Format("{} tracks, {} constant and {} animated channels, {} of {} keys kept, {} -> {} bytes ({:.1f}x), "
+        "max error: position {:.6f}, rotation {:.6f} rad, scale {:.6f}",
+        numTracks_, numConstantChannels_, numAnimatedChannels_, numCompressedKeys_, numSourceKeys_,
+        sourceSize_, compressedSize_, ratio, maxPositionError_, maxRotationError_, maxScaleError_);
+}
+
+SharedPtr<CompressedAnimation> CompressedAnimation::Compress(ea::span<const AnimationTrack* const> tracks, float length,
+    const AnimationCompressionSettings& settings, AnimationCompressionStats* stats)
+{
+    auto result = MakeShared<CompressedAnimation>();
+    result->length_ = length;
+
+    AnimationCompressionStats localStats;
+    AnimationCompressionStats& compressionStats = stats ? *stats : localStats;
+    compressionStats = AnimationCompressionStats{};
+
+    // Tracks without keyframes are not animated and are skipped.
+    // Rotations are interpolated linearly, so add keyframes where it matters.
+    ea::vector<const AnimationTrack*> sourceTracks;
+    ea::vector<AnimationTrack> denseTracks;
+    for (const AnimationTrack* track : tracks)
+    {
+        if (!track->keyFrames_.empty())
+        {
+            sourceTracks.push_back(track);
+            denseTracks.push_back(SubdivideRotations(*track, settings.rotationTolerance_));
+        }
+    }
+
+    // Collect key times shared by all channels
+    ea::vector<float>& keyTimes = result->keyTimes_;
+    for (const AnimationTrack& track : denseTracks)
+    {
+        for (const AnimationKeyFrame& keyFrame : track.keyFrames_)
+            keyTimes.push_back(keyFrame.time_);
+    }
+    ea::sort(keyTimes.begin(), keyTimes.end());
+    keyTimes.erase(ea::unique(keyTimes.begin(), keyTimes.end()), keyTimes.end());
+
+    if (keyTimes.size() > 65536)
+    {
+        URHO3D_LOGERROR("Cannot compress animation with more than 65536 distinct key times");
+        return nullptr;
+    }
+
+    const auto getKeyTimeIndex = [&](float time)
+    {
+        const auto iter = ea::lower_bound(keyTimes.begin(), keyTimes.end(), time);
+        return static_cast<unsigned short>(iter - keyTimes.begin());
+    };
+
+    const auto vectorError = [](const Vector3& lhs, const Vector3& rhs) { return (lhs - rhs).Length(); };
+    const auto vectorLerp = [](const Vector3& lhs, const Vector3& rhs, float factor) { return lhs.Lerp(rhs, factor); };
+
+    const auto addVectorChannel = [&](ChannelGroup& group, unsigned trackIndex, const AnimationTrack& track,
+        Vector3 Transform::*member, float tolerance)
+    {
+        const ea::vector<unsigned> keys = ReduceKeys(track, member, tolerance, vectorLerp, vectorError);
+
+        Vector3 rangeMin = track.keyFrames_.front().*member;
+        Vector3 rangeMax = rangeMin;
+        for (unsigned key : keys)
+        {
+            rangeMin = VectorMin(rangeMin, track.keyFrames_[key].*member);
+            rangeMax = VectorMax(rangeMax, track.keyFrames_[key].*member);
+        }
+        const Vector3 rangeStep = (rangeMax - rangeMin) / VectorQuantizationScale;
+
+        group.trackIndices_.push_back(trackIndex);
+        group.rangeMin_.push_back(rangeMin);
+        group.rangeStep_.push_back(rangeStep);
+        for (unsigned key : keys)
+        {
+            const AnimationKeyFrame& keyFrame = track.keyFrames_[key];
+            group.keyTimes_.push_back(getKeyTimeIndex(keyFrame.time_));
+
+            unsigned short value[3];
+            EncodeVector(keyFrame.*member, rangeMin, rangeStep, value);
+            group.keyValues_.insert(group.keyValues_.end(), ea::begin(value), ea::end(value));
+        }
+        group.keyOffsets_.push_back(group.keyTimes_.size());
+        return keys.size();
+    };
+
+    const auto addRotationChannel = [&](ChannelGroup& group, unsigned trackIndex, const AnimationTrack& track)
+    {
+        const ea::vector<unsigned> keys = ReduceKeys(track, &Transform::rotation_, settings.rotationTolerance_,
+            NlerpShortestPath, GetRotationError);
+
+        group.trackIndices_.push_back(trackIndex);
+        for (unsigned key : keys)
+        {
+            const AnimationKeyFrame& keyFrame = track.keyFrames_[key];
+            group.keyTimes_.push_back(getKeyTimeIndex(keyFrame.time_));
+
+            unsigned short value[3];
+            EncodeRotation(keyFrame.rotation_, value);
+            group.keyValues_.insert(group.keyValues_.end(), ea::begin(value), ea::end(value));
+        }
+        group.keyOffsets_.push_back(group.keyTimes_.size());
+        return keys.size();
+    };
+
+    for (ChannelGroup* group : {&result->positions_, &result->rotations_, &result->scales_})
+        group->keyOffsets_.push_back(0);
+
+    for (unsigned trackIndex = 0; trackIndex < denseTracks.size(); ++trackIndex)
+    {
+        const AnimationTrack* track = &denseTracks[trackIndex];
+        const unsigned numSourceKeys = sourceTracks[trackIndex]->keyFrames_.size();
+        const auto& keyFrames = track->keyFrames_;
+
+        result->trackNames_.push_back(track->nameHash_);
+        result->trackIndices_[track->nameHash_] = trackIndex;
+        result->channelMasks_.push_back(track->channelMask_);
+        result->baseValues_.push_back(keyFrames.front());
+        compressionStats.sourceSize_ += numSourceKeys * sizeof(AnimationKeyFrame);
+
+        const Transform& baseValue = result->baseValues_.back();
+        const auto isConstant = [&](const auto& getError, float tolerance)
+        {
+            for (const AnimationKeyFrame& keyFrame : keyFrames)
+            {
+                if (getError(keyFrame, baseValue) > tolerance)
+                    return false;
+            }
+            return true;
+        };
+
+        if (track->channelMask_ & CHANNEL_POSITION)
+        {
+            const auto getError = [](const Transform& lhs, const Transform& rhs) { return (lhs.position_ - rhs.position_).Length(); };
+            if (isConstant(getError, settings.positionTolerance_))
+                ++compressionStats.numConstantChannels_;
+            else
+            {
+                ++compressionStats.numAnimatedChannels_;
+                compressionStats.numSourceKeys_ += numSourceKeys;
+                compressionStats.numCompressedKeys_ += addVectorChannel(result->positions_, trackIndex, *track,
+                    &Transform::position_, settings.positionTolerance_);
+            }
+        }
+
+        if (track->channelMask_ & CHANNEL_ROTATION)
+        {
+            const auto getError = [](const Transform& lhs, const Transform& rhs) { return GetRotationError(lhs.rotation_, rhs.rotation_); };
+            if (isConstant(getError, settings.rotationTolerance_))
+                ++compressionStats.numConstantChannels_;
+            else
+            {
+                ++compressionStats.numAnimatedChannels_;
+                compressionStats.numSourceKeys_ += numSourceKeys;
+                compressionStats.numCompressedKeys_ += addRotationChannel(result->rotations_, trackIndex, *track);
+            }
+        }
+
+        if (track->channelMask_ & CHANNEL_SCALE)
+        {
+            const auto getError = [](const Transform& lhs, const Transform& rhs) { return (lhs.scale_ - rhs.scale_).Length(); };
+            if (isConstant(getError, settings.scaleTolerance_))
+                ++compressionStats.numConstantChannels_;
+            else
+            {
+                ++compressionStats.numAnimatedChannels_;
+                compressionStats.numSourceKeys_ += numSourceKeys;
+                compressionStats.numCompressedKeys_ += addVectorChannel(result->scales_, trackIndex, *track,
+                    &Transform::scale_, settings.scaleTolerance_);
+            }
+        }
+    }
+
+    compressionStats.numTracks_ = sourceTracks.size();
+    compressionStats.compressedSize_ = result->GetMemoryUse();
+
+    // Measure errors at source keyframes
+    ea::vector<unsigned> keyHints(result->GetNumKeyHints());
+    ea::vector<Transform> pose(result->GetNumTracks());
+    ea::vector<unsigned> sourceKeys(sourceTracks.size());
+    for (float time : keyTimes)
+    {
+        result->Sample(time, false, keyHints, pose);
+        for (unsigned trackIndex = 0; trackIndex < sourceTracks.size(); ++trackIndex)
+        {
+            const AnimationTrack& track = *sourceTracks[trackIndex];
+            unsigned& sourceKey = sourceKeys[trackIndex];
+            for (; sourceKey < track.keyFrames_.size() && track.keyFrames_[sourceKey].time_ <= time; ++sourceKey)
+            {
+                const AnimationKeyFrame& keyFrame = track.keyFrames_[sourceKey];
+                const Transform& value = pose[trackIndex];
+                if (track.channelMask_ & CHANNEL_POSITION)
+                {
+                    compressionStats.maxPositionError_ = ea::max(compressionStats.maxPositionError_,
+                        (value.position_ - keyFrame.position_).Length());
+                }
+                if (track.channelMask_ & CHANNEL_ROTATION)
+                {
+                    compressionStats.maxRotationError_ = ea::max(compressionStats.maxRotationError_,
+                        GetRotationError(value.rotation_, keyFrame.rotation_));
+                }
+                if (track.channelMask_ & CHANNEL_SCALE)
+                {
+                    compressionStats.maxScaleError_ = ea::max(compressionStats.maxScaleError_,
+                        (value.scale_ - keyFrame.scale_).Length());
+                }
+            }
+        }
+    }
+
+    return result;
+}
+
+bool CompressedAnimation::Load(Deserializer& source)
+{
+    length_ = source.ReadFloat();
+    if (!ReadArray(source, keyTimes_))
+        return false;
+
+    const unsigned numTracks = source.ReadVLE();
+    trackNames_.resize(numTracks);
+    channelMasks_.resize(numTracks);
+    baseValues_.resize(numTracks);
+    trackIndices_.clear();
+    for (unsigned i = 0; i < numTracks; ++i)
+    {
+        trackNames_[i] = source.ReadStringHash();
+        trackIndices_[trackNames_[i]] = i;
+        channelMasks_[i] = AnimationChannelFlags(source.ReadUByte());
+        baseValues_[i].position_ = source.ReadVector3();
+        baseValues_[i].rotation_ = source.ReadQuaternion();
+        baseValues_[i].scale_ = source.ReadVector3();
+    }
+
+    for (ChannelGroup* group : {&positions_, &rotations_, &scales_})
+    {
+        if (!ReadArray(source, group->trackIndices_) || !ReadArray(source, group->keyOffsets_)
+            || !ReadArray(source, group->keyTimes_) || !ReadArray(source, group->keyValues_)
+            || !ReadArray(source, group->rangeMin_) || !ReadArray(source, group->rangeStep_))
+            return false;
+
+        // Validate sizes so sampling never reads out of bounds
+        const unsigned numChannels = group->GetNumChannels();
+        const unsigned numKeys = group->keyTimes_.size();
+        const bool hasRanges = group != &rotations_;
+        if (group->keyOffsets_.size() != numChannels + 1 || group->keyOffsets_.back() != numKeys
+            || group->keyValues_.size() != numKeys * 3
+            || (hasRanges && (group->rangeMin_.size() != numChannels || group->rangeStep_.size() != numChannels)))
+        {
+            URHO3D_LOGERROR("Compressed animation data is corrupted");
+            return false;
+        }
+
+        for (unsigned channel = 0; channel < numChannels; ++channel)
+        {
+            if (group->trackIndices_[channel] >= numTracks
+                || group->keyOffsets_[channel + 1] < group->keyOffsets_[channel] + 1)
+            {
+                URHO3D_LOGERROR("Compressed animation data is corrupted");
+                return false;
+            }
+        }
+
+        for (unsigned short keyTime : group->keyTimes_)
+        {
+            if (keyTime >= keyTimes_.size())
+            {
+                URHO3D_LOGERROR("Compressed animation data is corrupted");
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+bool CompressedAnimation::Save(Serializer& dest) const
+{
+    dest.WriteFloat(length_);
+    WriteArray(dest, keyTimes_);
+
+    dest.WriteVLE(trackNames_.size());
+    for (unsigned i = 0; i < trackNames_.size(); ++i)
+    {
+        dest.WriteStringHash(trackNames_[i]);
+        dest.WriteUByte(channelMasks_[i]);
+        dest.WriteVector3(baseValues_[i].position_);
+        dest.WriteQuaternion(baseValues_[i].rotation_);
+        dest.WriteVector3(baseValues_[i].scale_);
+    }
+
+    for (const ChannelGroup* group : {&positions_, &rotations_, &scales_})
+    {
+        WriteArray(dest, group->trackIndices_);
+        WriteArray(dest, group->keyOffsets_);
+        WriteArray(dest, group->keyTimes_);
+        WriteArray(dest, group->keyValues_);
+        WriteArray(dest, group->rangeMin_);
+        WriteArray(dest, group->rangeStep_);
+    }
+
+    return true;
+}
+
+void CompressedAnimation::Decompress(unsigned trackIndex, AnimationTrack& track) const
+{
+    track.keyFrames_.clear();
+    if (trackIndex >= GetNumTracks())
+        return;
+
+    // Collect key times of all animated channels of the track
+    ea::vector<unsigned short> trackKeyTimes;
+    for (const ChannelGroup* group : {&positions_, &rotations_, &scales_})
+    {
+        for (unsigned channel = 0; channel < group->GetNumChannels(); ++channel)
+        {
+            if (group->trackIndices_[channel] != trackIndex)
+                continue;
+
+            const auto begin = group->keyTimes_.begin() + group->keyOffsets_[channel];
+            const auto end = group->keyTimes_.begin() + group->keyOffsets_[channel + 1];
+            trackKeyTimes.insert(trackKeyTimes.end(), begin, end);
+        }
+    }
+    ea::sort(trackKeyTimes.begin(), trackKeyTimes.end());
+    trackKeyTimes.erase(ea::unique(trackKeyTimes.begin(), trackKeyTimes.end()), trackKeyTimes.end());
+
+    track.channelMask_ = channelMasks_[trackIndex];
+
+    // Fully constant track is represented with one keyframe
+    if (trackKeyTimes.empty())
+    {
+        AnimationKeyFrame& keyFrame = track.keyFrames_.emplace_back();
+        static_cast<Transform&>(keyFrame) = baseValues_[trackIndex];
+        return;
+    }
+
+    ea::vector<unsigned> keyHints(GetNumKeyHints());
+    ea::vector<Transform> pose(GetNumTracks());
+    for (unsigned short keyTime : trackKeyTimes)
+    {
+        const float time = keyTimes_[keyTime];
+        Sample(time, false, keyHints, pose);
+
+        AnimationKeyFrame& keyFrame = track.keyFrames_.emplace_back();
+        static_cast<Transform&>(keyFrame) = pose[trackIndex];
+        keyFrame.time_ = time;
+    }
+}
+
+void CompressedAnimation::Sample(float time, bool isLooped, ea::span<unsigned> keyHints, ea::span<Transform> output) const
+{
+    URHO3D_ASSERT(keyHints.size() >= GetNumKeyHints());
+    URHO3D_ASSERT(output.size() >= GetNumTracks());
+
+    // Constant channels are taken from base values
+    ea::copy(baseValues_.begin(), baseValues_.end(), output.begin());
+
+    unsigned* hints = keyHints.data();
+    SampleVectorChannels(positions_, time, isLooped, hints, output, &Transform::position_);
+    hints += positions_.GetNumChannels();
+    SampleRotationChannels(rotations_, time, isLooped, hints, output);
+    hints += rotations_.GetNumChannels();
+    SampleVectorChannels(scales_, time, isLooped, hints, output, &Transform::scale_);
+}
+
+void CompressedAnimation::FindKeys(const ChannelGroup& group, unsigned channel, float time, bool isLooped,
+    unsigned& keyHint, unsigned& key, unsigned& nextKey, float& blendFactor) const
+{
+    const unsigned firstKey = group.keyOffsets_[channel];
+    const unsigned numKeys = group.keyOffsets_[channel + 1] - firstKey;
+    const unsigned short* channelKeyTimes = &group.keyTimes_[firstKey];
+    const auto getKeyTime = [&](unsigned index) { return keyTimes_[channelKeyTimes[index]]; };
+
+    // Same logic as in KeyFrameSet::GetKeyFrames
+    const float searchTime = ea::max(time, 0.0f);
+    unsigned index = ea::min(keyHint, numKeys - 1);
+    while (index && searchTime < getKeyTime(index))
+        --index;
+    while (index + 1 < numKeys && searchTime >= getKeyTime(index + 1))
+        ++index;
+    keyHint = index;
+
+    const unsigned nextIndex = index + 1 < numKeys ? index + 1 : (isLooped ? 0 : index);
+    if (index != nextIndex)
+    {
+        const float keyTime = getKeyTime(index);
+        float timeInterval = getKeyTime(nextIndex) - keyTime;
+        if (timeInterval < 0.0f)
+            timeInterval += length_;
+        blendFactor = timeInterval > 0.0f ? (time - keyTime) / timeInterval : 1.0f;
+    }
+    else
+        blendFactor = 0.0f;
+
+    key = firstKey + index;
+    nextKey = firstKey + nextIndex;
+}
+
+void CompressedAnimation::SampleVectorChannels(const ChannelGroup& group, float time, bool isLooped,
+    unsigned* keyHints, ea::span<Transform> output, Vector3 Transform::*member) const
+{
+    const unsigned numChannels = group.GetNumChannels();
+    for (unsigned firstChannel = 0; firstChannel < numChannels; firstChannel += LaneCount)
+    {
+        const unsigned numLanes = ea::min(LaneCount, numChannels - firstChannel);
+
+        alignas(16) float value[3][LaneCount]{};
+        alignas(16) float nextValue[3][LaneCount]{};
+        alignas(16) float rangeMin[3][LaneCount]{};
+        alignas(16) float rangeStep[3][LaneCount]{};
+        alignas(16) float blendFactor[LaneCount]{};
+
+        for (unsigned lane = 0; lane < numLanes; ++lane)
+        {
+            const unsigned channel = firstChannel + lane;
+            unsigned key{};
+            unsigned nextKey{};
+            FindKeys(group, channel, time, isLooped, keyHints[channel], key, nextKey, blendFactor[lane]);
+
+            for (unsigned i = 0; i < 3; ++i)
+            {
+                value[i][lane] = group.keyValues_[key * 3 + i];
+                nextValue[i][lane] = group.keyValues_[nextKey * 3 + i];
+                rangeMin[i][lane] = group.rangeMin_[channel].Data()[i];
+                rangeStep[i][lane] = group.rangeStep_[channel].Data()[i];
+            }
+        }
+
+        LerpVectorLanes(value, nextValue, blendFactor, rangeMin, rangeStep);
+
+        for (unsigned lane = 0; lane < numLanes; ++lane)
+        {
+            Transform& transform = output[group.trackIndices_[firstChannel + lane]];
+            transform.*member = Vector3{value[0][lane], value[1][lane], value[2][lane]};
+        }
+    }
+}
+
+void CompressedAnimation::SampleRotationChannels(const ChannelGroup& group, float time, bool isLooped,
+    unsigned* keyHints, ea::span<Transform> output) const
+{
+    const unsigned numChannels = group.GetNumChannels();
+    for (unsigned firstChannel = 0; firstChannel < numChannels; firstChannel += LaneCount)
+    {
+        const unsigned numLanes = ea::min(LaneCount, numChannels - firstChannel);
+
+        alignas(16) float components[2][3][LaneCount]{};
+        alignas(16) float largest[2][LaneCount]{};
+        alignas(16) float blendFactor[LaneCount]{};
+        unsigned largestIndex[2][LaneCount]{};
+
+        for (unsigned lane = 0; lane < numLanes; ++lane)
+        {
+            const unsigned channel = firstChannel + lane;
+            unsigned keys[2]{};
+            FindKeys(group, channel, time, isLooped, keyHints[channel], keys[0], keys[1], blendFactor[lane]);
+
+            for (unsigned k = 0; k < 2; ++k)
+            {
+                const unsigned short* encoded = &group.keyValues_[keys[k] * 3];
+                for (unsigned i = 0; i < 3; ++i)
+                    components[k][i][lane] = encoded[i] & RotationComponentMask;
+                largestIndex[k][lane] = (encoded[0] >> 15) | ((encoded[1] >> 15) << 1);
+            }
+        }
+
+        DecodeRotationLanes(components[0], largest[0]);
+        DecodeRotationLanes(components[1], largest[1]);
+
+        // Restore component order, W X Y Z
+        alignas(16) float rotation[2][4][LaneCount]{};
+        for (unsigned k = 0; k < 2; ++k)
+        {
+            for (unsigned lane = 0; lane < numLanes; ++lane)
+            {
+                const float source[4] = {components[k][0][lane], components[k][1][lane], components[k][2][lane], largest[k][lane]};
+                const unsigned char* order = RotationComponentOrder[largestIndex[k][lane]];
+                for (unsigned i = 0; i < 4; ++i)
+                    rotation[k][i][lane] = source[order[i]];
+            }
+            // Keep unused lanes normalized
+            for (unsigned lane = numLanes; lane < LaneCount; ++lane)
+                rotation[k][0][lane] = 1.0f;
+        }
+
+        NlerpLanes(rotation[0], rotation[1], blendFactor);
+
+        for (unsigned lane = 0; lane < numLanes; ++lane)
+        {
+            Transform& transform = output[group.trackIndices_[firstChannel + lane]];
+            transform.rotation_ = Quaternion{rotation[0][0][lane], rotation[0][1][lane], rotation[0][2][lane], rotation[0][3][lane]};
+        }
+    }
+}
+
+unsigned CompressedAnimation::GetTrackIndex(StringHash nameHash) const
+{
+    const auto iter = trackIndices_.find(nameHash);
+    return iter != trackIndices_.end() ? iter->second : M_MAX_UNSIGNED;
+}
+
+unsigned CompressedAnimation::GetNumKeyHints() const
+{
+    return positions_.GetNumChannels() + rotations_.GetNumChannels() + scales_.GetNumChannels();
+}
+
+unsigned CompressedAnimation::GetMemoryUse() const
+{
+    return sizeof(CompressedAnimation) + keyTimes_.size() * sizeof(float)
+        + trackNames_.size() * (sizeof(StringHash) + sizeof(AnimationChannelFlags) + sizeof(Transform))
+        + positions_.GetMemoryUse() + rotations_.GetMemoryUse() + scales_.GetMemoryUse();
+}
+
+unsigned CompressedAnimation::ChannelGroup::GetMemoryUse() const
+{
+    return trackIndices_.size() * sizeof(unsigned) + keyOffsets_.size() * sizeof(unsigned)
+        + keyTimes_.size() * sizeof(unsigned short) + keyValues_.size() * sizeof(unsigned short)
+        + rangeMin_.size() * sizeof(Vector3) + rangeStep_.size() * sizeof(Vector3);
+}
+
+}
@@ -0,0 +1,165 @@
+//
+// Copyright (c) 2008-2022 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+/// \file
+
+#pragma once
+
+#include "../Container/Ptr.h"
+#include "../Container/RefCounted.h"
+#include "../Graphics/AnimationTrack.h"
+
+#include <EASTL/span.h>
+#include <EASTL/unordered_map.h>
+
+namespace Urho3D
+{
+
+class Deserializer;
+class Serializer;
+
+/// Settings of animation compression. Tolerances are maximum errors allowed for key reduction.
+struct AnimationCompressionSettings
+{
+    /// Maximum position error in local units.
+    float positionTolerance_{0.0005f};
+    /// Maximum rotation error in radians.
+    float rotationTolerance_{0.0005f};
+    /// Maximum scale error.
+    float scaleTolerance_{0.0005f};
+};
+
+/// Result of animation compression. Errors are measured at source keyframes.
+struct AnimationCompressionStats
+{
+    /// Number of compressed tracks.
+    unsigned numTracks_{};
+    /// Number of channels replaced with constant values.
+    unsigned numConstantChannels_{};
+    /// Number of animated channels.
+    unsigned numAnimatedChannels_{};
+    /// Number of keys in animated channels before key reduction.
+    unsigned numSourceKeys_{};
+    /// Number of keys in animated channels after key reduction.
+    unsigned numCompressedKeys_{};
+    /// Memory used by source keyframes in bytes.
+    unsigned sourceSize_{};
+    /// Memory used by compressed data in bytes.
+    unsigned compressedSize_{};
+    /// Maximum position error.
+    float maxPositionError_{};
+    /// Maximum rotation error in radians.
+    float maxRotationError_{};
+    /// Maximum scale error.
+    float maxScaleError_{};
+
+    /// Return human-readable summary.
+    ea::string ToString() const;
+};
+
+/// Compressed transform tracks of an animation. Immutable once created.
+/// Constant channels are stored once, rotations are quantized with smallest-three encoding,
+/// positions and scales are quantized within the range of the channel, redundant keys are removed.
+/// All tracks are sampled at once, animated channels are interpolated in groups with SIMD if available.
+class URHO3D_API CompressedAnimation : public RefCounted
+{
+public:
+    /// Compress tracks. Tracks must have sorted keyframes. Tracks without keyframes are skipped.
+    static SharedPtr<CompressedAnimation> Compress(ea::span<const AnimationTrack* const> tracks, float length,
+        const AnimationCompressionSettings& settings, AnimationCompressionStats* stats = nullptr);
+
+    /// Load from stream. Return true if successful.
+    bool Load(Deserializer& source);
+    /// Save to stream. Return true if successful.
+    bool Save(Serializer& dest) const;
+    /// Restore keyframes of the track. Keyframes are created at times of all keys of the track.
+    void Decompress(unsigned trackIndex, AnimationTrack& track) const;
+
+    /// Sample all tracks at given time. Key hints should be zero-initialized and kept between calls.
+    void Sample(float time, bool isLooped, ea::span<unsigned> keyHints, ea::span<Transform> output) const;
+
+    /// Return index of the track by name hash, or M_MAX_UNSIGNED if not found.
+    unsigned GetTrackIndex(StringHash nameHash) const;
+    /// Return number of tracks.
+    unsigned GetNumTracks() const { return baseValues_.size(); }
+    /// Return number of key hints required for sampling.
+    unsigned GetNumKeyHints() const;
+    /// Return value of the first keyframe of the track.
+    const Transform& GetBaseValue(unsigned trackIndex) const { return baseValues_[trackIndex]; }
+    /// Return memory used by compressed data in bytes.
+    unsigned GetMemoryUse() const;
+
+private:
+    /// Animated channels of one type. Values are stored as 3 quantized components per key.
+    struct ChannelGroup
+    {
+        /// Index of the track of each channel.
+        ea::vector<unsigned> trackIndices_;
+        /// Index of the first key of each channel, with one extra element at the end.
+        ea::vector<unsigned> keyOffsets_;
+        /// Index in the shared key time array for each key.
+        ea::vector<unsigned short> keyTimes_;
+        /// Quantized values of each key.
+        ea::vector<unsigned short> keyValues_;
+        /// Minimum value of each channel, not used for rotations.
+        ea::vector<Vector3> rangeMin_;
+        /// Size of quantization step of each channel, not used for rotations.
+        ea::vector<Vector3> rangeStep_;
+
+        /// Return number of channels.
+        unsigned GetNumChannels() const { return trackIndices_.size(); }
+        /// Return memory used by the group in bytes.
+        unsigned GetMemoryUse() const;
+    };
+
+    /// Sample vector channels, either positions or scales.
+    void SampleVectorChannels(const ChannelGroup& group, float time, bool isLooped, unsigned* keyHints,
+        ea::span<Transform> output, Vector3 Transform::*member) const;
+    /// Sample rotation channels.
+    void SampleRotationChannels(const ChannelGroup& group, float time, bool isLooped, unsigned* keyHints,
+        ea::span<Transform> output) const;
+    /// Find keys and blend factor for the channel.
+    void FindKeys(const ChannelGroup& group, unsigned channel, float time, bool isLooped, unsigned& keyHint,
+        unsigned& key, unsigned& nextKey, float& blendFactor) const;
+
+    /// Animation length.
+    float length_{};
+    /// Sorted unique key times shared by all channels.
+    ea::vector<float> keyTimes_;
+    /// Track names.
+    ea::vector<StringHash> trackNames_;
+    /// Track indices by name.
+    ea::unordered_map<StringHash, unsigned> trackIndices_;
+    /// Channel masks of tracks.
+    ea::vector<AnimationChannelFlags> channelMasks_;
+    /// Values of first keyframes. Constant channels are stored here.
+    ea::vector<Transform> baseValues_;
+    /// Animated position channels.
+    ChannelGroup positions_;
+    /// Animated rotation channels.
+    ChannelGroup rotations_;
+    /// Animated scale channels.
+    ChannelGroup scales_;
+};
+
+}
@@ -46,10 +46,10 @@ struct ConstantBufferCollectionRef
 class ConstantBufferCollection
 {
 public:
-    /// Clear and/or initialize for work.
+    /// Clear and/or initialize for work. Zero alignment is treated as no alignment.
     void ClearAndInitialize(unsigned alignment)
     {
-        alignment_ = alignment;
+        alignment_ = ea::max(1u, alignment);
         currentBufferIndex_ = 0;
         for (auto& buffer : buffers_)
             buffer.second = 0;
@@ -79,6 +79,31 @@ public:
         return {{ currentBufferIndex_, offset, size }, data };
     }
 
+    /// Append all blocks from another collection. Return index of the first appended buffer.
+    /// Offsets of blocks within buffers are preserved.
+    unsigned Append(const ConstantBufferCollection& other)
+    {
+        assert(bufferSize_ == other.bufferSize_ && alignment_ == other.alignment_);
+
+        // Start new buffer unless current buffer is empty
+        const unsigned firstBufferIndex = buffers_[currentBufferIndex_].second != 0
+            ? currentBufferIndex_ + 1 : currentBufferIndex_;
+
+        const unsigned numBuffers = other.GetNumBuffers();
+        for (unsigned i = 0; i < numBuffers; ++i)
+        {
+            currentBufferIndex_ = firstBufferIndex + i;
+            if (buffers_.size() <= currentBufferIndex_)
+                AllocateBuffer();
+
+            auto& destBuffer = buffers_[currentBufferIndex_];
+            const auto& sourceBuffer = other.buffers_[i];
+            memcpy(destBuffer.first.data(), sourceBuffer.first.data(), sourceBuffer.second);
+            destBuffer.second = sourceBuffer.second;
+        }
+        return firstBufferIndex;
+    }
+
     /// Return number of buffers.
     unsigned GetNumBuffers() const { return currentBufferIndex_ + 1; }
 
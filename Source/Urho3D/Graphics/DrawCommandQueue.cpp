@@ -38,9 +38,10 @@ DrawCommandQueue::DrawCommandQueue(Graphics* graphics)
 
 void DrawCommandQueue::Reset(bool preferConstantBuffers)
 {
+    preferConstantBuffers_ = preferConstantBuffers;
     useConstantBuffers_ = preferConstantBuffers
-        ? graphics_->GetCaps().constantBuffersSupported_
-        : !graphics_->GetCaps().globalUniformsSupported_;
+        ? Graphics::GetCaps().constantBuffersSupported_
+        : !Graphics::GetCaps().globalUniformsSupported_;
 
     // Reset state accumulators
     currentDrawCommand_ = {};
@@ -49,7 +50,7 @@ void DrawCommandQueue::Reset(bool preferConstantBuffers)
     // Clear shadep parameters
     if (useConstantBuffers_)
     {
-        constantBuffers_.collection_.ClearAndInitialize(graphics_->GetCaps().constantBufferOffsetAlignment_);
+        constantBuffers_.collection_.ClearAndInitialize(Graphics::GetCaps().constantBufferOffsetAlignment_);
         constantBuffers_.currentLayout_ = nullptr;
         constantBuffers_.currentData_ = nullptr;
         constantBuffers_.currentHashes_.fill(0);
@@ -71,6 +72,73 @@ void DrawCommandQueue::Reset(bool preferConstantBuffers)
     scissorRects_.push_back(IntRect::ZERO);
 }
 
+void DrawCommandQueue::Append(const DrawCommandQueue& other)
+{
+    assert(useConstantBuffers_ == other.useConstantBuffers_);
+    if (other.drawCommands_.empty())
+        return;
+
+    // Append shader parameters
+    const unsigned shaderParametersOffset = shaderParameters_.collection_.Size();
+    unsigned constantBuffersOffset = 0;
+    if (useConstantBuffers_)
+        constantBuffersOffset = constantBuffers_.collection_.Append(other.constantBuffers_.collection_);
+    else
+    {
+        shaderParameters_.collection_.Append(other.shaderParameters_.collection_);
+        shaderParameters_.currentGroupRange_.first = shaderParameters_.collection_.Size();
+        shaderParameters_.currentGroupRange_.second = shaderParameters_.currentGroupRange_.first;
+    }
+
+    // Append shader resources
+    const unsigned shaderResourcesOffset = shaderResources_.size();
+    shaderResources_.insert(shaderResources_.end(), other.shaderResources_.begin(), other.shaderResources_.end());
+    currentShaderResourceGroup_.first = shaderResources_.size();
+    currentShaderResourceGroup_.second = currentShaderResourceGroup_.first;
+
+    // Append scissor rects except the first one, which is always empty
+    const unsigned scissorRectsOffset = scissorRects_.size() - 1;
+    if (other.scissorRects_.size() > 1)
+    {
+        scissorRects_.insert(scissorRects_.end(), other.scissorRects_.begin() + 1, other.scissorRects_.end());
+
+        // SetScissorRect expects that current scissor rect is the last one
+        const IntRect currentScissorRect = scissorRects_[currentDrawCommand_.scissorRect_];
+        currentDrawCommand_.scissorRect_ = scissorRects_.size();
+        scissorRects_.push_back(currentScissorRect);
+    }
+
+    // Append draw commands with adjusted references
+    const unsigned drawCommandsOffset = drawCommands_.size();
+    drawCommands_.insert(drawCommands_.end(), other.drawCommands_.begin(), other.drawCommands_.end());
+    for (unsigned i = drawCommandsOffset; i < drawCommands_.size(); ++i)
+    {
+        DrawCommandDescription& cmd = drawCommands_[i];
+        if (useConstantBuffers_)
+        {
+            for (ConstantBufferCollectionRef& ref : cmd.constantBuffers_)
+            {
+                if (ref.size_ != 0)
+                    ref.index_ += constantBuffersOffset;
+            }
+        }
+        else
+        {
+            for (ShaderParameterRange& range : cmd.shaderParameters_)
+            {
+                range.first += shaderParametersOffset;
+                range.second += shaderParametersOffset;
+            }
+        }
+
+        cmd.shaderResources_.first += shaderResourcesOffset;
+        cmd.shaderResources_.second += shaderResourcesOffset;
+
+        if (cmd.scissorRect_ != 0)
+            cmd.scissorRect_ += scissorRectsOffset;
+    }
+}
+
 void DrawCommandQueue::Execute()
 {
     if (drawCommands_.empty())
@@ -107,10 +107,15 @@ public:
     {
         assert(pipelineState);
         currentDrawCommand_.pipelineState_ = pipelineState;
+        SetShaderProgramLayout(pipelineState->GetShaderProgramLayout());
+    }
 
+    /// Set layout of constant buffers. Called by SetPipelineState.
+    void SetShaderProgramLayout(ShaderProgramLayout* layout)
+    {
         if (useConstantBuffers_)
         {
-            constantBuffers_.currentLayout_ = pipelineState->GetShaderProgramLayout();
+            constantBuffers_.currentLayout_ = layout;
         }
     }
 
@@ -366,12 +371,30 @@ public:
         drawCommands_.push_back(currentDrawCommand_);
     }
 
+    /// Append all commands from another queue, e.g. from the segment recorded in another thread.
+    /// Both queues should be reset with the same settings.
+    /// Shall not be called between BeginShaderParameterGroup and CommitShaderParameterGroup.
+    void Append(const DrawCommandQueue& other);
+
     /// Execute commands in the queue.
     void Execute();
 
+    /// Getters
+    /// @{
+    bool GetPreferConstantBuffers() const { return preferConstantBuffers_; }
+    bool IsUsingConstantBuffers() const { return useConstantBuffers_; }
+    ea::span<const DrawCommandDescription> GetDrawCommands() const { return drawCommands_; }
+    ea::span<const ShaderResourceDesc> GetShaderResources() const { return shaderResources_; }
+    ea::span<const IntRect> GetScissorRects() const { return scissorRects_; }
+    const ShaderParameterCollection& GetShaderParameters() const { return shaderParameters_.collection_; }
+    const ConstantBufferCollection& GetConstantBuffers() const { return constantBuffers_.collection_; }
+    /// @}
+
 private:
     /// Cached pointer to Graphics.
     Graphics* graphics_{};
+    /// Whether constant buffers are preferred. Used to reset queue with the same settings.
+    bool preferConstantBuffers_{};
     /// Whether to use constant buffers.
     bool useConstantBuffers_{};
 
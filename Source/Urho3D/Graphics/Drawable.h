@@ -68,7 +68,6 @@ class Viewport;
 class Zone;
 struct RayQueryResult;
 struct ReflectionProbeData;
-struct WorkItem;
 
 /// Geometry update type.
 enum UpdateGeometryType
@@ -202,7 +201,6 @@ class URHO3D_API Drawable : public Component, public PipelineStateTracker
 
     friend class Octant;
     friend class Octree;
-    friend void UpdateDrawablesWork(const WorkItem* item, unsigned threadIndex);
 
 public:
     /// Construct.
@@ -204,6 +204,8 @@ public:
     void UpdateBatches(const FrameInfo& frame) override;
     /// Visualize the component as debug geometry.
     void DrawDebugGeometry(DebugRenderer* debug, bool depthTest) override;
+    /// Return whether attribute animations may bypass OnSetAttribute. Derived types use OnSetAttribute.
+    bool SupportsNativeAttributeAnimation() const override { return GetType() == Light::GetTypeStatic(); }
 
     /// Set light type.
     /// @property
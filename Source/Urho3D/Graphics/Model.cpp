@@ -60,6 +60,83 @@ unsigned LookupIndexBuffer(IndexBuffer* buffer, const ea::vector<SharedPtr<Index
     return 0;
 }
 
+namespace
+{
+
+/// Minimum number of vertices required to fit bone hit capsule.
+const unsigned MinVerticesForBoneHitCapsule = 4;
+
+/// Fit capsule along the principal axis of points so that all points are inside.
+bool FitBoneHitCapsule(const ea::vector<Vector3>& points, Bone& bone)
+{
+    if (points.size() < MinVerticesForBoneHitCapsule)
+        return false;
+
+    Vector3 center;
+    for (const Vector3& point : points)
+        center += point;
+    center /= static_cast<float>(points.size());
+
+    Matrix3 covariance = Matrix3::ZERO;
+    for (const Vector3& point : points)
+    {
+        const Vector3 delta = point - center;
+        covariance.m00_ += delta.x_ * delta.x_;
+        covariance.m01_ += delta.x_ * delta.y_;
+        covariance.m02_ += delta.x_ * delta.z_;
+        covariance.m11_ += delta.y_ * delta.y_;
+        covariance.m12_ += delta.y_ * delta.z_;
+        covariance.m22_ += delta.z_ * delta.z_;
+    }
+    covariance.m10_ = covariance.m01_;
+    covariance.m20_ = covariance.m02_;
+    covariance.m21_ = covariance.m12_;
+
+    // Find principal axis by power iteration, starting from the axis with the greatest variance
+    Vector3 axis = covariance.m00_ >= covariance.m11_ && covariance.m00_ >= covariance.m22_ ? Vector3::RIGHT
+        : covariance.m11_ >= covariance.m22_ ? Vector3::UP : Vector3::FORWARD;
+    for (unsigned i = 0; i < 16; ++i)
+    {
+        const Vector3 nextAxis = covariance * axis;
+        const float length = nextAxis.Length();
+        if (length < M_EPSILON)
+            break;
+        axis = nextAxis / length;
+    }
+
+    float radiusSquared = 0.0f;
+    for (const Vector3& point : points)
+    {
+        const Vector3 delta = point - center;
+        const float axisPosition = delta.DotProduct(axis);
+        radiusSquared = ea::max(radiusSquared, delta.LengthSquared() - axisPosition * axisPosition);
+    }
+    if (radiusSquared < M_EPSILON)
+        return false;
+
+    // Shrink the segment as long as end spheres still contain all points
+    float segmentStart = M_INFINITY;
+    float segmentEnd = -M_INFINITY;
+    for (const Vector3& point : points)
+    {
+        const Vector3 delta = point - center;
+        const float axisPosition = delta.DotProduct(axis);
+        const float axisDistanceSquared = delta.LengthSquared() - axisPosition * axisPosition;
+        const float capExtent = sqrtf(ea::max(0.0f, radiusSquared - axisDistanceSquared));
+        segmentStart = ea::min(segmentStart, axisPosition + capExtent);
+        segmentEnd = ea::max(segmentEnd, axisPosition - capExtent);
+    }
+    if (segmentStart > segmentEnd)
+        segmentStart = segmentEnd = (segmentStart + segmentEnd) * 0.5f;
+
+    bone.hitCapsuleStart_ = center + axis * segmentStart;
+    bone.hitCapsuleEnd_ = center + axis * segmentEnd;
+    bone.hitCapsuleRadius_ = sqrtf(radiusSquared);
+    return true;
+}
+
+}
+
 Model::Model(Context* context) :
     ResourceWithMetadata(context)
 {
@@ -365,6 +442,8 @@ bool Model::EndLoad()
     loadVBData_.clear();
     loadIBData_.clear();
     loadGeometries_.clear();
+
+    RecalculateBoneHitCapsules();
     return true;
 }
 
@@ -609,6 +688,84 @@ void Model::SetSkeleton(const Skeleton& skeleton)
     skeleton_ = skeleton;
 }
 
+void Model::RecalculateBoneHitCapsules()
+{
+    ea::vector<Bone>& bones = skeleton_.GetModifiableBones();
+    const unsigned numBones = bones.size();
+    if (!numBones)
+        return;
+
+    // Assign each vertex of the most detailed LODs to the bone with the greatest weight
+    ea::vector<ea::vector<Vector3>> bonePoints(numBones);
+    ea::vector<Vector4> unpackedData;
+    for (unsigned geometryIndex = 0; geometryIndex < geometries_.size(); ++geometryIndex)
+    {
+        Geometry* geometry = !geometries_[geometryIndex].empty() ? geometries_[geometryIndex][0].Get() : nullptr;
+        VertexBuffer* vertexBuffer = geometry ? geometry->GetVertexBuffer(0) : nullptr;
+        const unsigned char* vertexData = vertexBuffer ? vertexBuffer->GetShadowData() : nullptr;
+        if (!vertexData)
+            continue;
+
+        const VertexElement* positionElement = vertexBuffer->GetElement(SEM_POSITION);
+        const VertexElement* indicesElement = vertexBuffer->GetElement(SEM_BLENDINDICES);
+        const VertexElement* weightsElement = vertexBuffer->GetElement(SEM_BLENDWEIGHTS);
+        if (!positionElement || !indicesElement || !weightsElement)
+            continue;
+
+        unsigned vertexStart = geometry->GetVertexStart();
+        unsigned vertexCount = geometry->GetVertexCount();
+        if (!vertexCount || vertexStart + vertexCount > vertexBuffer->GetVertexCount())
+        {
+            vertexStart = 0;
+            vertexCount = vertexBuffer->GetVertexCount();
+        }
+
+        const unsigned vertexSize = vertexBuffer->GetVertexSize();
+        unpackedData.resize(vertexCount * 3);
+        VertexBuffer::UnpackVertexData(vertexData, vertexSize, *positionElement, vertexStart, vertexCount,
+            unpackedData.data(), 3 * sizeof(Vector4));
+        VertexBuffer::UnpackVertexData(vertexData, vertexSize, *indicesElement, vertexStart, vertexCount,
+            unpackedData.data() + 1, 3 * sizeof(Vector4));
+        VertexBuffer::UnpackVertexData(vertexData, vertexSize, *weightsElement, vertexStart, vertexCount,
+            unpackedData.data() + 2, 3 * sizeof(Vector4));
+
+        const ea::vector<unsigned>* boneMapping = geometryIndex < geometryBoneMappings_.size()
+            && !geometryBoneMappings_[geometryIndex].empty() ? &geometryBoneMappings_[geometryIndex] : nullptr;
+
+        for (unsigned i = 0; i < vertexCount; ++i)
+        {
+            const Vector4& blendIndices = unpackedData[i * 3 + 1];
+            const Vector4& blendWeights = unpackedData[i * 3 + 2];
+            const float* weights = blendWeights.Data();
+
+            const unsigned dominantInfluence = static_cast<unsigned>(
+                ea::max_element(weights, weights + 4) - weights);
+            if (weights[dominantInfluence] < M_LARGE_EPSILON)
+                continue;
+
+            unsigned boneIndex = static_cast<unsigned>(blendIndices.Data()[dominantInfluence]);
+            if (boneMapping)
+                boneIndex = boneIndex < boneMapping->size() ? (*boneMapping)[boneIndex] : M_MAX_UNSIGNED;
+            if (boneIndex >= numBones)
+                continue;
+
+            const Bone& bone = bones[boneIndex];
+            bonePoints[boneIndex].push_back(bone.offsetMatrix_ * static_cast<Vector3>(unpackedData[i * 3]));
+        }
+    }
+
+    for (unsigned boneIndex = 0; boneIndex < numBones; ++boneIndex)
+    {
+        Bone& bone = bones[boneIndex];
+        if (!FitBoneHitCapsule(bonePoints[boneIndex], bone))
+        {
+            bone.hitCapsuleStart_ = Vector3::ZERO;
+            bone.hitCapsuleEnd_ = Vector3::ZERO;
+            bone.hitCapsuleRadius_ = 0.0f;
+        }
+    }
+}
+
 void Model::SetGeometryBoneMappings(const ea::vector<ea::vector<unsigned> >& geometryBoneMappings)
 {
     geometryBoneMappings_ = geometryBoneMappings;
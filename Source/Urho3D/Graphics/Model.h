@@ -159,6 +159,9 @@ public:
     bool SetGeometryCenter(unsigned index, const Vector3& center);
     /// Set skeleton.
     void SetSkeleton(const Skeleton& skeleton);
+    /// Recalculate bone hit capsules from vertex weights of the most detailed LODs. Vertex buffers should be shadowed.
+    /// Called automatically on load.
+    void RecalculateBoneHitCapsules();
     /// Set bone mappings when model has more bones than the skinning shader can handle.
     void SetGeometryBoneMappings(const ea::vector<ea::vector<unsigned> >& geometryBoneMappings);
     /// Set vertex morphs.
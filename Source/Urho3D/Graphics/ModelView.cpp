@@ -1241,6 +1241,7 @@ void ModelView::ExportModel(Model* model) const
 
     skeleton.UpdateBoneOrder();
     model->SetSkeleton(skeleton);
+    model->RecalculateBoneHitCapsules();
 }
 
 SharedPtr<Model> ModelView::ExportModel(const ea::string& name) const
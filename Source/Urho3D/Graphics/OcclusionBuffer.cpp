@@ -29,6 +29,10 @@
 #include "../Graphics/OcclusionBuffer.h"
 #include "../IO/Log.h"
 
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#endif
+
 #include "../DebugNew.h"
 
 namespace Urho3D
@@ -45,14 +49,6 @@ enum ClipMask : unsigned
 };
 URHO3D_FLAGSET(ClipMask, ClipMaskFlags);
 
-void DrawOcclusionBatchWork(const WorkItem* item, unsigned threadIndex)
-{
-    URHO3D_PROFILE("DrawOcclusionBatchWork");
-    auto* buffer = reinterpret_cast<OcclusionBuffer*>(item->aux_);
-    OcclusionBatch& batch = *reinterpret_cast<OcclusionBatch*>(item->start_);
-    buffer->DrawBatch(batch, threadIndex);
-}
-
 OcclusionBuffer::OcclusionBuffer(Context* context) :
     Object(context)
 {
@@ -86,16 +82,20 @@ bool OcclusionBuffer::SetSize(int width, int height, bool threaded)
     width_ = width;
     height_ = height;
 
-    // Build work buffers for threading
-    unsigned numThreadBuffers = threaded ? GetSubsystem<WorkQueue>()->GetNumThreads() + 1 : 1;
-    buffers_.resize(numThreadBuffers);
-    for (unsigned i = 0; i < numThreadBuffers; ++i)
+    // Reserve extra memory in case 3D clipping is not exact
+    buffer_.dataWithSafety_ = new int[width * (height + 2) + 2];
+    buffer_.data_ = buffer_.dataWithSafety_.get() + width + 1;
+
+    // Triangles are rasterized immediately if not threaded.
+    // Otherwise, each thread collects triangles and then tiles of buffer rows are rasterized in parallel.
+    const unsigned numThreads = threaded ? WorkQueue::GetMaxThreadIndex() : 1;
+    numTiles_ = (height + OCCLUSION_TILE_ROWS - 1) / OCCLUSION_TILE_ROWS;
+    threadData_.clear();
+    threadData_.resize(numThreads);
+    if (numThreads > 1)
     {
-        // Reserve extra memory in case 3D clipping is not exact
-        OcclusionBufferData& buffer = buffers_[i];
-        buffer.dataWithSafety_ = new int[width * (height + 2) + 2];
-        buffer.data_ = buffer.dataWithSafety_.get() + width + 1;
-        buffer.used_ = false;
+        for (OcclusionThreadData& threadData : threadData_)
+            threadData.tileTriangles_.resize(numTiles_);
     }
 
     mipBuffers_.clear();
@@ -113,7 +113,7 @@ bool OcclusionBuffer::SetSize(int width, int height, bool threaded)
     }
 
     URHO3D_LOGDEBUG("Set occlusion buffer size " + ea::to_string(width_) + "x" + ea::to_string(height_) + " with " +
-             ea::to_string(mipBuffers_.size()) + " mip levels and " + ea::to_string(numThreadBuffers) + " thread buffers");
+             ea::to_string(mipBuffers_.size()) + " mip levels and " + ea::to_string(numTiles_) + " tiles");
 
     CalculateViewport();
     return true;
@@ -159,12 +159,7 @@ void OcclusionBuffer::Reset()
 void OcclusionBuffer::Clear()
 {
     Reset();
-
-    // Only clear the main thread buffer. Rest are cleared on-demand when drawing the first batch
-    ClearBuffer(0);
-    for (unsigned i = 1; i < buffers_.size(); ++i)
-        buffers_[i].used_ = false;
-
+    ClearBuffer();
     depthHierarchyDirty_ = true;
 }
 
@@ -206,41 +201,54 @@ bool OcclusionBuffer::AddTriangles(const Matrix3x4& model, const void* vertexDat
 
 void OcclusionBuffer::DrawTriangles()
 {
-    if (buffers_.size() == 1)
+    if (threadData_.size() == 1)
     {
         // Not threaded
         for (auto i = batches_.begin(); i != batches_.end(); ++i)
             DrawBatch(*i, 0);
-
-        depthHierarchyDirty_ = true;
     }
-    else if (buffers_.size() > 1)
+    else if (threadData_.size() > 1)
     {
-        // Threaded
+        // Threaded: transform and bin triangles of each batch, then rasterize tiles independently.
+        // Each tile is rasterized by exactly one thread, so threads never write to the same pixels.
         auto* queue = GetSubsystem<WorkQueue>();
 
-        for (auto i = batches_.begin(); i != batches_.end(); ++i)
+        for (OcclusionThreadData& threadData : threadData_)
         {
-            SharedPtr<WorkItem> item = queue->GetFreeItem();
-            item->priority_ = M_MAX_UNSIGNED;
-            item->workFunction_ = DrawOcclusionBatchWork;
-            item->aux_ = this;
-            item->start_ = &(*i);
-            queue->AddWorkItem(item);
+            threadData.triangles_.clear();
+            for (ea::vector<unsigned>& tileTriangles : threadData.tileTriangles_)
+                tileTriangles.clear();
         }
 
-        queue->Complete(M_MAX_UNSIGNED);
+        ForEachParallel(queue, 1, batches_.size(), [&](unsigned beginIndex, unsigned endIndex)
+        {
+            URHO3D_PROFILE("DrawOcclusionBatchWork");
+            const unsigned threadIndex = WorkQueue::GetThreadIndex();
+            for (unsigned i = beginIndex; i < endIndex; ++i)
+                DrawBatch(batches_[i], threadIndex);
+        });
+
+        ForEachParallel(queue, 1, numTiles_, [&](unsigned beginIndex, unsigned endIndex)
+        {
+            URHO3D_PROFILE("DrawOcclusionTileWork");
+            for (unsigned i = beginIndex; i < endIndex; ++i)
+                DrawTile(i);
+        });
+    }
 
-        MergeBuffers();
-        depthHierarchyDirty_ = true;
+    for (OcclusionThreadData& threadData : threadData_)
+    {
+        numTriangles_ += threadData.numTriangles_;
+        threadData.numTriangles_ = 0;
     }
 
+    depthHierarchyDirty_ = true;
     batches_.clear();
 }
 
 void OcclusionBuffer::BuildDepthHierarchy()
 {
-    if (buffers_.empty() || !depthHierarchyDirty_)
+    if (!buffer_.data_ || !depthHierarchyDirty_)
         return;
 
     URHO3D_PROFILE("BuildDepthHierarchy");
@@ -252,7 +260,7 @@ void OcclusionBuffer::BuildDepthHierarchy()
     {
         for (int y = 0; y < height; ++y)
         {
-            int* src = buffers_[0].data_ + (y * 2) * width_;
+            int* src = buffer_.data_ + (y * 2) * width_;
             DepthValue* dest = mipBuffers_[0].get() + y * width;
             DepthValue* end = dest + width;
 
@@ -342,19 +350,25 @@ void OcclusionBuffer::ResetUseTimer()
 
 bool OcclusionBuffer::IsVisible(const BoundingBox& worldSpaceBox) const
 {
-    if (buffers_.empty())
+    if (!buffer_.data_)
         return true;
 
-    // Transform corners to projection space
+    // Transform corners to projection space. Only one corner is fully transformed,
+    // the rest are obtained by adding scaled matrix columns, which is cheaper and vectorizes well.
+    const Vector3 size = worldSpaceBox.Size();
+    const Vector4 axisX = Vector4(viewProj_.m00_, viewProj_.m10_, viewProj_.m20_, viewProj_.m30_) * size.x_;
+    const Vector4 axisY = Vector4(viewProj_.m01_, viewProj_.m11_, viewProj_.m21_, viewProj_.m31_) * size.y_;
+    const Vector4 axisZ = Vector4(viewProj_.m02_, viewProj_.m12_, viewProj_.m22_, viewProj_.m32_) * size.z_;
+
     Vector4 vertices[8];
     vertices[0] = ModelTransform(viewProj_, worldSpaceBox.min_);
-    vertices[1] = ModelTransform(viewProj_, Vector3(worldSpaceBox.max_.x_, worldSpaceBox.min_.y_, worldSpaceBox.min_.z_));
-    vertices[2] = ModelTransform(viewProj_, Vector3(worldSpaceBox.min_.x_, worldSpaceBox.max_.y_, worldSpaceBox.min_.z_));
-    vertices[3] = ModelTransform(viewProj_, Vector3(worldSpaceBox.max_.x_, worldSpaceBox.max_.y_, worldSpaceBox.min_.z_));
-    vertices[4] = ModelTransform(viewProj_, Vector3(worldSpaceBox.min_.x_, worldSpaceBox.min_.y_, worldSpaceBox.max_.z_));
-    vertices[5] = ModelTransform(viewProj_, Vector3(worldSpaceBox.max_.x_, worldSpaceBox.min_.y_, worldSpaceBox.max_.z_));
-    vertices[6] = ModelTransform(viewProj_, Vector3(worldSpaceBox.min_.x_, worldSpaceBox.max_.y_, worldSpaceBox.max_.z_));
-    vertices[7] = ModelTransform(viewProj_, worldSpaceBox.max_);
+    vertices[1] = vertices[0] + axisX;
+    vertices[2] = vertices[0] + axisY;
+    vertices[3] = vertices[1] + axisY;
+    vertices[4] = vertices[0] + axisZ;
+    vertices[5] = vertices[1] + axisZ;
+    vertices[6] = vertices[2] + axisZ;
+    vertices[7] = vertices[3] + axisZ;
 
     // Apply a far clip relative bias
     for (auto& vertice : vertices)
@@ -444,8 +458,8 @@ bool OcclusionBuffer::IsVisible(const BoundingBox& worldSpaceBox) const
     }
 
     // If no conclusive result, finally check the pixel-level data
-    int* row = buffers_[0].data_ + rect.top_ * width_;
-    int* endRow = buffers_[0].data_ + rect.bottom_ * width_;
+    int* row = buffer_.data_ + rect.top_ * width_;
+    int* endRow = buffer_.data_ + rect.bottom_ * width_;
     while (row <= endRow)
     {
         int* src = row + rect.left_;
@@ -470,13 +484,6 @@ unsigned OcclusionBuffer::GetUseTimer()
 
 void OcclusionBuffer::DrawBatch(const OcclusionBatch& batch, unsigned threadIndex)
 {
-    // If buffer not yet used, clear it
-    if (threadIndex > 0 && !buffers_[threadIndex].used_)
-    {
-        ClearBuffer(threadIndex);
-        buffers_[threadIndex].used_ = true;
-    }
-
     Matrix4 modelViewProj = viewProj_ * batch.model_;
 
     // Theoretical max. amount of vertices if each of the 6 clipping planes doubles the triangle count
@@ -640,7 +647,7 @@ void OcclusionBuffer::DrawTriangle(Vector4* vertices, unsigned threadIndex)
         bool clockwise = SignedArea(projected[0], projected[1], projected[2]) < 0.0f;
         if (cullMode_ == CULL_NONE || (cullMode_ == CULL_CCW && clockwise) || (cullMode_ == CULL_CW && !clockwise))
         {
-            DrawTriangle2D(projected, clockwise, threadIndex);
+            SubmitTriangle2D(projected, clockwise, threadIndex);
             drawOk = true;
         }
     }
@@ -678,7 +685,7 @@ void OcclusionBuffer::DrawTriangle(Vector4* vertices, unsigned threadIndex)
                 bool clockwise = SignedArea(projected[0], projected[1], projected[2]) < 0.0f;
                 if (cullMode_ == CULL_NONE || (cullMode_ == CULL_CCW && clockwise) || (cullMode_ == CULL_CW && !clockwise))
                 {
-                    DrawTriangle2D(projected, clockwise, threadIndex);
+                    SubmitTriangle2D(projected, clockwise, threadIndex);
                     drawOk = true;
                 }
             }
@@ -686,7 +693,7 @@ void OcclusionBuffer::DrawTriangle(Vector4* vertices, unsigned threadIndex)
     }
 
     if (drawOk)
-        ++numTriangles_;
+        ++threadData_[threadIndex].numTriangles_;
 }
 
 void OcclusionBuffer::ClipVertices(const Vector4& plane, Vector4* vertices, bool* triangles, unsigned& numTriangles)
@@ -809,6 +816,13 @@ struct Edge
         invZStep_ = RoundToInt(slope * gradients.dInvZdX_ + gradients.dInvZdY_);
     }
 
+    /// Advance edge by given number of rows.
+    void Advance(int numRows)
+    {
+        x_ += xStep_ * numRows;
+        invZ_ += invZStep_ * numRows;
+    }
+
     /// X coordinate.
     int x_;
     /// X coordinate step.
@@ -819,7 +833,100 @@ struct Edge
     int invZStep_;
 };
 
-void OcclusionBuffer::DrawTriangle2D(const Vector3* vertices, bool clockwise, unsigned threadIndex)
+/// Draw horizontal span of depth values, keeping the closest ones.
+inline void DrawDepthSpan(int* dest, int* end, int invZ, int invZStep)
+{
+#ifdef URHO3D_SSE
+    const __m128i invZStep4 = _mm_set1_epi32(invZStep * 4);
+    __m128i invZ4 = _mm_setr_epi32(invZ, invZ + invZStep, invZ + invZStep * 2, invZ + invZStep * 3);
+    while (end - dest >= 4)
+    {
+        const __m128i depth = _mm_loadu_si128(reinterpret_cast<const __m128i*>(dest));
+        const __m128i closer = _mm_cmplt_epi32(invZ4, depth);
+        const __m128i result = _mm_or_si128(_mm_and_si128(closer, invZ4), _mm_andnot_si128(closer, depth));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(dest), result);
+        invZ4 = _mm_add_epi32(invZ4, invZStep4);
+        dest += 4;
+    }
+    invZ = _mm_cvtsi128_si32(invZ4);
+#endif
+
+    while (dest < end)
+    {
+        if (invZ < *dest)
+            *dest = invZ;
+        invZ += invZStep;
+        ++dest;
+    }
+}
+
+/// Draw spans between left and right edges for rows [beginY, endY) clipped to [clipTop, clipBottom).
+/// Edges are expected to be positioned at beginY.
+inline void DrawTriangleSpans(int* bufferData, int width, Edge left, Edge right, int dInvZdX,
+    int beginY, int endY, int clipTop, int clipBottom)
+{
+    const int startY = Max(beginY, clipTop);
+    const int stopY = Min(endY, clipBottom);
+    if (startY >= stopY)
+        return;
+
+    left.Advance(startY - beginY);
+    right.Advance(startY - beginY);
+
+    int* row = bufferData + startY * width;
+    int* endRow = bufferData + stopY * width;
+    while (row < endRow)
+    {
+        DrawDepthSpan(row + (left.x_ >> 16u), row + (right.x_ >> 16u), left.invZ_, dInvZdX);
+
+        left.x_ += left.xStep_;
+        left.invZ_ += left.invZStep_;
+        right.x_ += right.xStep_;
+        row += width;
+    }
+}
+
+void OcclusionBuffer::SubmitTriangle2D(const Vector3* vertices, bool clockwise, unsigned threadIndex)
+{
+    if (threadData_.size() == 1)
+    {
+        DrawTriangle2D(vertices, clockwise, 0, height_);
+        return;
+    }
+
+    const int topY = (int)Min(vertices[0].y_, Min(vertices[1].y_, vertices[2].y_));
+    const int bottomY = (int)Max(vertices[0].y_, Max(vertices[1].y_, vertices[2].y_));
+    if (topY == bottomY)
+        return;
+
+    const int firstTile = Clamp(topY, 0, height_ - 1) / OCCLUSION_TILE_ROWS;
+    const int lastTile = Clamp(bottomY - 1, 0, height_ - 1) / OCCLUSION_TILE_ROWS;
+
+    OcclusionThreadData& threadData = threadData_[threadIndex];
+    const unsigned triangleIndex = threadData.triangles_.size();
+    OcclusionTriangle& triangle = threadData.triangles_.emplace_back();
+    ea::copy(vertices, vertices + 3, triangle.vertices_);
+    triangle.clockwise_ = clockwise;
+
+    for (int tileIndex = firstTile; tileIndex <= lastTile; ++tileIndex)
+        threadData.tileTriangles_[tileIndex].push_back(triangleIndex);
+}
+
+void OcclusionBuffer::DrawTile(unsigned tileIndex)
+{
+    const int clipTop = tileIndex * OCCLUSION_TILE_ROWS;
+    const int clipBottom = Min(clipTop + OCCLUSION_TILE_ROWS, height_);
+    for (const OcclusionThreadData& threadData : threadData_)
+    {
+        for (unsigned triangleIndex : threadData.tileTriangles_[tileIndex])
+        {
+            const OcclusionTriangle& triangle = threadData.triangles_[triangleIndex];
+            DrawTriangle2D(triangle.vertices_, triangle.clockwise_, clipTop, clipBottom);
+        }
+    }
+}
+
+void OcclusionBuffer::DrawTriangle2D(const Vector3* vertices, bool clockwise, int clipTop, int clipBottom)
 {
     int top, middle, bottom;
     bool middleIsRight;
@@ -896,148 +1003,48 @@ void OcclusionBuffer::DrawTriangle2D(const Vector3* vertices, bool clockwise, un
     Gradients gradients(vertices);
     Edge topToBottom(gradients, vertices[top], vertices[bottom], topY);
 
-    int* bufferData = buffers_[threadIndex].data_;
+    int* bufferData = buffer_.data_;
 
-    if (middleIsRight)
+    // Top half
+    if (!topDegenerate)
     {
-        // Top half
-        if (!topDegenerate)
+        Edge topToMiddle(gradients, vertices[top], vertices[middle], topY);
+        if (middleIsRight)
         {
-            Edge topToMiddle(gradients, vertices[top], vertices[middle], topY);
-            int* row = bufferData + topY * width_;
-            int* endRow = bufferData + middleY * width_;
-            while (row < endRow)
-            {
-                int invZ = topToBottom.invZ_;
-                int* dest = row + (topToBottom.x_ >> 16u);
-                int* end = row + (topToMiddle.x_ >> 16u);
-                while (dest < end)
-                {
-                    if (invZ < *dest)
-                        *dest = invZ;
-                    invZ += gradients.dInvZdXInt_;
-                    ++dest;
-                }
-
-                topToBottom.x_ += topToBottom.xStep_;
-                topToBottom.invZ_ += topToBottom.invZStep_;
-                topToMiddle.x_ += topToMiddle.xStep_;
-                row += width_;
-            }
+            DrawTriangleSpans(bufferData, width_, topToBottom, topToMiddle, gradients.dInvZdXInt_,
+                topY, middleY, clipTop, clipBottom);
         }
-
-        // Bottom half
-        if (!bottomDegenerate)
+        else
         {
-            Edge middleToBottom(gradients, vertices[middle], vertices[bottom], middleY);
-            int* row = bufferData + middleY * width_;
-            int* endRow = bufferData + bottomY * width_;
-            while (row < endRow)
-            {
-                int invZ = topToBottom.invZ_;
-                int* dest = row + (topToBottom.x_ >> 16u);
-                int* end = row + (middleToBottom.x_ >> 16u);
-                while (dest < end)
-                {
-                    if (invZ < *dest)
-                        *dest = invZ;
-                    invZ += gradients.dInvZdXInt_;
-                    ++dest;
-                }
-
-                topToBottom.x_ += topToBottom.xStep_;
-                topToBottom.invZ_ += topToBottom.invZStep_;
-                middleToBottom.x_ += middleToBottom.xStep_;
-                row += width_;
-            }
+            DrawTriangleSpans(bufferData, width_, topToMiddle, topToBottom, gradients.dInvZdXInt_,
+                topY, middleY, clipTop, clipBottom);
         }
     }
-    else
-    {
-        // Top half
-        if (!topDegenerate)
-        {
-            Edge topToMiddle(gradients, vertices[top], vertices[middle], topY);
-            int* row = bufferData + topY * width_;
-            int* endRow = bufferData + middleY * width_;
-            while (row < endRow)
-            {
-                int invZ = topToMiddle.invZ_;
-                int* dest = row + (topToMiddle.x_ >> 16u);
-                int* end = row + (topToBottom.x_ >> 16u);
-                while (dest < end)
-                {
-                    if (invZ < *dest)
-                        *dest = invZ;
-                    invZ += gradients.dInvZdXInt_;
-                    ++dest;
-                }
-
-                topToMiddle.x_ += topToMiddle.xStep_;
-                topToMiddle.invZ_ += topToMiddle.invZStep_;
-                topToBottom.x_ += topToBottom.xStep_;
-                row += width_;
-            }
-        }
 
-        // Bottom half
-        if (!bottomDegenerate)
+    // Bottom half
+    if (!bottomDegenerate)
+    {
+        topToBottom.Advance(middleY - topY);
+        Edge middleToBottom(gradients, vertices[middle], vertices[bottom], middleY);
+        if (middleIsRight)
         {
-            Edge middleToBottom(gradients, vertices[middle], vertices[bottom], middleY);
-            int* row = bufferData + middleY * width_;
-            int* endRow = bufferData + bottomY * width_;
-            while (row < endRow)
-            {
-                int invZ = middleToBottom.invZ_;
-                int* dest = row + (middleToBottom.x_ >> 16u);
-                int* end = row + (topToBottom.x_ >> 16u);
-                while (dest < end)
-                {
-                    if (invZ < *dest)
-                        *dest = invZ;
-                    invZ += gradients.dInvZdXInt_;
-                    ++dest;
-                }
-
-                middleToBottom.x_ += middleToBottom.xStep_;
-                middleToBottom.invZ_ += middleToBottom.invZStep_;
-                topToBottom.x_ += topToBottom.xStep_;
-                row += width_;
-            }
+            DrawTriangleSpans(bufferData, width_, topToBottom, middleToBottom, gradients.dInvZdXInt_,
+                middleY, bottomY, clipTop, clipBottom);
         }
-    }
-}
-
-void OcclusionBuffer::MergeBuffers()
-{
-    URHO3D_PROFILE("MergeBuffers");
-
-    for (unsigned i = 1; i < buffers_.size(); ++i)
-    {
-        if (!buffers_[i].used_)
-            continue;
-
-        int* src = buffers_[i].data_;
-        int* dest = buffers_[0].data_;
-        int count = width_ * height_;
-
-        while (count--)
+        else
         {
-            // If thread buffer's depth value is closer, overwrite the original
-            if (*src < *dest)
-                *dest = *src;
-            ++src;
-            ++dest;
+            DrawTriangleSpans(bufferData, width_, middleToBottom, topToBottom, gradients.dInvZdXInt_,
+                middleY, bottomY, clipTop, clipBottom);
         }
     }
 }
 
-void OcclusionBuffer::ClearBuffer(unsigned threadIndex)
+void OcclusionBuffer::ClearBuffer()
 {
-    if (threadIndex >= buffers_.size())
+    if (!buffer_.data_)
         return;
 
-    int* dest = buffers_[threadIndex].data_;
+    int* dest = buffer_.data_;
     int count = width_ * height_;
     auto fillValue = (int)OCCLUSION_Z_SCALE;
 
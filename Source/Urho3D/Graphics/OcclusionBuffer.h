@@ -51,15 +51,33 @@ struct DepthValue
     int max_;
 };
 
-/// Per-thread occlusion buffer data.
+/// Occlusion buffer data.
 struct OcclusionBufferData
 {
     /// Full buffer data with safety padding.
     ea::shared_array<int> dataWithSafety_;
     /// Buffer data.
-    int* data_;
-    /// Use flag.
-    bool used_;
+    int* data_{};
+};
+
+/// Triangle projected to occlusion buffer space and waiting for rasterization.
+struct OcclusionTriangle
+{
+    /// Vertices in buffer space.
+    Vector3 vertices_[3];
+    /// Whether the triangle is clockwise.
+    bool clockwise_{};
+};
+
+/// Per-thread storage of projected triangles. Triangles are binned into tiles of buffer rows.
+struct OcclusionThreadData
+{
+    /// Projected triangles.
+    ea::vector<OcclusionTriangle> triangles_;
+    /// Indices of triangles overlapping each tile.
+    ea::vector<ea::vector<unsigned>> tileTriangles_;
+    /// Number of triangles drawn by the thread.
+    unsigned numTriangles_{};
 };
 
 /// Stored occlusion render job.
@@ -87,6 +105,7 @@ static const float OCCLUSION_RELATIVE_BIAS = 0.00001f;
 static const int OCCLUSION_FIXED_BIAS = 16;
 static const float OCCLUSION_X_SCALE = 65536.0f;
 static const float OCCLUSION_Z_SCALE = 16777216.0f;
+static const int OCCLUSION_TILE_ROWS = 16;
 
 /// Software renderer for occlusion.
 class URHO3D_API OcclusionBuffer : public Object
@@ -127,7 +146,7 @@ public:
     void ResetUseTimer();
 
     /// Return highest level depth values.
-    int* GetBuffer() const { return buffers_.size() ? buffers_[0].data_ : nullptr; }
+    int* GetBuffer() const { return buffer_.data_; }
 
     /// Return view transform matrix.
     const Matrix3x4& GetView() const { return view_; }
@@ -151,7 +170,7 @@ public:
     CullMode GetCullMode() const { return cullMode_; }
 
     /// Return whether is using threads to speed up rendering.
-    bool IsThreaded() const { return buffers_.size() > 1; }
+    bool IsThreaded() const { return threadData_.size() > 1; }
 
     /// Test a bounding box for visibility. For best performance, build depth hierarchy first.
     bool IsVisible(const BoundingBox& worldSpaceBox) const;
@@ -176,15 +195,21 @@ private:
     void DrawTriangle(Vector4* vertices, unsigned threadIndex);
     /// Clip vertices against a plane.
     void ClipVertices(const Vector4& plane, Vector4* vertices, bool* triangles, unsigned& numTriangles);
-    /// Draw a clipped triangle.
-    void DrawTriangle2D(const Vector3* vertices, bool clockwise, unsigned threadIndex);
-    /// Clear a thread work buffer.
-    void ClearBuffer(unsigned threadIndex);
-    /// Merge thread work buffers into the first buffer.
-    void MergeBuffers();
-
-    /// Highest-level buffer data per thread.
-    ea::vector<OcclusionBufferData> buffers_;
+    /// Draw a clipped triangle immediately or store it for threaded rasterization.
+    void SubmitTriangle2D(const Vector3* vertices, bool clockwise, unsigned threadIndex);
+    /// Draw a clipped triangle. Only rows in range [clipTop, clipBottom) are drawn.
+    void DrawTriangle2D(const Vector3* vertices, bool clockwise, int clipTop, int clipBottom);
+    /// Draw stored triangles that overlap a tile.
+    void DrawTile(unsigned tileIndex);
+    /// Clear the buffer.
+    void ClearBuffer();
+
+    /// Highest-level buffer data.
+    OcclusionBufferData buffer_;
+    /// Per-thread storage of triangles. Contains one element if threading is disabled.
+    ea::vector<OcclusionThreadData> threadData_;
+    /// Number of tiles of buffer rows.
+    unsigned numTiles_{};
     /// Reduced size depth buffers.
     ea::vector<ea::shared_array<DepthValue> > mipBuffers_;
     /// Submitted render jobs.
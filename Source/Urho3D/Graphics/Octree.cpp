@@ -28,6 +28,7 @@
 #include "../Core/CoreEvents.h"
 #include "../Core/Profiler.h"
 #include "../Core/Thread.h"
+#include "../Graphics/AnimationController.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../Graphics/Graphics.h"
 #include "../Graphics/Octree.h"
@@ -60,22 +61,6 @@ static const int DEFAULT_OCTREE_LEVELS = 8;
 
 extern const char* SUBSYSTEM_CATEGORY;
 
-void UpdateDrawablesWork(const WorkItem* item, unsigned threadIndex)
-{
-    URHO3D_PROFILE("UpdateDrawablesWork");
-    const FrameInfo& frame = *(reinterpret_cast<FrameInfo*>(item->aux_));
-    auto** start = reinterpret_cast<Drawable**>(item->start_);
-    auto** end = reinterpret_cast<Drawable**>(item->end_);
-
-    while (start != end)
-    {
-        Drawable* drawable = *start;
-        if (drawable)
-            drawable->Update(frame);
-        ++start;
-    }
-}
-
 inline bool CompareRayQueryResults(const RayQueryResult& lhs, const RayQueryResult& rhs)
 {
     return lhs.distance_ < rhs.distance_;
@@ -443,6 +428,8 @@ Octree::Octree(Context* context) :
 
 Octree::~Octree()
 {
+    ReleaseAnimationControllers();
+
     // Reset root pointer from all child octants now so that they do not move their drawables to root
     drawableUpdates_.clear();
     rootOctant_.ResetOctree();
@@ -458,6 +445,7 @@ void Octree::RegisterObject(Context* context)
     URHO3D_ATTRIBUTE_EX("Bounding Box Min", Vector3, worldBoundingBox_.min_, UpdateOctreeSize, defaultBoundsMin, AM_DEFAULT);
     URHO3D_ATTRIBUTE_EX("Bounding Box Max", Vector3, worldBoundingBox_.max_, UpdateOctreeSize, defaultBoundsMax, AM_DEFAULT);
     URHO3D_ATTRIBUTE_EX("Number of Levels", int, numLevels_, UpdateOctreeSize, DEFAULT_OCTREE_LEVELS, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Animation Bone Budget", GetAnimationBoneBudget, SetAnimationBoneBudget, unsigned, 0, AM_DEFAULT);
 }
 
 void Octree::DrawDebugGeometry(DebugRenderer* debug, bool depthTest)
@@ -493,37 +481,25 @@ void Octree::Update(const FrameInfo& frame)
         URHO3D_PROFILE("UpdateDrawables");
 
         // Perform updates in worker threads. Notify the scene that a threaded update is going on and components
-        // (for example physics objects) should not perform non-threadsafe work when marked dirty
+        // (for example physics objects) should not perform non-threadsafe work when marked dirty.
+        // Small tasks are used because cost of update varies a lot between drawables.
         Scene* scene = GetScene();
         auto* queue = GetSubsystem<WorkQueue>();
         scene->BeginThreadedUpdate();
 
         pendingNodeTransforms_.Clear();
 
-        int numWorkItems = queue->GetNumThreads() + 1; // Worker threads + main thread
-        int drawablesPerItem = Max((int)(drawableUpdates_.size() / numWorkItems), 1);
-
-        auto start = drawableUpdates_.begin();
-        // Create a work item for each thread
-        for (int i = 0; i < numWorkItems; ++i)
+        ForEachParallel(queue, DrawablesPerParallelTask, drawableUpdates_.size(),
+            [&](unsigned beginIndex, unsigned endIndex)
         {
-            SharedPtr<WorkItem> item = queue->GetFreeItem();
-            item->priority_ = M_MAX_UNSIGNED;
-            item->workFunction_ = UpdateDrawablesWork;
-            item->aux_ = const_cast<FrameInfo*>(&frame);
-
-            auto end = drawableUpdates_.end();
-            if (i < numWorkItems - 1 && end - start > drawablesPerItem)
-                end = start + drawablesPerItem;
-
-            item->start_ = &(*start);
-            item->end_ = &(*end);
-            queue->AddWorkItem(item);
-
-            start = end;
-        }
+            URHO3D_PROFILE("UpdateDrawablesWork");
+            for (unsigned i = beginIndex; i < endIndex; ++i)
+            {
+                if (Drawable* drawable = drawableUpdates_[i])
+                    drawable->Update(frame);
+            }
+        });
 
-        queue->Complete(M_MAX_UNSIGNED);
         scene->EndThreadedUpdate();
     }
 
@@ -546,6 +522,8 @@ void Octree::Update(const FrameInfo& frame)
         threadedDrawableUpdates_.clear();
     }
 
+    UpdateAnimationLodScale();
+
     // Commit delayed Node transforms
     if (!drawableUpdates_.empty())
     {
@@ -791,9 +769,10 @@ void Octree::QueueUpdate(Drawable* drawable)
 
 void Octree::CancelUpdate(Drawable* drawable)
 {
-    // This doesn't have to take into account scene being in threaded update, because it is called only
-    // when removing a drawable from octree, which should only ever happen from the main thread.
+    // This doesn't have to lock the mutex, because it is called only when removing a drawable from octree,
+    // which should only ever happen from the main thread outside of threaded update.
     drawableUpdates_.erase_first(drawable);
+    threadedDrawableUpdates_.erase_first(drawable);
     drawable->updateQueued_ = false;
 }
 
@@ -808,6 +787,153 @@ void Octree::DrawDebugGeometry(bool depthTest)
     DrawDebugGeometry(debug, depthTest);
 }
 
+unsigned Octree::AnimationControllerIndex::GetIndex(const AnimationController* controller) const
+{
+    return controller->updateOctreeIndex_;
+}
+
+void Octree::AnimationControllerIndex::SetIndex(AnimationController* controller, unsigned index) const
+{
+    controller->updateOctreeIndex_ = index;
+}
+
+void Octree::AddAnimationController(AnimationController* controller)
+{
+    animationControllers_.Add(controller);
+}
+
+void Octree::RemoveAnimationController(AnimationController* controller)
+{
+    // Don't shift other controllers here, they may be iterated right now
+    animationControllers_.Remove(controller);
+}
+
+void Octree::SetAnimationBoneBudget(unsigned budget)
+{
+    animationBoneBudget_ = budget;
+    if (!animationBoneBudget_)
+        animationLodScale_ = 1.0f;
+}
+
+void Octree::UpdateAnimationLodScale()
+{
+    // Models are not evaluated on every frame, use smoothed value to avoid oscillations
+    const unsigned numEvaluatedBones = numEvaluatedAnimationBones_.exchange(0, std::memory_order_relaxed);
+    averageEvaluatedAnimationBones_ = Lerp(averageEvaluatedAnimationBones_,
+        static_cast<float>(numEvaluatedBones), AnimationBoneBudgetSmoothing);
+
+    if (!animationBoneBudget_)
+        return;
+
+    // Number of evaluated bones is roughly inversely proportional to the scale for distant models
+    const float ratio = averageEvaluatedAnimationBones_ / animationBoneBudget_;
+    if (ratio > 1.0f || animationLodScale_ > 1.0f)
+    {
+        const float correction = Sqrt(Clamp(ratio, 0.5f, 2.0f));
+        animationLodScale_ = Clamp(animationLodScale_ * correction, 1.0f, MaxAnimationLodScale);
+    }
+}
+
+void Octree::OnSceneSet(Scene* scene)
+{
+    if (scene)
+    {
+        SubscribeToEvent(scene, E_SCENEPOSTUPDATE, URHO3D_HANDLER(Octree, HandleScenePostUpdate));
+
+        // Take over AnimationController-s that were created before the Octree
+        ea::vector<AnimationController*> controllers;
+        scene->GetComponents<AnimationController>(controllers, true);
+        for (AnimationController* controller : controllers)
+            controller->UpdateEventSubscription();
+    }
+    else
+    {
+        UnsubscribeFromEvent(E_SCENEPOSTUPDATE);
+        ReleaseAnimationControllers();
+    }
+}
+
+void Octree::HandleScenePostUpdate(StringHash eventType, VariantMap& eventData)
+{
+    using namespace ScenePostUpdate;
+
+    UpdateAnimationControllers(eventData[P_TIMESTEP].GetFloat());
+}
+
+void Octree::UpdateAnimationControllers(float timeStep)
+{
+    animationControllers_.Compact();
+    if (animationControllers_.Empty())
+        return;
+
+    URHO3D_PROFILE("UpdateAnimationControllers");
+
+    // Controllers added during the update will be updated next time
+    const unsigned numControllers = animationControllers_.Size();
+
+    // Resolve animation tracks in the main thread because it may access arbitrary nodes
+    for (unsigned i = 0; i < numControllers; ++i)
+    {
+        if (AnimationController* controller = animationControllers_[i])
+            controller->PrepareUpdate();
+    }
+
+    // Advance animations and mark animated models dirty, animated models will be updated in parallel later
+    if (numControllers >= MinAnimationControllersForParallelUpdate)
+    {
+        Scene* scene = GetScene();
+        auto workQueue = GetSubsystem<WorkQueue>();
+        scene->BeginThreadedUpdate();
+        ForEachParallel(workQueue, AnimationControllersPerParallelTask, numControllers,
+            [&](unsigned beginIndex, unsigned endIndex)
+        {
+            for (unsigned i = beginIndex; i < endIndex; ++i)
+            {
+                if (AnimationController* controller = animationControllers_[i])
+                    controller->UpdateAnimationStates(timeStep);
+            }
+        });
+        scene->EndThreadedUpdate();
+
+        // Animated models marked dirty by the controllers are updated in parallel with the other drawables.
+        // Move them to the main queue immediately so they are cancelled properly if removed before the update.
+        for (Drawable* drawable : threadedDrawableUpdates_)
+        {
+            if (drawable)
+                drawableUpdates_.push_back(drawable);
+        }
+        threadedDrawableUpdates_.clear();
+    }
+    else
+    {
+        for (unsigned i = 0; i < numControllers; ++i)
+        {
+            if (AnimationController* controller = animationControllers_[i])
+                controller->UpdateAnimationStates(timeStep);
+        }
+    }
+
+    // Node and attribute animations may have arbitrary side effects, apply them in the main thread
+    for (unsigned i = 0; i < numControllers && i < animationControllers_.Size(); ++i)
+    {
+        if (AnimationController* controller = animationControllers_[i])
+            controller->CommitUpdate();
+    }
+}
+
+void Octree::ReleaseAnimationControllers()
+{
+    // Controllers may be removed from the list when released
+    const ea::vector<AnimationController*> controllers = animationControllers_.GetElements();
+    animationControllers_.Clear();
+
+    for (AnimationController* controller : controllers)
+    {
+        if (controller)
+            controller->DisconnectFromOctree();
+    }
+}
+
 void Octree::HandleRenderUpdate(StringHash eventType, VariantMap& eventData)
 {
     // When running in headless mode, update the Octree manually during the RenderUpdate event
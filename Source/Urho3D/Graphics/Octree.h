@@ -23,6 +23,7 @@
 #pragma once
 
 #include "../Container/MultiVector.h"
+#include "../Container/StableIndexVector.h"
 #include "../Core/Mutex.h"
 #include "../Core/WorkQueue.h"
 #include "../Graphics/Drawable.h"
@@ -32,6 +33,7 @@
 namespace Urho3D
 {
 
+class AnimationController;
 class Octree;
 class Zone;
 
@@ -280,9 +282,53 @@ public:
     /// Visualize the component as debug geometry.
     void DrawDebugGeometry(bool depthTest);
 
+    /// Add AnimationController to batched update. For internal use only.
+    void AddAnimationController(AnimationController* controller);
+    /// Remove AnimationController from batched update. Safe to call during the update. For internal use only.
+    void RemoveAnimationController(AnimationController* controller);
+    /// Return number of AnimationController-s updated in batch.
+    unsigned GetNumAnimationControllers() const { return animationControllers_.GetNumElements(); }
+
+    /// Set max number of bones evaluated by animation per frame. Animation LOD of all models is scaled to fit the budget.
+    /// Zero budget means no limit.
+    /// @property
+    void SetAnimationBoneBudget(unsigned budget);
+    /// Return max number of bones evaluated by animation per frame.
+    /// @property
+    unsigned GetAnimationBoneBudget() const { return animationBoneBudget_; }
+    /// Return scale of animation LOD distances chosen to fit the budget.
+    float GetAnimationLodScale() const { return animationLodScale_; }
+    /// Return average number of bones evaluated by animation per frame.
+    float GetAverageEvaluatedAnimationBones() const { return averageEvaluatedAnimationBones_; }
+    /// Report bones evaluated by animation. Safe to call from worker threads. For internal use only.
+    void AddEvaluatedAnimationBones(unsigned numBones) { numEvaluatedAnimationBones_.fetch_add(numBones, std::memory_order_relaxed); }
+
+    /// Min number of AnimationController-s to update them in parallel.
+    static const unsigned MinAnimationControllersForParallelUpdate = 128;
+    /// Number of AnimationController-s processed by one parallel task.
+    static const unsigned AnimationControllersPerParallelTask = 32;
+    /// Number of drawables processed by one parallel task.
+    static const unsigned DrawablesPerParallelTask = 16;
+    /// Max scale of animation LOD distances when animation bone budget is exceeded.
+    static constexpr float MaxAnimationLodScale = 64.0f;
+    /// Smoothing factor for number of bones evaluated per frame.
+    static constexpr float AnimationBoneBudgetSmoothing = 0.25f;
+
+protected:
+    /// Handle scene being assigned.
+    void OnSceneSet(Scene* scene) override;
+
 private:
     /// Handle render update in case of headless execution.
     void HandleRenderUpdate(StringHash eventType, VariantMap& eventData);
+    /// Handle scene post-update event.
+    void HandleScenePostUpdate(StringHash eventType, VariantMap& eventData);
+    /// Update all AnimationController-s in batch.
+    void UpdateAnimationControllers(float timeStep);
+    /// Return all AnimationController-s to individual update.
+    void ReleaseAnimationControllers();
+    /// Adjust animation LOD scale to fit the bone budget.
+    void UpdateAnimationLodScale();
     /// Update octree size.
     void UpdateOctreeSize() { SetSize(worldBoundingBox_, numLevels_); }
 
@@ -296,6 +342,22 @@ private:
     WorkQueueVector<ea::pair<Node*, Transform>> pendingNodeTransforms_;
     /// All Drawable objects.
     ea::vector<Drawable*> drawables_;
+    /// Accessor of index in animationControllers_.
+    struct AnimationControllerIndex
+    {
+        unsigned GetIndex(const AnimationController* controller) const;
+        void SetIndex(AnimationController* controller, unsigned index) const;
+    };
+    /// AnimationController-s updated in batch. Removed controllers are replaced with null until the next update.
+    StableIndexVector<AnimationController, AnimationControllerIndex> animationControllers_;
+    /// Max number of bones evaluated by animation per frame.
+    unsigned animationBoneBudget_{};
+    /// Number of bones evaluated by animation during current frame.
+    std::atomic<unsigned> numEvaluatedAnimationBones_{};
+    /// Average number of bones evaluated by animation per frame.
+    float averageEvaluatedAnimationBones_{};
+    /// Current scale of animation LOD distances.
+    float animationLodScale_{1.0f};
     /// Mutex for octree reinsertions.
     Mutex octreeMutex_;
     /// Ray query temporary list of drawables.
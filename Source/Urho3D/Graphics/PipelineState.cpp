@@ -27,6 +27,7 @@
 #include "../IO/Log.h"
 #include "../Graphics/Geometry.h"
 #include "../Graphics/Graphics.h"
+#include "../Graphics/PipelineStatePrecache.h"
 #include "../Graphics/Shader.h"
 #include "../Resource/ResourceEvents.h"
 
@@ -129,6 +130,8 @@ PipelineStateCache::PipelineStateCache(Context* context)
     SubscribeToEvent(E_RELOADFINISHED, &PipelineStateCache::HandleResourceReload);
 }
 
+PipelineStateCache::~PipelineStateCache() = default;
+
 SharedPtr<PipelineState> PipelineStateCache::GetPipelineState(PipelineStateDesc desc)
 {
     if (!desc.IsInitialized())
@@ -143,6 +146,8 @@ SharedPtr<PipelineState> PipelineStateCache::GetPipelineState(PipelineStateDesc
         pipelineState = MakeShared<PipelineState>(this);
         pipelineState->Setup(desc);
         weakPipelineState = pipelineState;
+        if (precache_)
+            precache_->StorePipelineState(desc);
     }
     pipelineState->RestoreCachedState(graphics_);
     return pipelineState;
@@ -154,6 +159,16 @@ void PipelineStateCache::ReleasePipelineState(const PipelineStateDesc& desc)
         URHO3D_LOGERROR("Unexpected call of PipelineStateCache::ReleasePipelineState");
 }
 
+void PipelineStateCache::BeginPrecache(const ea::string& fileName)
+{
+    precache_ = MakeShared<PipelineStatePrecache>(this, fileName);
+}
+
+void PipelineStateCache::EndPrecache()
+{
+    precache_ = nullptr;
+}
+
 void PipelineStateCache::OnDeviceLost()
 {
     for (const auto& item : states_)
@@ -40,6 +40,7 @@ namespace Urho3D
 
 class Geometry;
 class PipelineStateCache;
+class PipelineStatePrecache;
 class ShaderVariation;
 
 /// Set of input buffers with vertex and index data.
@@ -263,6 +264,7 @@ class URHO3D_API PipelineStateCache : public Object, private GPUObject
 
 public:
     explicit PipelineStateCache(Context* context);
+    ~PipelineStateCache() override;
 
     /// Create new or return existing pipeline state. Returned state may be invalid.
     /// Return nullptr if description is malformed.
@@ -271,6 +273,13 @@ public:
     /// Internal. Remove pipeline state with given description from cache.
     void ReleasePipelineState(const PipelineStateDesc& desc);
 
+    /// Begin recording created pipeline states to file. Pipeline states recorded during previous runs are precached.
+    void BeginPrecache(const ea::string& fileName);
+    /// End recording created pipeline states and save them to file.
+    void EndPrecache();
+    /// Return pipeline state precache, if any.
+    PipelineStatePrecache* GetPrecache() const { return precache_; }
+
 private:
     /// GPUObject callbacks
     /// @{
@@ -282,6 +291,7 @@ private:
     void HandleResourceReload(StringHash eventType, VariantMap& eventData);
 
     ea::unordered_map<PipelineStateDesc, WeakPtr<PipelineState>> states_;
+    SharedPtr<PipelineStatePrecache> precache_;
 };
 
 }
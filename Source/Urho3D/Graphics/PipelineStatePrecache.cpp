@@ -0,0 +1,305 @@
+//
+// Copyright (c) 2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/CoreEvents.h"
+#include "../Core/Profiler.h"
+#include "../Graphics/PipelineStatePrecache.h"
+#include "../Graphics/Shader.h"
+#include "../Graphics/ShaderVariation.h"
+#include "../IO/ArchiveSerialization.h"
+#include "../IO/BinaryArchive.h"
+#include "../IO/File.h"
+#include "../IO/FileSystem.h"
+#include "../IO/Log.h"
+#include "../Resource/ResourceCache.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+/// Version of file format. Increment on any change in PipelineStateDesc.
+static const unsigned PipelineStatePrecacheVersion = 1;
+
+void SerializeVertexElement(Archive& archive, const char* name, VertexElement& value)
+{
+    ArchiveBlock block = archive.OpenUnorderedBlock(name);
+    SerializeValueAsType<unsigned>(archive, "type", value.type_);
+    SerializeValueAsType<unsigned>(archive, "semantic", value.semantic_);
+    SerializeValue(archive, "index", value.index_);
+    SerializeValue(archive, "perInstance", value.perInstance_);
+    SerializeValue(archive, "offset", value.offset_);
+}
+
+}
+
+void PipelineStatePrecacheEntry::SerializeInBlock(Archive& archive)
+{
+    SerializeValue(archive, "vs", vertexShaderName_);
+    SerializeValue(archive, "vsdefines", vertexShaderDefines_);
+    SerializeValue(archive, "vshash", vertexShaderSourceHash_);
+    SerializeValue(archive, "ps", pixelShaderName_);
+    SerializeValue(archive, "psdefines", pixelShaderDefines_);
+    SerializeValue(archive, "pshash", pixelShaderSourceHash_);
+
+    SerializeValueAsType<unsigned>(archive, "primitiveType", desc_.primitiveType_);
+
+    SerializeValue(archive, "numVertexElements", desc_.numVertexElements_);
+    if (desc_.numVertexElements_ > PipelineStateDesc::MaxNumVertexElements)
+        throw ArchiveException("'{}' has too many vertex elements", archive.GetCurrentBlockPath());
+    auto vertexElements = ea::span<VertexElement>(desc_.vertexElements_.data(), desc_.numVertexElements_);
+    SerializeArrayAsObjects(archive, "vertexElements", vertexElements, "element",
+        [](Archive& archive, const char* name, VertexElement& value) { SerializeVertexElement(archive, name, value); });
+    SerializeValueAsType<unsigned>(archive, "indexType", desc_.indexType_);
+
+    SerializeValue(archive, "depthWriteEnabled", desc_.depthWriteEnabled_);
+    SerializeValue(archive, "stencilTestEnabled", desc_.stencilTestEnabled_);
+    SerializeValueAsType<unsigned>(archive, "depthCompareFunction", desc_.depthCompareFunction_);
+    SerializeValueAsType<unsigned>(archive, "stencilCompareFunction", desc_.stencilCompareFunction_);
+    SerializeValueAsType<unsigned>(archive, "stencilOperationOnPassed", desc_.stencilOperationOnPassed_);
+    SerializeValueAsType<unsigned>(archive, "stencilOperationOnStencilFailed", desc_.stencilOperationOnStencilFailed_);
+    SerializeValueAsType<unsigned>(archive, "stencilOperationOnDepthFailed", desc_.stencilOperationOnDepthFailed_);
+    SerializeValue(archive, "stencilReferenceValue", desc_.stencilReferenceValue_);
+    SerializeValue(archive, "stencilCompareMask", desc_.stencilCompareMask_);
+    SerializeValue(archive, "stencilWriteMask", desc_.stencilWriteMask_);
+
+    SerializeValueAsType<unsigned>(archive, "fillMode", desc_.fillMode_);
+    SerializeValueAsType<unsigned>(archive, "cullMode", desc_.cullMode_);
+    SerializeValue(archive, "constantDepthBias", desc_.constantDepthBias_);
+    SerializeValue(archive, "slopeScaledDepthBias", desc_.slopeScaledDepthBias_);
+    SerializeValue(archive, "scissorTestEnabled", desc_.scissorTestEnabled_);
+    SerializeValue(archive, "lineAntiAlias", desc_.lineAntiAlias_);
+
+    SerializeValue(archive, "colorWriteEnabled", desc_.colorWriteEnabled_);
+    SerializeValueAsType<unsigned>(archive, "blendMode", desc_.blendMode_);
+    SerializeValue(archive, "alphaToCoverageEnabled", desc_.alphaToCoverageEnabled_);
+
+    if (archive.IsInput())
+    {
+        desc_.vertexShader_ = nullptr;
+        desc_.pixelShader_ = nullptr;
+        desc_.RecalculateHash();
+    }
+}
+
+bool PipelineStatePrecacheEntry::IsUpToDate(const Shader* vertexShader, const Shader* pixelShader) const
+{
+    return PipelineStatePrecache::GetShaderSourceHash(vertexShader, VS) == vertexShaderSourceHash_
+        && PipelineStatePrecache::GetShaderSourceHash(pixelShader, PS) == pixelShaderSourceHash_;
+}
+
+PipelineStatePrecache::PipelineStatePrecache(PipelineStateCache* owner, const ea::string& fileName)
+    : Object(owner->GetContext())
+    , owner_(owner)
+    , fileName_(fileName)
+{
+    Load();
+
+    // Start loading of all used shaders in background so they are ready when pipeline states are created
+    if (!pendingEntries_.empty())
+    {
+        auto cache = GetSubsystem<ResourceCache>();
+        ea::unordered_set<ea::string> shaderNames;
+        for (const PipelineStatePrecacheEntry& entry : pendingEntries_)
+        {
+            shaderNames.insert(entry.vertexShaderName_);
+            shaderNames.insert(entry.pixelShaderName_);
+        }
+        for (const ea::string& shaderName : shaderNames)
+            cache->BackgroundLoadResource<Shader>(shaderName);
+
+        SubscribeToEvent(E_BEGINFRAME, [this](StringHash, VariantMap&) { Update(); });
+    }
+
+    URHO3D_LOGINFO("Begin recording pipeline states to {}, {} states to precache", fileName_, pendingEntries_.size());
+}
+
+PipelineStatePrecache::~PipelineStatePrecache()
+{
+    URHO3D_LOGINFO("End recording pipeline states");
+    Save();
+}
+
+void PipelineStatePrecache::StorePipelineState(const PipelineStateDesc& desc)
+{
+    Shader* vertexShader = desc.vertexShader_->GetOwner();
+    Shader* pixelShader = desc.pixelShader_->GetOwner();
+    if (!vertexShader || !pixelShader)
+        return;
+
+    PipelineStatePrecacheEntry entry;
+    entry.vertexShaderName_ = vertexShader->GetName();
+    entry.vertexShaderDefines_ = desc.vertexShader_->GetDefines();
+    entry.pixelShaderName_ = pixelShader->GetName();
+    entry.pixelShaderDefines_ = desc.pixelShader_->GetDefines();
+    entry.desc_ = desc;
+    entry.desc_.vertexShader_ = nullptr;
+    entry.desc_.pixelShader_ = nullptr;
+    entry.desc_.RecalculateHash();
+
+    const auto iter = entries_.find(entry);
+    if (iter != entries_.end())
+        return;
+
+    entry.vertexShaderSourceHash_ = GetShaderSourceHash(vertexShader, VS);
+    entry.pixelShaderSourceHash_ = GetShaderSourceHash(pixelShader, PS);
+    entries_.insert(entry);
+    dirty_ = true;
+}
+
+void PipelineStatePrecache::Update()
+{
+    URHO3D_PROFILE("PrecachePipelineStates");
+
+    unsigned numCreatedStates = 0;
+    while (nextPendingEntry_ < pendingEntries_.size() && numCreatedStates < maxStatesPerFrame_)
+    {
+        const PipelineStatePrecacheEntry& entry = pendingEntries_[nextPendingEntry_];
+
+        bool failed = false;
+        Shader* vertexShader = GetLoadedShader(entry.vertexShaderName_, failed);
+        Shader* pixelShader = GetLoadedShader(entry.pixelShaderName_, failed);
+        if (!failed && (!vertexShader || !pixelShader))
+            break;
+
+        ++nextPendingEntry_;
+        if (failed || !CreatePipelineState(entry, vertexShader, pixelShader))
+        {
+            // Shaders are changed or removed, entry will be recorded again if still used
+            entries_.erase(entry);
+            dirty_ = true;
+            continue;
+        }
+
+        ++numCreatedStates;
+    }
+
+    if (nextPendingEntry_ >= pendingEntries_.size())
+    {
+        URHO3D_LOGINFO("Precached {} pipeline states", precachedStates_.size());
+        pendingEntries_.clear();
+        nextPendingEntry_ = 0;
+        UnsubscribeFromEvent(E_BEGINFRAME);
+    }
+}
+
+void PipelineStatePrecache::Save()
+{
+    if (!dirty_)
+        return;
+
+    File file(context_, fileName_, FILE_WRITE);
+    if (!file.IsOpen())
+    {
+        URHO3D_LOGERROR("Cannot save pipeline states to {}", fileName_);
+        return;
+    }
+
+    BinaryOutputArchive archive(context_, file);
+    const bool saved = ConsumeArchiveException([&]
+    {
+        ArchiveBlock block = archive.OpenUnorderedBlock("pipelineStates");
+        SerializeInBlock(archive);
+    });
+    if (saved)
+        dirty_ = false;
+}
+
+unsigned PipelineStatePrecache::GetShaderSourceHash(const Shader* shader, ShaderType type)
+{
+    return StringHash(shader->GetSourceCode(type)).Value();
+}
+
+void PipelineStatePrecache::Load()
+{
+    if (!GetSubsystem<FileSystem>()->FileExists(fileName_))
+        return;
+
+    File file(context_, fileName_);
+    BinaryInputArchive archive(context_, file);
+    const bool loaded = ConsumeArchiveException([&]
+    {
+        ArchiveBlock block = archive.OpenUnorderedBlock("pipelineStates");
+        SerializeInBlock(archive);
+    });
+    if (!loaded)
+    {
+        entries_.clear();
+        pendingEntries_.clear();
+    }
+}
+
+void PipelineStatePrecache::SerializeInBlock(Archive& archive)
+{
+    const unsigned version = archive.SerializeVersion(PipelineStatePrecacheVersion);
+    if (version != PipelineStatePrecacheVersion)
+        throw ArchiveException("Pipeline state cache has unsupported version {}", version);
+
+    if (archive.IsInput())
+    {
+        SerializeVectorAsObjects(archive, "entries", pendingEntries_, "entry");
+        entries_.insert(pendingEntries_.begin(), pendingEntries_.end());
+    }
+    else
+    {
+        ea::vector<PipelineStatePrecacheEntry> entries(entries_.begin(), entries_.end());
+        SerializeVectorAsObjects(archive, "entries", entries, "entry");
+    }
+}
+
+bool PipelineStatePrecache::CreatePipelineState(
+    const PipelineStatePrecacheEntry& entry, Shader* vertexShader, Shader* pixelShader)
+{
+    if (!entry.IsUpToDate(vertexShader, pixelShader))
+        return false;
+
+    PipelineStateDesc desc = entry.desc_;
+    desc.vertexShader_ = vertexShader->GetVariation(VS, entry.vertexShaderDefines_);
+    desc.pixelShader_ = pixelShader->GetVariation(PS, entry.pixelShaderDefines_);
+    if (SharedPtr<PipelineState> pipelineState = owner_->GetPipelineState(desc))
+        precachedStates_.push_back(pipelineState);
+    return true;
+}
+
+Shader* PipelineStatePrecache::GetLoadedShader(const ea::string& name, bool& failed) const
+{
+    auto cache = GetSubsystem<ResourceCache>();
+    if (auto shader = cache->GetExistingResource<Shader>(name))
+        return shader;
+
+    // Wait for background loading, then try to load synchronously as fallback
+    if (cache->GetNumBackgroundLoadResources() > 0)
+        return nullptr;
+
+    auto shader = cache->GetResource<Shader>(name, false);
+    if (!shader)
+        failed = true;
+    return shader;
+}
+
+}
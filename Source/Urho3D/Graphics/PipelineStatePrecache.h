@@ -0,0 +1,140 @@
+//
+// Copyright (c) 2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Core/Object.h"
+#include "../Graphics/PipelineState.h"
+
+#include <EASTL/unordered_set.h>
+
+namespace Urho3D
+{
+
+class Archive;
+class Shader;
+
+/// Pipeline state description that doesn't reference any runtime objects and can be stored on disk.
+struct URHO3D_API PipelineStatePrecacheEntry
+{
+    /// Shader resource names and defines
+    /// @{
+    ea::string vertexShaderName_;
+    ea::string vertexShaderDefines_;
+    ea::string pixelShaderName_;
+    ea::string pixelShaderDefines_;
+    /// @}
+
+    /// Hashes of shader source code at the moment of pipeline state creation.
+    /// @{
+    unsigned vertexShaderSourceHash_{};
+    unsigned pixelShaderSourceHash_{};
+    /// @}
+
+    /// Pipeline state description without shaders.
+    PipelineStateDesc desc_;
+
+    void SerializeInBlock(Archive& archive);
+    /// Return whether the source code of the shaders is the same as when the entry was recorded.
+    bool IsUpToDate(const Shader* vertexShader, const Shader* pixelShader) const;
+
+    bool operator ==(const PipelineStatePrecacheEntry& rhs) const
+    {
+        return vertexShaderName_ == rhs.vertexShaderName_
+            && vertexShaderDefines_ == rhs.vertexShaderDefines_
+            && pixelShaderName_ == rhs.pixelShaderName_
+            && pixelShaderDefines_ == rhs.pixelShaderDefines_
+            && desc_ == rhs.desc_;
+    }
+
+    unsigned ToHash() const
+    {
+        unsigned hash = desc_.ToHash();
+        CombineHash(hash, StringHash(vertexShaderName_).Value());
+        CombineHash(hash, StringHash(vertexShaderDefines_).Value());
+        CombineHash(hash, StringHash(pixelShaderName_).Value());
+        CombineHash(hash, StringHash(pixelShaderDefines_).Value());
+        return hash;
+    }
+};
+
+/// Utility class that records pipeline states used during runtime and pre-creates them on the next run.
+/// Shaders are loaded from disk in background and pipeline states are created over several frames.
+/// Entries are discarded if source code of corresponding shaders has changed.
+class URHO3D_API PipelineStatePrecache : public Object
+{
+    URHO3D_OBJECT(PipelineStatePrecache, Object);
+
+public:
+    /// Construct and load pipeline states recorded during previous runs, if file exists.
+    PipelineStatePrecache(PipelineStateCache* owner, const ea::string& fileName);
+    /// Destruct. Save all recorded pipeline states.
+    ~PipelineStatePrecache() override;
+
+    /// Set max number of pipeline states created per frame.
+    void SetMaxStatesPerFrame(unsigned maxStatesPerFrame) { maxStatesPerFrame_ = maxStatesPerFrame; }
+    /// Record pipeline state. Called by PipelineStateCache when new pipeline state is created.
+    void StorePipelineState(const PipelineStateDesc& desc);
+    /// Create next portion of pipeline states loaded from file.
+    void Update();
+    /// Save recorded pipeline states to file.
+    void Save();
+
+    /// Return source code hash of the shader of given type.
+    static unsigned GetShaderSourceHash(const Shader* shader, ShaderType type);
+
+    /// Getters
+    /// @{
+    unsigned GetMaxStatesPerFrame() const { return maxStatesPerFrame_; }
+    unsigned GetNumPendingStates() const { return pendingEntries_.size() - nextPendingEntry_; }
+    unsigned GetNumPrecachedStates() const { return precachedStates_.size(); }
+    const ea::unordered_set<PipelineStatePrecacheEntry>& GetEntries() const { return entries_; }
+    /// @}
+
+private:
+    void Load();
+    void SerializeInBlock(Archive& archive);
+    /// Create pipeline state for entry. Return false if entry is outdated.
+    bool CreatePipelineState(const PipelineStatePrecacheEntry& entry, Shader* vertexShader, Shader* pixelShader);
+    /// Return loaded shader or nullptr if shader is still loading. Set failed if shader cannot be loaded.
+    Shader* GetLoadedShader(const ea::string& name, bool& failed) const;
+
+    /// Cache that owns this object.
+    PipelineStateCache* owner_{};
+    /// File name.
+    ea::string fileName_;
+    /// Max number of pipeline states created per frame.
+    unsigned maxStatesPerFrame_{16};
+
+    /// All recorded entries, including loaded from file.
+    ea::unordered_set<PipelineStatePrecacheEntry> entries_;
+    /// Entries loaded from file and not created yet.
+    ea::vector<PipelineStatePrecacheEntry> pendingEntries_;
+    unsigned nextPendingEntry_{};
+    /// Pipeline states created from file. Kept alive to remain in the cache.
+    ea::vector<SharedPtr<PipelineState>> precachedStates_;
+    /// Whether there are changes not saved to file.
+    bool dirty_{};
+};
+
+}
@@ -316,6 +316,8 @@ public:
 
     /// Return new or existing pipeline state.
     SharedPtr<PipelineState> GetOrCreatePipelineState(const PipelineStateDesc& desc);
+    /// Return pipeline state cache.
+    PipelineStateCache* GetPipelineStateCache() const { return pipelineStateCache_; }
     /// Return default draw queue that can be used to cook and execute draw commands from main thread.
     DrawCommandQueue* GetDefaultDrawQueue() { return defaultDrawQueue_.Get(); }
     /// Return backbuffer viewport by index.
@@ -170,6 +170,38 @@ public:
         offset_ = 0;
     }
 
+    /// Append all parameters from another collection.
+    void Append(const ShaderParameterCollection& other)
+    {
+        if (other.count_ == 0)
+            return;
+
+        // Resize data buffer
+        if (offset_ + other.offset_ > data_.size())
+            data_.resize(offset_ + other.offset_);
+
+        // Resize metadata buffers
+        const unsigned newCount = count_ + other.count_;
+        if (newCount > names_.size())
+        {
+            names_.resize(newCount);
+            dataOffsets_.resize(newCount);
+            dataSizes_.resize(newCount);
+            dataTypes_.resize(newCount);
+        }
+
+        // Store metadata and data
+        ea::copy_n(other.names_.begin(), other.count_, names_.begin() + count_);
+        ea::copy_n(other.dataSizes_.begin(), other.count_, dataSizes_.begin() + count_);
+        ea::copy_n(other.dataTypes_.begin(), other.count_, dataTypes_.begin() + count_);
+        for (unsigned i = 0; i < other.count_; ++i)
+            dataOffsets_[count_ + i] = other.dataOffsets_[i] + offset_;
+
+        memcpy(&data_[offset_], other.data_.data(), other.offset_);
+        offset_ += other.offset_;
+        count_ = newCount;
+    }
+
     /// Return size.
     unsigned Size() const { return count_; }
 
@@ -146,7 +146,10 @@ void Skeleton::UpdateBoneOrder()
     for (unsigned boneIndex = 0; boneIndex < numBones; ++boneIndex)
     {
         if (bones_[boneIndex].parentIndex_ == boneIndex)
+        {
+            bones_[boneIndex].depth_ = 0;
             bonesOrder_.push_back(boneIndex);
+        }
     }
 
     // Collect layer by layer
@@ -164,7 +167,10 @@ void Skeleton::UpdateBoneOrder()
 
             const bool isDirectChild = ea::find(currentParents.begin(), currentParents.end(), parentBoneIndex) != currentParents.end();
             if (isDirectChild)
+            {
+                bones_[boneIndex].depth_ = bones_[parentBoneIndex].depth_ + 1;
                 bonesOrder_.push_back(boneIndex);
+            }
         }
 
         rangeBegin = rangeEnd;
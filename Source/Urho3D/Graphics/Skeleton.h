@@ -83,6 +83,8 @@ struct Bone
     StringHash nameHash_;
     /// Parent bone index.
     unsigned parentIndex_;
+    /// Depth in the hierarchy, 0 for root bones. Calculated by Skeleton::UpdateBoneOrder.
+    unsigned depth_{};
     /// Reset position.
     Vector3 initialPosition_;
     /// Reset rotation.
@@ -99,6 +101,13 @@ struct Bone
     float radius_;
     /// Local-space bounding box.
     BoundingBox boundingBox_;
+    /// Local-space hit capsule fitted to vertices dominated by this bone. Not serialized, generated by Model.
+    /// Capsule is unused if radius is zero.
+    /// @{
+    Vector3 hitCapsuleStart_;
+    Vector3 hitCapsuleEnd_;
+    float hitCapsuleRadius_{};
+    /// @}
     /// Scene node.
     WeakPtr<Node> node_;
 };
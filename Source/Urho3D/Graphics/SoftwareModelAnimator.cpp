@@ -23,6 +23,8 @@
 #include "../Precompiled.h"
 
 #include "../Core/Context.h"
+#include "../Core/Thread.h"
+#include "../Core/WorkQueue.h"
 #include "../IO/Log.h"
 #include "../Graphics/Geometry.h"
 #include "../Graphics/IndexBuffer.h"
@@ -31,6 +33,10 @@
 
 #include <EASTL/sort.h>
 
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#endif
+
 #include "../DebugNew.h"
 
 namespace Urho3D
@@ -48,6 +54,58 @@ Vector3 TransformNormal(const Matrix3x4& m, const Vector3& v)
     };
 }
 
+#ifdef URHO3D_SSE
+/// Load 3 floats without reading past them.
+inline __m128 LoadVector3(const float* data)
+{
+    const __m128 xy = _mm_loadl_pi(_mm_setzero_ps(), reinterpret_cast<const __m64*>(data));
+    return _mm_movelh_ps(xy, _mm_load_ss(data + 2));
+}
+
+/// Store 3 floats without writing past them.
+inline void StoreVector3(float* data, __m128 value)
+{
+    _mm_storel_pi(reinterpret_cast<__m64*>(data), value);
+    _mm_store_ss(data + 2, _mm_movehl_ps(value, value));
+}
+
+/// Blend skinning matrices of the vertex and return them as columns.
+inline void BlendSkinMatrices(__m128 (&columns)[4], ea::span<const Matrix3x4> worldTransforms,
+    const unsigned char* indices, const float* weights, unsigned numBones)
+{
+    const Matrix3x4& first = worldTransforms[indices[0]];
+    const __m128 firstWeight = _mm_set1_ps(weights[0]);
+    __m128 row0 = _mm_mul_ps(_mm_loadu_ps(&first.m00_), firstWeight);
+    __m128 row1 = _mm_mul_ps(_mm_loadu_ps(&first.m10_), firstWeight);
+    __m128 row2 = _mm_mul_ps(_mm_loadu_ps(&first.m20_), firstWeight);
+
+    for (unsigned boneIndex = 1; boneIndex < numBones; ++boneIndex)
+    {
+        const Matrix3x4& matrix = worldTransforms[indices[boneIndex]];
+        const __m128 weight = _mm_set1_ps(weights[boneIndex]);
+        row0 = _mm_add_ps(row0, _mm_mul_ps(_mm_loadu_ps(&matrix.m00_), weight));
+        row1 = _mm_add_ps(row1, _mm_mul_ps(_mm_loadu_ps(&matrix.m10_), weight));
+        row2 = _mm_add_ps(row2, _mm_mul_ps(_mm_loadu_ps(&matrix.m20_), weight));
+    }
+
+    __m128 row3 = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(row0, row1, row2, row3);
+    columns[0] = row0;
+    columns[1] = row1;
+    columns[2] = row2;
+    columns[3] = row3;
+}
+
+/// Transform direction by matrix columns.
+inline __m128 TransformDirection(const __m128 (&columns)[4], const float* data)
+{
+    const __m128 x = _mm_mul_ps(columns[0], _mm_set1_ps(data[0]));
+    const __m128 y = _mm_mul_ps(columns[1], _mm_set1_ps(data[1]));
+    const __m128 z = _mm_mul_ps(columns[2], _mm_set1_ps(data[2]));
+    return _mm_add_ps(_mm_add_ps(x, y), z);
+}
+#endif
+
 }
 
 SoftwareModelAnimator::SoftwareModelAnimator(Context* context) : Object(context) {}
@@ -100,7 +158,12 @@ void SoftwareModelAnimator::ApplyMorphs(ea::span<const ModelMorph> morphs)
             if (!clonedBuffer)
                 continue;
 
-            ApplyMorph(clonedBuffer, bufferMorph.second, morph.weight_);
+            // Morphs may overlap, so only vertices of the same morph are processed in parallel
+            const VertexBufferMorph& vertexBufferMorph = bufferMorph.second;
+            ForEachVertexRange(vertexBufferMorph.vertexCount_, [&](unsigned beginVertex, unsigned endVertex)
+            {
+                ApplyMorph(clonedBuffer, vertexBufferMorph, morph.weight_, beginVertex, endVertex);
+            });
         }
     }
 }
@@ -117,37 +180,86 @@ void SoftwareModelAnimator::ApplySkinning(ea::span<const Matrix3x4> worldTransfo
         if (!clonedBuffer || !animationData.hasSkeletalAnimation_)
             continue;
 
-        if (!animationData.skinNormals_ && !animationData.skinTangents_)
-            ApplyVertexBufferSkinning<false, false>(clonedBuffer, animationData, worldTransforms);
-        else if (animationData.skinNormals_ && !animationData.skinTangents_)
-            ApplyVertexBufferSkinning<true, false>(clonedBuffer, animationData, worldTransforms);
-        else if (animationData.skinNormals_ && animationData.skinTangents_)
-            ApplyVertexBufferSkinning<true, true>(clonedBuffer, animationData, worldTransforms);
-        else
-            ApplyVertexBufferSkinning<false, true>(clonedBuffer, animationData, worldTransforms); // this is really weird case
+        ForEachVertexRange(clonedBuffer->GetVertexCount(), [&](unsigned beginVertex, unsigned endVertex)
+        {
+            if (!animationData.skinNormals_ && !animationData.skinTangents_)
+                ApplyVertexBufferSkinning<false, false>(clonedBuffer, animationData, worldTransforms, beginVertex, endVertex);
+            else if (animationData.skinNormals_ && !animationData.skinTangents_)
+                ApplyVertexBufferSkinning<true, false>(clonedBuffer, animationData, worldTransforms, beginVertex, endVertex);
+            else if (animationData.skinNormals_ && animationData.skinTangents_)
+                ApplyVertexBufferSkinning<true, true>(clonedBuffer, animationData, worldTransforms, beginVertex, endVertex);
+            else // this is really weird case
+                ApplyVertexBufferSkinning<false, true>(clonedBuffer, animationData, worldTransforms, beginVertex, endVertex);
+        });
     }
 }
 
+template <class Callback>
+void SoftwareModelAnimator::ForEachVertexRange(unsigned numVertices, const Callback& callback) const
+{
+    // WorkQueue can be used only from the main thread
+    auto workQueue = GetSubsystem<WorkQueue>();
+    if (!workQueue || numVertices < MinVerticesForParallelUpdate || !Thread::IsMainThread())
+    {
+        if (numVertices > 0)
+            callback(0, numVertices);
+        return;
+    }
+
+    ForEachParallel(workQueue, VerticesPerParallelTask, numVertices, callback);
+}
+
 template <bool SkinNormals, bool SkinTangents>
 void SoftwareModelAnimator::ApplyVertexBufferSkinning(VertexBuffer* clonedBuffer, const VertexBufferAnimationData& animationData,
-    ea::span<const Matrix3x4> worldTransforms) const
+    ea::span<const Matrix3x4> worldTransforms, unsigned beginVertex, unsigned endVertex) const
 {
     const unsigned clonedVertexSize = clonedBuffer->GetVertexSize();
     const unsigned normalOffset = clonedBuffer->GetElementOffset(TYPE_VECTOR3, SEM_NORMAL);
     const unsigned tangentOffset = clonedBuffer->GetElementOffset(TYPE_VECTOR4, SEM_TANGENT);
 
-    unsigned char* clonedBufferData = clonedBuffer->GetShadowData();
+    unsigned char* clonedBufferData = clonedBuffer->GetShadowData() + beginVertex * clonedVertexSize;
 
     unsigned char* positionsData = clonedBufferData;
     unsigned char* normalsData = SkinNormals ? clonedBufferData + normalOffset : nullptr;
     unsigned char* tangentsData = SkinTangents ? clonedBufferData + tangentOffset : nullptr;
 
-    const unsigned char* indicesData = animationData.blendIndices_.data();
-    const float* weightsData = animationData.blendWeights_.data();
+    const unsigned char* indicesData = animationData.blendIndices_.data() + beginVertex * numBones_;
+    const float* weightsData = animationData.blendWeights_.data() + beginVertex * numBones_;
+
+#ifdef URHO3D_SSE
+    __m128 columns[4];
+    for (unsigned vertexIndex = beginVertex; vertexIndex < endVertex; ++vertexIndex)
+    {
+        BlendSkinMatrices(columns, worldTransforms, indicesData, weightsData, numBones_);
+
+        auto position = reinterpret_cast<float*>(positionsData);
+        StoreVector3(position, _mm_add_ps(TransformDirection(columns, position), columns[3]));
+
+        if constexpr (SkinNormals)
+        {
+            auto normal = reinterpret_cast<float*>(normalsData);
+            StoreVector3(normal, TransformDirection(columns, normal));
+        }
+
+        if constexpr (SkinTangents)
+        {
+            auto tangent = reinterpret_cast<float*>(tangentsData);
+            StoreVector3(tangent, TransformDirection(columns, tangent));
+        }
+
+        // Advance
+        indicesData += numBones_;
+        weightsData += numBones_;
 
-    const unsigned numVertices = clonedBuffer->GetVertexCount();
+        positionsData += clonedVertexSize;
+        if constexpr (SkinNormals)
+            normalsData += clonedVertexSize;
+        if constexpr (SkinTangents)
+            tangentsData += clonedVertexSize;
+    }
+#else
     Matrix3x4 matrix;
-    for (unsigned vertexIndex = 0; vertexIndex < numVertices; ++vertexIndex)
+    for (unsigned vertexIndex = beginVertex; vertexIndex < endVertex; ++vertexIndex)
     {
         matrix = worldTransforms[indicesData[0]] * weightsData[0];
         for (unsigned boneIndex = 1; boneIndex < numBones_; ++boneIndex)
@@ -178,7 +290,7 @@ void SoftwareModelAnimator::ApplyVertexBufferSkinning(VertexBuffer* clonedBuffer
         if constexpr (SkinTangents)
             tangentsData += clonedVertexSize;
     }
-
+#endif
 }
 
 void SoftwareModelAnimator::Commit()
@@ -410,6 +522,13 @@ void SoftwareModelAnimator::InitializeAnimationData()
 void SoftwareModelAnimator::CopyMorphVertices(void* destVertexData, const void* srcVertexData, unsigned vertexCount,
     VertexBuffer* destBuffer, VertexBuffer* srcBuffer) const
 {
+    // Copy whole range if layouts match
+    if (destBuffer->GetElements() == srcBuffer->GetElements())
+    {
+        memcpy(destVertexData, srcVertexData, vertexCount * srcBuffer->GetVertexSize());
+        return;
+    }
+
     unsigned mask = destBuffer->GetElementMask() & srcBuffer->GetElementMask();
     unsigned normalOffset = srcBuffer->GetElementOffset(SEM_NORMAL);
     unsigned tangentOffset = srcBuffer->GetElementOffset(SEM_TANGENT);
@@ -439,47 +558,47 @@ void SoftwareModelAnimator::CopyMorphVertices(void* destVertexData, const void*
     }
 }
 
-void SoftwareModelAnimator::ApplyMorph(VertexBuffer* buffer, const VertexBufferMorph& morph, float weight)
+void SoftwareModelAnimator::ApplyMorph(VertexBuffer* buffer, const VertexBufferMorph& morph, float weight,
+    unsigned beginVertex, unsigned endVertex) const
 {
     const VertexMaskFlags elementMask = morph.elementMask_ & buffer->GetElementMask();
-    unsigned vertexCount = morph.vertexCount_;
-    unsigned normalOffset = buffer->GetElementOffset(SEM_NORMAL);
-    unsigned tangentOffset = buffer->GetElementOffset(SEM_TANGENT);
-    unsigned vertexSize = buffer->GetVertexSize();
+    const unsigned normalOffset = buffer->GetElementOffset(SEM_NORMAL);
+    const unsigned tangentOffset = buffer->GetElementOffset(SEM_TANGENT);
+    const unsigned vertexSize = buffer->GetVertexSize();
+
+    // Each morphed vertex is vertex index followed by 3 floats per morphed element
+    const unsigned numElements = (elementMask & MASK_POSITION ? 1 : 0)
+        + (elementMask & MASK_NORMAL ? 1 : 0) + (elementMask & MASK_TANGENT ? 1 : 0);
+    const unsigned morphVertexSize = sizeof(unsigned) + numElements * 3 * sizeof(float);
 
-    unsigned char* srcData = morph.morphData_.get();
+    const unsigned char* srcData = morph.morphData_.get() + beginVertex * morphVertexSize;
     unsigned char* destData = buffer->GetShadowData();
 
-    while (vertexCount--)
+    const unsigned offsets[3] = {0, normalOffset, tangentOffset};
+    const VertexMaskFlags masks[3] = {MASK_POSITION, MASK_NORMAL, MASK_TANGENT};
+#ifdef URHO3D_SSE
+    const __m128 weightVector = _mm_set1_ps(weight);
+#endif
+    for (unsigned morphVertexIndex = beginVertex; morphVertexIndex < endVertex; ++morphVertexIndex)
     {
         const unsigned vertexIndex = *reinterpret_cast<const unsigned*>(srcData);
         srcData += sizeof(unsigned);
 
-        if (elementMask & MASK_POSITION)
+        unsigned char* vertexData = destData + vertexIndex * vertexSize;
+        for (unsigned elementIndex = 0; elementIndex < 3; ++elementIndex)
         {
-            auto dest = reinterpret_cast<float*>(destData + vertexIndex * vertexSize);
-            auto src = reinterpret_cast<const float*>(srcData);
-            dest[0] += src[0] * weight;
-            dest[1] += src[1] * weight;
-            dest[2] += src[2] * weight;
-            srcData += 3 * sizeof(float);
-        }
-        if (elementMask & MASK_NORMAL)
-        {
-            auto dest = reinterpret_cast<float*>(destData + vertexIndex * vertexSize + normalOffset);
-            auto src = reinterpret_cast<const float*>(srcData);
-            dest[0] += src[0] * weight;
-            dest[1] += src[1] * weight;
-            dest[2] += src[2] * weight;
-            srcData += 3 * sizeof(float);
-        }
-        if (elementMask & MASK_TANGENT)
-        {
-            auto dest = reinterpret_cast<float*>(destData + vertexIndex * vertexSize + tangentOffset);
+            if (!(elementMask & masks[elementIndex]))
+                continue;
+
+            auto dest = reinterpret_cast<float*>(vertexData + offsets[elementIndex]);
             auto src = reinterpret_cast<const float*>(srcData);
+#ifdef URHO3D_SSE
+            StoreVector3(dest, _mm_add_ps(LoadVector3(dest), _mm_mul_ps(LoadVector3(src), weightVector)));
+#else
             dest[0] += src[0] * weight;
             dest[1] += src[1] * weight;
             dest[2] += src[2] * weight;
+#endif
             srcData += 3 * sizeof(float);
         }
     }
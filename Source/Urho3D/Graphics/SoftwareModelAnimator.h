@@ -53,6 +53,10 @@ class URHO3D_API SoftwareModelAnimator : public Object
 public:
     /// Max number of bones.
     static const unsigned MaxBones = 4;
+    /// Min number of vertices to animate them in parallel.
+    static const unsigned MinVerticesForParallelUpdate = 8192;
+    /// Number of vertices processed by one parallel task.
+    static const unsigned VerticesPerParallelTask = 2048;
 
     /// Construct.
     explicit SoftwareModelAnimator(Context* context);
@@ -66,9 +70,9 @@ public:
 
     /// Reset morph and/or skeletal animation. Safe to call from worker thread.
     void ResetAnimation();
-    /// Apply morphs. Safe to call from worker thread.
+    /// Apply morphs. Safe to call from worker thread. Large buffers are processed in parallel if called from main thread.
     void ApplyMorphs(ea::span<const ModelMorph> morphs);
-    /// Apply skinning.
+    /// Apply skinning. Safe to call from worker thread. Large buffers are processed in parallel if called from main thread.
     void ApplySkinning(ea::span<const Matrix3x4> worldTransforms);
     /// Commit data to GPU.
     void Commit();
@@ -89,12 +93,16 @@ private:
     /// Copy morph vertices.
     void CopyMorphVertices(void* destVertexData, const void* srcVertexData, unsigned vertexCount,
         VertexBuffer* destBuffer, VertexBuffer* srcBuffer) const;
-    /// Apply a vertex buffer morph.
-    void ApplyMorph(VertexBuffer* buffer, const VertexBufferMorph& morph, float weight);
-    /// Apply skinning for given vertex buffer.
+    /// Invoke callback for vertex ranges, in parallel if possible.
+    template <class Callback>
+    void ForEachVertexRange(unsigned numVertices, const Callback& callback) const;
+    /// Apply a vertex buffer morph for given range of morphed vertices.
+    void ApplyMorph(VertexBuffer* buffer, const VertexBufferMorph& morph, float weight,
+        unsigned beginVertex, unsigned endVertex) const;
+    /// Apply skinning for given range of vertices of vertex buffer.
     template <bool SkinNormals, bool SkinTangents>
     void ApplyVertexBufferSkinning(VertexBuffer* clonedBuffer, const VertexBufferAnimationData& animationData,
-        ea::span<const Matrix3x4> worldTransforms) const;
+        ea::span<const Matrix3x4> worldTransforms, unsigned beginVertex, unsigned endVertex) const;
 
     /// Original model.
     SharedPtr<Model> originalModel_;
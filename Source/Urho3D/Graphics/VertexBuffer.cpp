@@ -509,9 +509,12 @@ void DynamicVertexBuffer::Commit()
     vertexBuffer_->SetDataRange(shadowData_.data(), 0, numVertices_, true);
 }
 
-void DynamicVertexBuffer::GrowBuffer()
+void DynamicVertexBuffer::GrowBuffer(unsigned minNumVertices)
 {
-    maxNumVertices_ = maxNumVertices_ > 0 ? 2 * maxNumVertices_ : 128;
+    if (maxNumVertices_ == 0)
+        maxNumVertices_ = 128;
+    while (maxNumVertices_ < minNumVertices)
+        maxNumVertices_ *= 2;
     shadowData_.resize(maxNumVertices_ * vertexSize_);
     vertexBufferNeedResize_ = true;
 }
@@ -225,7 +225,7 @@ public:
     {
         const unsigned startVertex = numVertices_;
         if (startVertex + count > maxNumVertices_)
-            GrowBuffer();
+            GrowBuffer(startVertex + count);
 
         numVertices_ += count;
         unsigned char* data = shadowData_.data() + startVertex * vertexSize_;
@@ -240,11 +240,14 @@ public:
         return indexAndData.first;
     }
 
+    /// Return writeable data of previously allocated vertex. Pointer is invalidated when new vertices are added.
+    unsigned char* GetVertexData(unsigned index) { return shadowData_.data() + index * vertexSize_; }
+
     VertexBuffer* GetVertexBuffer() const { return vertexBuffer_; }
     unsigned GetVertexCount() const { return numVertices_; }
 
 private:
-    void GrowBuffer();
+    void GrowBuffer(unsigned minNumVertices);
 
     SharedPtr<VertexBuffer> vertexBuffer_;
     ByteVector shadowData_;
@@ -0,0 +1,310 @@
+//
+// Copyright (c) 2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../IO/BitBuffer.h"
+#include "../IO/Deserializer.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+/// Max absolute value of any component of normalized quaternion except the largest one.
+const float SmallestThreeRange = 0.70710678f;
+
+unsigned GetMaxQuantizedValue(unsigned numBits)
+{
+    return (1u << numBits) - 1;
+}
+
+}
+
+BitBuffer::BitBuffer(const void* data, unsigned size)
+{
+    SetData(data, size);
+}
+
+void BitBuffer::SetData(const void* data, unsigned size)
+{
+    const auto bytes = static_cast<const unsigned char*>(data);
+    buffer_.assign(bytes, bytes + size);
+    numBits_ = size * 8;
+    readPosition_ = 0;
+}
+
+void BitBuffer::SetData(Deserializer& source, unsigned size)
+{
+    buffer_.resize(size);
+    const unsigned actualSize = size ? source.Read(buffer_.data(), size) : 0;
+    buffer_.resize(actualSize);
+    numBits_ = actualSize * 8;
+    readPosition_ = 0;
+}
+
+void BitBuffer::Clear()
+{
+    buffer_.clear();
+    numBits_ = 0;
+    readPosition_ = 0;
+}
+
+void BitBuffer::WriteBits(unsigned value, unsigned numBits)
+{
+    URHO3D_ASSERT(numBits <= 32);
+
+    buffer_.resize((numBits_ + numBits + 7) / 8);
+    while (numBits > 0)
+    {
+        const unsigned byteIndex = numBits_ / 8;
+        const unsigned bitOffset = numBits_ % 8;
+        const unsigned numChunkBits = ea::min(8 - bitOffset, numBits);
+        const unsigned chunkMask = (1u << numChunkBits) - 1;
+
+        buffer_[byteIndex] |= static_cast<unsigned char>((value & chunkMask) << bitOffset);
+
+        value = numChunkBits < 32 ? value >> numChunkBits : 0;
+        numBits_ += numChunkBits;
+        numBits -= numChunkBits;
+    }
+}
+
+unsigned BitBuffer::ReadBits(unsigned numBits)
+{
+    URHO3D_ASSERT(numBits <= 32);
+
+    unsigned result = 0;
+    unsigned resultOffset = 0;
+    while (numBits > 0)
+    {
+        const unsigned byteIndex = readPosition_ / 8;
+        const unsigned bitOffset = readPosition_ % 8;
+        const unsigned numChunkBits = ea::min(8 - bitOffset, numBits);
+        const unsigned chunkMask = (1u << numChunkBits) - 1;
+
+        const unsigned byte = byteIndex < buffer_.size() ? buffer_[byteIndex] : 0;
+        result |= ((byte >> bitOffset) & chunkMask) << resultOffset;
+
+        readPosition_ += numChunkBits;
+        resultOffset += numChunkBits;
+        numBits -= numChunkBits;
+    }
+    return result;
+}
+
+void BitBuffer::WriteVLE(unsigned value)
+{
+    while (value >= 0x80)
+    {
+        WriteBits((value & 0x7f) | 0x80, 8);
+        value >>= 7;
+    }
+    WriteBits(value, 8);
+}
+
+unsigned BitBuffer::ReadVLE()
+{
+    unsigned result = 0;
+    for (unsigned shift = 0; shift < 32; shift += 7)
+    {
+        const unsigned byte = ReadBits(8);
+        result |= (byte & 0x7f) << shift;
+        if ((byte & 0x80) == 0)
+            break;
+    }
+    return result;
+}
+
+void BitBuffer::WriteFloat(float value)
+{
+    WriteBits(FloatToRawIntBits(value), 32);
+}
+
+float BitBuffer::ReadFloat()
+{
+    const unsigned bits = ReadBits(32);
+    float result;
+    memcpy(&result, &bits, sizeof(float));
+    return result;
+}
+
+void BitBuffer::WriteHalfFloat(float value)
+{
+    WriteBits(FloatToHalf(value), 16);
+}
+
+float BitBuffer::ReadHalfFloat()
+{
+    return HalfToFloat(static_cast<unsigned short>(ReadBits(16)));
+}
+
+void BitBuffer::WriteQuantizedFloat(float value, float minValue, float maxValue, unsigned numBits)
+{
+    URHO3D_ASSERT(numBits > 0 && numBits <= MaxQuantizationBits);
+
+    const float range = maxValue - minValue;
+    const float normalizedValue = range > 0.0f ? Clamp((value - minValue) / range, 0.0f, 1.0f) : 0.0f;
+    const unsigned maxQuantizedValue = GetMaxQuantizedValue(numBits);
+    WriteBits(static_cast<unsigned>(normalizedValue * maxQuantizedValue + 0.5f), numBits);
+}
+
+float BitBuffer::ReadQuantizedFloat(float minValue, float maxValue, unsigned numBits)
+{
+    URHO3D_ASSERT(numBits > 0 && numBits <= MaxQuantizationBits);
+
+    const unsigned maxQuantizedValue = GetMaxQuantizedValue(numBits);
+    const float normalizedValue = static_cast<float>(ReadBits(numBits)) / maxQuantizedValue;
+    return minValue + normalizedValue * (maxValue - minValue);
+}
+
+void BitBuffer::WriteVector3(const Vector3& value)
+{
+    WriteFloat(value.x_);
+    WriteFloat(value.y_);
+    WriteFloat(value.z_);
+}
+
+Vector3 BitBuffer::ReadVector3()
+{
+    const float x = ReadFloat();
+    const float y = ReadFloat();
+    const float z = ReadFloat();
+    return {x, y, z};
+}
+
+void BitBuffer::WriteHalfVector3(const Vector3& value)
+{
+    WriteHalfFloat(value.x_);
+    WriteHalfFloat(value.y_);
+    WriteHalfFloat(value.z_);
+}
+
+Vector3 BitBuffer::ReadHalfVector3()
+{
+    const float x = ReadHalfFloat();
+    const float y = ReadHalfFloat();
+    const float z = ReadHalfFloat();
+    return {x, y, z};
+}
+
+void BitBuffer::WriteQuantizedVector3(const Vector3& value, const Vector3& minValue, const Vector3& maxValue, unsigned numBits)
+{
+    WriteQuantizedFloat(value.x_, minValue.x_, maxValue.x_, numBits);
+    WriteQuantizedFloat(value.y_, minValue.y_, maxValue.y_, numBits);
+    WriteQuantizedFloat(value.z_, minValue.z_, maxValue.z_, numBits);
+}
+
+Vector3 BitBuffer::ReadQuantizedVector3(const Vector3& minValue, const Vector3& maxValue, unsigned numBits)
+{
+    const float x = ReadQuantizedFloat(minValue.x_, maxValue.x_, numBits);
+    const float y = ReadQuantizedFloat(minValue.y_, maxValue.y_, numBits);
+    const float z = ReadQuantizedFloat(minValue.z_, maxValue.z_, numBits);
+    return {x, y, z};
+}
+
+void BitBuffer::WriteQuaternion(const Quaternion& value)
+{
+    WriteFloat(value.w_);
+    WriteFloat(value.x_);
+    WriteFloat(value.y_);
+    WriteFloat(value.z_);
+}
+
+Quaternion BitBuffer::ReadQuaternion()
+{
+    const float w = ReadFloat();
+    const float x = ReadFloat();
+    const float y = ReadFloat();
+    const float z = ReadFloat();
+    return {w, x, y, z};
+}
+
+void BitBuffer::WriteSmallestThreeQuaternion(const Quaternion& value, unsigned numBits)
+{
+    const Quaternion normalizedValue = value.Normalized();
+    const float components[4]{normalizedValue.w_, normalizedValue.x_, normalizedValue.y_, normalizedValue.z_};
+
+    unsigned largestIndex = 0;
+    for (unsigned i = 1; i < 4; ++i)
+    {
+        if (Abs(components[i]) > Abs(components[largestIndex]))
+            largestIndex = i;
+    }
+
+    // q and -q represent the same rotation, so the largest component is always made positive
+    const float sign = components[largestIndex] < 0.0f ? -1.0f : 1.0f;
+
+    WriteBits(largestIndex, 2);
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        if (i != largestIndex)
+            WriteQuantizedFloat(components[i] * sign, -SmallestThreeRange, SmallestThreeRange, numBits);
+    }
+}
+
+Quaternion BitBuffer::ReadSmallestThreeQuaternion(unsigned numBits)
+{
+    const unsigned largestIndex = ReadBits(2);
+
+    float components[4]{};
+    float sumSquared = 0.0f;
+    for (unsigned i = 0; i < 4; ++i)
+    {
+        if (i != largestIndex)
+        {
+            components[i] = ReadQuantizedFloat(-SmallestThreeRange, SmallestThreeRange, numBits);
+            sumSquared += components[i] * components[i];
+        }
+    }
+    components[largestIndex] = Sqrt(ea::max(0.0f, 1.0f - sumSquared));
+
+    return Quaternion{components[0], components[1], components[2], components[3]}.Normalized();
+}
+
+void BitBuffer::WriteString(ea::string_view value)
+{
+    WriteVLE(value.size());
+    for (const char ch : value)
+        WriteBits(static_cast<unsigned char>(ch), 8);
+}
+
+ea::string BitBuffer::ReadString()
+{
+    const unsigned encodedSize = ReadVLE();
+
+    // Don't trust the size of corrupted or malicious data, the string cannot be longer than the remaining bits
+    const unsigned remainingBytes = IsEof() ? 0 : (numBits_ - readPosition_) / 8;
+    const unsigned size = ea::min(encodedSize, remainingBytes);
+
+    ea::string result;
+    result.reserve(size);
+    for (unsigned i = 0; i < size; ++i)
+        result.push_back(static_cast<char>(ReadBits(8)));
+    return result;
+}
+
+}
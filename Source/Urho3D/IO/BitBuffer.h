@@ -0,0 +1,121 @@
+//
+// Copyright (c) 2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+/// \file
+
+#pragma once
+
+#include "../Container/ByteVector.h"
+#include "../Math/Quaternion.h"
+#include "../Math/Vector3.h"
+
+#include <EASTL/string.h>
+
+namespace Urho3D
+{
+
+class Deserializer;
+
+/// Dynamically sized buffer that can be read and written to as a stream of bits.
+/// Used to pack quantized values tighter than byte-aligned Serializer allows.
+/// Bits are stored starting from the least significant bit of each byte.
+class URHO3D_API BitBuffer
+{
+public:
+    /// Max number of bits for quantized floats.
+    static constexpr unsigned MaxQuantizationBits = 24;
+
+    /// Construct an empty buffer.
+    BitBuffer() = default;
+    /// Construct from a memory area.
+    BitBuffer(const void* data, unsigned size);
+
+    /// Set data from a memory area and reset read position.
+    void SetData(const void* data, unsigned size);
+    /// Set data from a stream and reset read position.
+    void SetData(Deserializer& source, unsigned size);
+    /// Reset to zero size.
+    void Clear();
+
+    /// Set read position in bits.
+    void SeekBit(unsigned position) { readPosition_ = position; }
+    /// Return read position in bits.
+    unsigned TellBit() const { return readPosition_; }
+    /// Return whether the read position is at the end of the buffer.
+    bool IsEof() const { return readPosition_ >= numBits_; }
+
+    /// Return data.
+    const unsigned char* GetData() const { return buffer_.empty() ? nullptr : buffer_.data(); }
+    /// Return the buffer.
+    const ByteVector& GetBuffer() const { return buffer_; }
+    /// Return size in bytes, including padding of the last byte.
+    unsigned GetSize() const { return buffer_.size(); }
+    /// Return size in bits.
+    unsigned GetNumBits() const { return numBits_; }
+
+    /// Write values.
+    /// @{
+    void WriteBits(unsigned value, unsigned numBits);
+    void WriteBool(bool value) { WriteBits(value ? 1 : 0, 1); }
+    void WriteVLE(unsigned value);
+    void WriteFloat(float value);
+    void WriteHalfFloat(float value);
+    void WriteQuantizedFloat(float value, float minValue, float maxValue, unsigned numBits);
+    void WriteVector3(const Vector3& value);
+    void WriteHalfVector3(const Vector3& value);
+    void WriteQuantizedVector3(const Vector3& value, const Vector3& minValue, const Vector3& maxValue, unsigned numBits);
+    void WriteQuaternion(const Quaternion& value);
+    void WriteSmallestThreeQuaternion(const Quaternion& value, unsigned numBits);
+    void WriteString(ea::string_view value);
+    /// @}
+
+    /// Read values written by corresponding Write* functions.
+    /// Reading past the end of the buffer returns zero bits.
+    /// @{
+    unsigned ReadBits(unsigned numBits);
+    bool ReadBool() { return ReadBits(1) != 0; }
+    unsigned ReadVLE();
+    float ReadFloat();
+    float ReadHalfFloat();
+    float ReadQuantizedFloat(float minValue, float maxValue, unsigned numBits);
+    Vector3 ReadVector3();
+    Vector3 ReadHalfVector3();
+    Vector3 ReadQuantizedVector3(const Vector3& minValue, const Vector3& maxValue, unsigned numBits);
+    Quaternion ReadQuaternion();
+    Quaternion ReadSmallestThreeQuaternion(unsigned numBits);
+    ea::string ReadString();
+    /// @}
+
+    /// Return number of bits used by WriteSmallestThreeQuaternion.
+    static unsigned GetSmallestThreeQuaternionBits(unsigned numBits) { return 2 + 3 * numBits; }
+
+private:
+    /// Data buffer.
+    ByteVector buffer_;
+    /// Number of written bits.
+    unsigned numBits_{};
+    /// Read position in bits.
+    unsigned readPosition_{};
+};
+
+}
@@ -0,0 +1,201 @@
+//
+// Copyright (c) 2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Math/CapsuleBatch.h"
+
+#ifdef URHO3D_SSE
+#include <emmintrin.h>
+#endif
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+#ifdef URHO3D_SSE
+inline __m128 Select(__m128 mask, __m128 ifTrue, __m128 ifFalse)
+{
+    return _mm_or_ps(_mm_and_ps(mask, ifTrue), _mm_andnot_ps(mask, ifFalse));
+}
+
+inline __m128 Dot(__m128 ax, __m128 ay, __m128 az, __m128 bx, __m128 by, __m128 bz)
+{
+    return _mm_add_ps(_mm_add_ps(_mm_mul_ps(ax, bx), _mm_mul_ps(ay, by)), _mm_mul_ps(az, bz));
+}
+
+/// Return hit distances to four spheres that are not behind the ray origin. Same as scalar code in Ray.cpp.
+inline __m128 HitDistanceFrontSpheres(__m128 ox, __m128 oy, __m128 oz, __m128 dx, __m128 dy, __m128 dz,
+    __m128 cx, __m128 cy, __m128 cz, __m128 squaredRadius)
+{
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 infinity = _mm_set1_ps(M_INFINITY);
+
+    const __m128 ocx = _mm_sub_ps(ox, cx);
+    const __m128 ocy = _mm_sub_ps(oy, cy);
+    const __m128 ocz = _mm_sub_ps(oz, cz);
+    const __m128 c = _mm_sub_ps(Dot(ocx, ocy, ocz, ocx, ocy, ocz), squaredRadius);
+    const __m128 b = Dot(ocx, ocy, ocz, dx, dy, dz);
+    const __m128 d = _mm_sub_ps(_mm_mul_ps(b, b), c);
+
+    const __m128 dist = _mm_sub_ps(_mm_sub_ps(zero, b), _mm_sqrt_ps(_mm_max_ps(d, zero)));
+    const __m128 hit = _mm_and_ps(_mm_cmpge_ps(d, zero), _mm_cmple_ps(b, zero));
+    return Select(_mm_cmple_ps(c, zero), zero, Select(hit, dist, infinity));
+}
+#endif
+
+}
+
+void CapsuleBatch::Clear()
+{
+    size_ = 0;
+    startX_.clear();
+    startY_.clear();
+    startZ_.clear();
+    endX_.clear();
+    endY_.clear();
+    endZ_.clear();
+    radius_.clear();
+}
+
+void CapsuleBatch::Add(const Vector3& start, const Vector3& end, float radius)
+{
+    // Replace padding if any
+    if (size_ % 4 != 0)
+    {
+        startX_[size_] = start.x_;
+        startY_[size_] = start.y_;
+        startZ_[size_] = start.z_;
+        endX_[size_] = end.x_;
+        endY_[size_] = end.y_;
+        endZ_[size_] = end.z_;
+        radius_[size_] = radius;
+        ++size_;
+        return;
+    }
+
+    // Allocate 4 capsules at once, unused ones are never hit
+    startX_.insert(startX_.end(), {start.x_, 0.0f, 0.0f, 0.0f});
+    startY_.insert(startY_.end(), {start.y_, 0.0f, 0.0f, 0.0f});
+    startZ_.insert(startZ_.end(), {start.z_, 0.0f, 0.0f, 0.0f});
+    endX_.insert(endX_.end(), {end.x_, 0.0f, 0.0f, 0.0f});
+    endY_.insert(endY_.end(), {end.y_, 0.0f, 0.0f, 0.0f});
+    endZ_.insert(endZ_.end(), {end.z_, 0.0f, 0.0f, 0.0f});
+    radius_.insert(radius_.end(), {radius, 0.0f, 0.0f, 0.0f});
+    ++size_;
+}
+
+ea::span<const float> CapsuleBatch::HitDistances(const Ray& ray, float sweepRadius)
+{
+    const unsigned paddedSize = startX_.size();
+    distances_.resize(paddedSize);
+
+#ifdef URHO3D_SSE
+    const __m128 zero = _mm_setzero_ps();
+    const __m128 infinity = _mm_set1_ps(M_INFINITY);
+    const __m128 epsilon = _mm_set1_ps(M_EPSILON);
+    const __m128 ox = _mm_set1_ps(ray.origin_.x_);
+    const __m128 oy = _mm_set1_ps(ray.origin_.y_);
+    const __m128 oz = _mm_set1_ps(ray.origin_.z_);
+    const __m128 dx = _mm_set1_ps(ray.direction_.x_);
+    const __m128 dy = _mm_set1_ps(ray.direction_.y_);
+    const __m128 dz = _mm_set1_ps(ray.direction_.z_);
+    const __m128 sweep = _mm_set1_ps(sweepRadius);
+
+    for (unsigned i = 0; i < paddedSize; i += 4)
+    {
+        const __m128 ax = _mm_loadu_ps(&startX_[i]);
+        const __m128 ay = _mm_loadu_ps(&startY_[i]);
+        const __m128 az = _mm_loadu_ps(&startZ_[i]);
+        const __m128 bx = _mm_loadu_ps(&endX_[i]);
+        const __m128 by = _mm_loadu_ps(&endY_[i]);
+        const __m128 bz = _mm_loadu_ps(&endZ_[i]);
+        const __m128 radius = _mm_add_ps(_mm_loadu_ps(&radius_[i]), sweep);
+        const __m128 squaredRadius = _mm_mul_ps(radius, radius);
+
+        // Nearest hit of the end spheres
+        const __m128 sphereDist = _mm_min_ps(
+            HitDistanceFrontSpheres(ox, oy, oz, dx, dy, dz, ax, ay, az, squaredRadius),
+            HitDistanceFrontSpheres(ox, oy, oz, dx, dy, dz, bx, by, bz, squaredRadius));
+
+        // Nearest hit of the cylinder body, see Ray::HitDistanceCapsule
+        const __m128 axisX = _mm_sub_ps(bx, ax);
+        const __m128 axisY = _mm_sub_ps(by, ay);
+        const __m128 axisZ = _mm_sub_ps(bz, az);
+        const __m128 originX = _mm_sub_ps(ox, ax);
+        const __m128 originY = _mm_sub_ps(oy, ay);
+        const __m128 originZ = _mm_sub_ps(oz, az);
+
+        const __m128 axisLengthSquared = Dot(axisX, axisY, axisZ, axisX, axisY, axisZ);
+        const __m128 axisDotDirection = Dot(axisX, axisY, axisZ, dx, dy, dz);
+        const __m128 axisDotOrigin = Dot(axisX, axisY, axisZ, originX, originY, originZ);
+        const __m128 directionDotOrigin = Dot(dx, dy, dz, originX, originY, originZ);
+        const __m128 originLengthSquared = Dot(originX, originY, originZ, originX, originY, originZ);
+
+        const __m128 a = _mm_sub_ps(axisLengthSquared, _mm_mul_ps(axisDotDirection, axisDotDirection));
+        const __m128 b = _mm_sub_ps(_mm_mul_ps(axisLengthSquared, directionDotOrigin), _mm_mul_ps(axisDotOrigin, axisDotDirection));
+        const __m128 c = _mm_sub_ps(_mm_mul_ps(axisLengthSquared, _mm_sub_ps(originLengthSquared, squaredRadius)),
+            _mm_mul_ps(axisDotOrigin, axisDotOrigin));
+        const __m128 d = _mm_sub_ps(_mm_mul_ps(b, b), _mm_mul_ps(a, c));
+
+        const __m128 insideSlab = _mm_and_ps(_mm_cmpge_ps(axisDotOrigin, zero), _mm_cmple_ps(axisDotOrigin, axisLengthSquared));
+        const __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmple_ps(c, zero), insideSlab), _mm_cmpgt_ps(axisLengthSquared, zero));
+
+        const __m128 bodyDist = _mm_div_ps(_mm_sub_ps(_mm_sub_ps(zero, b), _mm_sqrt_ps(_mm_max_ps(d, zero))),
+            _mm_max_ps(a, epsilon));
+        const __m128 axisPosition = _mm_add_ps(axisDotOrigin, _mm_mul_ps(bodyDist, axisDotDirection));
+
+        __m128 bodyHit = _mm_and_ps(_mm_cmpgt_ps(c, zero), _mm_cmpgt_ps(a, _mm_mul_ps(epsilon, axisLengthSquared)));
+        bodyHit = _mm_and_ps(bodyHit, _mm_cmpge_ps(d, zero));
+        bodyHit = _mm_and_ps(bodyHit, _mm_cmpge_ps(bodyDist, zero));
+        bodyHit = _mm_and_ps(bodyHit, _mm_cmpge_ps(axisPosition, zero));
+        bodyHit = _mm_and_ps(bodyHit, _mm_cmple_ps(axisPosition, axisLengthSquared));
+
+        const __m128 dist = _mm_min_ps(sphereDist, Select(bodyHit, bodyDist, infinity));
+        _mm_storeu_ps(&distances_[i], Select(inside, zero, dist));
+    }
+#else
+    for (unsigned i = 0; i < size_; ++i)
+        distances_[i] = ray.HitDistanceCapsule(GetStart(i), GetEnd(i), radius_[i] + sweepRadius);
+#endif
+
+    return {distances_.data(), size_};
+}
+
+Vector3 CapsuleBatch::GetClosestSegmentPoint(unsigned index, const Vector3& point) const
+{
+    const Vector3 start = GetStart(index);
+    const Vector3 axis = GetEnd(index) - start;
+    const float axisLengthSquared = axis.LengthSquared();
+    if (axisLengthSquared < M_EPSILON)
+        return start;
+
+    const float t = Clamp((point - start).DotProduct(axis) / axisLengthSquared, 0.0f, 1.0f);
+    return start + axis * t;
+}
+
+}
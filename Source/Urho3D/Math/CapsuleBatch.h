@@ -0,0 +1,76 @@
+//
+// Copyright (c) 2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#pragma once
+
+#include "../Math/Ray.h"
+
+#include <EASTL/span.h>
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+/// Batch of capsules tested against rays and swept spheres at once.
+/// Capsules are stored as structure of arrays so that four capsules are tested per SIMD iteration.
+class URHO3D_API CapsuleBatch
+{
+public:
+    /// Remove all capsules.
+    void Clear();
+    /// Add capsule defined by segment and radius.
+    void Add(const Vector3& start, const Vector3& end, float radius);
+    /// Calculate hit distances to all capsules in the order they were added, or infinity if no hit.
+    /// Capsules are inflated by sweep radius, so non-zero radius performs sphere cast.
+    /// Ray direction is expected to be normalized.
+    ea::span<const float> HitDistances(const Ray& ray, float sweepRadius = 0.0f);
+
+    /// Return number of capsules.
+    unsigned GetSize() const { return size_; }
+    /// Return capsule segment start.
+    Vector3 GetStart(unsigned index) const { return {startX_[index], startY_[index], startZ_[index]}; }
+    /// Return capsule segment end.
+    Vector3 GetEnd(unsigned index) const { return {endX_[index], endY_[index], endZ_[index]}; }
+    /// Return capsule radius.
+    float GetRadius(unsigned index) const { return radius_[index]; }
+    /// Return closest point on capsule segment.
+    Vector3 GetClosestSegmentPoint(unsigned index, const Vector3& point) const;
+
+private:
+    /// Number of capsules.
+    unsigned size_{};
+    /// Capsule data, padded to multiple of 4.
+    /// @{
+    ea::vector<float> startX_;
+    ea::vector<float> startY_;
+    ea::vector<float> startZ_;
+    ea::vector<float> endX_;
+    ea::vector<float> endY_;
+    ea::vector<float> endZ_;
+    ea::vector<float> radius_;
+    /// @}
+    /// Hit distances of the last test.
+    ea::vector<float> distances_;
+};
+
+}
@@ -31,6 +31,27 @@
 namespace Urho3D
 {
 
+namespace
+{
+
+/// Return hit distance to a sphere that is not behind the ray origin. Ray direction is expected to be normalized.
+float HitDistanceFrontSphere(const Ray& ray, const Vector3& center, float squaredRadius)
+{
+    const Vector3 centeredOrigin = ray.origin_ - center;
+    const float c = centeredOrigin.DotProduct(centeredOrigin) - squaredRadius;
+    if (c <= 0.0f)
+        return 0.0f;
+
+    const float b = centeredOrigin.DotProduct(ray.direction_);
+    const float d = b * b - c;
+    if (d < 0.0f || b > 0.0f)
+        return M_INFINITY;
+
+    return -b - sqrtf(d);
+}
+
+}
+
 Vector3 Ray::ClosestPoint(const Ray& ray) const
 {
     // Algorithm based on http://paulbourke.net/geometry/lineline3d/
@@ -202,6 +223,40 @@ float Ray::HitDistance(const Sphere& sphere) const
         return (-b + dSqrt) / (2.0f * a);
 }
 
+float Ray::HitDistanceCapsule(const Vector3& start, const Vector3& end, float radius) const
+{
+    // Capsule is the union of the cylinder body and two end spheres, so the nearest hit is the nearest hit of any of them
+    const float squaredRadius = radius * radius;
+    float dist = ea::min(HitDistanceFrontSphere(*this, start, squaredRadius), HitDistanceFrontSphere(*this, end, squaredRadius));
+
+    const Vector3 axis = end - start;
+    const Vector3 centeredOrigin = origin_ - start;
+    const float axisLengthSquared = axis.DotProduct(axis);
+    const float axisDotDirection = axis.DotProduct(direction_);
+    const float axisDotOrigin = axis.DotProduct(centeredOrigin);
+
+    // Quadratic equation for the infinite cylinder, scaled by squared axis length
+    const float a = axisLengthSquared - axisDotDirection * axisDotDirection;
+    const float b = axisLengthSquared * direction_.DotProduct(centeredOrigin) - axisDotOrigin * axisDotDirection;
+    const float c = axisLengthSquared * (centeredOrigin.DotProduct(centeredOrigin) - squaredRadius) - axisDotOrigin * axisDotOrigin;
+
+    // Check if ray originates inside the cylinder body
+    if (axisLengthSquared > 0.0f && c <= 0.0f && axisDotOrigin >= 0.0f && axisDotOrigin <= axisLengthSquared)
+        return 0.0f;
+
+    // Ray parallel to the axis or originating inside infinite cylinder can only enter through the end spheres
+    const float d = b * b - a * c;
+    if (c > 0.0f && a > M_EPSILON * axisLengthSquared && d >= 0.0f)
+    {
+        const float bodyDist = (-b - sqrtf(d)) / a;
+        const float axisPosition = axisDotOrigin + bodyDist * axisDotDirection;
+        if (bodyDist >= 0.0f && axisPosition >= 0.0f && axisPosition <= axisLengthSquared)
+            dist = ea::min(dist, bodyDist);
+    }
+
+    return dist;
+}
+
 float Ray::HitDistance(const Vector3& v0, const Vector3& v1, const Vector3& v2, Vector3* outNormal, Vector3* outBary) const
 {
     // Based on Fast, Minimum Storage Ray/Triangle Intersection by Möller & Trumbore
@@ -38,6 +38,12 @@ struct Transform
     Vector3 scale_{Vector3::ONE};
 
     Matrix3x4 ToMatrix3x4() const { return Matrix3x4(position_, rotation_, scale_); };
+
+    /// Linear interpolation with another transform. Rotation is normalized-lerped along the shortest path.
+    Transform Lerp(const Transform& rhs, float t) const
+    {
+        return {position_.Lerp(rhs.position_, t), rotation_.Nlerp(rhs.rotation_, t, true), scale_.Lerp(rhs.scale_, t)};
+    }
 };
 
 }
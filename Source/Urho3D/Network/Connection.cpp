@@ -32,6 +32,7 @@
 #include "../Network/ClockSynchronizer.h"
 #include "../Network/Connection.h"
 #include "../Network/Network.h"
+#include "../Network/NetworkReceiveThread.h"
 #include "../Network/NetworkEvents.h"
 #include "../Network/Protocol.h"
 #include "../Replica/ReplicationManager.h"
@@ -393,56 +394,85 @@ bool Connection::ProcessMessage(int msgID, MemoryBuffer& buffer)
         MemoryBuffer msg(buffer.GetData() + buffer.GetPosition(), packetSize);
         buffer.Seek(buffer.GetPosition() + packetSize);
 
-        switch (msgID)
-        {
-            case MSG_IDENTITY:
-                ProcessIdentity(msgID, msg);
-                break;
-
-            case MSG_SCENELOADED:
-                ProcessSceneLoaded(msgID, msg);
-                break;
-
-            case MSG_REQUESTPACKAGE:
-            case MSG_PACKAGEDATA:
-                ProcessPackageDownload(msgID, msg);
-                break;
+        ProcessUnpackedMessage(msgID, msg);
+    }
+    return true;
+}
 
-            case MSG_LOADSCENE:
-                ProcessLoadScene(msgID, msg);
-                break;
+bool Connection::ProcessPacket(const IncomingPacket& packet)
+{
+    tempPacketCounter_.x_++;
+    const unsigned char* data = packet.data_.data();
+    const unsigned size = packet.data_.size();
+    if (packet.messageStart_ >= size)
+        return false;
 
-            case MSG_SCENECHECKSUMERROR:
-                ProcessSceneChecksumError(msgID, msg);
-                break;
+    if (packet.messageId_ != MSG_PACKED_MESSAGE)
+    {
+        MemoryBuffer msg(data + packet.messageStart_, size - packet.messageStart_);
+        ProcessUnknownMessage(packet.messageId_, msg);
+        return true;
+    }
 
-            case MSG_REMOTEEVENT:
-            case MSG_REMOTENODEEVENT:
-                ProcessRemoteEvent(msgID, msg);
-                break;
+    // Messages are already unpacked and validated by the receive thread
+    for (const IncomingMessage& message : packet.messages_)
+    {
+        MemoryBuffer msg(data + message.offset_, message.size_);
+        ProcessUnpackedMessage(message.messageId_, msg);
+    }
+    return true;
+}
 
-            case MSG_PACKAGEINFO:
-                ProcessPackageInfo(msgID, msg);
-                break;
+void Connection::ProcessUnpackedMessage(int msgID, MemoryBuffer& msg)
+{
+    switch (msgID)
+    {
+        case MSG_IDENTITY:
+            ProcessIdentity(msgID, msg);
+            break;
+
+        case MSG_SCENELOADED:
+            ProcessSceneLoaded(msgID, msg);
+            break;
+
+        case MSG_REQUESTPACKAGE:
+        case MSG_PACKAGEDATA:
+            ProcessPackageDownload(msgID, msg);
+            break;
+
+        case MSG_LOADSCENE:
+            ProcessLoadScene(msgID, msg);
+            break;
+
+        case MSG_SCENECHECKSUMERROR:
+            ProcessSceneChecksumError(msgID, msg);
+            break;
+
+        case MSG_REMOTEEVENT:
+        case MSG_REMOTENODEEVENT:
+            ProcessRemoteEvent(msgID, msg);
+            break;
+
+        case MSG_PACKAGEINFO:
+            ProcessPackageInfo(msgID, msg);
+            break;
+
+        case MSG_CLOCK_SYNC:
+            if (clock_)
+            {
+                ClockSynchronizerMessage clockMessage;
+                clockMessage.Load(msg);
+                clock_->ProcessMessage(clockMessage);
+            }
+            break;
 
-            case MSG_CLOCK_SYNC:
-                if (clock_)
-                {
-                    ClockSynchronizerMessage clockMessage;
-                    clockMessage.Load(msg);
-                    clock_->ProcessMessage(clockMessage);
-                }
+        default:
+            if (replicationManager_ && replicationManager_->ProcessMessage(this, static_cast<NetworkMessageId>(msgID), msg))
                 break;
 
-            default:
-                if (replicationManager_ && replicationManager_->ProcessMessage(this, static_cast<NetworkMessageId>(msgID), msg))
-                    break;
-
-                ProcessUnknownMessage(msgID, msg);
-                break;
-        }
+            ProcessUnknownMessage(msgID, msg);
+            break;
     }
-    return true;
 }
 
 void Connection::Ban()
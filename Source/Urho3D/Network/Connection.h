@@ -46,6 +46,7 @@ namespace Urho3D
 
 class ClockSynchronizer;
 class File;
+struct IncomingPacket;
 class MemoryBuffer;
 class ReplicationManager;
 class Node;
@@ -158,6 +159,8 @@ public:
     void SendAllBuffers();
     /// Process a message from the server or client. Called by Network.
     bool ProcessMessage(int msgID, MemoryBuffer& buffer);
+    /// Process a packet unpacked by the network receive thread. Called by Network.
+    bool ProcessPacket(const IncomingPacket& packet);
     /// Ban this connections IP address.
     void Ban();
     /// Return the RakNet address/guid.
@@ -258,6 +261,8 @@ private:
     void ProcessPackageInfo(int msgID, MemoryBuffer& msg);
     /// Process unknown message. All unknown messages are forwarded as an events
     void ProcessUnknownMessage(int msgID, MemoryBuffer& msg);
+    /// Process a single message unpacked from packed message.
+    void ProcessUnpackedMessage(int msgID, MemoryBuffer& msg);
     /// Check a package list received from server and initiate package downloads as necessary. Return true on success, or false if failed to initialze downloads (cache dir not set).
     bool RequestNeededPackages(unsigned numPackages, MemoryBuffer& msg);
     /// Initiate a package download.
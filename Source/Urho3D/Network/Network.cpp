@@ -34,9 +34,12 @@
 #include "../Network/HttpRequest.h"
 #include "../Network/Network.h"
 #include "../Network/NetworkEvents.h"
+#include "../Network/NetworkReceiveThread.h"
 #include "../Network/Protocol.h"
 #include "../Replica/BehaviorNetworkObject.h"
 #include "../Replica/FilteredByDistance.h"
+#include "../Replica/FilteredByInterest.h"
+#include "../Replica/LagCompensatedHitbox.h"
 #include "../Replica/NetworkObject.h"
 #include "../Replica/PredictedKinematicController.h"
 #include "../Replica/ReplicatedAnimation.h"
@@ -214,6 +217,7 @@ Network::Network(Context* context) :
     rakPeer_ = SLNet::RakPeerInterface::GetInstance();
     rakPeerClient_ = SLNet::RakPeerInterface::GetInstance();
     rakPeer_->SetTimeoutTime(SERVER_TIMEOUT_TIME, SLNet::UNASSIGNED_SYSTEM_ADDRESS);
+    receiveThread_ = ea::make_unique<NetworkReceiveThread>(rakPeer_, rakPeerClient_);
     SetPassword("");
     SetDiscoveryBeacon(VariantMap());
 
@@ -231,6 +235,7 @@ Network::Network(Context* context) :
 
 Network::~Network()
 {
+    StopReceiveThread();
     rakPeer_->DetachPlugin(natPunchthroughServerClient_);
     rakPeerClient_->DetachPlugin(natPunchthroughClient_);
     // If server connection exists, disconnect, but do not send an event because we are shutting down
@@ -248,6 +253,7 @@ Network::~Network()
     delete natPunchServerAddress_;
     natPunchServerAddress_ = nullptr;
 
+    receiveThread_ = nullptr;
     SLNet::RakPeerInterface::DestroyInstance(rakPeer_);
     SLNet::RakPeerInterface::DestroyInstance(rakPeerClient_);
     rakPeer_ = nullptr;
@@ -317,9 +323,11 @@ void Network::DiscoverHosts(unsigned port)
     // JSandusky: Contrary to the manual, we actually do have to perform Startup first before we can Ping
     if (!rakPeerClient_->IsActive())
     {
+        StopReceiveThread();
         SLNet::SocketDescriptor socket;
         // Startup local connection with max 1 incoming connection(first param) and 1 socket description (third param)
         rakPeerClient_->Startup(1, &socket, 1);
+        StartReceiveThread();
     }
     rakPeerClient_->Ping("255.255.255.255", port, false);
 }
@@ -337,9 +345,11 @@ bool Network::Connect(const ea::string& address, unsigned short port, Scene* sce
     if (!rakPeerClient_->IsActive())
     {
         URHO3D_LOGINFO("Initializing client connection...");
+        StopReceiveThread();
         SLNet::SocketDescriptor socket;
         // Startup local connection with max 2 incoming connections(first param) and 1 socket description (third param)
         rakPeerClient_->Startup(2, &socket, 1);
+        StartReceiveThread();
     }
 
     SLNet::ConnectionAttemptResult connectResult = rakPeerClient_->Connect(address.c_str(), port, password_.c_str(), password_.length());
@@ -393,7 +403,9 @@ bool Network::StartServer(unsigned short port, unsigned int maxConnections)
     socket.port = port;
     socket.socketFamily = AF_INET;
     // Startup local connection with max 128 incoming connection(first param) and 1 socket description (third param)
+    StopReceiveThread();
     SLNet::StartupResult startResult = rakPeer_->Startup(maxConnections, &socket, 1);
+    StartReceiveThread();
     if (startResult == SLNet::RAKNET_STARTED)
     {
         URHO3D_LOGINFO("Started server on port " + ea::to_string(port));
@@ -423,7 +435,10 @@ void Network::StopServer()
 
     isServer_ = false;
     // Provide 300 ms to notify
+    StopReceiveThread();
     rakPeer_->Shutdown(300);
+    receiveThread_->GetQueue(true).Clear();
+    StartReceiveThread();
 
     URHO3D_PROFILE("StopServer");
 
@@ -449,7 +464,10 @@ void Network::StartNATClient()
         return;
     }
 
+    // Plugins are updated by the thread that receives packets
+    StopReceiveThread();
     rakPeer_->AttachPlugin(natPunchthroughServerClient_);
+    StartReceiveThread();
     guid_ = ea::string(rakPeer_->GetGuidFromSystemAddress(SLNet::UNASSIGNED_SYSTEM_ADDRESS).ToString());
     URHO3D_LOGINFO("GUID: " + guid_);
     rakPeer_->Connect(natPunchServerAddress_->ToString(false), natPunchServerAddress_->GetPort(), nullptr, 0);
@@ -463,6 +481,9 @@ void Network::AttemptNATPunchtrough(const ea::string& guid, Scene* scene, const
         remoteGUID_ = new SLNet::RakNetGUID;
 
     remoteGUID_->FromString(guid.c_str());
+
+    // Plugins are updated by the thread that receives packets
+    StopReceiveThread();
     rakPeerClient_->AttachPlugin(natPunchthroughClient_);
     if (rakPeerClient_->IsActive()) {
         natPunchthroughClient_->OpenNAT(*remoteGUID_, *natPunchServerAddress_);
@@ -474,6 +495,7 @@ void Network::AttemptNATPunchtrough(const ea::string& guid, Scene* scene, const
     }
 
     rakPeerClient_->Connect(natPunchServerAddress_->ToString(false), natPunchServerAddress_->GetPort(), nullptr, 0);
+    StartReceiveThread();
 }
 
 void Network::BroadcastMessage(int msgID, bool reliable, bool inOrder, const VectorBuffer& msg, unsigned contentID)
@@ -730,31 +752,24 @@ ea::string Network::GetDebugInfo() const
     return result;
 }
 
-void Network::HandleIncomingPacket(SLNet::Packet* packet, bool isServer)
+void Network::HandleIncomingPacket(const IncomingPacket& packet, bool isServer)
 {
-    unsigned char packetID = packet->data[0];
+    // Timestamp and packet ID are already parsed by receive thread
+    const unsigned char packetID = packet.packetId_;
+    unsigned dataStart = packet.dataStart_;
     bool packetHandled = false;
 
-    // Deal with timestamped backents
-    unsigned dataStart = sizeof(char);
-    if (packetID == ID_TIMESTAMP)
-    {
-        dataStart += sizeof(SLNet::Time);
-        packetID = packet->data[dataStart];
-        dataStart += sizeof(char);
-    }
-
     if (packetID == ID_NEW_INCOMING_CONNECTION)
     {
         if (isServer)
         {
-            NewConnectionEstablished(packet->systemAddress);
+            NewConnectionEstablished(packet.address_);
             packetHandled = true;
         }
     }
     else if (packetID == ID_ALREADY_CONNECTED)
     {
-        if (natPunchServerAddress_ && packet->systemAddress == *natPunchServerAddress_) {
+        if (natPunchServerAddress_ && packet.address_ == *natPunchServerAddress_) {
             URHO3D_LOGINFO("Already connected to NAT server! ");
             if (!isServer)
             {
@@ -765,7 +780,7 @@ void Network::HandleIncomingPacket(SLNet::Packet* packet, bool isServer)
     }
     else if (packetID == ID_CONNECTION_REQUEST_ACCEPTED) // We're a client, our connection as been accepted
     {
-        if(natPunchServerAddress_ && packet->systemAddress == *natPunchServerAddress_) {
+        if(natPunchServerAddress_ && packet.address_ == *natPunchServerAddress_) {
             URHO3D_LOGINFO("Succesfully connected to NAT punchtrough server! ");
             SendEvent(E_NATMASTERCONNECTIONSUCCEEDED);
             if (!isServer)
@@ -775,7 +790,7 @@ void Network::HandleIncomingPacket(SLNet::Packet* packet, bool isServer)
         } else {
             if (!isServer)
             {
-                OnServerConnected(packet->systemAddress);
+                OnServerConnected(packet.address_);
             }
         }
         packetHandled = true;
@@ -789,11 +804,11 @@ void Network::HandleIncomingPacket(SLNet::Packet* packet, bool isServer)
     {
         if (isServer)
         {
-            ClientDisconnected(packet->systemAddress);
+            ClientDisconnected(packet.address_);
         }
         else
         {
-            OnServerDisconnected(packet->systemAddress);
+            OnServerDisconnected(packet.address_);
         }
         packetHandled = true;
     }
@@ -801,17 +816,17 @@ void Network::HandleIncomingPacket(SLNet::Packet* packet, bool isServer)
     {
         if (isServer)
         {
-            ClientDisconnected(packet->systemAddress);
+            ClientDisconnected(packet.address_);
         }
         else
         {
-            OnServerDisconnected(packet->systemAddress);
+            OnServerDisconnected(packet.address_);
         }
         packetHandled = true;
     }
     else if (packetID == ID_CONNECTION_ATTEMPT_FAILED) // We've failed to connect to the server/peer
     {
-        if (natPunchServerAddress_ && packet->systemAddress == *natPunchServerAddress_) {
+        if (natPunchServerAddress_ && packet.address_ == *natPunchServerAddress_) {
             URHO3D_LOGERROR("Connection to NAT punchtrough server failed!");
             SendEvent(E_NATMASTERCONNECTIONFAILED);
 
@@ -819,14 +834,14 @@ void Network::HandleIncomingPacket(SLNet::Packet* packet, bool isServer)
 
             if (!isServer)
             {
-                OnServerDisconnected(packet->systemAddress);
+                OnServerDisconnected(packet.address_);
             }
         }
         packetHandled = true;
     }
     else if (packetID == ID_NAT_PUNCHTHROUGH_SUCCEEDED)
     {
-        SLNet::SystemAddress remotePeer = packet->systemAddress;
+        SLNet::SystemAddress remotePeer = packet.address_;
         URHO3D_LOGINFO("NAT punchtrough succeeded! Remote peer: " + ea::string(remotePeer.ToString()));
         if (!isServer)
         {
@@ -843,7 +858,7 @@ void Network::HandleIncomingPacket(SLNet::Packet* packet, bool isServer)
     else if (packetID == ID_NAT_PUNCHTHROUGH_FAILED)
     {
         URHO3D_LOGERROR("NAT punchtrough failed!");
-        SLNet::SystemAddress remotePeer = packet->systemAddress;
+        SLNet::SystemAddress remotePeer = packet.address_;
         using namespace NetworkNatPunchtroughFailed;
         VariantMap eventMap;
         eventMap[P_ADDRESS] = remotePeer.ToString(false);
@@ -879,8 +894,8 @@ void Network::HandleIncomingPacket(SLNet::Packet* packet, bool isServer)
 
             dataStart += sizeof(SLNet::TimeMS);
             VariantMap& eventMap = context_->GetEventDataMap();
-            if (packet->length > packet->length - dataStart) {
-                VectorBuffer buffer(packet->data + dataStart, packet->length - dataStart);
+            if (packet.data_.size() > packet.data_.size() - dataStart) {
+                VectorBuffer buffer(packet.data_.data() + dataStart, packet.data_.size() - dataStart);
                 VariantMap srcData = buffer.ReadVariantMap();
                 eventMap[P_BEACON] = srcData;
             }
@@ -888,8 +903,8 @@ void Network::HandleIncomingPacket(SLNet::Packet* packet, bool isServer)
                 eventMap[P_BEACON] = VariantMap();
             }
 
-            eventMap[P_ADDRESS] = ea::string(packet->systemAddress.ToString(false));
-            eventMap[P_PORT] = (int)packet->systemAddress.GetPort();
+            eventMap[P_ADDRESS] = ea::string(packet.address_.ToString(false));
+            eventMap[P_PORT] = (int)packet.address_.GetPort();
             SendEvent(E_NETWORKHOSTDISCOVERED, eventMap);
         }
         packetHandled = true;
@@ -898,20 +913,22 @@ void Network::HandleIncomingPacket(SLNet::Packet* packet, bool isServer)
     // Urho3D messages
     if (packetID >= ID_USER_PACKET_ENUM)
     {
-        unsigned int messageID = *(unsigned int*)(packet->data + dataStart);
-        dataStart += sizeof(unsigned int);
-
         if (isServer)
         {
-            HandleMessage(packet->systemAddress, 0, messageID, (const char*)(packet->data + dataStart), packet->length - dataStart);
+            // Only process messages from known sources
+            if (Connection* connection = GetConnection(packet.address_))
+                connection->ProcessPacket(packet);
+            else
+                URHO3D_LOGWARNING("Discarding message from unknown MessageConnection " + ea::string(packet.address_.ToString()));
         }
         else
         {
-            MemoryBuffer buffer(packet->data + dataStart, packet->length - dataStart);
-            bool processed = serverConnection_ && serverConnection_->ProcessMessage(messageID, buffer);
+            bool processed = serverConnection_ && serverConnection_->ProcessPacket(packet);
             if (!processed)
             {
-                HandleMessage(packet->systemAddress, 0, messageID, (const char*)(packet->data + dataStart), packet->length - dataStart);
+                const unsigned messageStart = packet.messageStart_;
+                HandleMessage(packet.address_, 0, packet.messageId_,
+                    reinterpret_cast<const char*>(packet.data_.data() + messageStart), packet.data_.size() - messageStart);
             }
         }
         packetHandled = true;
@@ -924,6 +941,34 @@ void Network::HandleIncomingPacket(SLNet::Packet* packet, bool isServer)
 
 }
 
+void Network::ProcessIncomingPackets(bool isServer)
+{
+    IncomingPacketQueue& queue = receiveThread_->GetQueue(isServer);
+    while (const IncomingPacket* packet = queue.Front())
+    {
+        const unsigned packetIndex = queue.GetFrontIndex();
+        HandleIncomingPacket(*packet, isServer);
+
+        // Queue is cleared if the peer is shut down while handling the packet
+        if (queue.GetFrontIndex() == packetIndex)
+            queue.Pop();
+    }
+}
+
+void Network::StartReceiveThread()
+{
+#ifdef URHO3D_THREADING
+    // Don't keep idle thread polling when there's nothing to receive
+    if (rakPeer_->IsActive() || rakPeerClient_->IsActive())
+        receiveThread_->Run();
+#endif
+}
+
+void Network::StopReceiveThread()
+{
+    receiveThread_->Stop();
+}
+
 void Network::Update(float timeStep)
 {
     URHO3D_PROFILE("UpdateNetwork");
@@ -934,25 +979,13 @@ void Network::Update(float timeStep)
     if (updateNow_)
         updateAcc_ = fmodf(updateAcc_, updateInterval_);
 
-    // Process all incoming messages for the server
-    if (rakPeer_->IsActive())
-    {
-        while (SLNet::Packet* packet = rakPeer_->Receive())
-        {
-            HandleIncomingPacket(packet, true);
-            rakPeer_->DeallocatePacket(packet);
-        }
-    }
+    // Receive packets on the main thread if receive thread is not running
+    if (!receiveThread_->IsStarted())
+        receiveThread_->ReceivePackets();
 
-    // Process all incoming messages for the client
-    if (rakPeerClient_->IsActive())
-    {
-        while (SLNet::Packet* packet = rakPeerClient_->Receive())
-        {
-            HandleIncomingPacket(packet, false);
-            rakPeerClient_->DeallocatePacket(packet);
-        }
-    }
+    // Process all incoming messages for the server, then for the client
+    ProcessIncomingPackets(true);
+    ProcessIncomingPackets(false);
 
     {
         using namespace NetworkInputProcessed;
@@ -1088,7 +1121,9 @@ void RegisterNetworkLibrary(Context* context)
     ReplicatedAnimation::RegisterObject(context);
     ReplicatedTransform::RegisterObject(context);
     TrackedAnimatedModel::RegisterObject(context);
+    LagCompensatedHitbox::RegisterObject(context);
     FilteredByDistance::RegisterObject(context);
+    FilteredByInterest::RegisterObject(context);
 #ifdef URHO3D_PHYSICS
     PredictedKinematicController::RegisterObject(context);
 #endif
@@ -23,6 +23,7 @@
 #pragma once
 
 #include <EASTL/hash_set.h>
+#include <EASTL/unique_ptr.h>
 
 #include "../Core/Object.h"
 #include "../IO/VectorBuffer.h"
@@ -33,6 +34,8 @@ namespace Urho3D
 
 class HttpRequest;
 class MemoryBuffer;
+class NetworkReceiveThread;
+struct IncomingPacket;
 class Scene;
 
 /// %Network subsystem. Manages client-server communications using the UDP protocol.
@@ -185,7 +188,13 @@ private:
     /// Reconfigure network simulator parameters on all existing connections.
     void ConfigureNetworkSimulator();
     /// All incoming packages are handled here.
-    void HandleIncomingPacket(SLNet::Packet* packet, bool isServer);
+    void HandleIncomingPacket(const IncomingPacket& packet, bool isServer);
+    /// Handle all packets received by server or client peer.
+    void ProcessIncomingPackets(bool isServer);
+    /// Start receiving packets on the receive thread if threading is enabled and any peer is active.
+    void StartReceiveThread();
+    /// Stop receive thread. Should be done before SLikeNet peers are started, shut down or get new plugins.
+    void StopReceiveThread();
     /// Return hash of endpoint.
     static unsigned long GetEndpointHash(const SLNet::AddressOrGUID& endpoint);
 
@@ -210,6 +219,8 @@ private:
     SLNet::RakPeerInterface* rakPeer_;
     /// SLikeNet peer instance for client connection.
     SLNet::RakPeerInterface* rakPeerClient_;
+    /// Thread that receives and unpacks incoming packets from both peers.
+    ea::unique_ptr<NetworkReceiveThread> receiveThread_;
     /// Client's server connection.
     SharedPtr<Connection> serverConnection_;
     /// Server's client connections. Key is SLNet::AddressOrGUID hash.
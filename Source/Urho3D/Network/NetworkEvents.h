@@ -124,6 +124,15 @@ URHO3D_EVENT(E_NETWORKUPDATESENT, NetworkUpdateSent)
     URHO3D_PARAM(P_ISSERVER, IsServer);                 // bool
 }
 
+/// Objects added to the client scene by the server. Sent to the client scene.
+/// Large scenes are streamed over several network frames, all objects are received when there are no pending objects.
+URHO3D_EVENT(E_NETWORKOBJECTSSTREAMED, NetworkObjectsStreamed)
+{
+    URHO3D_PARAM(P_SCENE, Scene);                       // Scene pointer
+    URHO3D_PARAM(P_NUMADDED, NumAdded);                 // unsigned
+    URHO3D_PARAM(P_NUMPENDING, NumPending);             // unsigned
+}
+
 /// Scene load failed, either due to file not found or checksum error.
 URHO3D_EVENT(E_NETWORKSCENELOADFAILED, NetworkSceneLoadFailed)
 {
@@ -0,0 +1,193 @@
+//
+// Copyright (c) 2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/Profiler.h"
+#include "../Core/Timer.h"
+#include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
+#include "../Network/NetworkReceiveThread.h"
+#include "../Network/Protocol.h"
+
+#include <slikenet/MessageIdentifiers.h>
+#include <slikenet/peerinterface.h>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+IncomingPacketQueue::IncomingPacketQueue(unsigned capacity)
+{
+    const unsigned size = NextPowerOfTwo(ea::max(capacity, 1u));
+    packets_.resize(size);
+    mask_ = size - 1;
+}
+
+IncomingPacket* IncomingPacketQueue::BeginPush()
+{
+    const unsigned tail = tail_.load(std::memory_order_relaxed);
+    const unsigned head = head_.load(std::memory_order_acquire);
+    if (tail - head > mask_)
+        return nullptr;
+    return &packets_[tail & mask_];
+}
+
+void IncomingPacketQueue::EndPush()
+{
+    tail_.fetch_add(1, std::memory_order_release);
+}
+
+IncomingPacket* IncomingPacketQueue::Front()
+{
+    const unsigned head = head_.load(std::memory_order_relaxed);
+    const unsigned tail = tail_.load(std::memory_order_acquire);
+    if (head == tail)
+        return nullptr;
+    return &packets_[head & mask_];
+}
+
+void IncomingPacketQueue::Pop()
+{
+    head_.fetch_add(1, std::memory_order_release);
+}
+
+void IncomingPacketQueue::Clear()
+{
+    head_.store(tail_.load(std::memory_order_acquire), std::memory_order_release);
+}
+
+NetworkReceiveThread::NetworkReceiveThread(SLNet::RakPeerInterface* serverPeer, SLNet::RakPeerInterface* clientPeer)
+    : Thread("NetworkReceive")
+    , serverPeer_(serverPeer)
+    , clientPeer_(clientPeer)
+    , serverQueue_(QueueCapacity)
+    , clientQueue_(QueueCapacity)
+{
+}
+
+NetworkReceiveThread::~NetworkReceiveThread()
+{
+    Stop();
+}
+
+void NetworkReceiveThread::ThreadFunction()
+{
+    URHO3D_PROFILE_THREAD("NetworkReceive Thread");
+
+    while (shouldRun_)
+    {
+        if (!ReceivePackets())
+            Time::Sleep(1);
+    }
+}
+
+bool NetworkReceiveThread::ReceivePackets()
+{
+    URHO3D_PROFILE("ReceiveNetworkPackets");
+
+    const bool serverReceived = ReceivePackets(serverPeer_, serverQueue_);
+    const bool clientReceived = ReceivePackets(clientPeer_, clientQueue_);
+    return serverReceived || clientReceived;
+}
+
+bool NetworkReceiveThread::ReceivePackets(SLNet::RakPeerInterface* peer, IncomingPacketQueue& queue)
+{
+    if (!peer->IsActive())
+        return false;
+
+    bool received = false;
+    // Leave packets in the peer if the main thread falls behind
+    while (IncomingPacket* incomingPacket = queue.BeginPush())
+    {
+        SLNet::Packet* packet = peer->Receive();
+        if (!packet)
+            break;
+
+        incomingPacket->address_ = packet->systemAddress;
+        incomingPacket->data_.assign(packet->data, packet->data + packet->length);
+        peer->DeallocatePacket(packet);
+
+        received = true;
+        if (UnpackPacket(*incomingPacket))
+            queue.EndPush();
+        else
+            URHO3D_LOGWARNING("Discarding malformed packet from {}", incomingPacket->address_.ToString());
+    }
+    return received;
+}
+
+bool NetworkReceiveThread::UnpackPacket(IncomingPacket& packet)
+{
+    const ByteVector& data = packet.data_;
+    const unsigned size = data.size();
+    packet.messages_.clear();
+
+    // Deal with timestamped packets
+    unsigned dataStart = sizeof(char);
+    if (size < dataStart)
+        return false;
+
+    unsigned char packetId = data[0];
+    if (packetId == ID_TIMESTAMP)
+    {
+        dataStart += sizeof(SLNet::Time);
+        if (size < dataStart + sizeof(char))
+            return false;
+        packetId = data[dataStart];
+        dataStart += sizeof(char);
+    }
+
+    packet.packetId_ = packetId;
+    packet.dataStart_ = dataStart;
+    if (packetId < ID_USER_PACKET_ENUM)
+        return true;
+
+    // Urho3D messages
+    if (size < dataStart + sizeof(unsigned))
+        return false;
+
+    MemoryBuffer buffer(data.data() + dataStart, size - dataStart);
+    packet.messageId_ = static_cast<int>(buffer.ReadUInt());
+    packet.messageStart_ = dataStart + buffer.GetPosition();
+    if (packet.messageId_ != MSG_PACKED_MESSAGE)
+        return true;
+
+    while (!buffer.IsEof())
+    {
+        if (buffer.GetSize() - buffer.GetPosition() < 2 * sizeof(unsigned))
+            return false;
+
+        IncomingMessage& message = packet.messages_.emplace_back();
+        message.messageId_ = static_cast<int>(buffer.ReadUInt());
+        message.size_ = buffer.ReadUInt();
+        message.offset_ = dataStart + buffer.GetPosition();
+        if (message.size_ > buffer.GetSize() - buffer.GetPosition())
+            return false;
+        buffer.Seek(buffer.GetPosition() + message.size_);
+    }
+    return true;
+}
+
+}
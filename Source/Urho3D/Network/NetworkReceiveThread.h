@@ -0,0 +1,140 @@
+//
+// Copyright (c) 2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+/// \file
+
+#pragma once
+
+#include "../Container/ByteVector.h"
+#include "../Core/Thread.h"
+
+#include <EASTL/vector.h>
+
+#include <slikenet/types.h>
+
+#include <atomic>
+
+namespace SLNet
+{
+    class RakPeerInterface;
+}
+
+namespace Urho3D
+{
+
+/// Message unpacked from incoming packet.
+struct IncomingMessage
+{
+    /// Message ID.
+    int messageId_{};
+    /// Offset of message data in the packet.
+    unsigned offset_{};
+    /// Size of message data.
+    unsigned size_{};
+};
+
+/// Incoming packet copied from SLikeNet peer and unpacked on network thread.
+struct IncomingPacket
+{
+    /// Address of the sender.
+    SLNet::SystemAddress address_;
+    /// Packet data.
+    ByteVector data_;
+    /// SLikeNet packet ID after optional timestamp.
+    unsigned char packetId_{};
+    /// Offset of packet payload after packet ID.
+    unsigned dataStart_{};
+    /// Urho3D message ID. Valid only for user packets.
+    int messageId_{};
+    /// Offset of Urho3D message data. Valid only for user packets.
+    unsigned messageStart_{};
+    /// Messages unpacked from MSG_PACKED_MESSAGE packet.
+    ea::vector<IncomingMessage> messages_;
+};
+
+/// Fixed-capacity lock-free queue of incoming packets for one producer and one consumer thread.
+/// Packet storage is reused to avoid allocations once the queue is warmed up.
+class URHO3D_API IncomingPacketQueue
+{
+public:
+    /// Construct. Capacity is rounded up to power of two.
+    explicit IncomingPacketQueue(unsigned capacity);
+
+    /// Return packet to be filled by producer, or null if queue is full.
+    IncomingPacket* BeginPush();
+    /// Make packet returned by BeginPush visible to consumer.
+    void EndPush();
+    /// Return oldest packet for consumer, or null if queue is empty.
+    IncomingPacket* Front();
+    /// Release packet returned by Front.
+    void Pop();
+    /// Remove all packets. Should be called from consumer thread.
+    void Clear();
+    /// Return index of the oldest packet. Should be called from consumer thread.
+    unsigned GetFrontIndex() const { return head_.load(std::memory_order_relaxed); }
+
+private:
+    ea::vector<IncomingPacket> packets_;
+    unsigned mask_{};
+    /// Index of the next packet to be consumed. Written only by consumer.
+    std::atomic<unsigned> head_{};
+    /// Index of the next packet to be produced. Written only by producer.
+    std::atomic<unsigned> tail_{};
+};
+
+/// Thread that polls SLikeNet peers and unpacks incoming packets so the main thread only has to apply them.
+/// Owned by Network. If threading is disabled, packets are received on the main thread via ReceivePackets.
+/// @nobind
+class URHO3D_API NetworkReceiveThread : public Thread
+{
+public:
+    /// Maximum number of packets waiting to be processed for each peer.
+    static constexpr unsigned QueueCapacity = 1024;
+
+    /// Construct.
+    NetworkReceiveThread(SLNet::RakPeerInterface* serverPeer, SLNet::RakPeerInterface* clientPeer);
+    /// Destruct.
+    ~NetworkReceiveThread() override;
+
+    /// Receive packets until stopped.
+    void ThreadFunction() override;
+    /// Receive and unpack all available packets. Return whether any packet was received.
+    bool ReceivePackets();
+
+    /// Return queue of packets received by server or client peer.
+    IncomingPacketQueue& GetQueue(bool isServer) { return isServer ? serverQueue_ : clientQueue_; }
+
+    /// Parse packet headers and unpack messages. Return false if packet is malformed.
+    static bool UnpackPacket(IncomingPacket& packet);
+
+private:
+    /// Receive available packets from peer into queue.
+    bool ReceivePackets(SLNet::RakPeerInterface* peer, IncomingPacketQueue& queue);
+
+    SLNet::RakPeerInterface* serverPeer_{};
+    SLNet::RakPeerInterface* clientPeer_{};
+    IncomingPacketQueue serverQueue_;
+    IncomingPacketQueue clientQueue_;
+};
+
+}
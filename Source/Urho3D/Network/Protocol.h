@@ -72,6 +72,10 @@ enum NetworkMessageId
     MSG_UPDATE_OBJECTS_UNRELIABLE,
     /// Client->Server. ReplicationManager message. Perform unordered and unreliable update of owned NetworkObjects from client to server.
     MSG_OBJECTS_FEEDBACK_UNRELIABLE,
+    /// Client->Server. ReplicationManager message. Acknowledge frames of received unreliable updates of NetworkObjects.
+    MSG_ACKNOWLEDGE_UPDATES_UNRELIABLE,
+    /// Client->Server and Server->Client. ReplicationManager message. Batched remote procedure calls of NetworkObjects.
+    MSG_OBJECTS_RPC,
 
     /// Message IDs starting from MSG_USER are reserved for the end user.
     MSG_USER = 512
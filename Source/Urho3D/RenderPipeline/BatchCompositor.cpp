@@ -26,6 +26,7 @@
 #include "../Graphics/Renderer.h"
 #include "../RenderPipeline/BatchCompositor.h"
 #include "../RenderPipeline/LightProcessor.h"
+#include "../RenderPipeline/PipelineBatchSortKey.h"
 #include "../RenderPipeline/RenderPipelineDefs.h"
 #include "../Scene/Node.h"
 
@@ -298,7 +299,7 @@ void BatchCompositor::ComposeLightVolumeBatches()
     }
 
     FillSortKeys(sortedLightVolumeBatches_, lightVolumeBatches_);
-    ea::sort(sortedLightVolumeBatches_.begin(), sortedLightVolumeBatches_.end());
+    SortPipelineBatches(nullptr, sortedLightVolumeBatches_, sortBuffers_);
 }
 
 void BatchCompositor::OnUpdateBegin(const CommonFrameInfo& frameInfo)
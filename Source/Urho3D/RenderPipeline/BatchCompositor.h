@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include "../Core/RadixSort.h"
 #include "../Graphics/GraphicsDefs.h"
 #include "../RenderPipeline/BatchStateCache.h"
 #include "../RenderPipeline/DrawableProcessor.h"
@@ -289,6 +290,7 @@ private:
     WorkQueueVector<ea::pair<ShadowSplitProcessor*, PipelineBatchDesc>> delayedShadowBatches_;
     ea::vector<PipelineBatch> lightVolumeBatches_;
     ea::vector<PipelineBatchByState> sortedLightVolumeBatches_;
+    RadixSortBuffers<PipelineBatchByState> sortBuffers_;
 };
 
 }
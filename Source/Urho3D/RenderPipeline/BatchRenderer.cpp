@@ -23,6 +23,7 @@
 #include "../Precompiled.h"
 
 #include "../Core/Context.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/Camera.h"
 #include "../Graphics/DrawCommandQueue.h"
 #include "../Graphics/Graphics.h"
@@ -155,18 +156,22 @@ public:
         }
     }
 
-    /// Add uniforms to instancing buffer for instanced batches.
-    void AddBatchesToInstancingBuffer(InstancingBuffer& instancingBuffer,
-        const SourceBatch& sourceBatch, unsigned instanceIndex)
+    /// Store uniforms of instanced batch in already allocated instances of instancing buffer.
+    /// Matrix3x4 rows are stored exactly as shader expects them, so transforms are copied as is.
+    void StoreBatchInInstancingBuffer(InstancingBuffer& instancingBuffer,
+        const SourceBatch& sourceBatch, unsigned startInstance) const
     {
-        instancingBuffer.AddInstance();
-        instancingBuffer.SetElements(&sourceBatch.worldTransform_[instanceIndex], 0, 3);
-        if (ambientEnabled_)
+        for (unsigned i = 0; i < sourceBatch.numWorldTransforms_; ++i)
         {
-            if (ambientMode_ == DrawableAmbientMode::Flat)
-                instancingBuffer.SetElements(&ambientValueFlat_, 3, 1);
-            else if (ambientMode_ == DrawableAmbientMode::Directional)
-                instancingBuffer.SetElements(ambientValueSH_, 3, 7);
+            const unsigned instanceIndex = startInstance + i;
+            instancingBuffer.SetInstanceElements(instanceIndex, &sourceBatch.worldTransform_[i], 0, 3);
+            if (ambientEnabled_)
+            {
+                if (ambientMode_ == DrawableAmbientMode::Flat)
+                    instancingBuffer.SetInstanceElements(instanceIndex, &ambientValueFlat_, 3, 1);
+                else if (ambientMode_ == DrawableAmbientMode::Directional)
+                    instancingBuffer.SetInstanceElements(instanceIndex, ambientValueSH_, 3, 7);
+            }
         }
     }
 
@@ -232,6 +237,23 @@ private:
     const SphericalHarmonicsDot9* ambientValueSH_{};
 };
 
+/// Return number of instances that batch adds to instancing buffer.
+unsigned GetNumBatchInstances(const ObjectParameterBuilder& objectParameterBuilder, const PipelineBatch& pipelineBatch)
+{
+    if (!objectParameterBuilder.IsBatchInstanced(pipelineBatch))
+        return 0;
+    return pipelineBatch.GetSourceBatch().numWorldTransforms_;
+}
+
+/// Evaluate lazily cached camera state so it can be safely accessed from worker threads.
+void PrepareCameraForThreadedAccess(const Camera& camera)
+{
+    camera.GetView();
+    camera.GetProjection();
+    camera.GetViewProj();
+    camera.GetEffectiveWorldTransform();
+}
+
 /// Batch renderer to command queue.
 template <bool DebuggerEnabled>
 class DrawCommandCompositor : public NonCopyable, private BatchRenderingContext
@@ -854,9 +876,21 @@ BatchRenderingContext::BatchRenderingContext(DrawCommandQueue& drawQueue, const
 {
 }
 
+BatchRenderingContext::BatchRenderingContext(DrawCommandQueue& drawQueue, const BatchRenderingContext& other)
+    : drawQueue_(drawQueue)
+    , camera_(other.camera_)
+    , outputShadowSplit_(other.outputShadowSplit_)
+    , globalResources_(other.globalResources_)
+    , frameParameters_(other.frameParameters_)
+    , cameraParameters_(other.cameraParameters_)
+{
+}
+
 BatchRenderer::BatchRenderer(RenderPipelineInterface* renderPipeline, const DrawableProcessor* drawableProcessor,
     InstancingBuffer* instancingBuffer)
     : Object(renderPipeline->GetContext())
+    , workQueue_(context_->GetSubsystem<WorkQueue>())
+    , graphics_(context_->GetSubsystem<Graphics>())
     , renderer_(context_->GetSubsystem<Renderer>())
     , debugger_(renderPipeline->GetDebugger())
     , drawableProcessor_(drawableProcessor)
@@ -872,7 +906,18 @@ void BatchRenderer::SetSettings(const BatchRendererSettings& settings)
 void BatchRenderer::RenderBatches(const BatchRenderingContext& ctx, PipelineBatchGroup<PipelineBatchByState> batchGroup)
 {
     batchGroup.flags_ = AdjustRenderFlags(batchGroup.flags_);
+    RenderBatchesImpl(ctx, batchGroup);
+}
+
+void BatchRenderer::RenderBatches(const BatchRenderingContext& ctx, PipelineBatchGroup<PipelineBatchBackToFront> batchGroup)
+{
+    batchGroup.flags_ = AdjustRenderFlags(batchGroup.flags_);
+    RenderBatchesImpl(ctx, batchGroup);
+}
 
+template <class T>
+void BatchRenderer::RenderBatchesImpl(const BatchRenderingContext& ctx, const PipelineBatchGroup<T>& batchGroup)
+{
     if (RenderPipelineDebugger::IsSnapshotInProgress(debugger_))
     {
         DrawCommandCompositor<true> compositor(ctx, settings_, debugger_,
@@ -880,37 +925,75 @@ void BatchRenderer::RenderBatches(const BatchRenderingContext& ctx, PipelineBatc
         for (const auto& sortedBatch : batchGroup.batches_)
             compositor.ProcessSceneBatch(*sortedBatch.pipelineBatch_);
         compositor.FlushDrawCommands(batchGroup.startInstance_ + batchGroup.numInstances_);
+        return;
     }
-    else
+
+    const unsigned maxSegments = workQueue_ ? workQueue_->GetNumThreads() + 1 : 1;
+    const unsigned numSegments = ea::min(maxSegments, batchGroup.batches_.size() / MinBatchesPerRecordingThread);
+    if (numSegments > 1)
     {
-        DrawCommandCompositor<false> compositor(ctx, settings_, nullptr,
-            *drawableProcessor_, *instancingBuffer_, batchGroup.flags_, batchGroup.startInstance_);
-        for (const auto& sortedBatch : batchGroup.batches_)
-            compositor.ProcessSceneBatch(*sortedBatch.pipelineBatch_);
-        compositor.FlushDrawCommands(batchGroup.startInstance_ + batchGroup.numInstances_);
+        RenderBatchesInThreads(ctx, batchGroup, numSegments);
+        return;
     }
+
+    DrawCommandCompositor<false> compositor(ctx, settings_, nullptr,
+        *drawableProcessor_, *instancingBuffer_, batchGroup.flags_, batchGroup.startInstance_);
+    for (const auto& sortedBatch : batchGroup.batches_)
+        compositor.ProcessSceneBatch(*sortedBatch.pipelineBatch_);
+    compositor.FlushDrawCommands(batchGroup.startInstance_ + batchGroup.numInstances_);
 }
 
-void BatchRenderer::RenderBatches(const BatchRenderingContext& ctx, PipelineBatchGroup<PipelineBatchBackToFront> batchGroup)
+template <class T>
+void BatchRenderer::RenderBatchesInThreads(const BatchRenderingContext& ctx, const PipelineBatchGroup<T>& batchGroup,
+    unsigned numSegments)
 {
-    batchGroup.flags_ = AdjustRenderFlags(batchGroup.flags_);
+    const unsigned numBatches = batchGroup.batches_.size();
+    const unsigned segmentSize = (numBatches + numSegments - 1) / numSegments;
+    numSegments = (numBatches + segmentSize - 1) / segmentSize;
 
-    if (RenderPipelineDebugger::IsSnapshotInProgress(debugger_))
+    while (segmentDrawQueues_.size() < numSegments)
+        segmentDrawQueues_.push_back(MakeShared<DrawCommandQueue>(graphics_));
+    segmentStartInstances_.resize(numSegments + 1);
+
+    // Count instances used by each segment to know where segments start in the instancing buffer
+    const ObjectParameterBuilder objectParameterBuilder(settings_, batchGroup.flags_);
+    if (objectParameterBuilder.IsInstancingSupported())
     {
-        DrawCommandCompositor<true> compositor(ctx, settings_, debugger_,
-            *drawableProcessor_, *instancingBuffer_, batchGroup.flags_, batchGroup.startInstance_);
-        for (const auto& sortedBatch : batchGroup.batches_)
-            compositor.ProcessSceneBatch(*sortedBatch.pipelineBatch_);
-        compositor.FlushDrawCommands(batchGroup.startInstance_ + batchGroup.numInstances_);
+        ForEachParallel(workQueue_, segmentSize, numBatches, [&](unsigned beginIndex, unsigned endIndex)
+        {
+            unsigned numInstances = 0;
+            for (unsigned i = beginIndex; i < endIndex; ++i)
+                numInstances += GetNumBatchInstances(objectParameterBuilder, *batchGroup.batches_[i].pipelineBatch_);
+            segmentStartInstances_[beginIndex / segmentSize + 1] = numInstances;
+        });
     }
     else
+        ea::fill(segmentStartInstances_.begin(), segmentStartInstances_.end(), 0u);
+
+    segmentStartInstances_[0] = batchGroup.startInstance_;
+    for (unsigned i = 1; i <= numSegments; ++i)
+        segmentStartInstances_[i] += segmentStartInstances_[i - 1];
+
+    // Record each segment into separate draw queue
+    PrepareCameraForThreadedAccess(ctx.camera_);
+    const bool preferConstantBuffers = ctx.drawQueue_.GetPreferConstantBuffers();
+    ForEachParallel(workQueue_, segmentSize, numBatches, [&](unsigned beginIndex, unsigned endIndex)
     {
-        DrawCommandCompositor<false> compositor(ctx, settings_, nullptr,
-            *drawableProcessor_, *instancingBuffer_, batchGroup.flags_, batchGroup.startInstance_);
-        for (const auto& sortedBatch : batchGroup.batches_)
-            compositor.ProcessSceneBatch(*sortedBatch.pipelineBatch_);
-        compositor.FlushDrawCommands(batchGroup.startInstance_ + batchGroup.numInstances_);
-    }
+        const unsigned segmentIndex = beginIndex / segmentSize;
+        DrawCommandQueue& segmentDrawQueue = *segmentDrawQueues_[segmentIndex];
+        segmentDrawQueue.Reset(preferConstantBuffers);
+
+        const BatchRenderingContext segmentCtx{segmentDrawQueue, ctx};
+        DrawCommandCompositor<false> compositor(segmentCtx, settings_, nullptr,
+            *drawableProcessor_, *instancingBuffer_, batchGroup.flags_, segmentStartInstances_[segmentIndex]);
+        for (unsigned i = beginIndex; i < endIndex; ++i)
+            compositor.ProcessSceneBatch(*batchGroup.batches_[i].pipelineBatch_);
+        compositor.FlushDrawCommands(segmentStartInstances_[segmentIndex + 1]);
+    });
+
+    // Concatenate segments in order
+    for (unsigned i = 0; i < numSegments; ++i)
+        ctx.drawQueue_.Append(*segmentDrawQueues_[i]);
 }
 
 void BatchRenderer::RenderLightVolumeBatches(const BatchRenderingContext& ctx,
@@ -951,28 +1034,55 @@ void BatchRenderer::PrepareInstancingBufferImpl(PipelineBatchGroup<T>& batches)
     batches.startInstance_ = 0;
     batches.numInstances_ = 0;
 
-    ObjectParameterBuilder objectParameterBuilder(settings_, batches.flags_);
+    const ObjectParameterBuilder objectParameterBuilder(settings_, batches.flags_);
     if (!objectParameterBuilder.IsInstancingSupported())
         return;
 
-    batches.startInstance_ = instancingBuffer_->GetNextInstanceIndex();
-    for (const T& sortedBatch : batches.batches_)
+    const unsigned numBatches = batches.batches_.size();
+    const unsigned maxChunks = workQueue_ ? workQueue_->GetNumThreads() + 1 : 1;
+    const unsigned numChunks = ea::max(1u, ea::min(maxChunks, numBatches / MinBatchesPerInstancingThread));
+    const unsigned chunkSize = ea::max(1u, (numBatches + numChunks - 1) / numChunks);
+    chunkStartInstances_.assign(numChunks + 1, 0u);
+
+    // Count instances of each chunk so that all instances are allocated at once
+    ForEachParallel(workQueue_, chunkSize, numBatches, [&](unsigned beginIndex, unsigned endIndex)
     {
-        const PipelineBatch& pipelineBatch = *sortedBatch.pipelineBatch_;
-        if (!objectParameterBuilder.IsBatchInstanced(pipelineBatch))
-            continue;
+        unsigned numInstances = 0;
+        for (unsigned i = beginIndex; i < endIndex; ++i)
+            numInstances += GetNumBatchInstances(objectParameterBuilder, *batches.batches_[i].pipelineBatch_);
+        chunkStartInstances_[beginIndex / chunkSize + 1] = numInstances;
+    });
+
+    for (unsigned i = 1; i <= numChunks; ++i)
+        chunkStartInstances_[i] += chunkStartInstances_[i - 1];
+
+    batches.numInstances_ = chunkStartInstances_[numChunks];
+    batches.startInstance_ = instancingBuffer_->AddInstances(batches.numInstances_);
+    if (batches.numInstances_ == 0)
+        return;
 
-        const SourceBatch& sourceBatch = pipelineBatch.GetSourceBatch();
-        if (objectParameterBuilder.IsAmbientEnabled())
+    // Fill disjoint ranges of allocated instances
+    ForEachParallel(workQueue_, chunkSize, numBatches, [&](unsigned beginIndex, unsigned endIndex)
+    {
+        ObjectParameterBuilder chunkParameterBuilder(settings_, batches.flags_);
+        unsigned instanceIndex = batches.startInstance_ + chunkStartInstances_[beginIndex / chunkSize];
+        for (unsigned i = beginIndex; i < endIndex; ++i)
         {
-            const LightAccumulator& lightAccumulator = drawableProcessor_->GetGeometryLighting(pipelineBatch.drawableIndex_);
-            objectParameterBuilder.SetBatchAmbient(lightAccumulator);
-        }
+            const PipelineBatch& pipelineBatch = *batches.batches_[i].pipelineBatch_;
+            if (!chunkParameterBuilder.IsBatchInstanced(pipelineBatch))
+                continue;
 
-        for (unsigned i = 0; i < sourceBatch.numWorldTransforms_; ++i)
-            objectParameterBuilder.AddBatchesToInstancingBuffer(*instancingBuffer_, sourceBatch, i);
-        batches.numInstances_ += sourceBatch.numWorldTransforms_;
-    }
+            const SourceBatch& sourceBatch = pipelineBatch.GetSourceBatch();
+            if (chunkParameterBuilder.IsAmbientEnabled())
+            {
+                const LightAccumulator& lightAccumulator = drawableProcessor_->GetGeometryLighting(pipelineBatch.drawableIndex_);
+                chunkParameterBuilder.SetBatchAmbient(lightAccumulator);
+            }
+
+            chunkParameterBuilder.StoreBatchInInstancingBuffer(*instancingBuffer_, sourceBatch, instanceIndex);
+            instanceIndex += sourceBatch.numWorldTransforms_;
+        }
+    });
 }
 
 BatchRenderFlags BatchRenderer::AdjustRenderFlags(BatchRenderFlags flags) const
@@ -37,6 +37,7 @@ class Camera;
 class DrawableProcessor;
 class InstancingBuffer;
 class ShadowSplitProcessor;
+class WorkQueue;
 
 /// Common parameters of batch rendering
 struct BatchRenderingContext
@@ -51,6 +52,8 @@ struct BatchRenderingContext
 
     BatchRenderingContext(DrawCommandQueue& drawQueue, const Camera& camera);
     BatchRenderingContext(DrawCommandQueue& drawQueue, const ShadowSplitProcessor& outputShadowSplit);
+    /// Construct with the same parameters as other context but different draw queue.
+    BatchRenderingContext(DrawCommandQueue& drawQueue, const BatchRenderingContext& other);
 };
 
 /// Utility class to convert pipeline batches into sequence of draw commands.
@@ -59,6 +62,11 @@ class URHO3D_API BatchRenderer : public Object
     URHO3D_OBJECT(BatchRenderer, Object);
 
 public:
+    /// Minimal number of batches recorded by one thread.
+    static constexpr unsigned MinBatchesPerRecordingThread = 256;
+    /// Minimal number of batches stored in instancing buffer by one thread.
+    static constexpr unsigned MinBatchesPerInstancingThread = 512;
+
     BatchRenderer(RenderPipelineInterface* renderPipeline, const DrawableProcessor* drawableProcessor,
         InstancingBuffer* instancingBuffer);
     void SetSettings(const BatchRendererSettings& settings);
@@ -79,11 +87,18 @@ public:
 
 private:
     template <class T>
+    void RenderBatchesImpl(const BatchRenderingContext& ctx, const PipelineBatchGroup<T>& batchGroup);
+    template <class T>
+    void RenderBatchesInThreads(const BatchRenderingContext& ctx, const PipelineBatchGroup<T>& batchGroup,
+        unsigned numSegments);
+    template <class T>
     void PrepareInstancingBufferImpl(PipelineBatchGroup<T>& batches);
     BatchRenderFlags AdjustRenderFlags(BatchRenderFlags flags) const;
 
     /// External dependencies
     /// @{
+    WorkQueue* workQueue_{};
+    Graphics* graphics_{};
     Renderer* renderer_{};
     RenderPipelineDebugger* debugger_{};
     const DrawableProcessor* drawableProcessor_{};
@@ -91,6 +106,13 @@ private:
     /// @}
 
     BatchRendererSettings settings_;
+
+    /// Draw queues for batch ranges recorded in worker threads.
+    ea::vector<SharedPtr<DrawCommandQueue>> segmentDrawQueues_;
+    /// First instance index of each batch range recorded in worker threads.
+    ea::vector<unsigned> segmentStartInstances_;
+    /// Offset of first instance of each batch range stored in instancing buffer in worker threads.
+    ea::vector<unsigned> chunkStartInstances_;
 };
 
 }
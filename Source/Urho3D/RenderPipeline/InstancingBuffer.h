@@ -64,6 +64,23 @@ public:
         memcpy(currentInstanceData_ + index * ElementStride, data, count * ElementStride);
     }
 
+    /// Add range of instances to buffer. Returns index of first instance. Use SetInstanceElements to fill them after.
+    unsigned AddInstances(unsigned count)
+    {
+        currentInstanceData_ = nullptr;
+        return vertexBuffer_->AddVertices(count).first;
+    }
+
+    /// Set one or more 4-float elements in specified instance.
+    /// Safe to call from worker threads for different instances as long as no instances are added.
+    void SetInstanceElements(unsigned instanceIndex, const void* data, unsigned index, unsigned count)
+    {
+        memcpy(GetInstanceData(instanceIndex) + index * ElementStride, data, count * ElementStride);
+    }
+
+    /// Return writeable data of allocated instance. Pointer is invalidated when instances are added.
+    unsigned char* GetInstanceData(unsigned instanceIndex) { return vertexBuffer_->GetVertexData(instanceIndex); }
+
     /// Getters
     /// @{
     const InstancingBufferSettings& GetSettings() const { return settings_; }
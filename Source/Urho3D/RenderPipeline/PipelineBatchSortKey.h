@@ -22,6 +22,7 @@
 
 #pragma once
 
+#include "../Core/RadixSort.h"
 #include "../Graphics/Geometry.h"
 #include "../Graphics/Graphics.h"
 #include "../Graphics/Material.h"
@@ -150,6 +151,16 @@ struct PipelineBatchBackToFront
         distance_ = batch->distance_;
     }
 
+    /// Return 64-bit key that orders batches the same way as comparison operator.
+    unsigned long long GetSortKey() const
+    {
+        // Map float to unsigned integer with the same order, then invert it to sort back to front
+        unsigned distanceBits{};
+        memcpy(&distanceBits, &distance_, sizeof(distanceBits));
+        distanceBits ^= (distanceBits & 0x80000000u) ? 0xffffffffu : 0x80000000u;
+        return (static_cast<unsigned long long>(renderOrder_) << 32) | ~distanceBits;
+    }
+
     /// Compare sorted batches.
     bool operator < (const PipelineBatchBackToFront& rhs) const
     {
@@ -159,6 +170,25 @@ struct PipelineBatchBackToFront
     }
 };
 
+/// Sort batches by state. Worker threads are used if work queue is provided and there are enough batches.
+inline void SortPipelineBatches(WorkQueue* workQueue,
+    ea::span<PipelineBatchByState> batches, RadixSortBuffers<PipelineBatchByState>& buffers)
+{
+    // Radix sort is stable, so sort by secondary key first
+    ParallelRadixSort(workQueue, batches, buffers,
+        [](const PipelineBatchByState& batch) { return batch.secondaryKey_; });
+    ParallelRadixSort(workQueue, batches, buffers,
+        [](const PipelineBatchByState& batch) { return batch.primaryKey_; });
+}
+
+/// Sort batches back to front. Worker threads are used if work queue is provided and there are enough batches.
+inline void SortPipelineBatches(WorkQueue* workQueue,
+    ea::span<PipelineBatchBackToFront> batches, RadixSortBuffers<PipelineBatchBackToFront>& buffers)
+{
+    ParallelRadixSort(workQueue, batches, buffers,
+        [](const PipelineBatchBackToFront& batch) { return batch.GetSortKey(); });
+}
+
 /// Group of batches to be rendered.
 template <class PipelineBatchSorted>
 struct PipelineBatchGroup
@@ -29,8 +29,6 @@
 #include "../RenderPipeline/BatchRenderer.h"
 #include "../RenderPipeline/ScenePass.h"
 
-#include <EASTL/sort.h>
-
 #include "../DebugNew.h"
 
 namespace Urho3D
@@ -57,12 +55,14 @@ void UnorderedScenePass::OnBatchesReady()
     BatchCompositor::FillSortKeys(sortedBaseBatches_, baseBatches_);
     BatchCompositor::FillSortKeys(sortedLightBatches_, lightBatches_, negativeLightBatches_);
 
-    ea::sort(sortedDeferredBatches_.begin(), sortedDeferredBatches_.end());
-    ea::sort(sortedBaseBatches_.begin(), sortedBaseBatches_.end());
+    SortPipelineBatches(workQueue_, sortedDeferredBatches_, sortBuffers_);
+    SortPipelineBatches(workQueue_, sortedBaseBatches_, sortBuffers_);
 
     const unsigned numNegativeLightBatches = negativeLightBatches_.Size();
-    ea::sort(sortedLightBatches_.begin(), sortedLightBatches_.end() - numNegativeLightBatches);
-    ea::sort(sortedLightBatches_.end() - numNegativeLightBatches, sortedLightBatches_.end());
+    const unsigned numPositiveLightBatches = sortedLightBatches_.size() - numNegativeLightBatches;
+    const ea::span<PipelineBatchByState> allLightBatches = sortedLightBatches_;
+    SortPipelineBatches(workQueue_, allLightBatches.subspan(0, numPositiveLightBatches), sortBuffers_);
+    SortPipelineBatches(workQueue_, allLightBatches.subspan(numPositiveLightBatches), sortBuffers_);
 
     deferredBatchGroup_ = { sortedDeferredBatches_ };
     baseBatchGroup_ = { sortedBaseBatches_ };
@@ -125,7 +125,7 @@ void BackToFrontScenePass::OnBatchesReady()
     for (unsigned i = substractiveLightBatchesBegin; i < substractiveLightBatchesEnd; ++i)
         sortedBatches_[i].distance_ *= substractiveDistanceFactor;
 
-    ea::sort(sortedBatches_.begin(), sortedBatches_.end());
+    SortPipelineBatches(workQueue_, sortedBatches_, sortBuffers_);
 
     if (GetFlags().Test(DrawableProcessorPassFlag::RefractionPass))
     {
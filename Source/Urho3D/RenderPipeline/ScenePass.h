@@ -75,6 +75,7 @@ protected:
     ea::vector<PipelineBatchByState> sortedDeferredBatches_;
     ea::vector<PipelineBatchByState> sortedBaseBatches_;
     ea::vector<PipelineBatchByState> sortedLightBatches_;
+    RadixSortBuffers<PipelineBatchByState> sortBuffers_;
 
     PipelineBatchGroup<PipelineBatchByState> deferredBatchGroup_;
     PipelineBatchGroup<PipelineBatchByState> baseBatchGroup_;
@@ -99,6 +100,7 @@ protected:
     void OnBatchesReady() override;
 
     ea::vector<PipelineBatchBackToFront> sortedBatches_;
+    RadixSortBuffers<PipelineBatchBackToFront> sortBuffers_;
     bool hasRefractionBatches_{};
 
     PipelineBatchGroup<PipelineBatchBackToFront> batchGroup_;
@@ -363,7 +363,8 @@ Matrix4 ShadowSplitProcessor::GetWorldToShadowSpaceMatrix(float subPixelOffset)
 void ShadowSplitProcessor::FinalizeShadowBatches()
 {
     BatchCompositor::FillSortKeys(sortedShadowBatches_, unsortedShadowBatches_);
-    ea::sort(sortedShadowBatches_.begin(), sortedShadowBatches_.end());
+    // Shadow splits are already processed in worker threads
+    SortPipelineBatches(nullptr, sortedShadowBatches_, sortBuffers_);
     shadowBatches_ = { sortedShadowBatches_,
         BatchRenderFlag::EnableInstancingForStaticGeometry | BatchRenderFlag::DisableColorOutput };
 }
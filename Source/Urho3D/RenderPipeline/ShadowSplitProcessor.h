@@ -128,6 +128,7 @@ private:
     /// @{
     ea::vector<PipelineBatch> unsortedShadowBatches_;
     ea::vector<PipelineBatchByState> sortedShadowBatches_;
+    RadixSortBuffers<PipelineBatchByState> sortBuffers_;
     PipelineBatchGroup<PipelineBatchByState> shadowBatches_;
     /// @}
 };
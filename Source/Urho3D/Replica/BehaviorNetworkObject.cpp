@@ -231,6 +231,20 @@ ea::optional<NetworkObjectRelevance> BehaviorNetworkObject::GetRelevanceForClien
     return ea::nullopt;
 }
 
+bool BehaviorNetworkObject::IsInterestManaged()
+{
+    if (callbackMask_.Test(NetworkCallbackMask::IsInterestManaged))
+    {
+        for (const auto& connectedBehavior : behaviors_)
+        {
+            if (connectedBehavior.callbackMask_.Test(NetworkCallbackMask::IsInterestManaged)
+                && connectedBehavior.component_->IsInterestManaged())
+                return true;
+        }
+    }
+    return false;
+}
+
 void BehaviorNetworkObject::UpdateTransformOnServer()
 {
     BaseClassName::UpdateTransformOnServer();
@@ -332,6 +346,27 @@ bool BehaviorNetworkObject::PrepareUnreliableDelta(NetworkFrame frame)
     return needUpdate;
 }
 
+bool BehaviorNetworkObject::PrepareForcedUnreliableDelta(NetworkFrame frame)
+{
+    bool needUpdate = BaseClassName::PrepareForcedUnreliableDelta(frame);
+
+    unreliableUpdateMask_ = 0;
+    if (callbackMask_.Test(NetworkCallbackMask::UnreliableDelta))
+    {
+        for (auto& connectedBehavior : behaviors_)
+        {
+            if (connectedBehavior.callbackMask_.Test(NetworkCallbackMask::UnreliableDelta))
+            {
+                if (connectedBehavior.component_->PrepareForcedUnreliableDelta(frame))
+                    unreliableUpdateMask_ |= connectedBehavior.bit_;
+            }
+        }
+    }
+
+    needUpdate = needUpdate || unreliableUpdateMask_ != 0;
+    return needUpdate;
+}
+
 void BehaviorNetworkObject::WriteUnreliableDelta(NetworkFrame frame, Serializer& dest)
 {
     BaseClassName::WriteUnreliableDelta(frame, dest);
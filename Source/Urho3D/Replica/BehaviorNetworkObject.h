@@ -99,6 +99,7 @@ public:
     void InitializeFromSnapshot(NetworkFrame frame, Deserializer& src, bool isOwned) override;
 
     ea::optional<NetworkObjectRelevance> GetRelevanceForClient(AbstractConnection* connection) override;
+    bool IsInterestManaged() override;
     void UpdateTransformOnServer() override;
     void InterpolateState(float replicaTimeStep, float inputTimeStep, const NetworkTime& replicaTime, const NetworkTime& inputTime) override;
 
@@ -107,6 +108,7 @@ public:
     void ReadReliableDelta(NetworkFrame frame, Deserializer& src) override;
 
     bool PrepareUnreliableDelta(NetworkFrame frame) override;
+    bool PrepareForcedUnreliableDelta(NetworkFrame frame) override;
     void WriteUnreliableDelta(NetworkFrame frame, Serializer& dest) override;
     void ReadUnreliableDelta(NetworkFrame frame, Deserializer& src) override;
 
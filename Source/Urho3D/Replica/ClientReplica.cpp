@@ -29,6 +29,7 @@
 #include "../Network/Connection.h"
 #include "../Network/Network.h"
 #include "../Network/NetworkEvents.h"
+#include "../Replica/DeltaEncoding.h"
 #include "../Replica/NetworkObject.h"
 #include "../Replica/ReplicationManager.h"
 #include "../Replica/NetworkSettingsConsts.h"
@@ -134,6 +135,8 @@ ClientReplica::ClientReplica(
 {
     URHO3D_ASSERT(objectRegistry_);
 
+    deltaCompressionHistory_ = GetSetting(NetworkSettings::DeltaCompressionHistory).GetUInt();
+
     SubscribeToEvent(E_INPUTREADY, [this](StringHash, VariantMap& eventData)
     {
         using namespace InputReady;
@@ -197,6 +200,14 @@ bool ClientReplica::ProcessMessage(NetworkMessageId messageId, MemoryBuffer& mes
         return true;
     }
 
+    case MSG_OBJECTS_RPC:
+    {
+        connection_->OnMessageReceived(messageId, messageData);
+
+        ProcessObjectsRpc(messageData);
+        return true;
+    }
+
     default:
         return false;
     }
@@ -238,6 +249,9 @@ void ClientReplica::ProcessRemoveObjects(MemoryBuffer& messageData)
 void ClientReplica::ProcessAddObjects(MemoryBuffer& messageData)
 {
     const auto messageFrame = static_cast<NetworkFrame>(messageData.ReadInt64());
+    const unsigned numPendingObjects = messageData.ReadVLE();
+
+    unsigned numAddedObjects = 0;
     while (!messageData.IsEof())
     {
         const auto networkId = static_cast<NetworkId>(messageData.ReadUInt());
@@ -260,8 +274,20 @@ void ClientReplica::ProcessAddObjects(MemoryBuffer& messageData)
             }
             else
                 networkObject->SetNetworkMode(NetworkObjectMode::ClientReplicated);
+
+            ++numAddedObjects;
         }
     }
+
+    isStreamingStateReceived_ = true;
+    numPendingObjects_ = numPendingObjects;
+
+    using namespace NetworkObjectsStreamed;
+    VariantMap& eventData = scene_->GetEventDataMap();
+    eventData[P_SCENE] = scene_;
+    eventData[P_NUMADDED] = numAddedObjects;
+    eventData[P_NUMPENDING] = numPendingObjects;
+    scene_->SendEvent(E_NETWORKOBJECTSSTREAMED, eventData);
 }
 
 void ClientReplica::ProcessUpdateObjectsReliable(MemoryBuffer& messageData)
@@ -287,20 +313,118 @@ void ClientReplica::ProcessUpdateObjectsUnreliable(MemoryBuffer& messageData)
 {
     const auto messageFrame = static_cast<NetworkFrame>(messageData.ReadInt64());
 
+    bool isMessageApplied = true;
     while (!messageData.IsEof())
     {
         const auto networkId = static_cast<NetworkId>(messageData.ReadUInt());
-        const StringHash componentType = messageData.ReadStringHash();
+        const unsigned baselineAge = messageData.ReadVLE();
 
-        messageData.ReadBuffer(componentBuffer_.GetBuffer());
+        NetworkObject* networkObject = nullptr;
+        if (baselineAge == 0)
+        {
+            const StringHash componentType = messageData.ReadStringHash();
+            messageData.ReadBuffer(componentBuffer_.GetBuffer());
 
-        if (NetworkObject* networkObject = GetCheckedNetworkObject(networkId, componentType))
+            networkObject = GetCheckedNetworkObject(networkId, componentType);
+        }
+        else
         {
-            componentBuffer_.Resize(componentBuffer_.GetBuffer().size());
-            componentBuffer_.Seek(0);
-            networkObject->ReadUnreliableDelta(messageFrame, componentBuffer_);
+            messageData.ReadBuffer(deltaBuffer_);
+
+            // Baseline may be missing if the object was recreated or if updates were received out of order
+            networkObject = objectRegistry_->GetNetworkObject(networkId);
+            if (networkObject && !ReadDeltaCompressedUpdate(networkId, messageFrame - baselineAge))
+                networkObject = nullptr;
         }
+
+        if (!networkObject)
+        {
+            isMessageApplied = false;
+            continue;
+        }
+
+        StoreUnreliableUpdate(networkId, messageFrame);
+
+        componentBuffer_.Resize(componentBuffer_.GetBuffer().size());
+        componentBuffer_.Seek(0);
+        networkObject->ReadUnreliableDelta(messageFrame, componentBuffer_);
+    }
+
+    // Server may use updates as baselines only if all of them were received
+    if (isMessageApplied)
+        AcknowledgeUpdateFrame(messageFrame);
+}
+
+bool ClientReplica::ReadDeltaCompressedUpdate(NetworkId networkId, NetworkFrame baselineFrame)
+{
+    const auto iter = unreliableUpdateHistory_.find(networkId);
+    if (iter == unreliableUpdateHistory_.end() || !iter->second.Has(baselineFrame))
+        return false;
+
+    const ByteVector& baseline = iter->second.GetRawUnchecked(baselineFrame);
+    MemoryBuffer src{deltaBuffer_};
+    return ReadDeltaEncodedBuffer(src, baseline, componentBuffer_.GetBuffer());
+}
+
+void ClientReplica::StoreUnreliableUpdate(NetworkId networkId, NetworkFrame frame)
+{
+    if (deltaCompressionHistory_ == 0)
+        return;
+
+    auto iter = unreliableUpdateHistory_.find(networkId);
+    if (iter == unreliableUpdateHistory_.end())
+    {
+        iter = unreliableUpdateHistory_.emplace(networkId, NetworkValue<ByteVector>{}).first;
+        iter->second.Resize(deltaCompressionHistory_);
     }
+
+    iter->second.Set(frame, componentBuffer_.GetBuffer());
+}
+
+void ClientReplica::AcknowledgeUpdateFrame(NetworkFrame frame)
+{
+    if (deltaCompressionHistory_ == 0)
+        return;
+
+    // Bit i of the mask corresponds to frame latestUpdateFrame_ - i - 1
+    if (!latestUpdateFrame_)
+    {
+        latestUpdateFrame_ = frame;
+        previousUpdateFramesMask_ = 0;
+    }
+    else if (frame > *latestUpdateFrame_)
+    {
+        const long long offset = frame - *latestUpdateFrame_;
+        previousUpdateFramesMask_ = offset < 32 ? previousUpdateFramesMask_ << offset : 0;
+        if (offset <= 32)
+            previousUpdateFramesMask_ |= 1u << (offset - 1);
+        latestUpdateFrame_ = frame;
+    }
+    else if (frame < *latestUpdateFrame_)
+    {
+        const long long offset = *latestUpdateFrame_ - frame;
+        if (offset <= 32)
+            previousUpdateFramesMask_ |= 1u << (offset - 1);
+    }
+
+    hasPendingAcknowledgement_ = true;
+}
+
+void ClientReplica::ProcessObjectsRpc(MemoryBuffer& messageData)
+{
+    NetworkRpcBatch::ReadCalls(messageData,
+        [&](NetworkId networkId, StringHash rpcId, MemoryBuffer& arguments)
+    {
+        NetworkObject* networkObject = objectRegistry_->GetNetworkObject(networkId);
+        if (!networkObject)
+        {
+            URHO3D_LOGWARNING("Received RPC for unknown NetworkObject {}", ToString(networkId));
+            return;
+        }
+
+        if (!networkObject->ProcessRpc(connection_, rpcId, arguments))
+            URHO3D_LOGWARNING("Received unknown RPC {} for NetworkObject {}", rpcId.ToDebugString(), ToString(networkId));
+    });
 }
 
 NetworkObject* ClientReplica::CreateNetworkObject(NetworkId networkId, StringHash componentType)
@@ -313,6 +437,7 @@ NetworkObject* ClientReplica::CreateNetworkObject(NetworkId networkId, StringHas
         return nullptr;
     }
     networkObject->SetNetworkId(networkId);
+    unreliableUpdateHistory_.erase(networkId);
 
     if (NetworkObject* oldNetworkObject = objectRegistry_->GetNetworkObject(networkId, false))
     {
@@ -351,6 +476,7 @@ void ClientReplica::RemoveNetworkObject(WeakPtr<NetworkObject> networkObject)
 {
     if (networkObject->GetNetworkMode() == NetworkObjectMode::ClientOwned)
         ownedObjects_.erase(networkObject);
+    unreliableUpdateHistory_.erase(networkObject->GetNetworkId());
 
     Node* parentNode = networkObject->GetNode()->GetParent();
     for (NetworkObject* childNetworkObject : networkObject->GetChildrenNetworkObjects())
@@ -407,6 +533,8 @@ void ClientReplica::OnNetworkUpdate()
         network_->SendEvent(E_ENDCLIENTNETWORKFRAME);
 
         SendObjectsFeedbackUnreliable(GetInputTime().Frame());
+        SendAcknowledgeUpdatesUnreliable();
+        SendObjectsRpc();
     }
 }
 
@@ -443,4 +571,39 @@ void ClientReplica::SendObjectsFeedbackUnreliable(NetworkFrame feedbackFrame)
     });
 }
 
+void ClientReplica::SendAcknowledgeUpdatesUnreliable()
+{
+    if (!hasPendingAcknowledgement_)
+        return;
+
+    hasPendingAcknowledgement_ = false;
+    connection_->SendGeneratedMessage(MSG_ACKNOWLEDGE_UPDATES_UNRELIABLE, PT_UNRELIABLE_UNORDERED,
+        [&](VectorBuffer& msg, ea::string* debugInfo)
+    {
+        msg.WriteInt64(static_cast<long long>(*latestUpdateFrame_));
+        msg.WriteUInt(previousUpdateFramesMask_);
+
+        if (debugInfo)
+            *debugInfo = Format("#{}", static_cast<long long>(*latestUpdateFrame_));
+        return true;
+    });
+}
+
+void ClientReplica::SendObjectsRpc()
+{
+    if (rpcBatch_.IsEmpty())
+        return;
+
+    connection_->SendGeneratedMessage(MSG_OBJECTS_RPC, PT_RELIABLE_ORDERED,
+        [&](VectorBuffer& msg, ea::string* debugInfo)
+    {
+        const unsigned numCalls = rpcBatch_.WriteCalls(msg, [](NetworkId) { return true; });
+
+        if (debugInfo)
+            *debugInfo = Format("{} calls", numCalls);
+        return numCalls > 0;
+    });
+    rpcBatch_.Clear();
+}
+
 }
@@ -28,7 +28,9 @@
 #include "../IO/VectorBuffer.h"
 #include "../Replica/TickSynchronizer.h"
 #include "../Replica/NetworkId.h"
+#include "../Replica/NetworkRpc.h"
 #include "../Replica/NetworkTime.h"
+#include "../Replica/NetworkValue.h"
 #include "../Replica/ProtocolMessages.h"
 
 #include <EASTL/optional.h>
@@ -137,10 +139,20 @@ public:
     bool HasOwnedNetworkObjects() const { return !ownedObjects_.empty(); }
     NetworkObject* GetOwnedNetworkObject() const { return ownedObjects_.size() == 1 ? *ownedObjects_.begin() : nullptr; }
 
+    /// Return number of relevant objects that are not yet streamed by the server.
+    unsigned GetNumPendingObjects() const { return numPendingObjects_; }
+    /// Return whether all objects relevant for the client are received.
+    bool IsStreamingComplete() const { return isStreamingStateReceived_ && numPendingObjects_ == 0; }
+
+    /// Return batch of remote procedure calls sent to the server at the end of the current input frame.
+    NetworkRpcBatch& GetRpcBatch() { return rpcBatch_; }
+
 private:
     void OnInputReady(float timeStep);
     void OnNetworkUpdate();
     void SendObjectsFeedbackUnreliable(NetworkFrame feedbackFrame);
+    void SendAcknowledgeUpdatesUnreliable();
+    void SendObjectsRpc();
 
     NetworkObject* CreateNetworkObject(NetworkId networkId, StringHash componentType);
     NetworkObject* GetCheckedNetworkObject(NetworkId networkId, StringHash componentType);
@@ -151,6 +163,10 @@ private:
     void ProcessAddObjects(MemoryBuffer& messageData);
     void ProcessUpdateObjectsReliable(MemoryBuffer& messageData);
     void ProcessUpdateObjectsUnreliable(MemoryBuffer& messageData);
+    bool ReadDeltaCompressedUpdate(NetworkId networkId, NetworkFrame baselineFrame);
+    void StoreUnreliableUpdate(NetworkId networkId, NetworkFrame frame);
+    void AcknowledgeUpdateFrame(NetworkFrame frame);
+    void ProcessObjectsRpc(MemoryBuffer& messageData);
 
     const WeakPtr<Network> network_;
     const WeakPtr<NetworkObjectRegistry> objectRegistry_;
@@ -159,6 +175,22 @@ private:
     ea::unordered_set<WeakPtr<NetworkObject>> ownedObjects_;
 
     VectorBuffer componentBuffer_;
+
+    bool isStreamingStateReceived_{};
+    unsigned numPendingObjects_{};
+
+    NetworkRpcBatch rpcBatch_;
+
+    /// Delta compression of unreliable updates.
+    /// @{
+    unsigned deltaCompressionHistory_{};
+    ea::unordered_map<NetworkId, NetworkValue<ByteVector>> unreliableUpdateHistory_;
+    ByteVector deltaBuffer_;
+
+    ea::optional<NetworkFrame> latestUpdateFrame_;
+    unsigned previousUpdateFramesMask_{};
+    bool hasPendingAcknowledgement_{};
+    /// @}
 };
 
 }
@@ -0,0 +1,114 @@
+//
+// Copyright (c) 2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+
+#include "../Precompiled.h"
+
+#include "../IO/Deserializer.h"
+#include "../IO/Serializer.h"
+#include "../Replica/DeltaEncoding.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+/// Runs of changed bytes separated by fewer unchanged bytes are merged, run header costs at least 2 bytes.
+const unsigned MinGapBetweenRuns = 3;
+
+/// Call callback(begin, end) for each run of changed bytes.
+template <class T> void ForEachChangedRun(ConstByteSpan baseline, ConstByteSpan value, const T& callback)
+{
+    URHO3D_ASSERT(baseline.size() == value.size());
+
+    const unsigned size = value.size();
+    unsigned index = 0;
+    while (index < size)
+    {
+        if (baseline[index] == value[index])
+        {
+            ++index;
+            continue;
+        }
+
+        const unsigned runBegin = index;
+        unsigned runEnd = index + 1;
+        unsigned numUnchanged = 0;
+        for (index = runEnd; index < size && numUnchanged < MinGapBetweenRuns; ++index)
+        {
+            if (baseline[index] != value[index])
+            {
+                runEnd = index + 1;
+                numUnchanged = 0;
+            }
+            else
+                ++numUnchanged;
+        }
+
+        callback(runBegin, runEnd);
+        index = runEnd;
+    }
+}
+
+}
+
+void WriteDeltaEncodedBuffer(Serializer& dest, ConstByteSpan baseline, ConstByteSpan value)
+{
+    unsigned numRuns = 0;
+    ForEachChangedRun(baseline, value, [&](unsigned, unsigned) { ++numRuns; });
+
+    dest.WriteVLE(numRuns);
+
+    unsigned previousRunEnd = 0;
+    ForEachChangedRun(baseline, value, [&](unsigned runBegin, unsigned runEnd)
+    {
+        dest.WriteVLE(runBegin - previousRunEnd);
+        dest.WriteVLE(runEnd - runBegin);
+        dest.Write(value.data() + runBegin, runEnd - runBegin);
+        previousRunEnd = runEnd;
+    });
+}
+
+bool ReadDeltaEncodedBuffer(Deserializer& src, ConstByteSpan baseline, ByteVector& value)
+{
+    value.assign(baseline.begin(), baseline.end());
+
+    const unsigned numRuns = src.ReadVLE();
+    unsigned offset = 0;
+    for (unsigned i = 0; i < numRuns; ++i)
+    {
+        const unsigned gap = src.ReadVLE();
+        const unsigned runSize = src.ReadVLE();
+        if (gap > value.size() - offset || runSize > value.size() - offset - gap)
+            return false;
+
+        offset += gap;
+        if (src.Read(value.data() + offset, runSize) != runSize)
+            return false;
+        offset += runSize;
+    }
+    return true;
+}
+
+}
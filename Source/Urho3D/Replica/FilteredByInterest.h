@@ -0,0 +1,55 @@
+//
+// Copyright (c) 2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+/// \file
+
+#pragma once
+
+#include "../Replica/BehaviorNetworkObject.h"
+
+namespace Urho3D
+{
+
+/// Behavior that delegates relevance of NetworkObject to the spatial interest grid of the server.
+/// Object is replicated to the client only if it's inside of the area of interest around objects owned by the client.
+/// Update frequency depends on the priority band of the area of interest.
+/// See InterestRadius, InterestHysteresis and InterestPriorityBands network settings.
+class URHO3D_API FilteredByInterest : public NetworkBehavior
+{
+    URHO3D_OBJECT(FilteredByInterest, NetworkBehavior);
+
+public:
+    static constexpr NetworkCallbackFlags CallbackMask = NetworkCallbackMask::IsInterestManaged;
+
+    explicit FilteredByInterest(Context* context);
+    ~FilteredByInterest() override;
+
+    static void RegisterObject(Context* context);
+
+    /// Implement NetworkBehavior.
+    /// @{
+    bool IsInterestManaged() override { return true; }
+    /// @}
+};
+
+};
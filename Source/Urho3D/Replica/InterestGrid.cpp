@@ -0,0 +1,90 @@
+//
+// Copyright (c) 2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Replica/InterestGrid.h"
+
+#include <EASTL/sort.h>
+
+namespace Urho3D
+{
+
+NetworkObjectRelevance InterestArea::GetRelevance(float distance, bool wasRelevant) const
+{
+    const float maxDistance = wasRelevant ? GetMaxDistance() : radius_;
+    if (distance > maxDistance)
+        return NetworkObjectRelevance::Irrelevant;
+
+    static constexpr auto maxPeriod = static_cast<unsigned>(NetworkObjectRelevance::MaxPeriod);
+    const unsigned numBands = ea::max(1u, numBands_);
+    const float bandWidth = radius_ / numBands;
+    const unsigned band = bandWidth > 0.0f ? ea::min(static_cast<unsigned>(distance / bandWidth), numBands - 1) : 0;
+    const unsigned period = ea::min(1u << ea::min(band, 7u), maxPeriod);
+    return static_cast<NetworkObjectRelevance>(period);
+}
+
+void InterestGrid::SetCellSize(float cellSize)
+{
+    cellSize_ = ea::max(cellSize, M_EPSILON);
+}
+
+void InterestGrid::Clear()
+{
+    objects_.clear();
+    cells_.clear();
+}
+
+void InterestGrid::AddObject(unsigned index, const Vector3& position)
+{
+    objects_.push_back(GridObject{GetCell(position), position, index});
+}
+
+void InterestGrid::Commit()
+{
+    const auto compareCells = [](const GridObject& lhs, const GridObject& rhs)
+    {
+        return lhs.cell_.y_ != rhs.cell_.y_ ? lhs.cell_.y_ < rhs.cell_.y_ : lhs.cell_.x_ < rhs.cell_.x_;
+    };
+    ea::sort(objects_.begin(), objects_.end(), compareCells);
+
+    const unsigned numObjects = objects_.size();
+    unsigned beginIndex = 0;
+    while (beginIndex < numObjects)
+    {
+        const IntVector2 cell = objects_[beginIndex].cell_;
+        unsigned endIndex = beginIndex + 1;
+        while (endIndex < numObjects && objects_[endIndex].cell_ == cell)
+            ++endIndex;
+
+        cells_[cell] = CellRange{beginIndex, endIndex};
+        beginIndex = endIndex;
+    }
+}
+
+IntVector2 InterestGrid::GetCell(const Vector3& position) const
+{
+    return {FloorToInt(position.x_ / cellSize_), FloorToInt(position.z_ / cellSize_)};
+}
+
+}
@@ -0,0 +1,142 @@
+//
+// Copyright (c) 2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+/// \file
+
+#pragma once
+
+#include "../Math/Vector2.h"
+#include "../Math/Vector3.h"
+#include "../Replica/NetworkId.h"
+
+#include <EASTL/unordered_map.h>
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+/// Area of interest of the client connection.
+/// Objects closer than radius become relevant, relevant objects stay relevant until they are farther than radius plus hysteresis.
+/// Area is split into concentric priority bands of equal width, update period doubles for each next band.
+struct URHO3D_API InterestArea
+{
+    float radius_{};
+    float hysteresis_{};
+    unsigned numBands_{1};
+
+    /// Return relevance of the object at given distance from the area center.
+    NetworkObjectRelevance GetRelevance(float distance, bool wasRelevant) const;
+    /// Return max distance at which object may be relevant.
+    float GetMaxDistance() const { return radius_ + hysteresis_; }
+};
+
+/// Uniform grid of NetworkObject indices used by the server for area-of-interest queries.
+/// Objects are bucketed by XZ coordinates, distances are checked in 3D.
+/// Grid is rebuilt every network frame and is read-only afterwards, so it can be queried from multiple threads.
+class URHO3D_API InterestGrid
+{
+public:
+    /// Set size of grid cell. Should be comparable with typical area of interest radius.
+    void SetCellSize(float cellSize);
+
+    /// Remove all objects and start rebuilding the grid.
+    void Clear();
+    /// Add object with given network index and world position.
+    void AddObject(unsigned index, const Vector3& position);
+    /// Finish rebuilding the grid. Should be called before queries.
+    void Commit();
+
+    /// Call callback(index, distance) for each object within radius from the center.
+    template <class T> void QueryObjects(const Vector3& center, float radius, const T& callback) const;
+
+    /// Return properties of the grid.
+    /// @{
+    float GetCellSize() const { return cellSize_; }
+    unsigned GetNumObjects() const { return objects_.size(); }
+    unsigned GetNumCells() const { return cells_.size(); }
+    /// @}
+
+private:
+    struct GridObject
+    {
+        IntVector2 cell_;
+        Vector3 position_;
+        unsigned index_{};
+    };
+
+    /// Range of objects in the cell.
+    struct CellRange
+    {
+        unsigned beginIndex_{};
+        unsigned endIndex_{};
+    };
+
+    IntVector2 GetCell(const Vector3& position) const;
+    template <class T> void QueryCell(const CellRange& range, const Vector3& center, float radius, const T& callback) const;
+
+    float cellSize_{32.0f};
+    ea::vector<GridObject> objects_;
+    ea::unordered_map<IntVector2, CellRange> cells_;
+};
+
+template <class T> void InterestGrid::QueryObjects(const Vector3& center, float radius, const T& callback) const
+{
+    const IntVector2 minCell = GetCell(center - Vector3::ONE * radius);
+    const IntVector2 maxCell = GetCell(center + Vector3::ONE * radius);
+    const auto numQueryCells = static_cast<long long>(maxCell.x_ - minCell.x_ + 1) * (maxCell.y_ - minCell.y_ + 1);
+
+    // Iterate over non-empty cells if query area is larger than the populated part of the grid
+    if (numQueryCells > static_cast<long long>(cells_.size()))
+    {
+        for (const auto& [cell, range] : cells_)
+        {
+            if (cell.x_ >= minCell.x_ && cell.x_ <= maxCell.x_ && cell.y_ >= minCell.y_ && cell.y_ <= maxCell.y_)
+                QueryCell(range, center, radius, callback);
+        }
+        return;
+    }
+
+    for (int y = minCell.y_; y <= maxCell.y_; ++y)
+    {
+        for (int x = minCell.x_; x <= maxCell.x_; ++x)
+        {
+            const auto iter = cells_.find(IntVector2{x, y});
+            if (iter != cells_.end())
+                QueryCell(iter->second, center, radius, callback);
+        }
+    }
+}
+
+template <class T> void InterestGrid::QueryCell(const CellRange& range, const Vector3& center, float radius, const T& callback) const
+{
+    const float radiusSquared = radius * radius;
+    for (unsigned i = range.beginIndex_; i < range.endIndex_; ++i)
+    {
+        const GridObject& object = objects_[i];
+        const float distanceSquared = (object.position_ - center).LengthSquared();
+        if (distanceSquared <= radiusSquared)
+            callback(object.index_, Sqrt(distanceSquared));
+    }
+}
+
+}
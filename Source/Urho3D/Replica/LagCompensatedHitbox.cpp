@@ -0,0 +1,74 @@
+//
+// Copyright (c) 2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Network/NetworkEvents.h"
+#include "../Replica/LagCompensatedHitbox.h"
+#include "../Replica/ReplicationManager.h"
+#include "../Replica/ServerReplicator.h"
+
+namespace Urho3D
+{
+
+LagCompensatedHitbox::LagCompensatedHitbox(Context* context)
+    : NetworkBehavior(context, NetworkCallbackMask::None)
+{
+}
+
+LagCompensatedHitbox::~LagCompensatedHitbox()
+{
+}
+
+void LagCompensatedHitbox::RegisterObject(Context* context)
+{
+    context->RegisterFactory<LagCompensatedHitbox>();
+
+    URHO3D_COPY_BASE_ATTRIBUTES(NetworkBehavior);
+
+    URHO3D_ATTRIBUTE("Size", Vector3, size_, Vector3::ONE, AM_DEFAULT);
+    URHO3D_ATTRIBUTE("Offset", Vector3, offset_, Vector3::ZERO, AM_DEFAULT);
+}
+
+LagCompensatedHitboxState LagCompensatedHitbox::GetWorldHitbox() const
+{
+    LagCompensatedHitboxState result;
+    result.objectId_ = GetNetworkObject()->GetNetworkId();
+    result.position_ = node_->LocalToWorld(offset_);
+    result.rotation_ = node_->GetWorldRotation();
+    result.halfSize_ = (size_ * node_->GetWorldScale()).Abs() * 0.5f;
+    return result;
+}
+
+void LagCompensatedHitbox::InitializeOnServer()
+{
+    SubscribeToEvent(E_ENDSERVERNETWORKFRAME, [this](StringHash, VariantMap&) { OnServerFrameEnd(); });
+}
+
+void LagCompensatedHitbox::OnServerFrameEnd()
+{
+    ServerReplicator* serverReplicator = GetNetworkObject()->GetReplicationManager()->GetServerReplicator();
+    if (serverReplicator)
+        serverReplicator->GetLagCompensationHistory().AddHitbox(GetWorldHitbox());
+}
+
+}
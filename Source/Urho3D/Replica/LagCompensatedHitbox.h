@@ -0,0 +1,71 @@
+//
+// Copyright (c) 2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+/// \file
+
+#pragma once
+
+#include "../Replica/BehaviorNetworkObject.h"
+#include "../Replica/LagCompensationHistory.h"
+
+namespace Urho3D
+{
+
+/// Behavior that records oriented box hitbox of the node into lag compensation history of the server.
+/// Use LagCompensationHistory of ServerReplicator to perform hit queries against past state of the hitboxes.
+/// Not implemented on client.
+class URHO3D_API LagCompensatedHitbox : public NetworkBehavior
+{
+    URHO3D_OBJECT(LagCompensatedHitbox, NetworkBehavior);
+
+public:
+    explicit LagCompensatedHitbox(Context* context);
+    ~LagCompensatedHitbox() override;
+
+    static void RegisterObject(Context* context);
+
+    /// Manage attributes.
+    /// @{
+    void SetSize(const Vector3& value) { size_ = value; }
+    const Vector3& GetSize() const { return size_; }
+    void SetOffset(const Vector3& value) { offset_ = value; }
+    const Vector3& GetOffset() const { return offset_; }
+    /// @}
+
+    /// Return current hitbox in world space.
+    LagCompensatedHitboxState GetWorldHitbox() const;
+
+    /// Implement NetworkBehavior.
+    /// @{
+    void InitializeOnServer() override;
+    /// @}
+
+private:
+    void OnServerFrameEnd();
+
+    /// Attributes independent on the client and the server.
+    /// @{
+    Vector3 size_{Vector3::ONE};
+    Vector3 offset_{};
+    /// @}
+};
+
+};
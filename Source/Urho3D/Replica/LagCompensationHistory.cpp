@@ -0,0 +1,215 @@
+//
+// Copyright (c) 2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+#include "../Precompiled.h"
+
+#include "../Math/Sphere.h"
+#include "../Replica/LagCompensationHistory.h"
+
+#include <EASTL/sort.h>
+
+namespace Urho3D
+{
+
+LagCompensatedHitboxState LagCompensatedHitboxState::Lerp(
+    const LagCompensatedHitboxState& lhs, const LagCompensatedHitboxState& rhs, float factor)
+{
+    LagCompensatedHitboxState result;
+    result.objectId_ = lhs.objectId_;
+    result.position_ = lhs.position_.Lerp(rhs.position_, factor);
+    result.rotation_ = lhs.rotation_.Slerp(rhs.rotation_, factor);
+    result.halfSize_ = lhs.halfSize_.Lerp(rhs.halfSize_, factor);
+    return result;
+}
+
+float LagCompensatedHitboxState::HitDistance(const Ray& ray, float radius) const
+{
+    const Quaternion inverseRotation = rotation_.Inverse();
+    const Ray localRay{inverseRotation * (ray.origin_ - position_), inverseRotation * ray.direction_};
+    const Vector3 localHalfSize = halfSize_ + Vector3::ONE * radius;
+    return localRay.HitDistance(BoundingBox{-localHalfSize, localHalfSize});
+}
+
+void LagCompensationHistory::SetCapacity(unsigned numFrames)
+{
+    Clear();
+    frames_.resize(ea::max(1u, numFrames));
+}
+
+void LagCompensationHistory::BeginFrame(NetworkFrame frame)
+{
+    URHO3D_ASSERT(!recordedFrame_);
+
+    if (frames_.empty())
+        SetCapacity(1);
+
+    // Frames are expected to increase monotonically, history is reset if server time goes back
+    if (latestFrame_ && frame <= *latestFrame_)
+        Clear();
+
+    recordedFrame_ = &frames_[GetFrameIndex(frame)];
+    recordedFrame_->frame_ = frame;
+    recordedFrame_->hitboxes_.clear();
+    latestFrame_ = frame;
+}
+
+void LagCompensationHistory::AddHitbox(const LagCompensatedHitboxState& hitbox)
+{
+    if (recordedFrame_)
+        recordedFrame_->hitboxes_.push_back(hitbox);
+}
+
+void LagCompensationHistory::EndFrame()
+{
+    if (!recordedFrame_)
+        return;
+
+    auto& hitboxes = recordedFrame_->hitboxes_;
+    ea::sort(hitboxes.begin(), hitboxes.end(),
+        [](const LagCompensatedHitboxState& lhs, const LagCompensatedHitboxState& rhs) { return lhs.objectId_ < rhs.objectId_; });
+    recordedFrame_ = nullptr;
+}
+
+void LagCompensationHistory::Clear()
+{
+    for (FrameHitboxes& frameHitboxes : frames_)
+    {
+        frameHitboxes.frame_ = ea::nullopt;
+        frameHitboxes.hitboxes_.clear();
+    }
+    latestFrame_ = ea::nullopt;
+    recordedFrame_ = nullptr;
+}
+
+void LagCompensationHistory::SampleHitboxes(const NetworkTime& time, ea::vector<LagCompensatedHitboxState>& hitboxes) const
+{
+    hitboxes.clear();
+
+    const auto oldestFrame = GetOldestFrame();
+    if (!oldestFrame)
+        return;
+
+    const FrameHitboxes* first = nullptr;
+    const FrameHitboxes* second = nullptr;
+    float blendFactor = 0.0f;
+    if (time.Frame() >= *latestFrame_)
+        first = FindFrame(*latestFrame_);
+    else if (time.Frame() < *oldestFrame)
+        first = FindFrame(*oldestFrame);
+    else
+    {
+        first = FindFrame(time.Frame());
+        second = FindFrame(time.Frame() + 1);
+        blendFactor = time.Fraction();
+
+        // Use the next recorded frame as is if there's a gap in the history
+        for (NetworkFrame frame = time.Frame() + 1; !first && frame <= *latestFrame_; ++frame)
+            first = FindFrame(frame);
+    }
+
+    if (!first)
+        return;
+
+    if (!second || blendFactor <= 0.0f)
+    {
+        hitboxes = first->hitboxes_;
+        return;
+    }
+
+    // Objects are sorted by ID, so it's enough to walk both frames once
+    const auto& secondHitboxes = second->hitboxes_;
+    auto secondIter = secondHitboxes.begin();
+    for (const LagCompensatedHitboxState& hitbox : first->hitboxes_)
+    {
+        while (secondIter != secondHitboxes.end() && secondIter->objectId_ < hitbox.objectId_)
+            ++secondIter;
+
+        if (secondIter != secondHitboxes.end() && secondIter->objectId_ == hitbox.objectId_)
+            hitboxes.push_back(LagCompensatedHitboxState::Lerp(hitbox, *secondIter, blendFactor));
+        else
+            hitboxes.push_back(hitbox);
+    }
+}
+
+void LagCompensationHistory::ProcessQueries(const NetworkTime& time, ea::span<const LagCompensatedQuery> queries,
+    ea::vector<LagCompensatedHit>& results) const
+{
+    static thread_local ea::vector<LagCompensatedHitboxState> hitboxesStorage;
+    auto& hitboxes = hitboxesStorage;
+    SampleHitboxes(time, hitboxes);
+
+    const unsigned numQueries = queries.size();
+    for (unsigned queryIndex = 0; queryIndex < numQueries; ++queryIndex)
+    {
+        const LagCompensatedQuery& query = queries[queryIndex];
+        const unsigned firstResult = results.size();
+
+        for (const LagCompensatedHitboxState& hitbox : hitboxes)
+        {
+            if (hitbox.objectId_ == query.ignoredObjectId_)
+                continue;
+
+            // Cheap rejection by bounding sphere
+            const Sphere boundingSphere{hitbox.position_, hitbox.halfSize_.Length() + query.radius_};
+            if (query.ray_.HitDistance(boundingSphere) > query.maxDistance_)
+                continue;
+
+            const float distance = hitbox.HitDistance(query.ray_, query.radius_);
+            if (distance <= query.maxDistance_)
+                results.push_back(LagCompensatedHit{queryIndex, hitbox.objectId_, distance, query.ray_.origin_ + query.ray_.direction_ * distance});
+        }
+
+        ea::sort(results.begin() + firstResult, results.end(),
+            [](const LagCompensatedHit& lhs, const LagCompensatedHit& rhs) { return lhs.distance_ < rhs.distance_; });
+    }
+}
+
+ea::optional<NetworkFrame> LagCompensationHistory::GetOldestFrame() const
+{
+    if (!latestFrame_)
+        return ea::nullopt;
+
+    const long long capacity = frames_.size();
+    for (NetworkFrame frame = *latestFrame_ - (capacity - 1); frame != *latestFrame_; ++frame)
+    {
+        if (FindFrame(frame))
+            return frame;
+    }
+    return latestFrame_;
+}
+
+unsigned LagCompensationHistory::GetFrameIndex(NetworkFrame frame) const
+{
+    const long long capacity = frames_.size();
+    const long long index = static_cast<long long>(frame) % capacity;
+    return static_cast<unsigned>(index >= 0 ? index : index + capacity);
+}
+
+const LagCompensationHistory::FrameHitboxes* LagCompensationHistory::FindFrame(NetworkFrame frame) const
+{
+    if (frames_.empty())
+        return nullptr;
+
+    const FrameHitboxes& frameHitboxes = frames_[GetFrameIndex(frame)];
+    return frameHitboxes.frame_ == frame ? &frameHitboxes : nullptr;
+}
+
+}
@@ -0,0 +1,123 @@
+//
+// Copyright (c) 2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+/// \file
+
+#pragma once
+
+#include "../Math/Quaternion.h"
+#include "../Math/Ray.h"
+#include "../Math/Vector3.h"
+#include "../Replica/NetworkId.h"
+#include "../Replica/NetworkTime.h"
+
+#include <EASTL/optional.h>
+#include <EASTL/span.h>
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+/// Oriented box hitbox of the NetworkObject in world space.
+struct URHO3D_API LagCompensatedHitboxState
+{
+    NetworkId objectId_{InvalidNetworkId};
+    Vector3 position_;
+    Quaternion rotation_;
+    Vector3 halfSize_;
+
+    /// Interpolate between two states of the same object.
+    static LagCompensatedHitboxState Lerp(const LagCompensatedHitboxState& lhs, const LagCompensatedHitboxState& rhs, float factor);
+    /// Return distance to the first hit of the ray swept with given radius, or infinity if there's no hit.
+    /// Sweep is approximated by inflating the box by the radius.
+    float HitDistance(const Ray& ray, float radius) const;
+};
+
+/// Ray or sphere sweep query against the past state of the hitboxes.
+struct LagCompensatedQuery
+{
+    Ray ray_;
+    float maxDistance_{M_INFINITY};
+    /// Radius of the swept sphere. Zero for ray query.
+    float radius_{};
+    /// Object ignored by the query, usually the object of the caster.
+    NetworkId ignoredObjectId_{InvalidNetworkId};
+};
+
+/// Result of LagCompensatedQuery.
+struct LagCompensatedHit
+{
+    unsigned queryIndex_{};
+    NetworkId objectId_{InvalidNetworkId};
+    float distance_{};
+    Vector3 position_;
+};
+
+/// Server-side history of hitboxes of NetworkObjects used for lag compensation.
+/// Hitboxes are recorded once per network frame into a ring buffer.
+/// Queries are processed against hitboxes interpolated to the specified time, e.g. replica time of the client,
+/// so the server can perform authoritative hit detection without rewinding the scene.
+class URHO3D_API LagCompensationHistory
+{
+public:
+    /// Set number of recent frames kept in the history. Clears the history.
+    void SetCapacity(unsigned numFrames);
+
+    /// Start recording of the frame. Overwrites the oldest frame if history is full.
+    void BeginFrame(NetworkFrame frame);
+    /// Add hitbox to the frame being recorded.
+    void AddHitbox(const LagCompensatedHitboxState& hitbox);
+    /// Finish recording of the frame.
+    void EndFrame();
+    /// Remove all recorded frames.
+    void Clear();
+
+    /// Return hitboxes interpolated to the specified time. Time is clamped to the recorded history.
+    void SampleHitboxes(const NetworkTime& time, ea::vector<LagCompensatedHitboxState>& hitboxes) const;
+    /// Process batch of queries at the specified time.
+    /// All hits are appended to the result, ordered by query index and then by distance.
+    void ProcessQueries(const NetworkTime& time, ea::span<const LagCompensatedQuery> queries,
+        ea::vector<LagCompensatedHit>& results) const;
+
+    /// Return properties of the history.
+    /// @{
+    unsigned GetCapacity() const { return frames_.size(); }
+    ea::optional<NetworkFrame> GetOldestFrame() const;
+    ea::optional<NetworkFrame> GetLatestFrame() const { return latestFrame_; }
+    /// @}
+
+private:
+    /// Hitboxes of the frame sorted by object ID.
+    struct FrameHitboxes
+    {
+        ea::optional<NetworkFrame> frame_;
+        ea::vector<LagCompensatedHitboxState> hitboxes_;
+    };
+
+    unsigned GetFrameIndex(NetworkFrame frame) const;
+    const FrameHitboxes* FindFrame(NetworkFrame frame) const;
+
+    ea::vector<FrameHitboxes> frames_;
+    ea::optional<NetworkFrame> latestFrame_;
+    FrameHitboxes* recordedFrame_{};
+};
+
+}
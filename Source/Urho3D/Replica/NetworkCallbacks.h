@@ -64,6 +64,11 @@ enum class NetworkCallbackMask
 
     Update                  = 1 << 7,
     /// @}
+
+    /// Server callbacks, appended to keep values of existing flags
+    /// @{
+    IsInterestManaged       = 1 << 8,
+    /// @}
 };
 URHO3D_FLAGSET(NetworkCallbackMask, NetworkCallbackFlags);
 
@@ -77,7 +82,11 @@ public:
 
     /// Return whether the component should be replicated for specified client connection, and how frequently.
     /// The first reported valid relevance is used.
+    /// May be called from worker threads for different connections at the same time, should not modify the scene.
     virtual ea::optional<NetworkObjectRelevance> GetRelevanceForClient(AbstractConnection* connection) { return ea::nullopt; }
+    /// Return whether the relevance of the object is evaluated by the spatial interest grid of the server.
+    /// GetRelevanceForClient is not called for such objects. Checked once when the object is initialized.
+    virtual bool IsInterestManaged() { return false; }
     /// Called when world transform or parent of the object is updated in Server mode.
     virtual void UpdateTransformOnServer() {}
 
@@ -90,6 +99,9 @@ public:
     virtual void WriteReliableDelta(NetworkFrame frame, Serializer& dest) {}
     /// Prepare for unreliable delta update and return update mask. If mask is zero, unreliable delta update is skipped.
     virtual bool PrepareUnreliableDelta(NetworkFrame frame) { return false; }
+    /// Prepare for unreliable delta update of the complete current state even if nothing has changed recently.
+    /// Used to deliver the final state of the object to clients that didn't receive earlier updates.
+    virtual bool PrepareForcedUnreliableDelta(NetworkFrame frame) { return PrepareUnreliableDelta(frame); }
     /// Write unreliable delta update.
     virtual void WriteUnreliableDelta(NetworkFrame frame, Serializer& dest) {}
 
@@ -24,7 +24,9 @@
 
 #include "../Core/Context.h"
 #include "../IO/Log.h"
+#include "../Replica/ClientReplica.h"
 #include "../Replica/NetworkObject.h"
+#include "../Replica/ServerReplicator.h"
 #include "../Scene/Scene.h"
 
 namespace Urho3D
@@ -50,6 +52,69 @@ void NetworkObject::RegisterObject(Context* context)
     context->RegisterFactory<NetworkObject>();
 }
 
+void NetworkObject::UnsubscribeFromRpc(StringHash rpcId)
+{
+    ea::erase_if(rpcHandlers_, [&](const auto& rpcHandler) { return rpcHandler.first == rpcId; });
+}
+
+bool NetworkObject::ProcessRpc(AbstractConnection* sender, StringHash rpcId, Deserializer& src)
+{
+    for (const auto& [handlerRpcId, handler] : rpcHandlers_)
+    {
+        if (handlerRpcId == rpcId)
+        {
+            // Handler may unsubscribe from RPC or remove this object, keep it alive until the call is finished
+            const RpcHandler handlerCopy = handler;
+            handlerCopy(sender, src);
+            return true;
+        }
+    }
+    return false;
+}
+
+void NetworkObject::AddRpcHandler(StringHash rpcId, RpcHandler handler)
+{
+    UnsubscribeFromRpc(rpcId);
+    rpcHandlers_.emplace_back(rpcId, ea::move(handler));
+}
+
+NetworkRpcBatch* NetworkObject::GetRpcBatchToServer() const
+{
+    ReplicationManager* replicationManager = GetReplicationManager();
+    ClientReplica* clientReplica = replicationManager ? replicationManager->GetClientReplica() : nullptr;
+    if (!clientReplica || !(IsOwnedByThisClient() || IsReplicatedClient()))
+    {
+        URHO3D_LOGWARNING("Cannot send RPC from NetworkObject {} that is not replicated from server", ToString(GetNetworkId()));
+        return nullptr;
+    }
+    return &clientReplica->GetRpcBatch();
+}
+
+NetworkRpcBatch* NetworkObject::GetRpcBatchToClient(AbstractConnection* connection) const
+{
+    ReplicationManager* replicationManager = GetReplicationManager();
+    ServerReplicator* serverReplicator = replicationManager ? replicationManager->GetServerReplicator() : nullptr;
+    NetworkRpcBatch* batch = serverReplicator && IsServer() ? serverReplicator->GetRpcBatch(connection) : nullptr;
+    if (!batch)
+    {
+        URHO3D_LOGWARNING("Cannot send RPC from NetworkObject {} to unknown client or from non-server object",
+            ToString(GetNetworkId()));
+    }
+    return batch;
+}
+
+NetworkRpcBatch* NetworkObject::GetRpcBatchToClients() const
+{
+    ReplicationManager* replicationManager = GetReplicationManager();
+    ServerReplicator* serverReplicator = replicationManager ? replicationManager->GetServerReplicator() : nullptr;
+    if (!serverReplicator || !IsServer())
+    {
+        URHO3D_LOGWARNING("Cannot send RPC from non-server NetworkObject {}", ToString(GetNetworkId()));
+        return nullptr;
+    }
+    return &serverReplicator->GetBroadcastRpcBatch();
+}
+
 void NetworkObject::UpdateObjectHierarchy()
 {
     NetworkObject* newParentNetworkObject = node_->GetParentDerivedComponent<NetworkObject>(true);
@@ -29,9 +29,11 @@
 #include "../Scene/Component.h"
 #include "../Network/AbstractConnection.h"
 #include "../Replica/NetworkCallbacks.h"
+#include "../Replica/NetworkRpc.h"
 #include "../Replica/ReplicationManager.h"
 
 #include <EASTL/fixed_vector.h>
+#include <EASTL/functional.h>
 #include <EASTL/optional.h>
 
 namespace Urho3D
@@ -101,6 +103,27 @@ public:
     bool IsOwnedByThisClient() const { return networkMode_ == NetworkObjectMode::ClientOwned; }
     bool IsReplicatedClient() const { return networkMode_ == NetworkObjectMode::ClientReplicated; }
 
+    /// Typed remote procedure calls.
+    /// Calls are batched and sent once per network frame in one reliable ordered message per connection.
+    /// Calls from server to client are dropped if the object is not replicated to the client.
+    /// Order of calls sent to one client and to all clients is not preserved relative to each other.
+    /// @{
+    /// Subscribe to RPC. Handler is called as `handler(sender, args...)`.
+    /// Any client this object is replicated to can call its RPCs on the server.
+    /// Server-side handlers must check `sender` (e.g. compare it with GetOwnerConnection()) before trusting the call.
+    template <class... Args, class T> void SubscribeToRpc(const NetworkRpc<Args...>& rpc, T handler);
+    void UnsubscribeFromRpc(StringHash rpcId);
+    /// Client-only: send RPC to the server.
+    template <class... Args> void SendRpcToServer(const NetworkRpc<Args...>& rpc, const ea::type_identity_t<Args>&... args);
+    /// Server-only: send RPC to the client.
+    template <class... Args>
+    void SendRpcToClient(AbstractConnection* connection, const NetworkRpc<Args...>& rpc, const ea::type_identity_t<Args>&... args);
+    /// Server-only: send RPC to all clients this object is replicated to.
+    template <class... Args> void SendRpcToClients(const NetworkRpc<Args...>& rpc, const ea::type_identity_t<Args>&... args);
+    /// Internal API: invoke RPC handler. Return false if there's no handler.
+    bool ProcessRpc(AbstractConnection* sender, StringHash rpcId, Deserializer& src);
+    /// @}
+
     /// Implement ClientNetworkCallback.
     /// @{
     void PrepareToRemove() override;
@@ -117,10 +140,17 @@ protected:
     void SetParentNetworkObject(NetworkId parentNetworkId);
 
 private:
+    using RpcHandler = ea::function<void(AbstractConnection* sender, Deserializer& src)>;
+
     NetworkObject* FindParentNetworkObject() const;
     void AddChildNetworkObject(NetworkObject* networkObject);
     void RemoveChildNetworkObject(NetworkObject* networkObject);
 
+    void AddRpcHandler(StringHash rpcId, RpcHandler handler);
+    NetworkRpcBatch* GetRpcBatchToServer() const;
+    NetworkRpcBatch* GetRpcBatchToClient(AbstractConnection* connection) const;
+    NetworkRpcBatch* GetRpcBatchToClients() const;
+
     /// ReplicationManager corresponding to the NetworkObject.
     NetworkObjectMode networkMode_{};
     WeakPtr<AbstractConnection> ownerConnection_{};
@@ -130,6 +160,37 @@ private:
     WeakPtr<NetworkObject> parentNetworkObject_;
     ea::vector<WeakPtr<NetworkObject>> childrenNetworkObjects_;
     /// @}
+
+    ea::vector<ea::pair<StringHash, RpcHandler>> rpcHandlers_;
 };
 
+template <class... Args, class T> void NetworkObject::SubscribeToRpc(const NetworkRpc<Args...>& rpc, T handler)
+{
+    AddRpcHandler(rpc.GetId(), [handler = ea::move(handler)](AbstractConnection* sender, Deserializer& src)
+    {
+        NetworkRpc<Args...>::InvokeHandler(handler, sender, src);
+    });
+}
+
+template <class... Args>
+void NetworkObject::SendRpcToServer(const NetworkRpc<Args...>& rpc, const ea::type_identity_t<Args>&... args)
+{
+    if (NetworkRpcBatch* batch = GetRpcBatchToServer())
+        batch->AddCall(GetNetworkId(), rpc, args...);
+}
+
+template <class... Args>
+void NetworkObject::SendRpcToClient(AbstractConnection* connection, const NetworkRpc<Args...>& rpc, const ea::type_identity_t<Args>&... args)
+{
+    if (NetworkRpcBatch* batch = GetRpcBatchToClient(connection))
+        batch->AddCall(GetNetworkId(), rpc, args...);
+}
+
+template <class... Args>
+void NetworkObject::SendRpcToClients(const NetworkRpc<Args...>& rpc, const ea::type_identity_t<Args>&... args)
+{
+    if (NetworkRpcBatch* batch = GetRpcBatchToClients())
+        batch->AddCall(GetNetworkId(), rpc, args...);
+}
+
 }
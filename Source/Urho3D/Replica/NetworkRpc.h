@@ -0,0 +1,209 @@
+//
+// Copyright (c) 2022 the rbfx project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+/// \file
+
+#pragma once
+
+#include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
+#include "../IO/VectorBuffer.h"
+#include "../Math/StringHash.h"
+#include "../Replica/NetworkId.h"
+
+#include <EASTL/tuple.h>
+#include <EASTL/type_traits.h>
+
+namespace Urho3D
+{
+
+class AbstractConnection;
+
+/// Utility to serialize arguments of remote procedure calls without Variant.
+/// Specialize for custom types.
+/// @{
+template <class T, class Enabled = void>
+struct NetworkRpcArgument;
+
+template <class T>
+struct NetworkRpcArgument<T, ea::enable_if_t<ea::is_arithmetic_v<T> || ea::is_enum_v<T>>>
+{
+    static void Write(Serializer& dest, const T& value) { dest.Write(&value, sizeof(T)); }
+    static T Read(Deserializer& src)
+    {
+        T value{};
+        src.Read(&value, sizeof(T));
+        return value;
+    }
+};
+
+#define URHO3D_NETWORK_RPC_ARGUMENT(type, name) \
+    template <> struct NetworkRpcArgument<type> \
+    { \
+        static void Write(Serializer& dest, const type& value) { dest.Write##name(value); } \
+        static type Read(Deserializer& src) { return src.Read##name(); } \
+    }
+
+URHO3D_NETWORK_RPC_ARGUMENT(Vector2, Vector2);
+URHO3D_NETWORK_RPC_ARGUMENT(Vector3, Vector3);
+URHO3D_NETWORK_RPC_ARGUMENT(Vector4, Vector4);
+URHO3D_NETWORK_RPC_ARGUMENT(Quaternion, Quaternion);
+URHO3D_NETWORK_RPC_ARGUMENT(Color, Color);
+URHO3D_NETWORK_RPC_ARGUMENT(IntVector2, IntVector2);
+URHO3D_NETWORK_RPC_ARGUMENT(IntVector3, IntVector3);
+URHO3D_NETWORK_RPC_ARGUMENT(StringHash, StringHash);
+URHO3D_NETWORK_RPC_ARGUMENT(ea::string, String);
+
+#undef URHO3D_NETWORK_RPC_ARGUMENT
+/// @}
+
+/// Typed remote procedure call of NetworkObject.
+/// Signature is defined at compile time and arguments are serialized directly, without Variant.
+/// Declare RPC once and use it both for sending and subscribing, e.g.:
+/// `static const NetworkRpc<Vector3, float> RpcFire{"Fire"};`
+template <class... Args>
+class NetworkRpc
+{
+public:
+    explicit NetworkRpc(const char* name) : name_(name), id_(name) {}
+
+    /// Write arguments of the call.
+    static void WriteArguments(Serializer& dest, const Args&... args)
+    {
+        (NetworkRpcArgument<Args>::Write(dest, args), ...);
+    }
+
+    /// Read arguments of the call and invoke the handler.
+    template <class T> static void InvokeHandler(const T& handler, AbstractConnection* sender, Deserializer& src)
+    {
+        // Braced initialization guarantees that arguments are read in order
+        const ea::tuple<Args...> args{NetworkRpcArgument<Args>::Read(src)...};
+        ea::apply([&](const Args&... unpackedArgs) { handler(sender, unpackedArgs...); }, args);
+    }
+
+    const char* GetName() const { return name_; }
+    StringHash GetId() const { return id_; }
+
+private:
+    const char* name_{};
+    StringHash id_;
+};
+
+/// Remote procedure calls accumulated during the network frame and sent in one message.
+/// Each call is stored as NetworkId, RPC ID, size of arguments and arguments.
+class URHO3D_API NetworkRpcBatch
+{
+public:
+    static constexpr unsigned MaxArgumentsSize = 0xffff;
+
+    /// Add call to the batch.
+    template <class... Args>
+    void AddCall(NetworkId objectId, const NetworkRpc<Args...>& rpc, const ea::type_identity_t<Args>&... args);
+    /// Remove all calls.
+    void Clear();
+
+    /// Write calls for which filter(objectId) returns true. Return number of written calls.
+    template <class T> unsigned WriteCalls(Serializer& dest, const T& filter) const;
+    /// Read calls from the message and call callback(objectId, rpcId, arguments) for each of them.
+    template <class T> static void ReadCalls(MemoryBuffer& src, const T& callback);
+
+    bool IsEmpty() const { return numCalls_ == 0; }
+    unsigned GetNumCalls() const { return numCalls_; }
+    unsigned GetSize() const { return buffer_.GetSize(); }
+
+private:
+    VectorBuffer buffer_;
+    unsigned numCalls_{};
+};
+
+template <class... Args>
+void NetworkRpcBatch::AddCall(NetworkId objectId, const NetworkRpc<Args...>& rpc, const ea::type_identity_t<Args>&... args)
+{
+    const unsigned callOffset = buffer_.GetSize();
+    buffer_.Seek(callOffset);
+    buffer_.WriteUInt(static_cast<unsigned>(objectId));
+    buffer_.WriteStringHash(rpc.GetId());
+    buffer_.WriteUShort(0);
+
+    const unsigned argumentsOffset = buffer_.GetSize();
+    NetworkRpc<Args...>::WriteArguments(buffer_, args...);
+    const unsigned argumentsSize = buffer_.GetSize() - argumentsOffset;
+
+    if (argumentsSize > MaxArgumentsSize)
+    {
+        URHO3D_LOGERROR("Arguments of RPC '{}' are too large: {} bytes", rpc.GetName(), argumentsSize);
+        buffer_.Resize(callOffset);
+        return;
+    }
+
+    buffer_.Seek(argumentsOffset - sizeof(unsigned short));
+    buffer_.WriteUShort(static_cast<unsigned short>(argumentsSize));
+    buffer_.Seek(buffer_.GetSize());
+    ++numCalls_;
+}
+
+template <class T>
+unsigned NetworkRpcBatch::WriteCalls(Serializer& dest, const T& filter) const
+{
+    const unsigned char* data = buffer_.GetData();
+    MemoryBuffer src(data, buffer_.GetSize());
+
+    unsigned numWrittenCalls = 0;
+    while (!src.IsEof())
+    {
+        const unsigned callOffset = src.Tell();
+        const auto objectId = static_cast<NetworkId>(src.ReadUInt());
+        src.ReadStringHash();
+        const unsigned argumentsSize = src.ReadUShort();
+        src.Seek(src.Tell() + argumentsSize);
+
+        if (filter(objectId))
+        {
+            dest.Write(data + callOffset, src.Tell() - callOffset);
+            ++numWrittenCalls;
+        }
+    }
+    return numWrittenCalls;
+}
+
+template <class T>
+void NetworkRpcBatch::ReadCalls(MemoryBuffer& src, const T& callback)
+{
+    while (!src.IsEof())
+    {
+        const auto objectId = static_cast<NetworkId>(src.ReadUInt());
+        const StringHash rpcId = src.ReadStringHash();
+        const unsigned argumentsSize = src.ReadUShort();
+
+        const unsigned argumentsOffset = src.Tell();
+        if (argumentsOffset + argumentsSize > src.GetSize())
+        {
+            URHO3D_LOGWARNING("Received truncated RPC batch");
+            return;
+        }
+
+        MemoryBuffer arguments(src.GetData() + argumentsOffset, argumentsSize);
+        callback(objectId, rpcId, arguments);
+        src.Seek(argumentsOffset + argumentsSize);
+    }
+}
+
+}
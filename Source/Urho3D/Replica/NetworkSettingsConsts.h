@@ -64,7 +64,7 @@ namespace NetworkSettings
 /// @{
 
 /// Version of internal protocol.
-URHO3D_NETWORK_SETTING(InternalProtocolVersion, unsigned, 1);
+URHO3D_NETWORK_SETTING(InternalProtocolVersion, unsigned, 5);
 /// Update frequency of the server, frames per second.
 URHO3D_NETWORK_SETTING(UpdateFrequency, unsigned, 30);
 /// Connection ID of current client.
@@ -81,6 +81,9 @@ URHO3D_NETWORK_SETTING(InterpolationLimit, float, 0.25f);
 URHO3D_NETWORK_SETTING(MaxInputFrames, unsigned, 256);
 /// Maximum number of input frames sent to server including relevant frame.
 URHO3D_NETWORK_SETTING(MaxInputRedundancy, unsigned, 32);
+/// Number of recent frames of unreliable updates kept for delta compression against acknowledged baselines.
+/// Updates are sent in full if there's no acknowledged baseline within this window. 0 disables delta compression.
+URHO3D_NETWORK_SETTING(DeltaCompressionHistory, unsigned, 32);
 
 /// @}
 
@@ -103,6 +106,22 @@ URHO3D_NETWORK_SETTING(InputBufferingMin, unsigned, 0);
 URHO3D_NETWORK_SETTING(InputBufferingMax, unsigned, 8);
 /// Interval in seconds between NetworkObject becoming unneeded for client and replication stopped.
 URHO3D_NETWORK_SETTING(RelevanceTimeout, float, 5.0f);
+/// Size of the cell of the spatial interest grid.
+URHO3D_NETWORK_SETTING(InterestGridCellSize, float, 32.0f);
+/// Radius of the area of interest around objects owned by the client. Used for interest-managed objects.
+URHO3D_NETWORK_SETTING(InterestRadius, float, 100.0f);
+/// Extra distance that interest-managed object should cross before it becomes irrelevant.
+URHO3D_NETWORK_SETTING(InterestHysteresis, float, 10.0f);
+/// Number of priority bands in the area of interest. Update period doubles in each next band.
+URHO3D_NETWORK_SETTING(InterestPriorityBands, unsigned, 3);
+/// Max size in bytes of unreliable update message sent to the client per network frame.
+/// Updates that don't fit are deferred, the update with the highest priority is always sent.
+URHO3D_NETWORK_SETTING(UnreliableUpdateBudget, unsigned, 1200);
+/// Distance from objects owned by the client at which priority of unreliable updates is halved.
+URHO3D_NETWORK_SETTING(UnreliablePriorityDistance, float, 50.0f);
+/// Max number of objects added to the client per network frame. Objects closest to the client are added first,
+/// the rest is streamed on the next frames. 0 disables the limit.
+URHO3D_NETWORK_SETTING(MaxAddedObjectsPerFrame, unsigned, 256);
 /// Duration in seconds of value tracking on server. Used for lag compensation.
 URHO3D_NETWORK_SETTING(ServerTracingDuration, float, 5.0f);
 
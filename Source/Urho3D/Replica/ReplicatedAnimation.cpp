@@ -50,6 +50,8 @@ void ReplicatedAnimation::RegisterObject(Context* context)
     URHO3D_ATTRIBUTE("Num Upload Attempts", unsigned, numUploadAttempts_, DefaultNumUploadAttempts, AM_DEFAULT);
     URHO3D_ATTRIBUTE("Replicate Owner", bool, replicateOwner_, false, AM_DEFAULT);
     URHO3D_ATTRIBUTE("Smoothing Time", float, smoothingTime_, DefaultSmoothingTime, AM_DEFAULT);
+
+    URHO3D_ACCESSOR_ATTRIBUTE("Quantization Bits", GetQuantizationBits, SetQuantizationBits, unsigned, DefaultQuantizationBits, AM_DEFAULT);
 }
 
 void ReplicatedAnimation::InitializeStandalone()
@@ -79,6 +81,8 @@ void ReplicatedAnimation::InitializeOnServer()
 
 void ReplicatedAnimation::WriteSnapshot(NetworkFrame frame, Serializer& dest)
 {
+    dest.WriteVLE(quantizationBits_);
+
     dest.WriteVLE(animationLookup_.size());
     for (const auto& [nameHash, name] : animationLookup_)
         dest.WriteString(name);
@@ -99,6 +103,8 @@ void ReplicatedAnimation::InitializeFromSnapshot(NetworkFrame frame, Deserialize
     client_.animationTrace_.Resize(traceDuration);
     client_.latestAppliedFrame_ = ea::nullopt;
 
+    quantizationBits_ = ea::min(src.ReadVLE(), BitBuffer::MaxQuantizationBits);
+
     ReadLookupsOnClient(src);
 
     // Read initial animations
@@ -173,9 +179,27 @@ Animation* ReplicatedAnimation::GetAnimationByHash(StringHash nameHash) const
 
 void ReplicatedAnimation::WriteSnapshot(Serializer& dest)
 {
+    const unsigned numAnimations = animationController_->GetNumAnimations();
+    if (quantizationBits_ != 0)
+    {
+        BitBuffer& buffer = server_.quantizedSnapshotBuffer_;
+        buffer.Clear();
+
+        buffer.WriteVLE(numAnimations);
+        for (unsigned i = 0; i < numAnimations; ++i)
+        {
+            const AnimationParameters& params = animationController_->GetAnimationParameters(i);
+            buffer.WriteBits(params.animationName_.Value(), 32);
+            params.SerializeQuantized(buffer, quantizationBits_);
+        }
+
+        dest.WriteVLE(buffer.GetSize());
+        dest.Write(buffer.GetData(), buffer.GetSize());
+        return;
+    }
+
     server_.snapshotBuffer_.Clear();
 
-    const unsigned numAnimations = animationController_->GetNumAnimations();
     for (unsigned i = 0; i < numAnimations; ++i)
     {
         const AnimationParameters& params = animationController_->GetAnimationParameters(i);
@@ -195,9 +219,25 @@ ReplicatedAnimation::AnimationSnapshot ReplicatedAnimation::ReadSnapshot(Deseria
     return result;
 }
 
-void ReplicatedAnimation::DecodeSnapshot(const AnimationSnapshot& snapshot, ea::vector<AnimationParameters>& result) const
+void ReplicatedAnimation::DecodeSnapshot(const AnimationSnapshot& snapshot, ea::vector<AnimationParameters>& result)
 {
     result.clear();
+    if (quantizationBits_ != 0)
+    {
+        BitBuffer& src = client_.quantizedSnapshotBuffer_;
+        src.SetData(snapshot.data(), snapshot.size());
+
+        const unsigned numAnimations = src.ReadVLE();
+        for (unsigned i = 0; i < numAnimations && !src.IsEof(); ++i)
+        {
+            Animation* animation = GetAnimationByHash(StringHash{src.ReadBits(32)});
+            const auto params = AnimationParameters::DeserializeQuantized(animation, src, quantizationBits_);
+            if (animation)
+                result.push_back(params);
+        }
+        return;
+    }
+
     MemoryBuffer src{snapshot.data(), snapshot.size()};
     while (!src.IsEof())
     {
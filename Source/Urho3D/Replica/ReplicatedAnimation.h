@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include "../IO/BitBuffer.h"
 #include "../Replica/BehaviorNetworkObject.h"
 
 #include <EASTL/fixed_vector.h>
@@ -45,6 +46,7 @@ public:
     static constexpr unsigned SmallSnapshotSize = 256;
     static constexpr unsigned DefaultNumUploadAttempts = 4;
     static constexpr float DefaultSmoothingTime = 0.2f;
+    static constexpr unsigned DefaultQuantizationBits = 0;
 
     static constexpr NetworkCallbackFlags CallbackMask =
         NetworkCallbackMask::ReliableDelta | NetworkCallbackMask::UnreliableDelta | NetworkCallbackMask::InterpolateState | NetworkCallbackMask::Update;
@@ -61,6 +63,10 @@ public:
     void SetSmoothingTime(float value) { smoothingTime_ = value; }
     float GetSmoothingTime() const { return smoothingTime_; }
 
+    /// Set number of bits used to quantize animation time and weights. 0 disables quantization.
+    void SetQuantizationBits(unsigned value) { quantizationBits_ = ea::min(value, BitBuffer::MaxQuantizationBits); }
+    unsigned GetQuantizationBits() const { return quantizationBits_; }
+
     const StringMap& GetAnimationLookup() const { return animationLookup_; }
 
     /// Implement NetworkBehavior.
@@ -75,6 +81,7 @@ public:
     void ReadReliableDelta(NetworkFrame frame, Deserializer& src) override;
 
     bool PrepareUnreliableDelta(NetworkFrame frame) override;
+    bool PrepareForcedUnreliableDelta(NetworkFrame frame) override { return animationController_ != nullptr; }
     void WriteUnreliableDelta(NetworkFrame frame, Serializer& dest) override;
     void ReadUnreliableDelta(NetworkFrame frame, Deserializer& src) override;
 
@@ -93,7 +100,7 @@ private:
     Animation* GetAnimationByHash(StringHash nameHash) const;
     void WriteSnapshot(Serializer& dest);
     AnimationSnapshot ReadSnapshot(Deserializer& src) const;
-    void DecodeSnapshot(const AnimationSnapshot& snapshot, ea::vector<AnimationParameters>& result) const;
+    void DecodeSnapshot(const AnimationSnapshot& snapshot, ea::vector<AnimationParameters>& result);
 
     WeakPtr<AnimationController> animationController_;
 
@@ -104,6 +111,11 @@ private:
     float smoothingTime_{DefaultSmoothingTime};
     /// @}
 
+    /// Attributes matching on the client and the server.
+    /// @{
+    unsigned quantizationBits_{DefaultQuantizationBits};
+    /// @}
+
     StringMap animationLookup_;
 
     struct ServerData
@@ -112,6 +124,7 @@ private:
         unsigned latestRevision_{};
         ea::vector<ea::string> newAnimationLookups_;
         VectorBuffer snapshotBuffer_;
+        BitBuffer quantizedSnapshotBuffer_;
     } server_;
 
     struct ClientData
@@ -120,6 +133,7 @@ private:
 
         ea::optional<NetworkFrame> latestAppliedFrame_;
         ea::vector<AnimationParameters> snapshotAnimations_;
+        BitBuffer quantizedSnapshotBuffer_;
 
         NetworkValue<AnimationSnapshot> animationTrace_;
     } client_;
@@ -68,6 +68,10 @@ void ReplicatedTransform::RegisterObject(Context* context)
     URHO3D_ENUM_ATTRIBUTE("Synchronize Rotation", synchronizeRotation_, replicatedRotationModeNames, DefaultSynchronizeRotation, AM_DEFAULT);
     URHO3D_ATTRIBUTE("Extrapolate Position", bool, extrapolatePosition_, DefaultExtrapolatePosition, AM_DEFAULT);
     URHO3D_ATTRIBUTE("Extrapolate Rotation", bool, extrapolateRotation_, DefaultExtrapolateRotation, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Position Quantization Bits", GetPositionQuantizationBits, SetPositionQuantizationBits, unsigned, DefaultPositionQuantizationBits, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Position Range", GetPositionRange, SetPositionRange, float, DefaultPositionRange, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Rotation Quantization Bits", GetRotationQuantizationBits, SetRotationQuantizationBits, unsigned, DefaultRotationQuantizationBits, AM_DEFAULT);
+    URHO3D_ATTRIBUTE("Half Precision Velocity", bool, halfPrecisionVelocity_, DefaultHalfPrecisionVelocity, AM_DEFAULT);
 }
 
 void ReplicatedTransform::InitializeOnServer()
@@ -95,7 +99,18 @@ void ReplicatedTransform::WriteSnapshot(NetworkFrame frame, Serializer& dest)
     flags[1] = synchronizeRotation_ != ReplicatedRotationMode::None;
     flags[2] = extrapolatePosition_;
     flags[3] = extrapolateRotation_;
+    flags[4] = positionQuantizationBits_ != 0;
+    flags[5] = rotationQuantizationBits_ != 0;
+    flags[6] = halfPrecisionVelocity_;
     dest.WriteVLE(flags.to_uint32());
+
+    if (flags[4])
+    {
+        dest.WriteVLE(positionQuantizationBits_);
+        dest.WriteFloat(positionRange_);
+    }
+    if (flags[5])
+        dest.WriteVLE(rotationQuantizationBits_);
 }
 
 void ReplicatedTransform::InitializeFromSnapshot(NetworkFrame frame, Deserializer& src, bool isOwned)
@@ -107,6 +122,20 @@ void ReplicatedTransform::InitializeFromSnapshot(NetworkFrame frame, Deserialize
     synchronizeRotation_ = flags[1] ? ReplicatedRotationMode::XYZ : ReplicatedRotationMode::None;
     extrapolatePosition_ = flags[2];
     extrapolateRotation_ = flags[3];
+    halfPrecisionVelocity_ = flags[6];
+
+    if (flags[4])
+    {
+        SetPositionQuantizationBits(src.ReadVLE());
+        SetPositionRange(src.ReadFloat());
+    }
+    else
+        positionQuantizationBits_ = 0;
+
+    if (flags[5])
+        SetRotationQuantizationBits(src.ReadVLE());
+    else
+        rotationQuantizationBits_ = 0;
 
     const auto replicationManager = GetNetworkObject()->GetReplicationManager();
     const unsigned updateFrequency = replicationManager->GetUpdateFrequency();
@@ -196,38 +225,97 @@ bool ReplicatedTransform::PrepareUnreliableDelta(NetworkFrame frame)
 
 void ReplicatedTransform::WriteUnreliableDelta(NetworkFrame frame, Serializer& dest)
 {
+    deltaBuffer_.Clear();
+
     if (synchronizePosition_)
     {
-        dest.WriteVector3(server_.position_);
-        dest.WriteVector3(server_.velocity_);
+        if (positionQuantizationBits_ != 0)
+        {
+            const Vector3 range = Vector3::ONE * positionRange_;
+            deltaBuffer_.WriteQuantizedVector3(server_.position_, -range, range, positionQuantizationBits_);
+        }
+        else
+            deltaBuffer_.WriteVector3(server_.position_);
+        WriteVelocity(deltaBuffer_, server_.velocity_);
     }
 
     if (synchronizeRotation_ == ReplicatedRotationMode::XYZ)
     {
-        dest.WriteQuaternion(server_.rotation_);
-        dest.WriteVector3(server_.angularVelocity_);
+        if (rotationQuantizationBits_ != 0)
+            deltaBuffer_.WriteSmallestThreeQuaternion(server_.rotation_, rotationQuantizationBits_);
+        else
+            deltaBuffer_.WriteQuaternion(server_.rotation_);
+        WriteVelocity(deltaBuffer_, server_.angularVelocity_);
     }
+
+    URHO3D_ASSERT(deltaBuffer_.GetSize() == GetUnreliableDeltaSize());
+    dest.Write(deltaBuffer_.GetData(), deltaBuffer_.GetSize());
 }
 
 void ReplicatedTransform::ReadUnreliableDelta(NetworkFrame frame, Deserializer& src)
 {
+    deltaBuffer_.SetData(src, GetUnreliableDeltaSize());
+
     if (synchronizePosition_)
     {
-        const Vector3 position = src.ReadVector3();
-        const Vector3 velocity = src.ReadVector3();
+        Vector3 position;
+        if (positionQuantizationBits_ != 0)
+        {
+            const Vector3 range = Vector3::ONE * positionRange_;
+            position = deltaBuffer_.ReadQuantizedVector3(-range, range, positionQuantizationBits_);
+        }
+        else
+            position = deltaBuffer_.ReadVector3();
+        const Vector3 velocity = ReadVelocity(deltaBuffer_);
 
         positionTrace_.Set(frame, {position, velocity});
     }
 
     if (synchronizeRotation_ == ReplicatedRotationMode::XYZ)
     {
-        const Quaternion rotation = src.ReadQuaternion();
-        const Vector3 angularVelocity = src.ReadVector3();
+        const Quaternion rotation = rotationQuantizationBits_ != 0
+            ? deltaBuffer_.ReadSmallestThreeQuaternion(rotationQuantizationBits_)
+            : deltaBuffer_.ReadQuaternion();
+        const Vector3 angularVelocity = ReadVelocity(deltaBuffer_);
 
         rotationTrace_.Set(frame, {rotation, angularVelocity});
     }
 }
 
+unsigned ReplicatedTransform::GetUnreliableDeltaSize() const
+{
+    const unsigned velocityBits = halfPrecisionVelocity_ ? 3 * 16 : 3 * 32;
+
+    unsigned numBits = 0;
+    if (synchronizePosition_)
+    {
+        numBits += positionQuantizationBits_ != 0 ? 3 * positionQuantizationBits_ : 3 * 32;
+        numBits += velocityBits;
+    }
+
+    if (synchronizeRotation_ == ReplicatedRotationMode::XYZ)
+    {
+        numBits += rotationQuantizationBits_ != 0
+            ? BitBuffer::GetSmallestThreeQuaternionBits(rotationQuantizationBits_) : 4 * 32;
+        numBits += velocityBits;
+    }
+
+    return (numBits + 7) / 8;
+}
+
+void ReplicatedTransform::WriteVelocity(BitBuffer& dest, const Vector3& value) const
+{
+    if (halfPrecisionVelocity_)
+        dest.WriteHalfVector3(value);
+    else
+        dest.WriteVector3(value);
+}
+
+Vector3 ReplicatedTransform::ReadVelocity(BitBuffer& src) const
+{
+    return halfPrecisionVelocity_ ? src.ReadHalfVector3() : src.ReadVector3();
+}
+
 PositionAndVelocity ReplicatedTransform::SampleTemporalPosition(const NetworkTime& time) const
 {
     return positionTrace_.SampleValid(time);
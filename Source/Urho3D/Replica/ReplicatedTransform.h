@@ -24,6 +24,7 @@
 
 #pragma once
 
+#include "../IO/BitBuffer.h"
 #include "../Replica/BehaviorNetworkObject.h"
 #include "../Replica/NetworkValue.h"
 
@@ -59,6 +60,10 @@ public:
     static constexpr ReplicatedRotationMode DefaultSynchronizeRotation = ReplicatedRotationMode::XYZ;
     static constexpr bool DefaultExtrapolatePosition = true;
     static constexpr bool DefaultExtrapolateRotation = false;
+    static constexpr unsigned DefaultPositionQuantizationBits = 0;
+    static constexpr float DefaultPositionRange = 1024.0f;
+    static constexpr unsigned DefaultRotationQuantizationBits = 0;
+    static constexpr bool DefaultHalfPrecisionVelocity = false;
 
     static constexpr NetworkCallbackFlags CallbackMask =
         NetworkCallbackMask::UpdateTransformOnServer | NetworkCallbackMask::UnreliableDelta | NetworkCallbackMask::InterpolateState;
@@ -92,6 +97,22 @@ public:
     void SetExtrapolateRotation(bool value) { extrapolateRotation_ = value; }
     bool GetExtrapolateRotation() const { return extrapolateRotation_; }
 
+    /// Quantization settings. 0 bits means that values are sent with full precision.
+    /// Quantized positions are clamped to [-range, range] on each axis.
+    /// @{
+    void SetPositionQuantizationBits(unsigned value) { positionQuantizationBits_ = ea::min(value, BitBuffer::MaxQuantizationBits); }
+    unsigned GetPositionQuantizationBits() const { return positionQuantizationBits_; }
+    void SetPositionRange(float value) { positionRange_ = ea::max(value, M_EPSILON); }
+    float GetPositionRange() const { return positionRange_; }
+    void SetRotationQuantizationBits(unsigned value) { rotationQuantizationBits_ = ea::min(value, BitBuffer::MaxQuantizationBits); }
+    unsigned GetRotationQuantizationBits() const { return rotationQuantizationBits_; }
+    void SetHalfPrecisionVelocity(bool value) { halfPrecisionVelocity_ = value; }
+    bool GetHalfPrecisionVelocity() const { return halfPrecisionVelocity_; }
+    /// @}
+
+    /// Return size of unreliable delta in bytes for current settings.
+    unsigned GetUnreliableDeltaSize() const;
+
     /// Implement NetworkBehavior.
     /// @{
     void InitializeOnServer() override;
@@ -102,6 +123,7 @@ public:
     void InterpolateState(float replicaTimeStep, float inputTimeStep, const NetworkTime& replicaTime, const NetworkTime& inputTime) override;
 
     bool PrepareUnreliableDelta(NetworkFrame frame) override;
+    bool PrepareForcedUnreliableDelta(NetworkFrame frame) override { return true; }
     void WriteUnreliableDelta(NetworkFrame frame, Serializer& dest) override;
     void ReadUnreliableDelta(NetworkFrame frame, Deserializer& src) override;
     /// @}
@@ -119,6 +141,9 @@ private:
     void InitializeCommon();
     void OnServerFrameEnd(NetworkFrame frame);
 
+    void WriteVelocity(BitBuffer& dest, const Vector3& value) const;
+    Vector3 ReadVelocity(BitBuffer& src) const;
+
     /// Attributes independent on the client and the server.
     /// @{
     unsigned numUploadAttempts_{DefaultNumUploadAttempts};
@@ -136,11 +161,17 @@ private:
     ReplicatedRotationMode synchronizeRotation_{DefaultSynchronizeRotation};
     bool extrapolatePosition_{DefaultExtrapolatePosition};
     bool extrapolateRotation_{DefaultExtrapolateRotation};
+    unsigned positionQuantizationBits_{DefaultPositionQuantizationBits};
+    float positionRange_{DefaultPositionRange};
+    unsigned rotationQuantizationBits_{DefaultRotationQuantizationBits};
+    bool halfPrecisionVelocity_{DefaultHalfPrecisionVelocity};
     /// @}
 
     NetworkValue<PositionAndVelocity> positionTrace_;
     NetworkValue<RotationAndVelocity> rotationTrace_;
 
+    BitBuffer deltaBuffer_;
+
     struct ServerData
     {
         unsigned pendingUploadAttempts_{};
@@ -26,11 +26,13 @@
 #include "../Core/CoreEvents.h"
 #include "../Core/Exception.h"
 #include "../Core/Timer.h"
+#include "../Core/WorkQueue.h"
 #include "../IO/Log.h"
 #include "../Math/RandomEngine.h"
 #include "../Network/Connection.h"
 #include "../Network/Network.h"
 #include "../Network/NetworkEvents.h"
+#include "../Replica/DeltaEncoding.h"
 #include "../Replica/NetworkObject.h"
 #include "../Replica/ReplicationManager.h"
 #include "../Replica/NetworkSettingsConsts.h"
@@ -39,6 +41,7 @@
 #include "../Scene/SceneEvents.h"
 
 #include <EASTL/numeric.h>
+#include <EASTL/sort.h>
 
 namespace Urho3D
 {
@@ -51,6 +54,12 @@ unsigned GetIndex(NetworkId networkId)
     return DeconstructComponentReference(networkId).first;
 }
 
+unsigned GetRingBufferSlot(NetworkFrame frame, unsigned size)
+{
+    const long long signedSize = size;
+    return static_cast<unsigned>((static_cast<long long>(frame) % signedSize + signedSize) % signedSize);
+}
+
 }
 
 SharedReplicationState::SharedReplicationState(NetworkObjectRegistry* objectRegistry)
@@ -75,6 +84,12 @@ void SharedReplicationState::OnNetworkObjectRemoved(NetworkObject* networkObject
     if (recentlyAddedObjects_.erase(networkObject->GetNetworkId()) == 0)
         recentlyRemovedObjects_.insert(networkObject->GetNetworkId());
 
+    const unsigned index = GetIndex(networkObject->GetNetworkId());
+    if (index < isInterestManaged_.size())
+        isInterestManaged_[index] = false;
+    if (index < unreliableUpdateHistory_.size())
+        ResetUnreliableUpdateHistory(index);
+
     if (AbstractConnection* ownerConnection = networkObject->GetOwnerConnection())
     {
         auto& ownedObjects = ownedObjectsByConnection_[ownerConnection];
@@ -90,23 +105,37 @@ void SharedReplicationState::PrepareForUpdate()
     InitializeNewObjects();
 
     objectRegistry_->GetSortedNetworkObjects(sortedNetworkObjects_);
+    UpdateInterestGrid();
 }
 
 void SharedReplicationState::ResetFrameBuffers()
 {
     const unsigned indexUppedBound = GetIndexUpperBound();
 
+    isInterestManaged_.resize(indexUppedBound);
+
     isDeltaUpdateQueued_.clear();
     isDeltaUpdateQueued_.resize(indexUppedBound);
 
+    isSnapshotQueued_.clear();
+    isSnapshotQueued_.resize(indexUppedBound);
+    snapshotData_.resize(indexUppedBound);
+
     needReliableDeltaUpdate_.clear();
     needReliableDeltaUpdate_.resize(indexUppedBound);
     reliableDeltaUpdateData_.resize(indexUppedBound);
 
     needUnreliableDeltaUpdate_.clear();
     needUnreliableDeltaUpdate_.resize(indexUppedBound);
+    isForcedUnreliableUpdateQueued_.clear();
+    isForcedUnreliableUpdateQueued_.resize(indexUppedBound);
+    isUnreliableUpdateForced_.clear();
+    isUnreliableUpdateForced_.resize(indexUppedBound);
     unreliableDeltaUpdateData_.resize(indexUppedBound);
 
+    if (deltaCompressionHistory_ > 0)
+        unreliableUpdateHistory_.resize(indexUppedBound);
+
     deltaUpdateBuffer_.Clear();
 }
 
@@ -124,18 +153,52 @@ void SharedReplicationState::InitializeNewObjects()
         networkObject->InitializeOnServer();
         networkObject->SetNetworkMode(NetworkObjectMode::Server);
 
+        isInterestManaged_[GetIndex(networkId)] = networkObject->IsInterestManaged();
+        if (deltaCompressionHistory_ > 0)
+            ResetUnreliableUpdateHistory(GetIndex(networkId));
+
         if (AbstractConnection* ownerConnection = networkObject->GetOwnerConnection())
             ownedObjectsByConnection_[ownerConnection].insert(networkObject);
     }
     recentlyAddedObjects_.clear();
 }
 
+void SharedReplicationState::UpdateInterestGrid()
+{
+    interestGrid_.Clear();
+    for (NetworkObject* networkObject : sortedNetworkObjects_)
+    {
+        const unsigned index = GetIndex(networkObject->GetNetworkId());
+        if (isInterestManaged_[index])
+            interestGrid_.AddObject(index, networkObject->GetNode()->GetWorldPosition());
+    }
+    interestGrid_.Commit();
+}
+
+void SharedReplicationState::ResetUnreliableUpdateHistory(unsigned index)
+{
+    if (deltaCompressionHistory_ > 0)
+        unreliableUpdateHistory_[index].Resize(deltaCompressionHistory_);
+}
+
 void SharedReplicationState::QueueDeltaUpdate(NetworkObject* networkObject)
 {
     const unsigned index = GetIndex(networkObject->GetNetworkId());
     isDeltaUpdateQueued_[index] = true;
 }
 
+void SharedReplicationState::QueueForcedUnreliableUpdate(NetworkObject* networkObject)
+{
+    const unsigned index = GetIndex(networkObject->GetNetworkId());
+    isForcedUnreliableUpdateQueued_[index] = true;
+}
+
+void SharedReplicationState::QueueSnapshot(NetworkObject* networkObject)
+{
+    const unsigned index = GetIndex(networkObject->GetNetworkId());
+    isSnapshotQueued_[index] = true;
+}
+
 void SharedReplicationState::CookDeltaUpdates(NetworkFrame currentFrame)
 {
     recentlyRemovedObjects_.clear();
@@ -158,7 +221,15 @@ void SharedReplicationState::CookDeltaUpdates(NetworkFrame currentFrame)
             reliableDeltaUpdateData_[i] = {beginOffset, endOffset};
         }
 
-        if (networkObject->PrepareUnreliableDelta(currentFrame))
+        // Cook the current state for deferred updates even if the object has stopped producing them
+        bool needUnreliableDelta = networkObject->PrepareUnreliableDelta(currentFrame);
+        if (!needUnreliableDelta && isForcedUnreliableUpdateQueued_[i])
+        {
+            needUnreliableDelta = networkObject->PrepareForcedUnreliableDelta(currentFrame);
+            isUnreliableUpdateForced_[i] = needUnreliableDelta;
+        }
+
+        if (needUnreliableDelta)
         {
             const unsigned beginOffset = deltaUpdateBuffer_.Tell();
             networkObject->WriteUnreliableDelta(currentFrame, deltaUpdateBuffer_);
@@ -166,8 +237,32 @@ void SharedReplicationState::CookDeltaUpdates(NetworkFrame currentFrame)
 
             needUnreliableDeltaUpdate_[i] = true;
             unreliableDeltaUpdateData_[i] = {beginOffset, endOffset};
+
+            // Keep recent updates so they can be used as baselines for delta compression
+            if (deltaCompressionHistory_ > 0)
+            {
+                const ConstByteSpan update = GetSpanData(unreliableDeltaUpdateData_[i]);
+                unreliableUpdateBuffer_.assign(update.begin(), update.end());
+                unreliableUpdateHistory_[i].Set(currentFrame, unreliableUpdateBuffer_);
+            }
         }
     }
+
+    // Snapshots are the same for all clients, write each of them once
+    for (unsigned i = 0; i < isSnapshotQueued_.size(); ++i)
+    {
+        if (!isSnapshotQueued_[i])
+            continue;
+
+        NetworkObject* networkObject = objectRegistry_->GetNetworkObjectByIndex(i);
+        URHO3D_ASSERT(networkObject);
+
+        const unsigned beginOffset = deltaUpdateBuffer_.Tell();
+        networkObject->WriteSnapshot(currentFrame, deltaUpdateBuffer_);
+        const unsigned endOffset = deltaUpdateBuffer_.Tell();
+
+        snapshotData_[i] = {beginOffset, endOffset};
+    }
 }
 
 unsigned SharedReplicationState::GetIndexUpperBound() const
@@ -196,6 +291,26 @@ ea::optional<ConstByteSpan> SharedReplicationState::GetUnreliableUpdateByIndex(u
     return GetSpanData(unreliableDeltaUpdateData_[index]);
 }
 
+ea::optional<ConstByteSpan> SharedReplicationState::GetSnapshotByIndex(unsigned index) const
+{
+    if (!isSnapshotQueued_[index])
+        return ea::nullopt;
+    return GetSpanData(snapshotData_[index]);
+}
+
+ea::optional<ConstByteSpan> SharedReplicationState::GetPastUnreliableUpdateByIndex(unsigned index, NetworkFrame frame) const
+{
+    if (index >= unreliableUpdateHistory_.size())
+        return ea::nullopt;
+
+    const NetworkValue<ByteVector>& history = unreliableUpdateHistory_[index];
+    if (!history.Has(frame))
+        return ea::nullopt;
+
+    const ByteVector& update = history.GetRawUnchecked(frame);
+    return ConstByteSpan{update.data(), update.size()};
+}
+
 ConstByteSpan SharedReplicationState::GetSpanData(const DeltaBufferSpan& span) const
 {
     const auto data = deltaUpdateBuffer_.GetData();
@@ -320,18 +435,71 @@ ClientReplicationState::ClientReplicationState(
     NetworkObjectRegistry* objectRegistry, AbstractConnection* connection, const VariantMap& settings)
     : ClientSynchronizationState(objectRegistry, connection, settings)
 {
+    interestArea_.radius_ = GetSetting(NetworkSettings::InterestRadius).GetFloat();
+    interestArea_.hysteresis_ = GetSetting(NetworkSettings::InterestHysteresis).GetFloat();
+    interestArea_.numBands_ = GetSetting(NetworkSettings::InterestPriorityBands).GetUInt();
+
+    deltaCompressionHistory_ = GetSetting(NetworkSettings::DeltaCompressionHistory).GetUInt();
+    sentUnreliableUpdates_.resize(deltaCompressionHistory_);
 }
 
-void ClientReplicationState::SendMessages(NetworkFrame currentFrame, const SharedReplicationState& sharedState)
+void ClientReplicationState::PrepareMessages(NetworkFrame currentFrame, const SharedReplicationState& sharedState)
 {
-    ClientSynchronizationState::SendMessages();
+    outgoingBuffer_.Clear();
+    outgoingMessages_.clear();
 
     if (IsSynchronized())
     {
-        SendRemoveObjects();
-        SendAddObjects();
-        SendUpdateObjectsReliable(sharedState);
-        SendUpdateObjectsUnreliable(currentFrame, sharedState);
+        PrepareRemoveObjects();
+        PrepareAddObjects(sharedState);
+        PrepareUpdateObjectsReliable(sharedState);
+        PrepareUpdateObjectsUnreliable(currentFrame, sharedState);
+        PrepareObjectsRpc(sharedState);
+    }
+
+    rpcBatch_.Clear();
+}
+
+void ClientReplicationState::SendMessages()
+{
+    ClientSynchronizationState::SendMessages();
+
+    const unsigned char* data = outgoingBuffer_.GetData();
+    for (const OutgoingMessage& message : outgoingMessages_)
+    {
+        const PacketType messageType = message.messageType_;
+        const bool reliable = messageType == PT_RELIABLE_ORDERED || messageType == PT_RELIABLE_UNORDERED;
+        const bool inOrder = messageType == PT_RELIABLE_ORDERED || messageType == PT_UNRELIABLE_ORDERED;
+
+        connection_->SendLoggedMessage(message.messageId_, reliable, inOrder, data + message.beginOffset_,
+            message.endOffset_ - message.beginOffset_, message.debugInfo_);
+    }
+
+    outgoingMessages_.clear();
+}
+
+template <class T>
+void ClientReplicationState::PrepareGeneratedMessage(NetworkMessageId messageId, PacketType messageType, T generator)
+{
+    OutgoingMessage message;
+    message.messageId_ = messageId;
+    message.messageType_ = messageType;
+    message.beginOffset_ = outgoingBuffer_.Tell();
+
+#ifdef URHO3D_LOGGING
+    ea::string* debugInfoPtr = &message.debugInfo_;
+#else
+    ea::string* debugInfoPtr = nullptr;
+#endif
+
+    if (generator(outgoingBuffer_, debugInfoPtr))
+    {
+        message.endOffset_ = outgoingBuffer_.Tell();
+        outgoingMessages_.push_back(ea::move(message));
+    }
+    else
+    {
+        outgoingBuffer_.Resize(message.beginOffset_);
     }
 }
 
@@ -348,6 +516,18 @@ bool ClientReplicationState::ProcessMessage(NetworkMessageId messageId, MemoryBu
         ProcessObjectsFeedbackUnreliable(messageData);
         return true;
 
+    case MSG_ACKNOWLEDGE_UPDATES_UNRELIABLE:
+        connection_->OnMessageReceived(messageId, messageData);
+
+        ProcessAcknowledgeUpdatesUnreliable(messageData);
+        return true;
+
+    case MSG_OBJECTS_RPC:
+        connection_->OnMessageReceived(messageId, messageData);
+
+        ProcessObjectsRpc(messageData);
+        return true;
+
     default:
         return false;
     }
@@ -390,9 +570,84 @@ void ClientReplicationState::ProcessObjectsFeedbackUnreliable(MemoryBuffer& mess
     }
 }
 
-void ClientReplicationState::SendRemoveObjects()
+void ClientReplicationState::ProcessAcknowledgeUpdatesUnreliable(MemoryBuffer& messageData)
+{
+    if (deltaCompressionHistory_ == 0)
+        return;
+
+    // Latest received frame and the mask of received frames preceding it
+    const auto latestFrame = static_cast<NetworkFrame>(messageData.ReadInt64());
+    const unsigned previousFramesMask = messageData.ReadUInt();
+
+    AcknowledgeUnreliableUpdates(latestFrame);
+    for (unsigned i = 0; i < 32; ++i)
+    {
+        if (previousFramesMask & (1u << i))
+            AcknowledgeUnreliableUpdates(latestFrame - static_cast<int>(i + 1));
+    }
+}
+
+void ClientReplicationState::ProcessObjectsRpc(MemoryBuffer& messageData)
+{
+    if (!IsSynchronized())
+    {
+        URHO3D_LOGWARNING("Connection {}: Received unexpected RPC", connection_->ToString());
+        return;
+    }
+
+    NetworkRpcBatch::ReadCalls(messageData,
+        [&](NetworkId networkId, StringHash rpcId, MemoryBuffer& arguments)
+    {
+        NetworkObject* networkObject = objectRegistry_->GetNetworkObject(networkId);
+        if (!networkObject)
+        {
+            URHO3D_LOGWARNING("Connection {}: Received RPC for unknown NetworkObject {}",
+                connection_->ToString(), ToString(networkId));
+            return;
+        }
+
+        // Client may call RPCs only for objects replicated to it
+        const unsigned index = GetIndex(networkId);
+        if (index >= objectsRelevance_.size() || objectsRelevance_[index] == NetworkObjectRelevance::Irrelevant)
+        {
+            URHO3D_LOGWARNING("Connection {}: Received RPC for NetworkObject {} that is not replicated to the client",
+                connection_->ToString(), ToString(networkId));
+            return;
+        }
+
+        if (!networkObject->ProcessRpc(connection_, rpcId, arguments))
+        {
+            URHO3D_LOGWARNING("Connection {}: Received unknown RPC {} for NetworkObject {}",
+                connection_->ToString(), rpcId.ToDebugString(), ToString(networkId));
+        }
+    });
+}
+
+void ClientReplicationState::AcknowledgeUnreliableUpdates(NetworkFrame frame)
+{
+    const auto slot = GetRingBufferSlot(frame, deltaCompressionHistory_);
+    SentUnreliableUpdates& sentUpdates = sentUnreliableUpdates_[slot];
+    if (sentUpdates.frame_ != frame)
+        return;
+
+    for (unsigned index : sentUpdates.objectIndices_)
+    {
+        if (index >= unreliableBaselines_.size())
+            continue;
+
+        UnreliableBaseline& baseline = unreliableBaselines_[index];
+        if (frame > baseline.minFrame_ && (!baseline.frame_ || *baseline.frame_ < frame))
+            baseline.frame_ = frame;
+    }
+
+    // Each frame is acknowledged only once
+    sentUpdates.frame_ = ea::nullopt;
+    sentUpdates.objectIndices_.clear();
+}
+
+void ClientReplicationState::PrepareRemoveObjects()
 {
-    connection_->SendGeneratedMessage(MSG_REMOVE_OBJECTS, PT_RELIABLE_ORDERED,
+    PrepareGeneratedMessage(MSG_REMOVE_OBJECTS, PT_RELIABLE_ORDERED,
         [&](VectorBuffer& msg, ea::string* debugInfo)
     {
         if (debugInfo)
@@ -414,14 +669,16 @@ void ClientReplicationState::SendRemoveObjects()
     });
 }
 
-void ClientReplicationState::SendAddObjects()
+void ClientReplicationState::PrepareAddObjects(const SharedReplicationState& sharedState)
 {
-    connection_->SendGeneratedMessage(MSG_ADD_OBJECTS, PT_RELIABLE_ORDERED,
+    PrepareGeneratedMessage(MSG_ADD_OBJECTS, PT_RELIABLE_ORDERED,
         [&](VectorBuffer& msg, ea::string* debugInfo)
     {
         msg.WriteInt64(static_cast<long long>(GetCurrentFrame()));
+        msg.WriteVLE(numPendingAddedObjects_);
 
-        bool sendMessage = false;
+        // Message is also sent when streaming progress changes so the client can track its readiness
+        bool sendMessage = sentNumPendingAddedObjects_ != numPendingAddedObjects_;
         for (const auto& [networkObject, isSnapshot] : pendingUpdatedObjects_)
         {
             if (!isSnapshot)
@@ -432,9 +689,10 @@ void ClientReplicationState::SendAddObjects()
             msg.WriteStringHash(networkObject->GetType());
             msg.WriteVLE(networkObject->GetOwnerConnectionId());
 
-            componentBuffer_.Clear();
-            networkObject->WriteSnapshot(GetCurrentFrame(), componentBuffer_);
-            msg.WriteBuffer(componentBuffer_.GetBuffer());
+            const auto snapshotSpan = sharedState.GetSnapshotByIndex(GetIndex(networkObject->GetNetworkId()));
+            URHO3D_ASSERT(snapshotSpan);
+            msg.WriteVLE(snapshotSpan->size());
+            msg.Write(snapshotSpan->data(), snapshotSpan->size());
 
             if (debugInfo)
             {
@@ -443,13 +701,16 @@ void ClientReplicationState::SendAddObjects()
                 debugInfo->append(ToString(networkObject->GetNetworkId()));
             }
         }
+
+        if (sendMessage)
+            sentNumPendingAddedObjects_ = numPendingAddedObjects_;
         return sendMessage;
     });
 }
 
-void ClientReplicationState::SendUpdateObjectsReliable(const SharedReplicationState& sharedState)
+void ClientReplicationState::PrepareUpdateObjectsReliable(const SharedReplicationState& sharedState)
 {
-    connection_->SendGeneratedMessage(MSG_UPDATE_OBJECTS_RELIABLE, PT_RELIABLE_ORDERED,
+    PrepareGeneratedMessage(MSG_UPDATE_OBJECTS_RELIABLE, PT_RELIABLE_ORDERED,
         [&](VectorBuffer& msg, ea::string* debugInfo)
     {
         msg.WriteInt64(static_cast<long long>(GetCurrentFrame()));
@@ -483,40 +744,120 @@ void ClientReplicationState::SendUpdateObjectsReliable(const SharedReplicationSt
     });
 }
 
-void ClientReplicationState::SendUpdateObjectsUnreliable(NetworkFrame currentFrame, const SharedReplicationState& sharedState)
+void ClientReplicationState::PrioritizeUnreliableUpdates(NetworkFrame currentFrame, const SharedReplicationState& sharedState)
+{
+    const float priorityDistance = GetSetting(NetworkSettings::UnreliablePriorityDistance).GetFloat();
+
+    unreliableUpdateCandidates_.clear();
+    for (const auto& [networkObject, isSnapshot] : pendingUpdatedObjects_)
+    {
+        // Skip redundant updates, both if update is empty or if snapshot was already sent
+        const unsigned index = GetIndex(networkObject->GetNetworkId());
+        if (isSnapshot)
+        {
+            unreliablePriorities_[index] = 0.0f;
+            isUnreliableUpdateDeferred_[index] = false;
+            // Object is recreated on the client, so previous baselines are no longer valid
+            unreliableBaselines_[index] = UnreliableBaseline{ea::nullopt, currentFrame};
+            continue;
+        }
+
+        // Forced updates are only needed by clients that didn't receive the latest state
+        if (!sharedState.GetUnreliableUpdateByIndex(index)
+            || (sharedState.IsUnreliableUpdateForced(index) && !isUnreliableUpdateDeferred_[index]))
+            continue;
+
+        const NetworkObjectRelevance relevance = objectsRelevance_[index];
+        URHO3D_ASSERT(relevance != NetworkObjectRelevance::Irrelevant);
+        if (relevance == NetworkObjectRelevance::NoUpdates)
+        {
+            isUnreliableUpdateDeferred_[index] = false;
+            continue;
+        }
+
+        // Priority is accumulated while the update is pending, so every object is eventually sent
+        const auto period = static_cast<unsigned>(relevance);
+        float& priority = unreliablePriorities_[index];
+        priority += GetDistancePriority(networkObject, priorityDistance) / period;
+
+        if (static_cast<long long>(currentFrame) % period != 0)
+            continue;
+
+        unreliableUpdateCandidates_.emplace_back(priority, networkObject);
+    }
+
+    const auto isHigherPriority = [](const ea::pair<float, NetworkObject*>& lhs, const ea::pair<float, NetworkObject*>& rhs)
+    {
+        if (lhs.first != rhs.first)
+            return lhs.first > rhs.first;
+        return lhs.second->GetNetworkId() < rhs.second->GetNetworkId();
+    };
+    ea::sort(unreliableUpdateCandidates_.begin(), unreliableUpdateCandidates_.end(), isHigherPriority);
+}
+
+float ClientReplicationState::GetDistancePriority(NetworkObject* networkObject, float priorityDistance) const
 {
-    connection_->SendGeneratedMessage(MSG_UPDATE_OBJECTS_UNRELIABLE, PT_UNRELIABLE_UNORDERED,
+    if (ownedObjectPositions_.empty() || priorityDistance <= 0.0f)
+        return 1.0f;
+
+    const Vector3 position = networkObject->GetNode()->GetWorldPosition();
+    float distance = M_LARGE_VALUE;
+    for (const Vector3& ownedObjectPosition : ownedObjectPositions_)
+        distance = ea::min(distance, (position - ownedObjectPosition).Length());
+
+    return 1.0f / (1.0f + distance / priorityDistance);
+}
+
+void ClientReplicationState::PrepareUpdateObjectsUnreliable(NetworkFrame currentFrame, const SharedReplicationState& sharedState)
+{
+    PrioritizeUnreliableUpdates(currentFrame, sharedState);
+
+    const unsigned budget = GetSetting(NetworkSettings::UnreliableUpdateBudget).GetUInt();
+    numDeferredUnreliableUpdates_ = 0;
+    numDeltaCompressedUnreliableUpdates_ = 0;
+
+    SentUnreliableUpdates* sentUpdates = nullptr;
+    if (deltaCompressionHistory_ > 0)
+    {
+        const auto slot = GetRingBufferSlot(currentFrame, deltaCompressionHistory_);
+        sentUpdates = &sentUnreliableUpdates_[slot];
+        sentUpdates->frame_ = currentFrame;
+        sentUpdates->objectIndices_.clear();
+    }
+
+    PrepareGeneratedMessage(MSG_UPDATE_OBJECTS_UNRELIABLE, PT_UNRELIABLE_UNORDERED,
         [&](VectorBuffer& msg, ea::string* debugInfo)
     {
         bool sendMessage = false;
 
+        const unsigned messageBegin = msg.Tell();
         msg.WriteInt64(static_cast<long long>(GetCurrentFrame()));
 
-        for (const auto& [networkObject, isSnapshot] : pendingUpdatedObjects_)
+        for (const auto& [priority, networkObject] : unreliableUpdateCandidates_)
         {
-            // Skip redundant updates, both if update is empty or if snapshot was already sent
             const unsigned index = GetIndex(networkObject->GetNetworkId());
-            if (isSnapshot)
-                continue;
-
             const auto updateSpan = sharedState.GetUnreliableUpdateByIndex(index);
-            if (!updateSpan)
-                continue;
 
-            const NetworkObjectRelevance relevance = objectsRelevance_[index];
-            URHO3D_ASSERT(relevance != NetworkObjectRelevance::Irrelevant);
-            if (relevance == NetworkObjectRelevance::NoUpdates)
-                continue;
+            const unsigned entryBegin = msg.Tell();
+            const unsigned numDeltaCompressed = numDeltaCompressedUnreliableUpdates_;
+            msg.WriteUInt(static_cast<unsigned>(networkObject->GetNetworkId()));
+            WriteUnreliableUpdate(msg, currentFrame, index, networkObject, *updateSpan, sharedState);
 
-            if (static_cast<long long>(currentFrame) % static_cast<unsigned>(relevance) != 0)
+            // Defer update if it doesn't fit into the budget, but always send the update with the highest priority
+            if (sendMessage && msg.Tell() - messageBegin > budget)
+            {
+                msg.Resize(entryBegin);
+                numDeltaCompressedUnreliableUpdates_ = numDeltaCompressed;
+                ++numDeferredUnreliableUpdates_;
+                isUnreliableUpdateDeferred_[index] = true;
                 continue;
+            }
 
             sendMessage = true;
-            msg.WriteUInt(static_cast<unsigned>(networkObject->GetNetworkId()));
-            msg.WriteStringHash(networkObject->GetType());
-
-            msg.WriteVLE(updateSpan->size());
-            msg.Write(updateSpan->data(), updateSpan->size());
+            unreliablePriorities_[index] = 0.0f;
+            isUnreliableUpdateDeferred_[index] = false;
+            if (sentUpdates)
+                sentUpdates->objectIndices_.push_back(index);
 
             if (debugInfo)
             {
@@ -529,7 +870,61 @@ void ClientReplicationState::SendUpdateObjectsUnreliable(NetworkFrame currentFra
     });
 }
 
-void ClientReplicationState::UpdateNetworkObjects(SharedReplicationState& sharedState)
+void ClientReplicationState::PrepareObjectsRpc(const SharedReplicationState& sharedState)
+{
+    const NetworkRpcBatch& broadcastRpcBatch = sharedState.GetBroadcastRpcBatch();
+    if (rpcBatch_.IsEmpty() && broadcastRpcBatch.IsEmpty())
+        return;
+
+    // Calls are sent after added objects, so the client is guaranteed to know the objects
+    const auto isReplicated = [&](NetworkId networkId)
+    {
+        const unsigned index = GetIndex(networkId);
+        return objectRegistry_->GetNetworkObject(networkId) && index < objectsRelevance_.size()
+            && objectsRelevance_[index] != NetworkObjectRelevance::Irrelevant;
+    };
+
+    PrepareGeneratedMessage(MSG_OBJECTS_RPC, PT_RELIABLE_ORDERED,
+        [&](VectorBuffer& msg, ea::string* debugInfo)
+    {
+        const unsigned numCalls = rpcBatch_.WriteCalls(msg, isReplicated) + broadcastRpcBatch.WriteCalls(msg, isReplicated);
+
+        if (debugInfo)
+            *debugInfo = Format("{} calls", numCalls);
+        return numCalls > 0;
+    });
+}
+
+void ClientReplicationState::WriteUnreliableUpdate(VectorBuffer& msg, NetworkFrame currentFrame, unsigned index,
+    NetworkObject* networkObject, ConstByteSpan update, const SharedReplicationState& sharedState)
+{
+    // Use the latest acknowledged update as baseline if it's still in the history
+    const UnreliableBaseline& baseline = unreliableBaselines_[index];
+    if (baseline.frame_ && currentFrame - *baseline.frame_ < static_cast<int>(deltaCompressionHistory_))
+    {
+        const auto baselineUpdate = sharedState.GetPastUnreliableUpdateByIndex(index, *baseline.frame_);
+        if (baselineUpdate && baselineUpdate->size() == update.size())
+        {
+            const auto baselineAge = static_cast<unsigned>(currentFrame - *baseline.frame_);
+            msg.WriteVLE(baselineAge);
+
+            componentBuffer_.Clear();
+            WriteDeltaEncodedBuffer(componentBuffer_, *baselineUpdate, update);
+            msg.WriteBuffer(componentBuffer_.GetBuffer());
+
+            ++numDeltaCompressedUnreliableUpdates_;
+            return;
+        }
+    }
+
+    // Fall back to full update
+    msg.WriteVLE(0);
+    msg.WriteStringHash(networkObject->GetType());
+    msg.WriteVLE(update.size());
+    msg.Write(update.data(), update.size());
+}
+
+void ClientReplicationState::UpdateNetworkObjects(const SharedReplicationState& sharedState)
 {
     if (!IsSynchronized())
         return;
@@ -540,9 +935,15 @@ void ClientReplicationState::UpdateNetworkObjects(SharedReplicationState& shared
     const unsigned indexUpperBound = sharedState.GetIndexUpperBound();
     objectsRelevance_.resize(indexUpperBound, NetworkObjectRelevance::Irrelevant);
     objectsRelevanceTimeouts_.resize(indexUpperBound);
+    unreliablePriorities_.resize(indexUpperBound);
+    isUnreliableUpdateDeferred_.resize(indexUpperBound);
+    unreliableBaselines_.resize(indexUpperBound);
 
     pendingRemovedObjects_.clear();
     pendingUpdatedObjects_.clear();
+    addedObjectCandidates_.clear();
+
+    UpdateOwnedObjectPositions(sharedState);
 
     // Process removed components first
     for (NetworkId networkId : sharedState.GetRecentlyRemovedObjects())
@@ -555,6 +956,8 @@ void ClientReplicationState::UpdateNetworkObjects(SharedReplicationState& shared
         }
     }
 
+    UpdateInterest(sharedState);
+
     // Process active components
     for (NetworkObject* networkObject : sharedState.GetSortedObjects())
     {
@@ -566,6 +969,29 @@ void ClientReplicationState::UpdateNetworkObjects(SharedReplicationState& shared
         const bool isParentRelevant = parentNetworkId == InvalidNetworkId
             || objectsRelevance_[GetIndex(parentNetworkId)] != NetworkObjectRelevance::Irrelevant;
 
+        if (sharedState.IsInterestManaged(index))
+        {
+            // Relevance is already evaluated by interest grid, owned objects are always relevant
+            const bool isOwned = networkObject->GetOwnerConnection() == connection_;
+            if (!isParentRelevant)
+                objectsRelevance_[index] = NetworkObjectRelevance::Irrelevant;
+            else if (isOwned)
+                objectsRelevance_[index] = NetworkObjectRelevance::NormalUpdates;
+            else
+                objectsRelevance_[index] = interestRelevance_[index];
+
+            if (objectsRelevance_[index] != NetworkObjectRelevance::Irrelevant)
+            {
+                if (wasRelevant)
+                    pendingUpdatedObjects_.push_back({ networkObject, false });
+                else
+                    addedObjectCandidates_.push_back(networkObject);
+            }
+            else if (wasRelevant)
+                pendingRemovedObjects_.push_back(networkId);
+            continue;
+        }
+
         if (!wasRelevant && isParentRelevant)
         {
             // Begin replication of the object if both the object and its parent are relevant
@@ -573,7 +999,7 @@ void ClientReplicationState::UpdateNetworkObjects(SharedReplicationState& shared
             if (objectsRelevance_[index] != NetworkObjectRelevance::Irrelevant)
             {
                 objectsRelevanceTimeouts_[index] = relevanceTimeout;
-                pendingUpdatedObjects_.push_back({ networkObject, true });
+                addedObjectCandidates_.push_back(networkObject);
             }
         }
         else if (wasRelevant)
@@ -597,10 +1023,147 @@ void ClientReplicationState::UpdateNetworkObjects(SharedReplicationState& shared
             }
 
             // Queue non-snapshot update
-            sharedState.QueueDeltaUpdate(networkObject);
             pendingUpdatedObjects_.push_back({ networkObject, false });
         }
     }
+
+    SelectAddedObjects(indexUpperBound);
+}
+
+void ClientReplicationState::UpdateOwnedObjectPositions(const SharedReplicationState& sharedState)
+{
+    ownedObjectPositions_.clear();
+    for (NetworkObject* ownedObject : sharedState.GetOwnedObjectsByConnection(connection_))
+        ownedObjectPositions_.push_back(ownedObject->GetNode()->GetWorldPosition());
+}
+
+void ClientReplicationState::SelectAddedObjects(unsigned indexUpperBound)
+{
+    const unsigned maxAddedObjects = GetSetting(NetworkSettings::MaxAddedObjectsPerFrame).GetUInt();
+    const bool isLimited = maxAddedObjects != 0 && addedObjectCandidates_.size() > maxAddedObjects;
+
+    if (isLimited)
+    {
+        // Add objects closest to the client first
+        const float priorityDistance = GetSetting(NetworkSettings::UnreliablePriorityDistance).GetFloat();
+
+        addedObjectPrioritiesByIndex_.resize(indexUpperBound);
+        for (NetworkObject* networkObject : addedObjectCandidates_)
+        {
+            const unsigned index = GetIndex(networkObject->GetNetworkId());
+            addedObjectPrioritiesByIndex_[index] = GetDistancePriority(networkObject, priorityDistance);
+        }
+
+        // Parent cannot be added after its children, so it should be at least as important as any of them.
+        // Otherwise distant parent of many close objects would be postponed forever.
+        // Values propagated to parents that are already replicated are never used.
+        for (auto iter = addedObjectCandidates_.rbegin(); iter != addedObjectCandidates_.rend(); ++iter)
+        {
+            const NetworkId parentNetworkId = (*iter)->GetParentNetworkId();
+            if (parentNetworkId == InvalidNetworkId)
+                continue;
+
+            float& parentPriority = addedObjectPrioritiesByIndex_[GetIndex(parentNetworkId)];
+            parentPriority = ea::max(parentPriority, addedObjectPrioritiesByIndex_[GetIndex((*iter)->GetNetworkId())]);
+        }
+
+        addedObjectPriorities_.clear();
+        for (unsigned i = 0; i < addedObjectCandidates_.size(); ++i)
+        {
+            const unsigned index = GetIndex(addedObjectCandidates_[i]->GetNetworkId());
+            addedObjectPriorities_.emplace_back(addedObjectPrioritiesByIndex_[index], i);
+        }
+
+        // Candidates are in hierarchy order, so parents win ties with their children
+        const auto isHigherPriority = [](const ea::pair<float, unsigned>& lhs, const ea::pair<float, unsigned>& rhs)
+        {
+            if (lhs.first != rhs.first)
+                return lhs.first > rhs.first;
+            return lhs.second < rhs.second;
+        };
+        const auto selectedEnd = addedObjectPriorities_.begin() + maxAddedObjects;
+        ea::nth_element(addedObjectPriorities_.begin(), selectedEnd, addedObjectPriorities_.end(), isHigherPriority);
+
+        isAddedObjectSelected_.resize(indexUpperBound);
+        for (auto iter = addedObjectPriorities_.begin(); iter != selectedEnd; ++iter)
+            isAddedObjectSelected_[GetIndex(addedObjectCandidates_[iter->second]->GetNetworkId())] = true;
+    }
+
+    // Objects that are not added stay irrelevant and are evaluated again on the next frame.
+    // Candidates are in hierarchy order, so children of postponed objects are postponed too.
+    numPendingAddedObjects_ = 0;
+    for (NetworkObject* networkObject : addedObjectCandidates_)
+    {
+        const unsigned index = GetIndex(networkObject->GetNetworkId());
+        if (isLimited)
+        {
+            const NetworkId parentNetworkId = networkObject->GetParentNetworkId();
+            const bool isParentAdded = parentNetworkId == InvalidNetworkId
+                || objectsRelevance_[GetIndex(parentNetworkId)] != NetworkObjectRelevance::Irrelevant;
+
+            const bool isSelected = isAddedObjectSelected_[index];
+            isAddedObjectSelected_[index] = false;
+
+            if (!isSelected || !isParentAdded)
+            {
+                objectsRelevance_[index] = NetworkObjectRelevance::Irrelevant;
+                ++numPendingAddedObjects_;
+                continue;
+            }
+        }
+
+        pendingUpdatedObjects_.push_back({ networkObject, true });
+    }
+}
+
+void ClientReplicationState::UpdateInterest(const SharedReplicationState& sharedState)
+{
+    for (unsigned index : interestObjects_)
+        interestRelevance_[index] = NetworkObjectRelevance::Irrelevant;
+    interestObjects_.clear();
+
+    interestRelevance_.resize(sharedState.GetIndexUpperBound(), NetworkObjectRelevance::Irrelevant);
+
+    const InterestGrid& interestGrid = sharedState.GetInterestGrid();
+    if (interestGrid.GetNumObjects() == 0)
+        return;
+
+    // Query area of interest around each owned object, the closest one defines priority
+    for (NetworkObject* ownedObject : sharedState.GetOwnedObjectsByConnection(connection_))
+    {
+        const Vector3 center = ownedObject->GetNode()->GetWorldPosition();
+        interestGrid.QueryObjects(center, interestArea_.GetMaxDistance(), [&](unsigned index, float distance)
+        {
+            const bool wasRelevant = objectsRelevance_[index] != NetworkObjectRelevance::Irrelevant;
+            const NetworkObjectRelevance relevance = interestArea_.GetRelevance(distance, wasRelevant);
+            if (relevance == NetworkObjectRelevance::Irrelevant)
+                return;
+
+            NetworkObjectRelevance& objectRelevance = interestRelevance_[index];
+            if (objectRelevance == NetworkObjectRelevance::Irrelevant)
+            {
+                interestObjects_.push_back(index);
+                objectRelevance = relevance;
+            }
+            else
+                objectRelevance = ea::min(objectRelevance, relevance);
+        });
+    }
+}
+
+void ClientReplicationState::QueueSharedUpdates(SharedReplicationState& sharedState) const
+{
+    for (const auto& [networkObject, isSnapshot] : pendingUpdatedObjects_)
+    {
+        if (isSnapshot)
+            sharedState.QueueSnapshot(networkObject);
+        else
+        {
+            sharedState.QueueDeltaUpdate(networkObject);
+            if (isUnreliableUpdateDeferred_[GetIndex(networkObject->GetNetworkId())])
+                sharedState.QueueForcedUnreliableUpdate(networkObject);
+        }
+    }
 }
 
 ServerReplicator::ServerReplicator(Scene* scene)
@@ -615,6 +1178,12 @@ ServerReplicator::ServerReplicator(Scene* scene)
     SetDefaultNetworkSetting(settings_, NetworkSettings::InternalProtocolVersion);
     SetNetworkSetting(settings_, NetworkSettings::UpdateFrequency, updateFrequency_);
 
+    sharedState_->SetInterestGridCellSize(GetSetting(NetworkSettings::InterestGridCellSize).GetFloat());
+    sharedState_->SetDeltaCompressionHistory(GetSetting(NetworkSettings::DeltaCompressionHistory).GetUInt());
+
+    const float tracingDuration = GetSetting(NetworkSettings::ServerTracingDuration).GetFloat();
+    lagCompensationHistory_.SetCapacity(ea::max(1, CeilToInt(tracingDuration * updateFrequency_)));
+
     SubscribeToEvent(E_INPUTREADY, [this](StringHash, VariantMap& eventData)
     {
         using namespace InputReady;
@@ -664,15 +1233,41 @@ void ServerReplicator::OnNetworkUpdate()
     using namespace EndServerNetworkFrame;
     auto& eventData = network_->GetEventDataMap();
     eventData[P_FRAME] = static_cast<long long>(currentFrame_);
+
+    lagCompensationHistory_.BeginFrame(currentFrame_);
     network_->SendEvent(E_ENDSERVERNETWORKFRAME, eventData);
+    lagCompensationHistory_.EndFrame();
 
-    sharedState_->PrepareForUpdate();
+    // Relevance callbacks may read world transforms from worker threads
+    scene_->UpdateDirtyTransforms();
+
+    connectionsToUpdate_.clear();
     for (auto& [connection, clientState] : connections_)
+        connectionsToUpdate_.push_back(clientState);
+
+    auto workQueue = GetSubsystem<WorkQueue>();
+
+    sharedState_->PrepareForUpdate();
+    ForEachParallel(workQueue, ConnectionsPerParallelTask, connectionsToUpdate_,
+        [&](unsigned /*index*/, ClientReplicationState* clientState)
+    {
         clientState->UpdateNetworkObjects(*sharedState_);
+    });
+
+    for (ClientReplicationState* clientState : connectionsToUpdate_)
+        clientState->QueueSharedUpdates(*sharedState_);
     sharedState_->CookDeltaUpdates(currentFrame_);
 
-    for (auto& [connection, clientState] : connections_)
-        clientState->SendMessages(currentFrame_, *sharedState_);
+    ForEachParallel(workQueue, ConnectionsPerParallelTask, connectionsToUpdate_,
+        [&](unsigned /*index*/, ClientReplicationState* clientState)
+    {
+        clientState->PrepareMessages(currentFrame_, *sharedState_);
+    });
+    sharedState_->GetBroadcastRpcBatch().Clear();
+
+    // Only actual sending is serialized
+    for (ClientReplicationState* clientState : connectionsToUpdate_)
+        clientState->SendMessages();
 }
 
 void ServerReplicator::AddConnection(AbstractConnection* connection)
@@ -751,9 +1346,10 @@ ea::string ServerReplicator::GetDebugInfo() const
 
     for (const auto& [connection, clientState] : connections_)
     {
-        result += Format("Connection {}: Ping {}ms, InDelay {}+{} frames, InLoss {}%\n",
+        result += Format("Connection {}: Ping {}ms, InDelay {}+{} frames, InLoss {}%, Deferred {}, Delta {}, Pending {}\n",
             connection->ToString(), connection->GetPing(), clientState->GetInputDelay(), clientState->GetInputBufferSize(),
-            CeilToInt(clientState->GetReportedInputLoss() * 100.0f));
+            CeilToInt(clientState->GetReportedInputLoss() * 100.0f), clientState->GetNumDeferredUnreliableUpdates(),
+            clientState->GetNumDeltaCompressedUnreliableUpdates(), clientState->GetNumPendingAddedObjects());
     }
 
     return result;
@@ -770,6 +1366,30 @@ unsigned ServerReplicator::GetFeedbackDelay(AbstractConnection* connection) cons
     return iter != connections_.end() ? iter->second->GetInputDelay() + iter->second->GetInputBufferSize() : 0;
 }
 
+unsigned ServerReplicator::GetNumDeferredUnreliableUpdates(AbstractConnection* connection) const
+{
+    const ClientReplicationState* clientState = GetClientState(connection);
+    return clientState ? clientState->GetNumDeferredUnreliableUpdates() : 0;
+}
+
+unsigned ServerReplicator::GetNumDeltaCompressedUnreliableUpdates(AbstractConnection* connection) const
+{
+    const ClientReplicationState* clientState = GetClientState(connection);
+    return clientState ? clientState->GetNumDeltaCompressedUnreliableUpdates() : 0;
+}
+
+NetworkRpcBatch* ServerReplicator::GetRpcBatch(AbstractConnection* connection) const
+{
+    ClientReplicationState* clientState = GetClientState(connection);
+    return clientState ? &clientState->GetRpcBatch() : nullptr;
+}
+
+unsigned ServerReplicator::GetNumPendingAddedObjects(AbstractConnection* connection) const
+{
+    const ClientReplicationState* clientState = GetClientState(connection);
+    return clientState ? clientState->GetNumPendingAddedObjects() : 0;
+}
+
 const ea::unordered_set<NetworkObject*>& ServerReplicator::GetNetworkObjectsOwnedByConnection(AbstractConnection* connection) const
 {
     return sharedState_->GetOwnedObjectsByConnection(connection);
@@ -28,9 +28,14 @@
 #include "../Core/Timer.h"
 #include "../IO/MemoryBuffer.h"
 #include "../IO/VectorBuffer.h"
+#include "../Network/AbstractConnection.h"
 #include "../Network/ClockSynchronizer.h"
 #include "../Replica/ClientInputStatistics.h"
+#include "../Replica/InterestGrid.h"
+#include "../Replica/LagCompensationHistory.h"
 #include "../Replica/NetworkId.h"
+#include "../Replica/NetworkRpc.h"
+#include "../Replica/NetworkValue.h"
 #include "../Replica/TickSynchronizer.h"
 #include "../Replica/ProtocolMessages.h"
 
@@ -55,11 +60,20 @@ class SharedReplicationState : public RefCounted
 public:
     explicit SharedReplicationState(NetworkObjectRegistry* objectRegistry);
 
+    /// Set size of the cell of the spatial interest grid.
+    void SetInterestGridCellSize(float cellSize) { interestGrid_.SetCellSize(cellSize); }
+    /// Set number of recent frames of unreliable updates kept for delta compression.
+    void SetDeltaCompressionHistory(unsigned numFrames) { deltaCompressionHistory_ = numFrames; }
+
     /// Initial preparation for network update.
     void PrepareForUpdate();
     /// Request delta update to be prepared for specified object.
     void QueueDeltaUpdate(NetworkObject* networkObject);
-    /// Cook all requested delta updates.
+    /// Request unreliable delta update of the current state to be prepared even if the object hasn't changed.
+    void QueueForcedUnreliableUpdate(NetworkObject* networkObject);
+    /// Request snapshot to be prepared for specified object.
+    void QueueSnapshot(NetworkObject* networkObject);
+    /// Cook all requested delta updates and snapshots.
     void CookDeltaUpdates(NetworkFrame currentFrame);
 
     /// Return state of the current frame.
@@ -70,6 +84,17 @@ public:
     const ea::unordered_set<NetworkObject*>& GetOwnedObjectsByConnection(AbstractConnection* connection) const;
     ea::optional<ConstByteSpan> GetReliableUpdateByIndex(unsigned index) const;
     ea::optional<ConstByteSpan> GetUnreliableUpdateByIndex(unsigned index) const;
+    bool IsUnreliableUpdateForced(unsigned index) const { return isUnreliableUpdateForced_[index]; }
+    ea::optional<ConstByteSpan> GetSnapshotByIndex(unsigned index) const;
+    ea::optional<ConstByteSpan> GetPastUnreliableUpdateByIndex(unsigned index, NetworkFrame frame) const;
+    bool IsInterestManaged(unsigned index) const { return isInterestManaged_[index]; }
+    const InterestGrid& GetInterestGrid() const { return interestGrid_; }
+    /// @}
+
+    /// Return batch of remote procedure calls sent to all clients in the current frame.
+    /// @{
+    NetworkRpcBatch& GetBroadcastRpcBatch() { return broadcastRpcBatch_; }
+    const NetworkRpcBatch& GetBroadcastRpcBatch() const { return broadcastRpcBatch_; }
     /// @}
 
 private:
@@ -85,6 +110,8 @@ private:
 
     void ResetFrameBuffers();
     void InitializeNewObjects();
+    void UpdateInterestGrid();
+    void ResetUnreliableUpdateHistory(unsigned index);
 
     ConstByteSpan GetSpanData(const DeltaBufferSpan& span) const;
 
@@ -95,15 +122,31 @@ private:
 
     ea::vector<NetworkObject*> sortedNetworkObjects_;
 
+    ea::vector<bool> isInterestManaged_;
+    InterestGrid interestGrid_;
+
     ea::vector<bool> isDeltaUpdateQueued_;
+    ea::vector<bool> isSnapshotQueued_;
     ea::vector<bool> needReliableDeltaUpdate_;
     ea::vector<bool> needUnreliableDeltaUpdate_;
+    ea::vector<bool> isForcedUnreliableUpdateQueued_;
+    ea::vector<bool> isUnreliableUpdateForced_;
 
     VectorBuffer deltaUpdateBuffer_;
     ea::vector<DeltaBufferSpan> reliableDeltaUpdateData_;
     ea::vector<DeltaBufferSpan> unreliableDeltaUpdateData_;
+    ea::vector<DeltaBufferSpan> snapshotData_;
+
+    /// Unreliable updates of recent frames used as baselines for delta compression.
+    /// @{
+    unsigned deltaCompressionHistory_{};
+    ea::vector<NetworkValue<ByteVector>> unreliableUpdateHistory_;
+    ByteVector unreliableUpdateBuffer_;
+    /// @}
 
     ea::unordered_map<AbstractConnection*, ea::unordered_set<NetworkObject*>> ownedObjectsByConnection_;
+
+    NetworkRpcBatch broadcastRpcBatch_;
 };
 
 /// Clock synchronization state specific to individual client connection.
@@ -171,12 +214,18 @@ public:
         NetworkObjectRegistry* objectRegistry, AbstractConnection* connection, const VariantMap& settings);
 
     /// Perform network update from the perspective of this client connection.
-    void UpdateNetworkObjects(SharedReplicationState& sharedState);
+    /// Safe to call from worker threads for different clients at the same time.
+    void UpdateNetworkObjects(const SharedReplicationState& sharedState);
+    /// Request delta updates and snapshots needed by this client.
+    void QueueSharedUpdates(SharedReplicationState& sharedState) const;
 
     /// Process messages for this client.
     bool ProcessMessage(NetworkMessageId messageId, MemoryBuffer& messageData);
-    /// Send messages to connection for current frame.
-    void SendMessages(NetworkFrame currentFrame, const SharedReplicationState& sharedState);
+    /// Prepare replication messages for current frame without sending them.
+    /// Safe to call from worker threads for different clients at the same time.
+    void PrepareMessages(NetworkFrame currentFrame, const SharedReplicationState& sharedState);
+    /// Send synchronization messages and prepared replication messages to connection.
+    void SendMessages();
 
     /// Manage reported input loss.
     /// @{
@@ -184,21 +233,99 @@ public:
     float GetReportedInputLoss() const { return reportedLoss_;}
     /// @}
 
+    /// Return number of unreliable updates that didn't fit into the budget in the current frame.
+    unsigned GetNumDeferredUnreliableUpdates() const { return numDeferredUnreliableUpdates_; }
+    /// Return number of unreliable updates that were delta-compressed in the current frame.
+    unsigned GetNumDeltaCompressedUnreliableUpdates() const { return numDeltaCompressedUnreliableUpdates_; }
+    /// Return number of relevant objects that are not yet added to the client due to the limit.
+    unsigned GetNumPendingAddedObjects() const { return numPendingAddedObjects_; }
+
+    /// Return batch of remote procedure calls sent to this client in the current frame.
+    NetworkRpcBatch& GetRpcBatch() { return rpcBatch_; }
+
 private:
+    /// Replication message prepared in outgoing buffer.
+    struct OutgoingMessage
+    {
+        NetworkMessageId messageId_{};
+        PacketType messageType_{};
+        unsigned beginOffset_{};
+        unsigned endOffset_{};
+        ea::string debugInfo_;
+    };
+
+    /// Latest acknowledged unreliable update of the NetworkObject.
+    struct UnreliableBaseline
+    {
+        /// Frame of the acknowledged update that may be used as baseline.
+        ea::optional<NetworkFrame> frame_;
+        /// Acknowledgements of this and earlier frames are ignored, e.g. because object was recreated on the client.
+        NetworkFrame minFrame_{};
+    };
+
+    /// Unreliable updates sent in the frame and waiting for acknowledgement.
+    struct SentUnreliableUpdates
+    {
+        ea::optional<NetworkFrame> frame_;
+        ea::vector<unsigned> objectIndices_;
+    };
+
     void ProcessObjectsFeedbackUnreliable(MemoryBuffer& messageData);
-    void SendRemoveObjects();
-    void SendAddObjects();
-    void SendUpdateObjectsReliable(const SharedReplicationState& sharedState);
-    void SendUpdateObjectsUnreliable(NetworkFrame currentFrame, const SharedReplicationState& sharedState);
+    void ProcessAcknowledgeUpdatesUnreliable(MemoryBuffer& messageData);
+    void AcknowledgeUnreliableUpdates(NetworkFrame frame);
+    void ProcessObjectsRpc(MemoryBuffer& messageData);
+    void UpdateInterest(const SharedReplicationState& sharedState);
+    void UpdateOwnedObjectPositions(const SharedReplicationState& sharedState);
+    void SelectAddedObjects(unsigned indexUpperBound);
+    void PrepareRemoveObjects();
+    void PrepareAddObjects(const SharedReplicationState& sharedState);
+    void PrepareUpdateObjectsReliable(const SharedReplicationState& sharedState);
+    void PrepareUpdateObjectsUnreliable(NetworkFrame currentFrame, const SharedReplicationState& sharedState);
+    void PrioritizeUnreliableUpdates(NetworkFrame currentFrame, const SharedReplicationState& sharedState);
+    void PrepareObjectsRpc(const SharedReplicationState& sharedState);
+    float GetDistancePriority(NetworkObject* networkObject, float priorityDistance) const;
+    void WriteUnreliableUpdate(VectorBuffer& msg, NetworkFrame currentFrame, unsigned index, NetworkObject* networkObject,
+        ConstByteSpan update, const SharedReplicationState& sharedState);
+    template <class T> void PrepareGeneratedMessage(NetworkMessageId messageId, PacketType messageType, T generator);
 
     ea::vector<NetworkObjectRelevance> objectsRelevance_;
     ea::vector<float> objectsRelevanceTimeouts_;
 
+    InterestArea interestArea_;
+    ea::vector<NetworkObjectRelevance> interestRelevance_;
+    ea::vector<unsigned> interestObjects_;
+
+    ea::vector<float> unreliablePriorities_;
+    ea::vector<Vector3> ownedObjectPositions_;
+    ea::vector<ea::pair<float, NetworkObject*>> unreliableUpdateCandidates_;
+    /// Objects whose latest unreliable update didn't fit into the budget and is not delivered yet.
+    ea::vector<bool> isUnreliableUpdateDeferred_;
+    unsigned numDeferredUnreliableUpdates_{};
+
+    unsigned deltaCompressionHistory_{};
+    ea::vector<UnreliableBaseline> unreliableBaselines_;
+    ea::vector<SentUnreliableUpdates> sentUnreliableUpdates_;
+    unsigned numDeltaCompressedUnreliableUpdates_{};
+
+    /// Objects that become relevant in the current frame, in hierarchy order.
+    ea::vector<NetworkObject*> addedObjectCandidates_;
+    /// Priority and position in addedObjectCandidates_.
+    ea::vector<ea::pair<float, unsigned>> addedObjectPriorities_;
+    ea::vector<float> addedObjectPrioritiesByIndex_;
+    ea::vector<bool> isAddedObjectSelected_;
+    unsigned numPendingAddedObjects_{};
+    ea::optional<unsigned> sentNumPendingAddedObjects_;
+
     ea::vector<NetworkId> pendingRemovedObjects_;
     ea::vector<ea::pair<NetworkObject*, bool>> pendingUpdatedObjects_;
 
     VectorBuffer componentBuffer_;
 
+    NetworkRpcBatch rpcBatch_;
+
+    VectorBuffer outgoingBuffer_;
+    ea::vector<OutgoingMessage> outgoingMessages_;
+
     float reportedLoss_{};
 };
 
@@ -224,6 +351,9 @@ public:
     ea::string GetDebugInfo() const;
     const Variant& GetSetting(const NetworkSetting& setting) const;
     unsigned GetFeedbackDelay(AbstractConnection* connection) const;
+    unsigned GetNumDeferredUnreliableUpdates(AbstractConnection* connection) const;
+    unsigned GetNumDeltaCompressedUnreliableUpdates(AbstractConnection* connection) const;
+    unsigned GetNumPendingAddedObjects(AbstractConnection* connection) const;
     const ea::unordered_set<NetworkObject*>& GetNetworkObjectsOwnedByConnection(AbstractConnection* connection) const;
     NetworkObject* GetNetworkObjectOwnedByConnection(AbstractConnection* connection) const;
     NetworkTime GetServerTime() const { return NetworkTime{currentFrame_}; }
@@ -231,12 +361,28 @@ public:
     NetworkFrame GetCurrentFrame() const { return currentFrame_; }
     /// @}
 
+    /// Return batches of remote procedure calls sent at the end of the current frame.
+    /// @{
+    NetworkRpcBatch* GetRpcBatch(AbstractConnection* connection) const;
+    NetworkRpcBatch& GetBroadcastRpcBatch() { return sharedState_->GetBroadcastRpcBatch(); }
+    /// @}
+
+    /// Return hitbox history used for lag compensation.
+    /// Hitboxes are recorded by LagCompensatedHitbox at the end of each network frame.
+    /// @{
+    LagCompensationHistory& GetLagCompensationHistory() { return lagCompensationHistory_; }
+    const LagCompensationHistory& GetLagCompensationHistory() const { return lagCompensationHistory_; }
+    /// @}
+
 private:
     void OnInputReady(float timeStep, bool isUpdateNow, float overtime);
     void OnNetworkUpdate();
 
     ClientReplicationState* GetClientState(AbstractConnection* connection) const;
 
+    /// Number of client connections updated in one WorkQueue task.
+    static const unsigned ConnectionsPerParallelTask = 1;
+
     const WeakPtr<Network> network_;
     const WeakPtr<Scene> scene_;
     const WeakPtr<NetworkObjectRegistry> objectRegistry_;
@@ -250,6 +396,10 @@ private:
 
     SharedPtr<SharedReplicationState> sharedState_;
     ea::unordered_map<AbstractConnection*, SharedPtr<ClientReplicationState>> connections_;
+
+    ea::vector<ClientReplicationState*> connectionsToUpdate_;
+
+    LagCompensationHistory lagCompensationHistory_;
 };
 
 }
@@ -101,6 +101,12 @@ void TrackedAnimatedModel::OnServerFrameEnd(NetworkFrame frame)
             positions[i] = node->GetWorldPosition();
             rotations[i] = node->GetWorldRotation();
         }
+        else if (!animatedModel_->GetCreateBoneNodes())
+        {
+            const Matrix3x4 boneTransform = animatedModel_->GetBoneWorldTransform(i);
+            positions[i] = boneTransform.Translation();
+            rotations[i] = boneTransform.Rotation();
+        }
         else
         {
             positions[i] = Vector3::ZERO;
@@ -144,7 +150,11 @@ void TrackedAnimatedModel::ProcessTemporalRayQuery(const NetworkTime& time, cons
     {
         const Vector3 position = bonePositions[i];
         const Quaternion rotation = boneRotations[i];
-        const Vector3 scale = bones[i].node_ ? bones[i].node_->GetWorldScale() : Vector3::ONE;
+        Vector3 scale = Vector3::ONE;
+        if (bones[i].node_)
+            scale = bones[i].node_->GetWorldScale();
+        else if (!animatedModel_->GetCreateBoneNodes())
+            scale = animatedModel_->GetBoneWorldTransform(i).Scale();
         boneTransforms[i] = Matrix3x4{position, rotation, scale};
     }
 
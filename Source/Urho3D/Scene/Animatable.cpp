@@ -31,6 +31,7 @@
 #include "../Resource/XMLElement.h"
 #include "../Scene/Animatable.h"
 #include "../Scene/ObjectAnimation.h"
+#include "../Scene/Scene.h"
 #include "../Scene/SceneEvents.h"
 #include "../Scene/ValueAnimation.h"
 
@@ -62,13 +63,69 @@ void AttributeAnimationInfo::ApplyValue(const Variant& newValue)
     }
 }
 
+bool AttributeAnimationInfo::ApplyNativeValue(float scaledTime)
+{
+    // Animation type may change if key frames are reset
+    const VariantType valueType = animation_->GetValueType();
+    if (valueType != boundValueType_)
+        BindNativeValueSetter(valueType);
+
+    auto* animatable = static_cast<Animatable*>(target_.Get());
+    if (!applyNativeValue_ || !animatable)
+        return false;
+
+    return (this->*applyNativeValue_)(animatable, scaledTime);
+}
+
+void AttributeAnimationInfo::BindNativeValueSetter(VariantType valueType)
+{
+    boundValueType_ = valueType;
+    applyNativeValue_ = nullptr;
+
+    auto* animatable = static_cast<Animatable*>(target_.Get());
+    if (!animatable || !animatable->SupportsNativeAttributeAnimation())
+        return;
+
+    if (valueType != attributeInfo_.type_ || !attributeInfo_.accessor_ || attributeInfo_.accessor_->GetValueType() != valueType)
+        return;
+
+    switch (valueType)
+    {
+    case VAR_FLOAT: applyNativeValue_ = &AttributeAnimationInfo::ApplyNativeValueImpl<float>; break;
+    case VAR_DOUBLE: applyNativeValue_ = &AttributeAnimationInfo::ApplyNativeValueImpl<double>; break;
+    case VAR_VECTOR2: applyNativeValue_ = &AttributeAnimationInfo::ApplyNativeValueImpl<Vector2>; break;
+    case VAR_VECTOR3: applyNativeValue_ = &AttributeAnimationInfo::ApplyNativeValueImpl<Vector3>; break;
+    case VAR_VECTOR4: applyNativeValue_ = &AttributeAnimationInfo::ApplyNativeValueImpl<Vector4>; break;
+    case VAR_QUATERNION: applyNativeValue_ = &AttributeAnimationInfo::ApplyNativeValueImpl<Quaternion>; break;
+    case VAR_COLOR: applyNativeValue_ = &AttributeAnimationInfo::ApplyNativeValueImpl<Color>; break;
+    case VAR_INTRECT: applyNativeValue_ = &AttributeAnimationInfo::ApplyNativeValueImpl<IntRect>; break;
+    case VAR_INTVECTOR2: applyNativeValue_ = &AttributeAnimationInfo::ApplyNativeValueImpl<IntVector2>; break;
+    case VAR_INTVECTOR3: applyNativeValue_ = &AttributeAnimationInfo::ApplyNativeValueImpl<IntVector3>; break;
+    default: break;
+    }
+}
+
+template <class T> bool AttributeAnimationInfo::ApplyNativeValueImpl(Animatable* animatable, float scaledTime)
+{
+    const T value = animation_->SampleValue<T>(scaledTime);
+    if (!animatable->OnSetAttributeValue(attributeInfo_, &value))
+        return false;
+
+    animatable->ApplyAttributes();
+    return true;
+}
+
 Animatable::Animatable(Context* context) :
     Serializable(context),
     animationEnabled_(true)
 {
 }
 
-Animatable::~Animatable() = default;
+Animatable::~Animatable()
+{
+    if (attributeAnimationScene_)
+        attributeAnimationScene_->RemoveAttributeAnimationTarget(this);
+}
 
 void Animatable::RegisterObject(Context* context)
 {
@@ -527,6 +584,18 @@ void Animatable::UpdateAttributeAnimations(float timeStep)
         SetAttributeAnimation(finishedNames[i], nullptr);
 }
 
+void Animatable::SetAttributeAnimationScene(Scene* scene)
+{
+    if (attributeAnimationScene_ == scene)
+        return;
+
+    if (attributeAnimationScene_)
+        attributeAnimationScene_->RemoveAttributeAnimationTarget(this);
+    attributeAnimationScene_ = scene;
+    if (attributeAnimationScene_)
+        attributeAnimationScene_->AddAttributeAnimationTarget(this);
+}
+
 AttributeAnimationInfo* Animatable::GetAttributeAnimationInfo(const ea::string& name) const
 {
     auto i = attributeAnimationInfos_.find(
@@ -32,6 +32,7 @@ namespace Urho3D
 {
 
 class Animatable;
+class Scene;
 class ValueAnimation;
 class AttributeAnimationInfo;
 class ObjectAnimation;
@@ -55,16 +56,28 @@ public:
 protected:
     /// Apply new animation value to the target object. Called by Update().
     void ApplyValue(const Variant& newValue) override;
+    /// Sample animation and apply value to the target object through typed attribute setter. Called by Update().
+    bool ApplyNativeValue(float scaledTime) override;
 
 private:
+    /// Bind typed value setter for the value type of the animation.
+    void BindNativeValueSetter(VariantType valueType);
+    /// Sample animation value of type T and apply it to the target object.
+    template <class T> bool ApplyNativeValueImpl(Animatable* animatable, float scaledTime);
+
     /// Attribute information.
     const AttributeInfo& attributeInfo_;
+    /// Value type of the animation for which the typed setter is bound.
+    VariantType boundValueType_{VAR_NONE};
+    /// Typed setter, null if the value should be applied through Variant.
+    bool (AttributeAnimationInfo::*applyNativeValue_)(Animatable* animatable, float scaledTime){};
 };
 
 /// Base class for animatable object, an animatable object can be set animation on it's attributes, or can be set an object animation to it.
 class URHO3D_API Animatable : public Serializable
 {
     URHO3D_OBJECT(Animatable, Serializable);
+    friend class Scene;
 
 public:
     /// Construct.
@@ -84,6 +97,10 @@ public:
     /// Save as JSON data. Return true if successful.
     bool SaveJSON(JSONValue& dest) const override;
 
+    /// Return whether attribute animations may set attributes through typed accessors, bypassing OnSetAttribute.
+    /// Subclasses may override OnSetAttribute, so only specific types without such overrides should return true.
+    virtual bool SupportsNativeAttributeAnimation() const { return false; }
+
     /// Set automatic update of animation, default true.
     /// @property
     void SetAnimationEnabled(bool enable);
@@ -143,6 +160,8 @@ protected:
     void OnObjectAnimationRemoved(ObjectAnimation* objectAnimation);
     /// Update attribute animations.
     void UpdateAttributeAnimations(float timeStep);
+    /// Set scene that updates attribute animations of this object in batch. Null to stop updating.
+    void SetAttributeAnimationScene(Scene* scene);
     /// Return attribute animation info.
     AttributeAnimationInfo* GetAttributeAnimationInfo(const ea::string& name) const;
     /// Handle attribute animation added.
@@ -156,6 +175,12 @@ protected:
     SharedPtr<ObjectAnimation> objectAnimation_;
     /// Attribute animation infos.
     ea::unordered_map<ea::string, SharedPtr<AttributeAnimationInfo> > attributeAnimationInfos_;
+
+private:
+    /// Scene that updates attribute animations in batch.
+    WeakPtr<Scene> attributeAnimationScene_;
+    /// Index in the attribute animation update list of the scene.
+    unsigned attributeAnimationSceneIndex_{M_MAX_UNSIGNED};
 };
 
 }
@@ -28,12 +28,6 @@
 #include "../Scene/Component.h"
 #include "../Scene/Scene.h"
 #include "../Scene/SceneEvents.h"
-#ifdef URHO3D_PHYSICS
-#include "../Physics/PhysicsWorld.h"
-#endif
-#ifdef URHO3D_PHYSICS2D
-#include "../Physics2D/PhysicsWorld2D.h"
-#endif
 
 #include "../DebugNew.h"
 
@@ -146,13 +140,13 @@ Scene* Component::GetScene() const
 void Component::OnAttributeAnimationAdded()
 {
     if (attributeAnimationInfos_.size() == 1)
-        SubscribeToEvent(GetScene(), E_ATTRIBUTEANIMATIONUPDATE, URHO3D_HANDLER(Component, HandleAttributeAnimationUpdate));
+        SetAttributeAnimationScene(GetScene());
 }
 
 void Component::OnAttributeAnimationRemoved()
 {
     if (attributeAnimationInfos_.empty())
-        UnsubscribeFromEvent(GetScene(), E_ATTRIBUTEANIMATIONUPDATE);
+        SetAttributeAnimationScene(nullptr);
 }
 
 void Component::OnNodeSet(Node* node)
@@ -207,30 +201,10 @@ void Component::GetComponents(ea::vector<Component*>& dest, StringHash type) con
         dest.clear();
 }
 
-void Component::HandleAttributeAnimationUpdate(StringHash eventType, VariantMap& eventData)
-{
-    using namespace AttributeAnimationUpdate;
-
-    UpdateAttributeAnimations(eventData[P_TIMESTEP].GetFloat());
-}
-
 Component* Component::GetFixedUpdateSource()
 {
-    Component* ret = nullptr;
     Scene* scene = GetScene();
-
-    if (scene)
-    {
-#ifdef URHO3D_PHYSICS
-        ret = scene->GetComponent<PhysicsWorld>();
-#endif
-#ifdef URHO3D_PHYSICS2D
-        if (!ret)
-            ret = scene->GetComponent<PhysicsWorld2D>();
-#endif
-    }
-
-    return ret;
+    return scene ? scene->GetFixedUpdateSource() : nullptr;
 }
 
 void Component::DoAutoRemove(AutoRemoveMode mode)
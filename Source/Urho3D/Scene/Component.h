@@ -49,6 +49,7 @@ class URHO3D_API Component : public Animatable
 
     friend class Node;
     friend class Scene;
+    friend class SceneComponentIndex;
 
 public:
     /// Construct.
@@ -127,8 +128,6 @@ protected:
     void SetID(unsigned id);
     /// Set scene node. Called by Node when creating the component.
     void SetNode(Node* node);
-    /// Handle scene attribute animation update event.
-    void HandleAttributeAnimationUpdate(StringHash eventType, VariantMap& eventData);
     /// Return a component from the scene root that sends out fixed update events (either PhysicsWorld or PhysicsWorld2D). Return null if neither exists.
     Component* GetFixedUpdateSource();
     /// Perform autoremove. Called by subclasses. Caller should keep a weak pointer to itself to check whether was actually removed, and return immediately without further member operations in that case.
@@ -142,6 +141,8 @@ protected:
     bool networkUpdate_;
     /// Enabled flag.
     bool enabled_;
+    /// Handle in the scene component index, if indexed.
+    unsigned sceneIndexHandle_{M_MAX_UNSIGNED};
 };
 
 template <class T> T* Component::GetComponent() const { return static_cast<T*>(GetComponent(T::GetTypeStatic())); }
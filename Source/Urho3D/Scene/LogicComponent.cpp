@@ -23,9 +23,6 @@
 #include "../Precompiled.h"
 
 #include "../IO/Log.h"
-#if defined(URHO3D_PHYSICS) || defined(URHO3D_PHYSICS2D)
-#include "../Physics/PhysicsEvents.h"
-#endif
 #include "../Scene/LogicComponent.h"
 #include "../Scene/Scene.h"
 #include "../Scene/SceneEvents.h"
@@ -97,15 +94,7 @@ void LogicComponent::OnSceneSet(Scene* scene)
     if (scene)
         UpdateEventSubscription();
     else
-    {
-        UnsubscribeFromEvent(E_SCENEUPDATE);
-        UnsubscribeFromEvent(GetPostUpdateEvent());
-#if defined(URHO3D_PHYSICS) || defined(URHO3D_PHYSICS2D)
-        UnsubscribeFromEvent(E_PHYSICSPRESTEP);
-        UnsubscribeFromEvent(E_PHYSICSPOSTSTEP);
-#endif
-        currentEventMask_ = USE_NO_EVENT;
-    }
+        RemoveFromUpdateLists();
 }
 
 void LogicComponent::UpdateEventSubscription()
@@ -114,119 +103,142 @@ void LogicComponent::UpdateEventSubscription()
     if (!scene)
         return;
 
-    bool enabled = IsEnabledEffective();
-
-    bool needUpdate = enabled && ((updateEventMask_ & USE_UPDATE) || !delayedStartCalled_);
-    if (needUpdate && !(currentEventMask_ & USE_UPDATE))
+    // Component may be moved to another scene
+    if (updateScene_ != scene)
     {
-        SubscribeToEvent(scene, E_SCENEUPDATE, URHO3D_HANDLER(LogicComponent, HandleSceneUpdate));
-        currentEventMask_ |= USE_UPDATE;
-    }
-    else if (!needUpdate && (currentEventMask_ & USE_UPDATE))
-    {
-        UnsubscribeFromEvent(scene, E_SCENEUPDATE);
-        currentEventMask_ &= ~USE_UPDATE;
+        RemoveFromUpdateLists();
+        updateScene_ = scene;
     }
 
-    bool needPostUpdate = enabled && (updateEventMask_ & USE_POSTUPDATE);
-    if (needPostUpdate && !(currentEventMask_ & USE_POSTUPDATE))
+    const bool enabled = IsEnabledEffective();
+
+    const bool needUpdate = enabled && ((updateEventMask_ & USE_UPDATE) || !delayedStartCalled_);
+    SetUpdateStageEnabled(scene, USE_UPDATE, LogicUpdateStage::Update, needUpdate);
+
+    const bool needPostUpdate = enabled && (updateEventMask_ & USE_POSTUPDATE);
+    const StringHash postUpdateEvent = GetPostUpdateEvent();
+    if (postUpdateEvent == E_SCENEPOSTUPDATE)
+        SetUpdateStageEnabled(scene, USE_POSTUPDATE, LogicUpdateStage::PostUpdate, needPostUpdate);
+    else if (needPostUpdate && !(currentEventMask_ & USE_POSTUPDATE))
     {
-        SubscribeToEvent(scene, GetPostUpdateEvent(), URHO3D_HANDLER(LogicComponent, HandleScenePostUpdate));
+        SubscribeToEvent(scene, postUpdateEvent, URHO3D_HANDLER(LogicComponent, HandleScenePostUpdate));
         currentEventMask_ |= USE_POSTUPDATE;
     }
     else if (!needPostUpdate && (currentEventMask_ & USE_POSTUPDATE))
     {
-        UnsubscribeFromEvent(scene, GetPostUpdateEvent());
+        UnsubscribeFromEvent(scene, postUpdateEvent);
         currentEventMask_ &= ~USE_POSTUPDATE;
     }
 
 #if defined(URHO3D_PHYSICS) || defined(URHO3D_PHYSICS2D)
-    Component* world = GetFixedUpdateSource();
-    if (!world)
+    const bool needFixedUpdate = enabled && (updateEventMask_ & USE_FIXEDUPDATE);
+    SetUpdateStageEnabled(scene, USE_FIXEDUPDATE, LogicUpdateStage::FixedUpdate, needFixedUpdate);
+
+    const bool needFixedPostUpdate = enabled && (updateEventMask_ & USE_FIXEDPOSTUPDATE);
+    SetUpdateStageEnabled(scene, USE_FIXEDPOSTUPDATE, LogicUpdateStage::FixedPostUpdate, needFixedPostUpdate);
+#endif
+}
+
+void LogicComponent::SetUpdateStageEnabled(Scene* scene, UpdateEvent event, LogicUpdateStage stage, bool enable)
+{
+    const bool isEnabled = !!(currentEventMask_ & event);
+    if (enable == isEnabled)
         return;
 
-    bool needFixedUpdate = enabled && (updateEventMask_ & USE_FIXEDUPDATE);
-    if (needFixedUpdate && !(currentEventMask_ & USE_FIXEDUPDATE))
+    LogicComponentScheduler& scheduler = scene->GetLogicComponentScheduler();
+    if (enable)
     {
-        SubscribeToEvent(world, E_PHYSICSPRESTEP, URHO3D_HANDLER(LogicComponent, HandlePhysicsPreStep));
-        currentEventMask_ |= USE_FIXEDUPDATE;
+        scheduler.AddComponent(this, stage);
+        currentEventMask_ |= event;
     }
-    else if (!needFixedUpdate && (currentEventMask_ & USE_FIXEDUPDATE))
+    else
     {
-        UnsubscribeFromEvent(world, E_PHYSICSPRESTEP);
-        currentEventMask_ &= ~USE_FIXEDUPDATE;
+        scheduler.RemoveComponent(this, stage);
+        currentEventMask_ &= ~event;
     }
+}
 
-    bool needFixedPostUpdate = enabled && (updateEventMask_ & USE_FIXEDPOSTUPDATE);
-    if (needFixedPostUpdate && !(currentEventMask_ & USE_FIXEDPOSTUPDATE))
-    {
-        SubscribeToEvent(world, E_PHYSICSPOSTSTEP, URHO3D_HANDLER(LogicComponent, HandlePhysicsPostStep));
-        currentEventMask_ |= USE_FIXEDPOSTUPDATE;
-    }
-    else if (!needFixedPostUpdate && (currentEventMask_ & USE_FIXEDPOSTUPDATE))
+void LogicComponent::RemoveFromUpdateLists()
+{
+    // Scene may be already destroyed together with its update lists
+    if (Scene* scene = updateScene_)
     {
-        UnsubscribeFromEvent(world, E_PHYSICSPOSTSTEP);
-        currentEventMask_ &= ~USE_FIXEDPOSTUPDATE;
+        SetUpdateStageEnabled(scene, USE_UPDATE, LogicUpdateStage::Update, false);
+        SetUpdateStageEnabled(scene, USE_FIXEDUPDATE, LogicUpdateStage::FixedUpdate, false);
+        SetUpdateStageEnabled(scene, USE_FIXEDPOSTUPDATE, LogicUpdateStage::FixedPostUpdate, false);
+
+        const StringHash postUpdateEvent = GetPostUpdateEvent();
+        if (postUpdateEvent == E_SCENEPOSTUPDATE)
+            SetUpdateStageEnabled(scene, USE_POSTUPDATE, LogicUpdateStage::PostUpdate, false);
+        else
+            UnsubscribeFromEvent(scene, postUpdateEvent);
     }
-#endif
+
+    updateScene_ = nullptr;
+    currentEventMask_ = USE_NO_EVENT;
 }
 
-void LogicComponent::HandleSceneUpdate(StringHash eventType, VariantMap& eventData)
+void LogicComponent::ApplyDelayedStart()
 {
-    using namespace SceneUpdate;
+    WeakPtr<LogicComponent> self(this);
 
     // Execute user-defined delayed start function before first update
-    if (!delayedStartCalled_)
-    {
-        DelayedStart();
-        delayedStartCalled_ = true;
+    DelayedStart();
+    if (self.Expired())
+        return;
 
-        // If did not need actual update events, unsubscribe now
-        if (!(updateEventMask_ & USE_UPDATE))
-        {
-            UnsubscribeFromEvent(GetScene(), E_SCENEUPDATE);
-            currentEventMask_ &= ~USE_UPDATE;
-            return;
-        }
-    }
+    delayedStartCalled_ = true;
 
-    // Then execute user-defined update function
-    Update(eventData[P_TIMESTEP].GetFloat());
+    // If did not need actual update events, stop updates now
+    UpdateEventSubscription();
 }
 
-void LogicComponent::HandleScenePostUpdate(StringHash eventType, VariantMap& eventData)
+void LogicComponent::ProcessUpdate(LogicUpdateStage stage, float timeStep)
 {
-    using namespace ScenePostUpdate;
+    switch (stage)
+    {
+    case LogicUpdateStage::Update:
+        if (!delayedStartCalled_)
+        {
+            WeakPtr<LogicComponent> self(this);
+            ApplyDelayedStart();
+            if (self.Expired() || !(currentEventMask_ & USE_UPDATE))
+                return;
+        }
+        Update(timeStep);
+        break;
 
-    // Execute user-defined post-update function
-    PostUpdate(eventData[P_TIMESTEP].GetFloat());
-}
+    case LogicUpdateStage::PostUpdate:
+        PostUpdate(timeStep);
+        break;
 
-#if defined(URHO3D_PHYSICS) || defined(URHO3D_PHYSICS2D)
+    case LogicUpdateStage::FixedUpdate:
+        // Execute user-defined delayed start function before first fixed update if not called yet
+        if (!delayedStartCalled_)
+        {
+            WeakPtr<LogicComponent> self(this);
+            ApplyDelayedStart();
+            if (self.Expired())
+                return;
+        }
+        FixedUpdate(timeStep);
+        break;
 
-void LogicComponent::HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData)
-{
-    using namespace PhysicsPreStep;
+    case LogicUpdateStage::FixedPostUpdate:
+        FixedPostUpdate(timeStep);
+        break;
 
-    // Execute user-defined delayed start function before first fixed update if not called yet
-    if (!delayedStartCalled_)
-    {
-        DelayedStart();
-        delayedStartCalled_ = true;
+    default:
+        break;
     }
-
-    // Execute user-defined fixed update function
-    FixedUpdate(eventData[P_TIMESTEP].GetFloat());
 }
 
-void LogicComponent::HandlePhysicsPostStep(StringHash eventType, VariantMap& eventData)
+void LogicComponent::HandleScenePostUpdate(StringHash eventType, VariantMap& eventData)
 {
-    using namespace PhysicsPostStep;
+    using namespace ScenePostUpdate;
 
-    // Execute user-defined fixed post-update function
-    FixedPostUpdate(eventData[P_TIMESTEP].GetFloat());
+    // Execute user-defined post-update function
+    PostUpdate(eventData[P_TIMESTEP].GetFloat());
 }
 
-#endif
-
 }
@@ -26,6 +26,7 @@
 
 #include "../Container/FlagSet.h"
 #include "../Scene/Component.h"
+#include "../Scene/LogicComponentScheduler.h"
 
 namespace Urho3D
 {
@@ -45,7 +46,8 @@ enum UpdateEvent : unsigned
 };
 URHO3D_FLAGSET(UpdateEvent, UpdateEventFlags);
 
-/// Helper base class for user-defined game logic components that hooks up to update events and forwards them to virtual functions similar to ScriptInstance class.
+/// Helper base class for user-defined game logic components that are updated by the Scene and forward updates to virtual functions similar to ScriptInstance class.
+/// Components are updated in lists grouped by type instead of individual event subscriptions.
 class URHO3D_API LogicComponent : public Component
 {
     URHO3D_OBJECT(LogicComponent, Component);
@@ -77,7 +79,12 @@ class URHO3D_API LogicComponent : public Component
     virtual void FixedPostUpdate(float timeStep);
 
     /// Return post update event type. Should stay the same for any given instance of the component.
+    /// Components with post update event other than E_SCENEPOSTUPDATE are updated via event subscription.
     virtual StringHash GetPostUpdateEvent() const;
+    /// Return whether update functions of different instances may be called concurrently from worker threads.
+    /// Thread-safe components may modify only their own node hierarchy and must not create or remove nodes and components during update.
+    /// Should stay the same for all instances of the type.
+    virtual bool IsThreadSafeUpdate() const { return false; }
 
     /// Set what update events should be subscribed to. Use this for optimization: by default all are in use. Note that this is not an attribute and is not saved or network-serialized, therefore it should always be called eg. in the subclass constructor.
     void SetUpdateEventMask(UpdateEventFlags mask);
@@ -88,6 +95,14 @@ class URHO3D_API LogicComponent : public Component
     /// Return whether the DelayedStart() function has been called.
     bool IsDelayedStartCalled() const { return delayedStartCalled_; }
 
+    /// Internal. Manage update lists of the Scene.
+    /// @{
+    void SetUpdateListIndex(LogicUpdateStage stage, unsigned index) { updateListIndices_[static_cast<unsigned>(stage)] = index; }
+    unsigned GetUpdateListIndex(LogicUpdateStage stage) const { return updateListIndices_[static_cast<unsigned>(stage)]; }
+    void ApplyDelayedStart();
+    void ProcessUpdate(LogicUpdateStage stage, float timeStep);
+    /// @}
+
 protected:
     /// Handle scene node being assigned at creation.
     void OnNodeSet(Node* node) override;
@@ -95,24 +110,24 @@ protected:
     void OnSceneSet(Scene* scene) override;
 
 private:
-    /// Subscribe/unsubscribe to update events based on current enabled state and update event mask.
+    /// Add to/remove from update lists of the Scene based on current enabled state and update event mask.
     void UpdateEventSubscription();
-    /// Handle scene update event.
-    void HandleSceneUpdate(StringHash eventType, VariantMap& eventData);
-    /// Handle scene post-update event.
+    /// Add to or remove from update list of the Scene.
+    void SetUpdateStageEnabled(Scene* scene, UpdateEvent event, LogicUpdateStage stage, bool enable);
+    /// Remove from all update lists of the Scene.
+    void RemoveFromUpdateLists();
+    /// Handle custom post-update event.
     void HandleScenePostUpdate(StringHash eventType, VariantMap& eventData);
-#if defined(URHO3D_PHYSICS) || defined(URHO3D_PHYSICS2D)
-    /// Handle physics pre-step event.
-    void HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData);
-    /// Handle physics post-step event.
-    void HandlePhysicsPostStep(StringHash eventType, VariantMap& eventData);
-#endif
     /// Requested event subscription mask.
     UpdateEventFlags updateEventMask_;
     /// Current event subscription mask.
     UpdateEventFlags currentEventMask_;
     /// Flag for delayed start.
     bool delayedStartCalled_;
+    /// Scene whose update lists contain this component.
+    WeakPtr<Scene> updateScene_;
+    /// Indices in update lists of the Scene.
+    unsigned updateListIndices_[static_cast<unsigned>(LogicUpdateStage::Count)]{};
 };
 
 }
@@ -0,0 +1,157 @@
+//
+// Copyright (c) 2008-2022 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+#include "../Precompiled.h"
+
+#include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
+#include "../Scene/LogicComponent.h"
+#include "../Scene/LogicComponentScheduler.h"
+#include "../Scene/Scene.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+unsigned LogicComponentScheduler::ComponentIndex::GetIndex(const LogicComponent* component) const
+{
+    return component->GetUpdateListIndex(stage_);
+}
+
+void LogicComponentScheduler::ComponentIndex::SetIndex(LogicComponent* component, unsigned index) const
+{
+    component->SetUpdateListIndex(stage_, index);
+}
+
+void LogicComponentScheduler::AddComponent(LogicComponent* component, LogicUpdateStage stage)
+{
+    StageData& stageData = stages_[static_cast<unsigned>(stage)];
+
+    const StringHash componentType = component->GetType();
+    auto iter = stageData.groupIndexByType_.find(componentType);
+    if (iter == stageData.groupIndexByType_.end())
+    {
+        iter = stageData.groupIndexByType_.emplace(componentType, stageData.groups_.size()).first;
+        TypeGroup& newGroup = stageData.groups_.emplace_back();
+        newGroup.type_ = componentType;
+        newGroup.threadSafe_ = component->IsThreadSafeUpdate();
+        newGroup.components_ = StableIndexVector<LogicComponent, ComponentIndex>{ComponentIndex{stage}};
+    }
+
+    TypeGroup& group = stageData.groups_[iter->second];
+    group.components_.Add(component);
+    ++stageData.numComponents_;
+}
+
+void LogicComponentScheduler::RemoveComponent(LogicComponent* component, LogicUpdateStage stage)
+{
+    StageData& stageData = stages_[static_cast<unsigned>(stage)];
+
+    const auto iter = stageData.groupIndexByType_.find(component->GetType());
+    if (iter == stageData.groupIndexByType_.end())
+        return;
+
+    // Don't shift other components here, the group may be iterated right now
+    TypeGroup& group = stageData.groups_[iter->second];
+    if (group.components_.Remove(component))
+        --stageData.numComponents_;
+}
+
+void LogicComponentScheduler::Update(Scene* scene, LogicUpdateStage stage, float timeStep)
+{
+    StageData& stageData = stages_[static_cast<unsigned>(stage)];
+
+    // Nested update of the same stage is not supported
+    if (stageData.updating_)
+        return;
+
+    stageData.updating_ = true;
+
+    // Iterate by index: new groups may be added during the update
+    for (unsigned groupIndex = 0; groupIndex < stageData.groups_.size(); ++groupIndex)
+    {
+        TypeGroup& group = stageData.groups_[groupIndex];
+        group.components_.Compact();
+
+        if (group.threadSafe_ && group.components_.Size() >= MinComponentsForParallelUpdate)
+            UpdateGroupInParallel(scene, stageData, groupIndex, stage, timeStep);
+        else
+            UpdateGroup(stageData, groupIndex, stage, timeStep);
+    }
+
+    stageData.updating_ = false;
+}
+
+unsigned LogicComponentScheduler::GetNumComponents(LogicUpdateStage stage) const
+{
+    return stages_[static_cast<unsigned>(stage)].numComponents_;
+}
+
+void LogicComponentScheduler::UpdateGroup(StageData& stageData, unsigned groupIndex, LogicUpdateStage stage, float timeStep)
+{
+    // Components added during the update will be updated next time.
+    // Don't keep references to the group and its elements, any component may be added or removed.
+    const unsigned numComponents = stageData.groups_[groupIndex].components_.Size();
+    for (unsigned i = 0; i < numComponents; ++i)
+    {
+        if (LogicComponent* component = stageData.groups_[groupIndex].components_[i])
+            component->ProcessUpdate(stage, timeStep);
+    }
+}
+
+void LogicComponentScheduler::UpdateGroupInParallel(Scene* scene, StageData& stageData, unsigned groupIndex,
+    LogicUpdateStage stage, float timeStep)
+{
+    URHO3D_PROFILE("UpdateLogicComponentsInParallel");
+
+    // Delayed start may change the scene, call it in the main thread first
+    const unsigned numComponents = stageData.groups_[groupIndex].components_.Size();
+    if (stage == LogicUpdateStage::Update || stage == LogicUpdateStage::FixedUpdate)
+    {
+        for (unsigned i = 0; i < numComponents; ++i)
+        {
+            LogicComponent* component = stageData.groups_[groupIndex].components_[i];
+            if (component && !component->IsDelayedStartCalled())
+                component->ApplyDelayedStart();
+        }
+    }
+
+    // Thread-safe components are not allowed to add or remove components during the update
+    const TypeGroup& group = stageData.groups_[groupIndex];
+
+    auto workQueue = scene->GetSubsystem<WorkQueue>();
+    scene->BeginThreadedUpdate();
+    ForEachParallel(workQueue, ComponentsPerParallelTask, numComponents,
+        [&](unsigned beginIndex, unsigned endIndex)
+    {
+        for (unsigned i = beginIndex; i < endIndex; ++i)
+        {
+            if (LogicComponent* component = group.components_[i])
+                component->ProcessUpdate(stage, timeStep);
+        }
+    });
+    scene->EndThreadedUpdate();
+}
+
+}
@@ -0,0 +1,115 @@
+//
+// Copyright (c) 2008-2022 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+
+/// \file
+
+#pragma once
+
+#include "../Container/Ptr.h"
+#include "../Container/StableIndexVector.h"
+#include "../Math/StringHash.h"
+
+#include <EASTL/unordered_map.h>
+#include <EASTL/vector.h>
+
+namespace Urho3D
+{
+
+class LogicComponent;
+class Scene;
+
+/// Update stage of LogicComponent.
+enum class LogicUpdateStage
+{
+    Update,
+    PostUpdate,
+    FixedUpdate,
+    FixedPostUpdate,
+    Count
+};
+
+/// Lists of LogicComponent-s updated by the Scene, grouped by component type.
+/// Components are updated in tight loops instead of individual event subscriptions.
+/// Components of thread-safe types are updated in parallel.
+class URHO3D_API LogicComponentScheduler
+{
+public:
+    /// Min number of components of thread-safe type to update them in parallel.
+    static const unsigned MinComponentsForParallelUpdate = 128;
+    /// Number of components processed by one parallel task.
+    static const unsigned ComponentsPerParallelTask = 64;
+
+    /// Add component to update stage.
+    void AddComponent(LogicComponent* component, LogicUpdateStage stage);
+    /// Remove component from update stage. Safe to call from update of any component.
+    void RemoveComponent(LogicComponent* component, LogicUpdateStage stage);
+    /// Update all components of the stage.
+    void Update(Scene* scene, LogicUpdateStage stage, float timeStep);
+
+    /// Return number of components in update stage.
+    unsigned GetNumComponents(LogicUpdateStage stage) const;
+
+private:
+    /// Accessor of index in the list of update stage.
+    struct ComponentIndex
+    {
+        LogicUpdateStage stage_{};
+
+        unsigned GetIndex(const LogicComponent* component) const;
+        void SetIndex(LogicComponent* component, unsigned index) const;
+    };
+
+    /// Components of the same type.
+    struct TypeGroup
+    {
+        /// Component type.
+        StringHash type_;
+        /// Whether the components may be updated in parallel.
+        bool threadSafe_{};
+        /// Components. Removed components are replaced with null until the next update.
+        StableIndexVector<LogicComponent, ComponentIndex> components_;
+    };
+
+    /// Components of one update stage.
+    struct StageData
+    {
+        /// Groups in the order of first appearance of the type.
+        ea::vector<TypeGroup> groups_;
+        /// Index of group by component type.
+        ea::unordered_map<StringHash, unsigned> groupIndexByType_;
+        /// Total number of components.
+        unsigned numComponents_{};
+        /// Whether the stage is being updated now.
+        bool updating_{};
+    };
+
+    /// Update components of the group sequentially.
+    void UpdateGroup(StageData& stageData, unsigned groupIndex, LogicUpdateStage stage, float timeStep);
+    /// Update components of the thread-safe group in parallel.
+    void UpdateGroupInParallel(Scene* scene, StageData& stageData, unsigned groupIndex, LogicUpdateStage stage, float timeStep);
+
+    /// Stages.
+    StageData stages_[static_cast<unsigned>(LogicUpdateStage::Count)];
+};
+
+}
@@ -36,6 +36,8 @@
 #include "../Scene/SceneEvents.h"
 #include "../Scene/UnknownComponent.h"
 
+#include <EASTL/fixed_vector.h>
+
 #include <charconv>
 
 #include "../DebugNew.h"
@@ -805,6 +807,15 @@ void Node::SetEnabledRecursive(bool enable)
 }
 
 void Node::MarkDirty()
+{
+    // Queue topmost dirty node so the Scene can recalculate the whole hierarchy at once
+    if (!dirty_ && scene_)
+        scene_->QueueTransformUpdate(this);
+
+    MarkDirtyRecursive();
+}
+
+void Node::MarkDirtyRecursive()
 {
     Node *cur = this;
     for (;;)
@@ -846,7 +857,7 @@ void Node::MarkDirty()
         {
             Node *next = i->Get();
             for (++i; i != cur->children_.end(); ++i)
-                (*i)->MarkDirty();
+                (*i)->MarkDirtyRecursive();
             cur = next;
         }
         else
@@ -1834,13 +1845,13 @@ void Node::SetTransformSilent(const Matrix3x4& matrix)
 void Node::OnAttributeAnimationAdded()
 {
     if (attributeAnimationInfos_.size() == 1)
-        SubscribeToEvent(GetScene(), E_ATTRIBUTEANIMATIONUPDATE, URHO3D_HANDLER(Node, HandleAttributeAnimationUpdate));
+        SetAttributeAnimationScene(GetScene());
 }
 
 void Node::OnAttributeAnimationRemoved()
 {
     if (attributeAnimationInfos_.empty())
-        UnsubscribeFromEvent(GetScene(), E_ATTRIBUTEANIMATIONUPDATE);
+        SetAttributeAnimationScene(nullptr);
 }
 
 Animatable* Node::FindAttributeAnimationTarget(const ea::string& name, ea::string& outName)
@@ -2035,6 +2046,24 @@ void Node::UpdateWorldTransform() const
     dirty_ = false;
 }
 
+void Node::UpdateWorldTransformHierarchy() const
+{
+    // Parents are always processed before children, so each node is recalculated only once
+    ea::fixed_vector<const Node*, 64> stack;
+    stack.push_back(this);
+    while (!stack.empty())
+    {
+        const Node* node = stack.back();
+        stack.pop_back();
+
+        if (node->dirty_)
+            node->UpdateWorldTransform();
+
+        for (const SharedPtr<Node>& child : node->children_)
+            stack.push_back(child);
+    }
+}
+
 void Node::RemoveChild(ea::vector<SharedPtr<Node> >::iterator i)
 {
     // Keep a shared pointer to the child about to be removed, to make sure the erase from container completes first. Otherwise
@@ -2193,11 +2222,4 @@ void Node::RemoveComponent(ea::vector<SharedPtr<Component> >::iterator i)
     components_.erase(i);
 }
 
-void Node::HandleAttributeAnimationUpdate(StringHash eventType, VariantMap& eventData)
-{
-    using namespace AttributeAnimationUpdate;
-
-    UpdateAttributeAnimations(eventData[P_TIMESTEP].GetFloat());
-}
-
 }
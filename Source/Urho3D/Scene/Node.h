@@ -105,6 +105,8 @@ public:
     bool SaveJSON(JSONValue& dest) const override;
     /// Apply attribute changes that can not be applied immediately recursively to child nodes and components.
     void ApplyAttributes() override;
+    /// Return whether attribute animations may bypass OnSetAttribute. Derived types use OnSetAttribute.
+    bool SupportsNativeAttributeAnimation() const override { return GetType() == Node::GetTypeStatic(); }
 
     /// Return whether should save default-valued attributes into XML. Always save node transforms for readability, even if identity.
     bool SaveDefaultAttributes(const AttributeInfo& attr) const override { return true; }
@@ -556,6 +558,14 @@ public:
 
     /// Return whether transform has changed and world transform needs recalculation.
     bool IsDirty() const { return dirty_; }
+    /// Recalculate dirty world transforms of this node and all its children without recursion.
+    void UpdateWorldTransformHierarchy() const;
+
+    /// Internal. Manage queued batch update of world transforms in the Scene.
+    /// @{
+    void SetTransformUpdateQueued(bool queued) { transformUpdateQueued_ = queued; }
+    bool IsTransformUpdateQueued() const { return transformUpdateQueued_; }
+    /// @}
 
     /// Return number of child scene nodes.
     unsigned GetNumChildren(bool recursive = false) const;
@@ -699,6 +709,8 @@ private:
     Component* SafeCreateComponent(const ea::string& typeName, StringHash type, CreateMode mode, unsigned id);
     /// Recalculate the world transform.
     void UpdateWorldTransform() const;
+    /// Mark node and child nodes dirty without queueing them for batch update.
+    void MarkDirtyRecursive();
     /// Remove child node by iterator.
     void RemoveChild(ea::vector<SharedPtr<Node> >::iterator i);
     /// Return child nodes recursively.
@@ -713,8 +725,6 @@ private:
     Node* CloneRecursive(Node* parent, SceneResolver& resolver, CreateMode mode);
     /// Remove a component from this node with the specified iterator.
     void RemoveComponent(ea::vector<SharedPtr<Component> >::iterator i);
-    /// Handle attribute animation update event.
-    void HandleAttributeAnimationUpdate(StringHash eventType, VariantMap& eventData);
     /// Find child node by index if name is an integer starting with "#" (like "#12" or "#0").
     /// Find child by name otherwise. Empty name is considered invalid.
     Node* GetChildByNameOrIndex(ea::string_view name) const;
@@ -725,6 +735,8 @@ private:
     mutable Matrix3x4 worldTransform_;
     /// World transform needs update flag.
     mutable std::atomic_bool dirty_;
+    /// Whether the node is queued for batch update of world transforms in the Scene.
+    bool transformUpdateQueued_{};
     /// Enabled flag.
     bool enabled_;
     /// Last SetEnabled flag before any SetDeepEnabled.
@@ -31,6 +31,14 @@
 #include "../IO/File.h"
 #include "../IO/Log.h"
 #include "../IO/PackageFile.h"
+#ifdef URHO3D_PHYSICS
+#include "../Physics/PhysicsEvents.h"
+#include "../Physics/PhysicsWorld.h"
+#endif
+#ifdef URHO3D_PHYSICS2D
+#include "../Physics/PhysicsEvents.h"
+#include "../Physics2D/PhysicsWorld2D.h"
+#endif
 #include "../Resource/ResourceCache.h"
 #include "../Resource/ResourceEvents.h"
 #include "../Resource/XMLFile.h"
@@ -79,6 +87,8 @@ Scene::Scene(Context* context) :
 
 Scene::~Scene()
 {
+    ReleaseAttributeAnimationTargets();
+
     // Remove root-level components first, so that scene subsystems such as the octree destroy themselves. This will speed up
     // the removal of child nodes' components
     RemoveAllComponents();
@@ -107,6 +117,63 @@ void Scene::RegisterObject(Context* context)
     URHO3D_ATTRIBUTE_EX("Lightmaps", ResourceRefList, lightmaps_, ReloadLightmaps, ResourceRefList(Texture2D::GetTypeStatic()), AM_DEFAULT);
 }
 
+void SceneComponentIndex::Insert(Component* component)
+{
+    if (Contains(component))
+        return;
+
+    unsigned handle = handleToPosition_.size();
+    if (!freeHandles_.empty())
+    {
+        handle = freeHandles_.back();
+        freeHandles_.pop_back();
+    }
+    else
+        handleToPosition_.push_back(M_MAX_UNSIGNED);
+
+    handleToPosition_[handle] = components_.size();
+    components_.push_back(component);
+    positionToHandle_.push_back(handle);
+    component->sceneIndexHandle_ = handle;
+}
+
+void SceneComponentIndex::Erase(Component* component)
+{
+    const unsigned handle = GetHandle(component);
+    if (handle == M_MAX_UNSIGNED)
+        return;
+
+    // Move the last component into the hole
+    const unsigned position = handleToPosition_[handle];
+    const unsigned lastPosition = components_.size() - 1;
+    if (position != lastPosition)
+    {
+        components_[position] = components_[lastPosition];
+        positionToHandle_[position] = positionToHandle_[lastPosition];
+        handleToPosition_[positionToHandle_[position]] = position;
+    }
+    components_.pop_back();
+    positionToHandle_.pop_back();
+
+    handleToPosition_[handle] = M_MAX_UNSIGNED;
+    freeHandles_.push_back(handle);
+    component->sceneIndexHandle_ = M_MAX_UNSIGNED;
+}
+
+unsigned SceneComponentIndex::GetHandle(const Component* component) const
+{
+    // Component may be indexed in another scene
+    const unsigned handle = component->sceneIndexHandle_;
+    const unsigned position = GetPosition(handle);
+    return position < components_.size() && components_[position] == component ? handle : M_MAX_UNSIGNED;
+}
+
+Component* SceneComponentIndex::GetComponentByHandle(unsigned handle) const
+{
+    const unsigned position = GetPosition(handle);
+    return position < components_.size() ? components_[position] : nullptr;
+}
+
 bool Scene::CreateComponentIndex(StringHash componentType)
 {
     if (!IsEmpty())
@@ -796,8 +863,10 @@ void Scene::Update(float timeStep)
 
     // Update variable timestep logic
     SendEvent(E_SCENEUPDATE, eventData);
+    logicComponentScheduler_.Update(this, LogicUpdateStage::Update, timeStep);
 
-    // Update scene attribute animation.
+    // Update scene attribute animation. Nodes and components are updated in batch, the event is for other animated objects
+    UpdateAttributeAnimationTargets(timeStep);
     SendEvent(E_ATTRIBUTEANIMATIONUPDATE, eventData);
 
     // Update scene subsystems. If a physics world is present, it will be updated, triggering fixed timestep logic updates
@@ -805,6 +874,10 @@ void Scene::Update(float timeStep)
 
     // Post-update variable timestep logic
     SendEvent(E_SCENEPOSTUPDATE, eventData);
+    logicComponentScheduler_.Update(this, LogicUpdateStage::PostUpdate, timeStep);
+
+    // Recalculate world transforms modified during the update all at once
+    UpdateDirtyTransforms();
 
     // Note: using a float for elapsed time accumulation is inherently inaccurate. The purpose of this value is
     // primarily to update material animation effects, as it is available to shaders. It can be reset by calling
@@ -812,6 +885,56 @@ void Scene::Update(float timeStep)
     elapsedTime_ += timeStep;
 }
 
+Component* Scene::FindFixedUpdateSource(const Component* ignoredComponent) const
+{
+#ifdef URHO3D_PHYSICS
+    if (auto physicsWorld = GetComponent<PhysicsWorld>(); physicsWorld && physicsWorld != ignoredComponent)
+        return physicsWorld;
+#endif
+#ifdef URHO3D_PHYSICS2D
+    if (auto physicsWorld2D = GetComponent<PhysicsWorld2D>(); physicsWorld2D && physicsWorld2D != ignoredComponent)
+        return physicsWorld2D;
+#endif
+    return nullptr;
+}
+
+#if defined(URHO3D_PHYSICS) || defined(URHO3D_PHYSICS2D)
+void Scene::UpdateFixedUpdateSubscription(const Component* removedComponent)
+{
+    Component* fixedUpdateSource = FindFixedUpdateSource(removedComponent);
+    if (fixedUpdateSource_ == fixedUpdateSource)
+        return;
+
+    if (fixedUpdateSource_)
+    {
+        UnsubscribeFromEvent(fixedUpdateSource_, E_PHYSICSPRESTEP);
+        UnsubscribeFromEvent(fixedUpdateSource_, E_PHYSICSPOSTSTEP);
+    }
+
+    fixedUpdateSource_ = fixedUpdateSource;
+
+    if (fixedUpdateSource_)
+    {
+        SubscribeToEvent(fixedUpdateSource_, E_PHYSICSPRESTEP, URHO3D_HANDLER(Scene, HandlePhysicsPreStep));
+        SubscribeToEvent(fixedUpdateSource_, E_PHYSICSPOSTSTEP, URHO3D_HANDLER(Scene, HandlePhysicsPostStep));
+    }
+}
+
+void Scene::HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData)
+{
+    using namespace PhysicsPreStep;
+
+    logicComponentScheduler_.Update(this, LogicUpdateStage::FixedUpdate, eventData[P_TIMESTEP].GetFloat());
+}
+
+void Scene::HandlePhysicsPostStep(StringHash eventType, VariantMap& eventData)
+{
+    using namespace PhysicsPostStep;
+
+    logicComponentScheduler_.Update(this, LogicUpdateStage::FixedPostUpdate, eventData[P_TIMESTEP].GetFloat());
+}
+#endif
+
 void Scene::BeginThreadedUpdate()
 {
     // Check the work queue subsystem whether it actually has created worker threads. If not, do not enter threaded mode.
@@ -843,6 +966,97 @@ void Scene::DelayedMarkedDirty(Component* component)
     delayedDirtyComponents_.push_back(component);
 }
 
+void Scene::QueueTransformUpdate(Node* node)
+{
+    MutexLock<SpinLockMutex> lock(transformUpdateMutex_);
+    if (!node->IsTransformUpdateQueued())
+    {
+        node->SetTransformUpdateQueued(true);
+        transformUpdateQueue_.emplace_back(node);
+    }
+}
+
+void Scene::UpdateDirtyTransforms()
+{
+    if (transformUpdateQueue_.empty())
+        return;
+
+    URHO3D_PROFILE("UpdateDirtyTransforms");
+
+    // Hierarchies of different roots don't overlap and can be updated in parallel
+    transformUpdateRoots_.clear();
+    for (Node* node : transformUpdateQueue_)
+    {
+        if (!node || node->GetScene() != this)
+            continue;
+
+        bool isNested = false;
+        for (Node* parent = node->GetParent(); parent; parent = parent->GetParent())
+        {
+            if (parent->IsTransformUpdateQueued())
+            {
+                isNested = true;
+                break;
+            }
+        }
+
+        if (!isNested)
+            transformUpdateRoots_.push_back(node);
+    }
+
+    const auto workQueue = GetSubsystem<WorkQueue>();
+    ForEachParallel(workQueue, 16, transformUpdateRoots_.size(), [&](unsigned beginIndex, unsigned endIndex)
+    {
+        for (unsigned i = beginIndex; i < endIndex; ++i)
+            transformUpdateRoots_[i]->UpdateWorldTransformHierarchy();
+    });
+
+    for (Node* node : transformUpdateQueue_)
+    {
+        if (node)
+            node->SetTransformUpdateQueued(false);
+    }
+    transformUpdateQueue_.clear();
+}
+
+void Scene::AddAttributeAnimationTarget(Animatable* target)
+{
+    attributeAnimationTargets_.Add(target);
+}
+
+void Scene::RemoveAttributeAnimationTarget(Animatable* target)
+{
+    // Don't shift other targets here, they may be iterated right now
+    attributeAnimationTargets_.Remove(target);
+}
+
+void Scene::UpdateAttributeAnimationTargets(float timeStep)
+{
+    attributeAnimationTargets_.Compact();
+    if (attributeAnimationTargets_.Empty())
+        return;
+
+    URHO3D_PROFILE("UpdateAttributeAnimations");
+
+    // Targets added during the update will be updated next time
+    const unsigned numTargets = attributeAnimationTargets_.Size();
+    for (unsigned i = 0; i < numTargets; ++i)
+    {
+        if (Animatable* target = attributeAnimationTargets_[i])
+            target->UpdateAttributeAnimations(timeStep);
+    }
+}
+
+void Scene::ReleaseAttributeAnimationTargets()
+{
+    for (Animatable* target : attributeAnimationTargets_.GetElements())
+    {
+        if (target)
+            target->attributeAnimationScene_ = nullptr;
+    }
+    attributeAnimationTargets_.Clear();
+}
+
 unsigned Scene::GetFreeNodeID(CreateMode mode)
 {
     if (mode == REPLICATED)
@@ -1047,7 +1261,12 @@ void Scene::ComponentAdded(Component* component)
     component->OnSceneSet(this);
 
     if (auto index = GetMutableComponentIndex(component->GetType()))
-        index->insert(component);
+        index->Insert(component);
+
+#if defined(URHO3D_PHYSICS) || defined(URHO3D_PHYSICS2D)
+    if (component->GetNode() == this)
+        UpdateFixedUpdateSubscription(nullptr);
+#endif
 }
 
 void Scene::ComponentRemoved(Component* component)
@@ -1056,7 +1275,7 @@ void Scene::ComponentRemoved(Component* component)
         return;
 
     if (auto index = GetMutableComponentIndex(component->GetType()))
-        index->erase(component);
+        index->Erase(component);
 
     unsigned id = component->GetID();
     if (Scene::IsReplicatedID(id))
@@ -1066,6 +1285,11 @@ void Scene::ComponentRemoved(Component* component)
 
     component->SetID(0);
     component->OnSceneSet(nullptr);
+
+#if defined(URHO3D_PHYSICS) || defined(URHO3D_PHYSICS2D)
+    if (component->GetNode() == this)
+        UpdateFixedUpdateSubscription(component);
+#endif
 }
 
 void Scene::SetVarNamesAttr(const ea::string& value)
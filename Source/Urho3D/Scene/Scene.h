@@ -27,9 +27,11 @@
 #include <EASTL/span.h>
 #include <EASTL/unique_ptr.h>
 
+#include "../Container/StableIndexVector.h"
 #include "../Core/Mutex.h"
 #include "../Resource/XMLElement.h"
 #include "../Resource/JSONFile.h"
+#include "../Scene/LogicComponentScheduler.h"
 #include "../Scene/Node.h"
 #include "../Scene/SceneResolver.h"
 
@@ -86,8 +88,53 @@ struct AsyncProgress
     unsigned totalNodes_;
 };
 
-/// Index of components in the Scene.
-using SceneComponentIndex = ea::hash_set<Component*>;
+/// Dense index of components of one type in the Scene.
+/// Components are stored contiguously and removed by swapping with the last one, so order is not preserved.
+/// Handles stay valid while the component is in the index and may be reused afterwards.
+class URHO3D_API SceneComponentIndex
+{
+public:
+    /// Add component to the index.
+    void Insert(Component* component);
+    /// Remove component from the index.
+    void Erase(Component* component);
+
+    /// Return whether the component is in the index.
+    bool Contains(const Component* component) const { return GetHandle(component) != M_MAX_UNSIGNED; }
+    /// Return handle of the component, or M_MAX_UNSIGNED if not in the index.
+    unsigned GetHandle(const Component* component) const;
+    /// Return component by handle, or null if the handle is not used.
+    Component* GetComponentByHandle(unsigned handle) const;
+    /// Return current position of the component in the contiguous array.
+    unsigned GetPosition(unsigned handle) const { return handle < handleToPosition_.size() ? handleToPosition_[handle] : M_MAX_UNSIGNED; }
+
+    /// Return all components.
+    ea::span<Component* const> GetComponents() const { return components_; }
+    /// Return all components cast to given type. T should be the indexed component type.
+    template <class T> ea::span<T* const> GetComponents() const
+    {
+        return {reinterpret_cast<T* const*>(components_.data()), components_.size()};
+    }
+
+    /// Container interface.
+    /// @{
+    unsigned size() const { return components_.size(); }
+    bool empty() const { return components_.empty(); }
+    Component* const* begin() const { return components_.begin(); }
+    Component* const* end() const { return components_.end(); }
+    Component* operator[](unsigned position) const { return components_[position]; }
+    /// @}
+
+private:
+    /// Components.
+    ea::vector<Component*> components_;
+    /// Handle of each component, parallel to components_.
+    ea::vector<unsigned> positionToHandle_;
+    /// Position of the component for each handle, M_MAX_UNSIGNED for unused handles.
+    ea::vector<unsigned> handleToPosition_;
+    /// Unused handles.
+    ea::vector<unsigned> freeHandles_;
+};
 
 /// Root scene node, represents the whole scene.
 class URHO3D_API Scene : public Node
@@ -118,6 +165,8 @@ public:
     const SceneComponentIndex& GetComponentIndex(StringHash componentType);
     /// Return component index for template type. Invalidated when indexed component is added or removed!
     template <class T> const SceneComponentIndex& GetComponentIndex() { return GetComponentIndex(T::GetTypeStatic()); }
+    /// Return contiguous array of indexed components of template type. Invalidated when indexed component is added or removed!
+    template <class T> ea::span<T* const> GetIndexedComponents() { return GetComponentIndex(T::GetTypeStatic()).template GetComponents<T>(); }
 
     /// Serialize object. May throw ArchiveException.
     void SerializeInBlock(Archive& archive) override;
@@ -257,9 +306,25 @@ public:
     void EndThreadedUpdate();
     /// Add a component to the delayed dirty notify queue. Is thread-safe.
     void DelayedMarkedDirty(Component* component);
+    /// Queue node with dirty world transform for batch update. Is thread-safe.
+    void QueueTransformUpdate(Node* node);
+    /// Recalculate all dirty world transforms of queued nodes and their children in parallel. Called at the end of Update.
+    void UpdateDirtyTransforms();
+    /// Return number of nodes queued for batch update of world transforms.
+    unsigned GetNumQueuedTransformUpdates() const { return transformUpdateQueue_.size(); }
+    /// Add Animatable to batched attribute animation update. For internal use only.
+    void AddAttributeAnimationTarget(Animatable* target);
+    /// Remove Animatable from batched attribute animation update. Safe to call during the update. For internal use only.
+    void RemoveAttributeAnimationTarget(Animatable* target);
+    /// Return number of Animatable-s with attribute animations updated in batch.
+    unsigned GetNumAttributeAnimationTargets() const { return attributeAnimationTargets_.GetNumElements(); }
 
     /// Return threaded update flag.
     bool IsThreadedUpdate() const { return threadedUpdate_; }
+    /// Return update lists of logic components.
+    LogicComponentScheduler& GetLogicComponentScheduler() { return logicComponentScheduler_; }
+    /// Return the scene component that sends out fixed update events (either PhysicsWorld or PhysicsWorld2D). Return null if neither exists.
+    Component* GetFixedUpdateSource() const { return FindFixedUpdateSource(nullptr); }
 
     /// Get free node ID, either non-local or local.
     unsigned GetFreeNodeID(CreateMode mode);
@@ -291,6 +356,20 @@ private:
     void HandleUpdate(StringHash eventType, VariantMap& eventData);
     /// Handle a background loaded resource completing.
     void HandleResourceBackgroundLoaded(StringHash eventType, VariantMap& eventData);
+    /// Update attribute animations of all Animatable-s in batch.
+    void UpdateAttributeAnimationTargets(float timeStep);
+    /// Stop batched attribute animation update of all Animatable-s.
+    void ReleaseAttributeAnimationTargets();
+    /// Return the scene component that sends out fixed update events, ignoring the component being removed.
+    Component* FindFixedUpdateSource(const Component* ignoredComponent) const;
+#if defined(URHO3D_PHYSICS) || defined(URHO3D_PHYSICS2D)
+    /// Subscribe to physics step events of the current fixed update source.
+    void UpdateFixedUpdateSubscription(const Component* removedComponent);
+    /// Handle physics pre-step event to run fixed update of logic components.
+    void HandlePhysicsPreStep(StringHash eventType, VariantMap& eventData);
+    /// Handle physics post-step event to run fixed post-update of logic components.
+    void HandlePhysicsPostStep(StringHash eventType, VariantMap& eventData);
+#endif
     /// Update asynchronous loading.
     void UpdateAsyncLoading();
     /// Finish asynchronous loading.
@@ -339,6 +418,12 @@ private:
     ea::vector<Component*> delayedDirtyComponents_;
     /// Mutex for the delayed dirty notification queue.
     Mutex sceneMutex_;
+    /// Topmost nodes whose world transforms became dirty.
+    ea::vector<WeakPtr<Node>> transformUpdateQueue_;
+    /// Mutex for the transform update queue.
+    SpinLockMutex transformUpdateMutex_;
+    /// Queued nodes that are not children of other queued nodes.
+    ea::vector<Node*> transformUpdateRoots_;
     /// Next free non-local node ID.
     unsigned replicatedNodeID_;
     /// Next free non-local component ID.
@@ -361,6 +446,18 @@ private:
     bool asyncLoading_;
     /// Threaded update flag.
     bool threadedUpdate_;
+    /// Update lists of logic components.
+    LogicComponentScheduler logicComponentScheduler_;
+    /// Physics world which step events drive fixed updates of logic components.
+    WeakPtr<Component> fixedUpdateSource_;
+    /// Accessor of index in attributeAnimationTargets_.
+    struct AttributeAnimationTargetIndex
+    {
+        unsigned GetIndex(const Animatable* target) const { return target->attributeAnimationSceneIndex_; }
+        void SetIndex(Animatable* target, unsigned index) const { target->attributeAnimationSceneIndex_ = index; }
+    };
+    /// Animatable-s with attribute animations updated in batch. Removed elements are replaced with null until the next update.
+    StableIndexVector<Animatable, AttributeAnimationTargetIndex> attributeAnimationTargets_;
 
     /// Lightmap textures names.
     ResourceRefList lightmaps_;
@@ -152,15 +152,14 @@ void SceneManager::UpdateViewports()
         return;
 
     unsigned index = 0;
-    const SceneComponentIndex& viewportComponents = activeScene_->GetComponentIndex<CameraViewport>();
+    const auto viewportComponents = activeScene_->GetIndexedComponents<CameraViewport>();
     if (renderSurface_.Expired())
         context_->GetSubsystem<Renderer>()->SetNumViewports(viewportComponents.size());
     else
         renderSurface_->SetNumViewports(viewportComponents.size());
 
-    for (Component* const component : viewportComponents)
+    for (CameraViewport* const cameraViewport : viewportComponents)
     {
-        auto* const cameraViewport = static_cast<CameraViewport* const>(component);
         // Trigger resizing of underlying viewport
         if (renderSurface_.Expired())
             cameraViewport->SetScreenRect({0, 0, context_->GetSubsystem<Graphics>()->GetWidth(), context_->GetSubsystem<Graphics>()->GetHeight()});
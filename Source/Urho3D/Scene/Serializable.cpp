@@ -71,6 +71,16 @@ Serializable::Serializable(Context* context) :
 
 Serializable::~Serializable() = default;
 
+bool Serializable::OnSetAttributeValue(const AttributeInfo& attr, const void* src)
+{
+    // Instance defaults are stored as Variant anyway
+    if (setInstanceDefault_ || !attr.accessor_ || attr.accessor_->GetValueType() != attr.type_)
+        return false;
+
+    attr.accessor_->SetValue(this, src);
+    return true;
+}
+
 void Serializable::OnSetAttribute(const AttributeInfo& attr, const Variant& src)
 {
     // TODO: may be could use an observer pattern here
@@ -51,6 +51,10 @@ public:
 
     /// Handle attribute write access. Default implementation writes to the variable at offset, or invokes the set accessor.
     virtual void OnSetAttribute(const AttributeInfo& attr, const Variant& src);
+    /// Handle attribute write access with the value of the type returned by AttributeAccessor::GetValueType, bypassing Variant.
+    /// Return false if not supported, OnSetAttribute should be used instead.
+    /// @nobind
+    virtual bool OnSetAttributeValue(const AttributeInfo& attr, const void* src);
     /// Handle attribute read access. Default implementation reads the variable at offset, or invokes the get accessor.
     virtual void OnGetAttribute(const AttributeInfo& attr, Variant& dest) const;
     /// Return reflection used for serialization.
@@ -175,15 +179,72 @@ SharedPtr<AttributeAccessor> MakeVariantAttributeAccessor(TGetFunction getFuncti
     return SharedPtr<AttributeAccessor>(new VariantAttributeAccessorImpl<TClassType, TGetFunction, TSetFunction>(getFunction, setFunction));
 }
 
+/// Template implementation of the attribute accessor with setter of known value type.
+/// Values of types accepted by IsTypedAttributeValue may be set without Variant.
+template <class TClassType, class T, class TGetFunction, class TSetFunction>
+class TypedAttributeAccessorImpl : public AttributeAccessor
+{
+public:
+    /// Construct.
+    TypedAttributeAccessorImpl(TGetFunction getFunction, TSetFunction setFunction) : getFunction_(getFunction), setFunction_(setFunction) { }
+
+    /// Invoke getter function.
+    void Get(const Serializable* ptr, Variant& value) const override
+    {
+        assert(ptr);
+        const auto classPtr = static_cast<const TClassType*>(ptr);
+        getFunction_(*classPtr, value);
+    }
+
+    /// Invoke setter function.
+    void Set(Serializable* ptr, const Variant& value) override
+    {
+        assert(ptr);
+        auto classPtr = static_cast<TClassType*>(ptr);
+        setFunction_(*classPtr, value.Get<T>());
+    }
+
+    /// Return type of the value accepted by SetValue.
+    VariantType GetValueType() const override
+    {
+        return IsTypedAttributeValue<T>() ? GetVariantType<T>() : VAR_NONE;
+    }
+
+    /// Invoke setter function with the value of type T.
+    void SetValue(Serializable* ptr, const void* value) override
+    {
+        assert(ptr && value);
+        auto classPtr = static_cast<TClassType*>(ptr);
+        setFunction_(*classPtr, *static_cast<const T*>(value));
+    }
+
+private:
+    /// Get functor.
+    TGetFunction getFunction_;
+    /// Set functor.
+    TSetFunction setFunction_;
+};
+
+/// Make typed attribute accessor implementation.
+/// \tparam TClassType Serializable class type.
+/// \tparam T Attribute value type.
+/// \tparam TGetFunction Functional object with call signature `void getFunction(const TClassType& self, Variant& value)`
+/// \tparam TSetFunction Functional object with call signature `void setFunction(TClassType& self, const T& value)`
+template <class TClassType, class T, class TGetFunction, class TSetFunction>
+SharedPtr<AttributeAccessor> MakeTypedAttributeAccessor(TGetFunction getFunction, TSetFunction setFunction)
+{
+    return SharedPtr<AttributeAccessor>(new TypedAttributeAccessorImpl<TClassType, T, TGetFunction, TSetFunction>(getFunction, setFunction));
+}
+
 /// Make member attribute accessor.
-#define URHO3D_MAKE_MEMBER_ATTRIBUTE_ACCESSOR(typeName, variable) Urho3D::MakeVariantAttributeAccessor<ClassName>( \
+#define URHO3D_MAKE_MEMBER_ATTRIBUTE_ACCESSOR(typeName, variable) Urho3D::MakeTypedAttributeAccessor<ClassName, typeName>( \
     [](const ClassName& self, Urho3D::Variant& value) { value = self.variable; }, \
-    [](ClassName& self, const Urho3D::Variant& value) { self.variable = value.Get<typeName>(); })
+    [](ClassName& self, const typeName& value) { self.variable = value; })
 
 /// Make member attribute accessor with custom post-set callback.
-#define URHO3D_MAKE_MEMBER_ATTRIBUTE_ACCESSOR_EX(typeName, variable, postSetCallback) Urho3D::MakeVariantAttributeAccessor<ClassName>( \
+#define URHO3D_MAKE_MEMBER_ATTRIBUTE_ACCESSOR_EX(typeName, variable, postSetCallback) Urho3D::MakeTypedAttributeAccessor<ClassName, typeName>( \
     [](const ClassName& self, Urho3D::Variant& value) { value = self.variable; }, \
-    [](ClassName& self, const Urho3D::Variant& value) { self.variable = value.Get<typeName>(); self.postSetCallback(); })
+    [](ClassName& self, const typeName& value) { self.variable = value; self.postSetCallback(); })
 
 /// Make custom member attribute accessor.
 #define URHO3D_MAKE_CUSTOM_MEMBER_ATTRIBUTE_ACCESSOR(typeName, variable) Urho3D::MakeVariantAttributeAccessor<ClassName>( \
@@ -191,9 +252,9 @@ SharedPtr<AttributeAccessor> MakeVariantAttributeAccessor(TGetFunction getFuncti
     [](ClassName& self, const Urho3D::Variant& value) { self.variable = value.GetCustom<typeName>(); })
 
 /// Make get/set attribute accessor.
-#define URHO3D_MAKE_GET_SET_ATTRIBUTE_ACCESSOR(getFunction, setFunction, typeName) Urho3D::MakeVariantAttributeAccessor<ClassName>( \
+#define URHO3D_MAKE_GET_SET_ATTRIBUTE_ACCESSOR(getFunction, setFunction, typeName) Urho3D::MakeTypedAttributeAccessor<ClassName, typeName>( \
     [](const ClassName& self, Urho3D::Variant& value) { value = self.getFunction(); }, \
-    [](ClassName& self, const Urho3D::Variant& value) { self.setFunction(value.Get<typeName>()); })
+    [](ClassName& self, const typeName& value) { self.setFunction(value); })
 
 /// Make member enum attribute accessor.
 #define URHO3D_MAKE_MEMBER_ENUM_ATTRIBUTE_ACCESSOR(variable) Urho3D::MakeVariantAttributeAccessor<ClassName>( \
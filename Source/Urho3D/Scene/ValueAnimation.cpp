@@ -48,6 +48,43 @@ const char* interpMethodNames[] =
     nullptr
 };
 
+namespace
+{
+
+float LerpAnimationValue(float value1, float value2, float t) { return Lerp(value1, value2, t); }
+double LerpAnimationValue(double value1, double value2, float t) { return value1 * (1.0f - t) + value2 * t; }
+Quaternion LerpAnimationValue(const Quaternion& value1, const Quaternion& value2, float t) { return value1.Slerp(value2, t); }
+
+IntRect LerpAnimationValue(const IntRect& value1, const IntRect& value2, float t)
+{
+    const float s = 1.0f - t;
+    return IntRect((int)(value1.left_ * s + value2.left_ * t), (int)(value1.top_ * s + value2.top_ * t),
+        (int)(value1.right_ * s + value2.right_ * t), (int)(value1.bottom_ * s + value2.bottom_ * t));
+}
+
+IntVector2 LerpAnimationValue(const IntVector2& value1, const IntVector2& value2, float t)
+{
+    const float s = 1.0f - t;
+    return IntVector2((int)(value1.x_ * s + value2.x_ * t), (int)(value1.y_ * s + value2.y_ * t));
+}
+
+IntVector3 LerpAnimationValue(const IntVector3& value1, const IntVector3& value2, float t)
+{
+    const float s = 1.0f - t;
+    return IntVector3((int)(value1.x_ * s + value2.x_ * t), (int)(value1.y_ * s + value2.y_ * t), (int)(value1.z_ * s + value2.z_ * t));
+}
+
+/// Vector2, Vector3, Vector4 and Color.
+template <class T> T LerpAnimationValue(const T& value1, const T& value2, float t) { return value1.Lerp(value2, t); }
+
+/// Return whether the value type supports spline interpolation.
+template <class T> constexpr bool IsSplineAnimationValue()
+{
+    return !ea::is_same_v<T, IntRect> && !ea::is_same_v<T, IntVector2> && !ea::is_same_v<T, IntVector3>;
+}
+
+}
+
 ValueAnimation::ValueAnimation(Context* context) :
     Resource(context),
     owner_(nullptr),
@@ -245,6 +282,7 @@ void ValueAnimation::SetValueType(VariantType valueType)
 
     keyFrames_.clear();
     eventFrames_.clear();
+    nativeData_.reset();
     beginTime_ = M_INFINITY;
     endTime_ = -M_INFINITY;
 }
@@ -265,12 +303,14 @@ void ValueAnimation::SetInterpolationMethod(InterpMethod method)
 
     interpolationMethod_ = method;
     splineTangentsDirty_ = true;
+    nativeData_.reset();
 }
 
 void ValueAnimation::SetSplineTension(float tension)
 {
     splineTension_ = tension;
     splineTangentsDirty_ = true;
+    nativeData_.reset();
 }
 
 bool ValueAnimation::SetKeyFrame(float time, const Variant& value)
@@ -304,6 +344,7 @@ bool ValueAnimation::SetKeyFrame(float time, const Variant& value)
     beginTime_ = Min(time, beginTime_);
     endTime_ = Max(time, endTime_);
     splineTangentsDirty_ = true;
+    nativeData_.reset();
 
     return true;
 }
@@ -360,6 +401,43 @@ Variant ValueAnimation::GetAnimationValue(float scaledTime) const
     }
 }
 
+template <class T> T ValueAnimation::SampleValue(float scaledTime) const
+{
+    const ValueAnimationNativeData<T>& data = GetNativeData<T>();
+    const unsigned numKeyFrames = data.values_.size();
+    if (numKeyFrames == 0)
+        return T{};
+
+    // Same key frame as in GetAnimationValue, but found with binary search
+    const auto nextKeyFrame = ea::upper_bound(data.times_.begin(), data.times_.end(), scaledTime);
+    const unsigned index = Max(1u, static_cast<unsigned>(nextKeyFrame - data.times_.begin()));
+
+    if (index >= numKeyFrames || !interpolatable_ || interpolationMethod_ == IM_NONE)
+        return data.values_[index - 1];
+
+    const float t = (scaledTime - data.times_[index - 1]) / (data.times_[index] - data.times_[index - 1]);
+    const T& value1 = data.values_[index - 1];
+    const T& value2 = data.values_[index];
+
+    if constexpr (IsSplineAnimationValue<T>())
+    {
+        if (interpolationMethod_ == IM_SPLINE && data.tangents_.size() == numKeyFrames)
+        {
+            const float tt = t * t;
+            const float ttt = t * tt;
+
+            const float h1 = 2.0f * ttt - 3.0f * tt + 1.0f;
+            const float h2 = -2.0f * ttt + 3.0f * tt;
+            const float h3 = ttt - 2.0f * tt + t;
+            const float h4 = ttt - tt;
+
+            return value1 * h1 + value2 * h2 + data.tangents_[index - 1] * h3 + data.tangents_[index] * h4;
+        }
+    }
+
+    return LerpAnimationValue(value1, value2, t);
+}
+
 void ValueAnimation::GetEventFrames(float beginTime, float endTime, ea::vector<const VAnimEventFrame*>& eventFrames) const
 {
     for (unsigned i = 0; i < eventFrames_.size(); ++i)
@@ -512,6 +590,37 @@ void ValueAnimation::UpdateSplineTangents() const
     splineTangentsDirty_ = false;
 }
 
+template <class T> const ValueAnimationNativeData<T>& ValueAnimation::GetNativeData() const
+{
+    assert(valueType_ == GetVariantType<T>());
+
+    if (!nativeData_)
+    {
+        auto data = ea::make_unique<ValueAnimationNativeData<T>>();
+        data->times_.reserve(keyFrames_.size());
+        data->values_.reserve(keyFrames_.size());
+        for (const VAnimKeyFrame& keyFrame : keyFrames_)
+        {
+            data->times_.push_back(keyFrame.time_);
+            data->values_.push_back(keyFrame.value_.Get<T>());
+        }
+
+        if (interpolationMethod_ == IM_SPLINE)
+        {
+            if (splineTangentsDirty_)
+                UpdateSplineTangents();
+
+            data->tangents_.reserve(splineTangents_.size());
+            for (const Variant& tangent : splineTangents_)
+                data->tangents_.push_back(tangent.Get<T>());
+        }
+
+        nativeData_ = ea::move(data);
+    }
+
+    return static_cast<const ValueAnimationNativeData<T>&>(*nativeData_);
+}
+
 Variant ValueAnimation::SubstractAndMultiply(const Variant& value1, const Variant& value2, float t) const
 {
     switch (valueType_)
@@ -543,4 +652,16 @@ Variant ValueAnimation::SubstractAndMultiply(const Variant& value1, const Varian
     }
 }
 
+// Instantiate value sampling for all types supported by typed attribute accessors
+template float ValueAnimation::SampleValue<float>(float scaledTime) const;
+template double ValueAnimation::SampleValue<double>(float scaledTime) const;
+template Vector2 ValueAnimation::SampleValue<Vector2>(float scaledTime) const;
+template Vector3 ValueAnimation::SampleValue<Vector3>(float scaledTime) const;
+template Vector4 ValueAnimation::SampleValue<Vector4>(float scaledTime) const;
+template Quaternion ValueAnimation::SampleValue<Quaternion>(float scaledTime) const;
+template Color ValueAnimation::SampleValue<Color>(float scaledTime) const;
+template IntRect ValueAnimation::SampleValue<IntRect>(float scaledTime) const;
+template IntVector2 ValueAnimation::SampleValue<IntVector2>(float scaledTime) const;
+template IntVector3 ValueAnimation::SampleValue<IntVector3>(float scaledTime) const;
+
 }
@@ -27,6 +27,8 @@
 #include "../Core/Variant.h"
 #include "../Resource/Resource.h"
 
+#include <EASTL/unique_ptr.h>
+
 namespace Urho3D
 {
 
@@ -66,6 +68,24 @@ struct VAnimEventFrame
     VariantMap eventData_{};
 };
 
+/// Key frames of value animation unpacked into native value type.
+struct ValueAnimationNativeDataBase
+{
+    /// Destruct.
+    virtual ~ValueAnimationNativeDataBase() = default;
+};
+
+/// Key frames of value animation unpacked into native value type T.
+template <class T> struct ValueAnimationNativeData : public ValueAnimationNativeDataBase
+{
+    /// Key frame times.
+    ea::vector<float> times_;
+    /// Key frame values.
+    ea::vector<T> values_;
+    /// Spline tangents, empty if spline interpolation is not used.
+    ea::vector<T> tangents_;
+};
+
 /// Value animation class.
 class URHO3D_API ValueAnimation : public Resource
 {
@@ -136,6 +156,10 @@ public:
 
     /// Return animation value.
     Variant GetAnimationValue(float scaledTime) const;
+    /// Return animation value without Variant conversions. T should match value type.
+    /// Supported for value types accepted by IsTypedAttributeValue.
+    /// @nobind
+    template <class T> T SampleValue(float scaledTime) const;
 
     /// Return all key frames.
     const ea::vector<VAnimKeyFrame>& GetKeyFrames() const { return keyFrames_; }
@@ -155,6 +179,8 @@ protected:
     void UpdateSplineTangents() const;
     /// Return (value1 - value2) * t.
     Variant SubstractAndMultiply(const Variant& value1, const Variant& value2, float t) const;
+    /// Return key frames unpacked into native value type, rebuild if dirty.
+    template <class T> const ValueAnimationNativeData<T>& GetNativeData() const;
 
     /// Owner.
     void* owner_;
@@ -176,6 +202,8 @@ protected:
     mutable VariantVector splineTangents_;
     /// Spline tangents dirty.
     mutable bool splineTangentsDirty_;
+    /// Key frames unpacked into native value type. Reset when key frames or interpolation are changed.
+    mutable ea::unique_ptr<ValueAnimationNativeDataBase> nativeData_;
     /// Event frames.
     ea::vector<VAnimEventFrame> eventFrames_;
 };
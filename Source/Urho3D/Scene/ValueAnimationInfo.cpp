@@ -88,7 +88,8 @@ bool ValueAnimationInfo::SetTime(float time)
     float scaledTime = CalculateScaledTime(currentTime_, finished);
 
     // Apply to the target object
-    ApplyValue(animation_->GetAnimationValue(scaledTime));
+    if (!ApplyNativeValue(scaledTime))
+        ApplyValue(animation_->GetAnimationValue(scaledTime));
 
     // Send keyframe event if necessary
     if (animation_->HasEventFrames())
@@ -77,6 +77,9 @@ public:
 protected:
     /// Apply new animation value to the target object. Called by Update().
     virtual void ApplyValue(const Variant& newValue);
+    /// Sample animation and apply value of native type to the target object, bypassing Variant. Called by Update().
+    /// Return false if not supported, ApplyValue is used then.
+    virtual bool ApplyNativeValue(float scaledTime) { return false; }
     /// Calculate scaled time.
     float CalculateScaledTime(float currentTime, bool& finished) const;
     /// Return event frames.